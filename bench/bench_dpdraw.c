@@ -0,0 +1,180 @@
+/**
+ * @file        bench_dpdraw.c
+ * @authors     Jamie Oaks
+ * @package     ABACUS (Approximate BAyesian C UtilitieS)
+ * @brief       Benchmarks of the random partition draws used by dpdraw.
+ * @copyright   Copyright (C) 2013 Jamie Oaks.
+ *   This file is part of ABACUS.  ABACUS is free software; you can
+ *   redistribute it and/or modify it under the terms of the GNU General Public
+ *   License as published by the Free Software Foundation; either version 2 of
+ *   the License, or (at your option) any later version.
+ * 
+ *   ABACUS is distributed in the hope that it will be useful, but WITHOUT ANY
+ *   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *   FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *   details.
+ * 
+ *   You should have received a copy of the GNU General Public License along
+ *   with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gsl/gsl_rng.h>
+
+#include "bench_utils.h"
+#include "partition_combinatorics_random.h"
+
+// the number of draws timed in each run
+#define BENCH_NUM_DRAWS 100000
+#define BENCH_NUM_CATEGORY_DRAWS 10000
+
+static volatile double bench_sink;
+
+static void bench_dirichlet_process_draw(FILE * results,
+        const bench_config * conf, const char * size, gsl_rng * rng,
+        double alpha) {
+    int r, i;
+    i_array * elements;
+    bench_result result;
+    elements = init_i_array(conf->n);
+    init_bench_result(&result, "dirichlet_process_draw", size,
+            BENCH_NUM_DRAWS);
+    for (r = 0; r < conf->num_repeats; r++) {
+        start_bench_run(&result);
+        for (i = 0; i < BENCH_NUM_DRAWS; i++) {
+            bench_sink = dirichlet_process_draw(rng, conf->n, alpha,
+                    elements);
+        }
+        stop_bench_run(&result);
+    }
+    write_bench_result(results, &result);
+    free_i_array(elements);
+}
+
+static void bench_draw_int_partition_category(FILE * results,
+        const bench_config * conf, const char * size, gsl_rng * rng) {
+    int r, i;
+    bench_result result;
+    init_bench_result(&result, "draw_int_partition_category", size,
+            BENCH_NUM_CATEGORY_DRAWS);
+    for (r = 0; r < conf->num_repeats; r++) {
+        start_bench_run(&result);
+        for (i = 0; i < BENCH_NUM_CATEGORY_DRAWS; i++) {
+            bench_sink = draw_int_partition_category(rng, conf->n);
+        }
+        stop_bench_run(&result);
+    }
+    write_bench_result(results, &result);
+}
+
+static void bench_draw_int_partition_category_alias(FILE * results,
+        const bench_config * conf, const char * size, gsl_rng * rng) {
+    int r, i;
+    int_partition_category_sampler * s;
+    bench_result result;
+    s = init_int_partition_category_sampler(conf->n);
+    init_bench_result(&result, "draw_int_partition_category_alias", size,
+            BENCH_NUM_DRAWS);
+    for (r = 0; r < conf->num_repeats; r++) {
+        start_bench_run(&result);
+        for (i = 0; i < BENCH_NUM_DRAWS; i++) {
+            bench_sink = draw_int_partition_category_alias(rng, s);
+        }
+        stop_bench_run(&result);
+    }
+    write_bench_result(results, &result);
+    free_int_partition_category_sampler(s);
+}
+
+static void bench_draw_int_partition(FILE * results,
+        const bench_config * conf, const char * size, gsl_rng * rng) {
+    int r, i;
+    i_array * parts;
+    int_partition_sampler * s;
+    bench_result result;
+    parts = init_i_array(conf->n);
+    s = init_int_partition_sampler(conf->n);
+    init_bench_result(&result, "draw_int_partition", size,
+            BENCH_NUM_CATEGORY_DRAWS);
+    for (r = 0; r < conf->num_repeats; r++) {
+        start_bench_run(&result);
+        for (i = 0; i < BENCH_NUM_CATEGORY_DRAWS; i++) {
+            bench_sink = draw_int_partition(rng, s, parts);
+        }
+        stop_bench_run(&result);
+    }
+    write_bench_result(results, &result);
+    free_int_partition_sampler(s);
+    free_i_array(parts);
+}
+
+static void bench_draw_int_partition_boltzmann(FILE * results,
+        const bench_config * conf, const char * size, gsl_rng * rng) {
+    int r, i;
+    i_array * parts;
+    bench_result result;
+    parts = init_i_array(conf->n);
+    init_bench_result(&result, "draw_int_partition_boltzmann", size,
+            BENCH_NUM_CATEGORY_DRAWS);
+    for (r = 0; r < conf->num_repeats; r++) {
+        start_bench_run(&result);
+        for (i = 0; i < BENCH_NUM_CATEGORY_DRAWS; i++) {
+            bench_sink = draw_int_partition_boltzmann(rng, conf->n, parts);
+        }
+        stop_bench_run(&result);
+    }
+    write_bench_result(results, &result);
+    free_i_array(parts);
+}
+
+static void bench_draw_set_partition_by_k(FILE * results,
+        const bench_config * conf, gsl_rng * rng) {
+    int r, i, k;
+    char size[128];
+    i_array * elements;
+    set_partition_table * t;
+    bench_result result;
+    k = (conf->n + 1) / 2;
+    elements = init_i_array(conf->n);
+    t = init_set_partition_table(conf->n, 0);
+    snprintf(size, sizeof(size), "n=%d;k=%d", conf->n, k);
+    init_bench_result(&result, "draw_set_partition_by_k", size,
+            BENCH_NUM_DRAWS);
+    for (r = 0; r < conf->num_repeats; r++) {
+        start_bench_run(&result);
+        for (i = 0; i < BENCH_NUM_DRAWS; i++) {
+            bench_sink = draw_set_partition_by_k(rng, t, conf->n, k,
+                    elements);
+        }
+        stop_bench_run(&result);
+    }
+    write_bench_result(results, &result);
+    free_set_partition_table(t);
+    free_i_array(elements);
+}
+
+int main(int argc, char ** argv) {
+    double alpha;
+    char size[128];
+    FILE * results;
+    bench_config * conf;
+    gsl_rng * rng;
+    conf = init_bench_config(100);
+    parse_bench_args(conf, "bench_dpdraw",
+            "Number of elements. Default: 100.", argc, argv);
+    rng = gsl_rng_alloc(gsl_rng_mt19937);
+    gsl_rng_set(rng, conf->seed);
+    results = open_bench_results(conf->results_path);
+    alpha = 1.0;
+    snprintf(size, sizeof(size), "n=%d;alpha=%g", conf->n, alpha);
+    bench_dirichlet_process_draw(results, conf, size, rng, alpha);
+    snprintf(size, sizeof(size), "n=%d", conf->n);
+    bench_draw_int_partition_category(results, conf, size, rng);
+    bench_draw_int_partition_category_alias(results, conf, size, rng);
+    bench_draw_int_partition(results, conf, size, rng);
+    bench_draw_int_partition_boltzmann(results, conf, size, rng);
+    bench_draw_set_partition_by_k(results, conf, rng);
+    close_bench_results(results);
+    gsl_rng_free(rng);
+    free_bench_config(conf);
+    return 0;
+}
@@ -0,0 +1,295 @@
+/**
+ * @file        bench_eureject.c
+ * @authors     Jamie Oaks
+ * @package     ABACUS (Approximate BAyesian C UtilitieS)
+ * @brief       Benchmarks of parsing and rejection in eureject.
+ * @copyright   Copyright (C) 2013 Jamie Oaks.
+ *   This file is part of ABACUS.  ABACUS is free software; you can
+ *   redistribute it and/or modify it under the terms of the GNU General Public
+ *   License as published by the Free Software Foundation; either version 2 of
+ *   the License, or (at your option) any later version.
+ * 
+ *   ABACUS is distributed in the hope that it will be useful, but WITHOUT ANY
+ *   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *   FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *   details.
+ * 
+ *   You should have received a copy of the GNU General Public License along
+ *   with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "bench_utils.h"
+#include "eureject.h"
+
+// the rows held in memory for the get_doubles benchmark
+#define BENCH_MAX_SPLIT_ROWS 10000
+
+// the columns of the header matched by the get_matching_indices benchmark,
+// as many as a table of site-frequency-spectrum stats can have
+#define BENCH_NUM_HEADER_COLUMNS 20000
+
+static volatile double bench_sink;
+
+/**
+ * Read the lines of the table (after its header) into `lines`.
+ */
+static void read_lines(const char * path, c_array * line_buffer,
+        s_array * lines) {
+    FILE * f;
+    int line_num;
+    if ((f = fopen(path, "r")) == NULL) {
+        perror(path);
+        exit(1);
+    }
+    line_num = 0;
+    lines->length = 0;
+    while (fgets(line_buffer->a, (line_buffer->capacity - 1), f) != NULL) {
+        line_num++;
+        if (line_num == 1) continue;
+        append_s_array(lines, line_buffer->a);
+    }
+    fclose(f);
+}
+
+static void bench_split_str(FILE * results, const bench_config * conf,
+        const char * size, const s_array * lines, int num_columns) {
+    int r, i;
+    s_array * words;
+    bench_result result;
+    words = init_s_array(num_columns);
+    init_bench_result(&result, "split_str", size, lines->length);
+    for (r = 0; r < conf->num_repeats; r++) {
+        start_bench_run(&result);
+        for (i = 0; i < lines->length; i++) {
+            split_str(get_s_array(lines, i), words, num_columns);
+        }
+        stop_bench_run(&result);
+    }
+    write_bench_result(results, &result);
+    free_s_array(words);
+}
+
+static void bench_get_matching_indices(FILE * results,
+        const bench_config * conf) {
+    int r, i;
+    char name[32];
+    char size[64];
+    s_array * stat_names;
+    s_array * header;
+    i_array * indices;
+    bench_result result;
+    stat_names = init_s_array(BENCH_NUM_HEADER_COLUMNS);
+    header = init_s_array(BENCH_NUM_HEADER_COLUMNS + 2);
+    indices = init_i_array(BENCH_NUM_HEADER_COLUMNS);
+    append_s_array(header, "param.1");
+    append_s_array(header, "param.2");
+    for (i = 0; i < BENCH_NUM_HEADER_COLUMNS; i++) {
+        sprintf(name, "stat.%d", (i + 1));
+        append_s_array(header, name);
+        // search in reverse order, the worst case of a linear search
+        sprintf(name, "stat.%d", (BENCH_NUM_HEADER_COLUMNS - i));
+        append_s_array(stat_names, name);
+    }
+    snprintf(size, sizeof(size), "columns=%d", BENCH_NUM_HEADER_COLUMNS);
+    // one operation per column matched
+    init_bench_result(&result, "get_matching_indices", size,
+            BENCH_NUM_HEADER_COLUMNS);
+    for (r = 0; r < conf->num_repeats; r++) {
+        start_bench_run(&result);
+        get_matching_indices(stat_names, header, indices);
+        stop_bench_run(&result);
+    }
+    write_bench_result(results, &result);
+    free_s_array(stat_names);
+    free_s_array(header);
+    free_i_array(indices);
+}
+
+static void bench_get_doubles(FILE * results, const bench_config * conf,
+        const char * size, const s_array * lines, int num_columns,
+        const i_array * stat_indices) {
+    int r, i, num_split;
+    s_array ** line_arrays;
+    d_array * stats;
+    bench_result result;
+    num_split = (lines->length < BENCH_MAX_SPLIT_ROWS) ? lines->length :
+            BENCH_MAX_SPLIT_ROWS;
+    line_arrays = (typeof(*line_arrays) *) calloc(num_split,
+            sizeof(*line_arrays));
+    for (i = 0; i < num_split; i++) {
+        line_arrays[i] = init_s_array(num_columns);
+        split_str(get_s_array(lines, i), line_arrays[i], num_columns);
+    }
+    stats = init_d_array(stat_indices->length);
+    init_bench_result(&result, "get_doubles", size, lines->length);
+    for (r = 0; r < conf->num_repeats; r++) {
+        start_bench_run(&result);
+        for (i = 0; i < lines->length; i++) {
+            get_doubles(line_arrays[i % num_split], stat_indices, stats);
+        }
+        stop_bench_run(&result);
+        bench_sink = stats->a[0];
+    }
+    write_bench_result(results, &result);
+    for (i = 0; i < num_split; i++) {
+        free_s_array(line_arrays[i]);
+    }
+    free(line_arrays);
+    free_d_array(stats);
+}
+
+static void bench_process_sample(FILE * results, const bench_config * conf,
+        const char * size, const s_array * lines, int num_columns,
+        const i_array * stat_indices, const d_array * std_obs_stats,
+        const d_array * means, const d_array * std_devs) {
+    int r, i, n;
+    s_array * line_array;
+    sample ** samples;
+    sample_array * retained;
+    bench_result result;
+    line_array = init_s_array(num_columns);
+    samples = (typeof(*samples) *) calloc(lines->length, sizeof(*samples));
+    init_bench_result(&result, "process_sample", size, lines->length);
+    for (r = 0; r < conf->num_repeats; r++) {
+        for (i = 0; i < lines->length; i++) {
+            split_str(get_s_array(lines, i), line_array, num_columns);
+            samples[i] = init_sample(conf->data_path->a, (i + 2), line_array,
+                    stat_indices, std_obs_stats, means, std_devs);
+        }
+        retained = init_sample_array(conf->num_retain);
+        n = 0;
+        start_bench_run(&result);
+        for (i = 0; i < lines->length; i++) {
+            // keep the rejected samples, to free them outside of the timing
+            if (process_sample(retained, samples[i]) < 0) {
+                samples[n++] = samples[i];
+            }
+        }
+        stop_bench_run(&result);
+        for (i = 0; i < n; i++) {
+            free_sample(samples[i]);
+        }
+        free_sample_array(retained);
+    }
+    write_bench_result(results, &result);
+    free(samples);
+    free_s_array(line_array);
+}
+
+static void bench_summarize(FILE * results, const bench_config * conf,
+        const char * size, const s_array * paths, c_array * line_buffer,
+        const i_array * stat_indices, int num_columns, d_array * means,
+        d_array * std_devs) {
+    int r;
+    s_array * paths_used;
+    sample_moments * moments;
+    bench_result result;
+    paths_used = init_s_array(1);
+    init_bench_result(&result, "summarize_stat_samples", size,
+            conf->num_rows);
+    for (r = 0; r < conf->num_repeats; r++) {
+        moments = init_sample_moments(stat_indices->length,
+                EUREJECT_SUMMARY_BLOCK_SIZE);
+        paths_used->length = 0;
+        start_bench_run(&result);
+        summarize_stat_samples(paths, line_buffer, stat_indices, moments,
+                means, std_devs, conf->num_rows, num_columns, paths_used,
+                NULL, NULL);
+        stop_bench_run(&result);
+        free_sample_moments(moments);
+    }
+    write_bench_result(results, &result);
+    free_s_array(paths_used);
+}
+
+static void bench_reject(FILE * results, const bench_config * conf,
+        const char * size, const s_array * paths, c_array * line_buffer,
+        const i_array * stat_indices, const d_array * std_obs_stats,
+        const d_array * means, const d_array * std_devs,
+        const s_array * header) {
+    int r;
+    sample_array * retained;
+    bench_result result;
+    init_bench_result(&result, "reject", size, conf->num_rows);
+    for (r = 0; r < conf->num_repeats; r++) {
+        start_bench_run(&result);
+        retained = reject(paths, line_buffer, stat_indices, std_obs_stats,
+                means, std_devs, conf->num_retain, header, NULL);
+        stop_bench_run(&result);
+        free_sample_array(retained);
+    }
+    write_bench_result(results, &result);
+}
+
+int main(int argc, char ** argv) {
+    int i;
+    char size[128];
+    FILE * f;
+    FILE * results;
+    bench_config * conf;
+    c_array * line_buffer;
+    s_array * paths;
+    s_array * header;
+    s_array * lines;
+    i_array * stat_indices;
+    d_array * obs_stats;
+    d_array * means;
+    d_array * std_devs;
+    conf = init_bench_config(0);
+    parse_bench_args(conf, "bench_eureject", NULL, argc, argv);
+    if ((f = fopen(conf->data_path->a, "w")) == NULL) {
+        perror(conf->data_path->a);
+        exit(1);
+    }
+    write_sim_table(f, conf->num_rows, conf->num_params, conf->num_stats,
+            conf->seed);
+    fclose(f);
+    snprintf(size, sizeof(size), "rows=%d;params=%d;stats=%d;k=%d",
+            conf->num_rows, conf->num_params, conf->num_stats,
+            conf->num_retain);
+
+    line_buffer = init_c_array(pow(2, 20));
+    paths = init_s_array(1);
+    header = init_s_array(1);
+    lines = init_s_array(conf->num_rows);
+    stat_indices = init_i_array(conf->num_stats);
+    obs_stats = init_d_array(conf->num_stats);
+    means = init_d_array(conf->num_stats);
+    std_devs = init_d_array(conf->num_stats);
+    append_s_array(paths, conf->data_path->a);
+    parse_header(conf->data_path->a, line_buffer, header);
+    for (i = 0; i < conf->num_stats; i++) {
+        append_i_array(stat_indices, (conf->num_params + i));
+    }
+    read_lines(conf->data_path->a, line_buffer, lines);
+    // the stats expected for parameter values of 0.5, in the middle of the
+    // table
+    for (i = 0; i < conf->num_stats; i++) {
+        append_d_array(obs_stats, ((i + 1) * 0.5));
+    }
+
+    results = open_bench_results(conf->results_path);
+    bench_get_matching_indices(results, conf);
+    bench_split_str(results, conf, size, lines, header->length);
+    bench_get_doubles(results, conf, size, lines, header->length,
+            stat_indices);
+    bench_summarize(results, conf, size, paths, line_buffer, stat_indices,
+            header->length, means, std_devs);
+    standardize_vector(obs_stats, means, std_devs);
+    bench_process_sample(results, conf, size, lines, header->length,
+            stat_indices, obs_stats, means, std_devs);
+    bench_reject(results, conf, size, paths, line_buffer, stat_indices,
+            obs_stats, means, std_devs, header);
+    close_bench_results(results);
+
+    free_c_array(line_buffer);
+    free_s_array(paths);
+    free_s_array(header);
+    free_s_array(lines);
+    free_i_array(stat_indices);
+    free_d_array(obs_stats);
+    free_d_array(means);
+    free_d_array(std_devs);
+    free_bench_config(conf);
+    return 0;
+}
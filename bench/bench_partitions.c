@@ -0,0 +1,210 @@
+/**
+ * @file        bench_partitions.c
+ * @authors     Jamie Oaks
+ * @package     ABACUS (Approximate BAyesian C UtilitieS)
+ * @brief       Benchmarks of the integer partition functions.
+ * @copyright   Copyright (C) 2013 Jamie Oaks.
+ *   This file is part of ABACUS.  ABACUS is free software; you can
+ *   redistribute it and/or modify it under the terms of the GNU General Public
+ *   License as published by the Free Software Foundation; either version 2 of
+ *   the License, or (at your option) any later version.
+ * 
+ *   ABACUS is distributed in the hope that it will be useful, but WITHOUT ANY
+ *   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *   FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *   details.
+ * 
+ *   You should have received a copy of the GNU General Public License along
+ *   with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "bench_utils.h"
+#include "partition_combinatorics.h"
+#include "partition_combinatorics_parallel.h"
+
+// the number of calls timed in each run of the counting benchmarks
+#define BENCH_NUM_CALLS 1000
+
+// the threads of the parallel enumeration benchmark
+#define BENCH_NUM_THREADS 4
+
+// the elements of the set partition enumeration benchmark, which has
+// B(12) = 4213597 partitions
+#define BENCH_SET_PARTITION_N 12
+
+static volatile double bench_sink;
+
+static void bench_number_of_int_partitions(FILE * results,
+        const bench_config * conf, const char * size) {
+    int r, i;
+    bench_result result;
+    init_bench_result(&result, "number_of_int_partitions", size,
+            BENCH_NUM_CALLS);
+    for (r = 0; r < conf->num_repeats; r++) {
+        start_bench_run(&result);
+        for (i = 0; i < BENCH_NUM_CALLS; i++) {
+            bench_sink = number_of_int_partitions(conf->n);
+        }
+        stop_bench_run(&result);
+    }
+    write_bench_result(results, &result);
+}
+
+static void bench_number_of_int_partitions_by_k(FILE * results,
+        const bench_config * conf, const char * size) {
+    int r, i;
+    i_array * counts;
+    bench_result result;
+    counts = init_i_array(conf->n);
+    init_bench_result(&result, "number_of_int_partitions_by_k", size,
+            BENCH_NUM_CALLS);
+    for (r = 0; r < conf->num_repeats; r++) {
+        start_bench_run(&result);
+        for (i = 0; i < BENCH_NUM_CALLS; i++) {
+            bench_sink = number_of_int_partitions_by_k(conf->n, counts);
+        }
+        stop_bench_run(&result);
+    }
+    write_bench_result(results, &result);
+    free_i_array(counts);
+}
+
+static void bench_frequency_of_int_partitions_by_k(FILE * results,
+        const bench_config * conf, const char * size) {
+    int r, i;
+    d_array * probs;
+    bench_result result;
+    probs = init_d_array(conf->n);
+    init_bench_result(&result, "frequency_of_int_partitions_by_k", size,
+            BENCH_NUM_CALLS);
+    for (r = 0; r < conf->num_repeats; r++) {
+        start_bench_run(&result);
+        for (i = 0; i < BENCH_NUM_CALLS; i++) {
+            bench_sink = frequency_of_int_partitions_by_k(conf->n, probs);
+        }
+        stop_bench_run(&result);
+    }
+    write_bench_result(results, &result);
+    free_d_array(probs);
+}
+
+static void bench_generate_int_partitions(FILE * results,
+        const bench_config * conf, const char * size) {
+    int r;
+    i_array_csr * partitions;
+    bench_result result;
+    // one operation per partition generated
+    init_bench_result(&result, "generate_int_partitions", size,
+            number_of_int_partitions(conf->n));
+    for (r = 0; r < conf->num_repeats; r++) {
+        start_bench_run(&result);
+        partitions = generate_int_partitions(conf->n);
+        stop_bench_run(&result);
+        free_i_array_csr(partitions);
+    }
+    write_bench_result(results, &result);
+}
+
+static int sum_int_partition_parts(const int * parts, int num_parts,
+        void * data) {
+    (*(long *) data) += parts[num_parts - 1];
+    return 0;
+}
+
+static void bench_visit_int_partitions(FILE * results,
+        const bench_config * conf, const char * size) {
+    int r;
+    long sum;
+    bench_result result;
+    // one operation per partition visited
+    init_bench_result(&result, "visit_int_partitions", size,
+            number_of_int_partitions(conf->n));
+    for (r = 0; r < conf->num_repeats; r++) {
+        sum = 0;
+        start_bench_run(&result);
+        visit_int_partitions(conf->n, sum_int_partition_parts, &sum);
+        stop_bench_run(&result);
+        bench_sink = sum;
+    }
+    write_bench_result(results, &result);
+}
+
+static void bench_visit_int_partitions_parallel(FILE * results,
+        const bench_config * conf, const char * size) {
+    int r, t;
+    long sums[BENCH_NUM_THREADS];
+    void * data[BENCH_NUM_THREADS];
+    char parallel_size[160];
+    bench_result result;
+    for (t = 0; t < BENCH_NUM_THREADS; t++) {
+        data[t] = &sums[t];
+    }
+    snprintf(parallel_size, sizeof(parallel_size), "%s;threads=%d", size,
+            BENCH_NUM_THREADS);
+    init_bench_result(&result, "visit_int_partitions_parallel",
+            parallel_size, number_of_int_partitions(conf->n));
+    for (r = 0; r < conf->num_repeats; r++) {
+        for (t = 0; t < BENCH_NUM_THREADS; t++) {
+            sums[t] = 0;
+        }
+        start_bench_run(&result);
+        visit_int_partitions_parallel(conf->n, BENCH_NUM_THREADS,
+                sum_int_partition_parts, data);
+        stop_bench_run(&result);
+        bench_sink = sums[0];
+    }
+    write_bench_result(results, &result);
+}
+
+static int count_set_partition_blocks(const int * blocks, int n,
+        int num_blocks, void * data) {
+    (*(long *) data) += num_blocks;
+    return 0;
+}
+
+static void bench_visit_set_partitions(FILE * results,
+        const bench_config * conf) {
+    int r;
+    long sum, num_partitions;
+    char size[64];
+    bench_result result;
+    set_partition_table * t;
+    t = init_set_partition_table(BENCH_SET_PARTITION_N, 0);
+    num_partitions = (long) round(exp(get_log_bell(t,
+            BENCH_SET_PARTITION_N)));
+    free_set_partition_table(t);
+    snprintf(size, sizeof(size), "n=%d", BENCH_SET_PARTITION_N);
+    // one operation per partition visited
+    init_bench_result(&result, "visit_set_partitions", size,
+            num_partitions);
+    for (r = 0; r < conf->num_repeats; r++) {
+        sum = 0;
+        start_bench_run(&result);
+        visit_set_partitions(BENCH_SET_PARTITION_N,
+                count_set_partition_blocks, &sum);
+        stop_bench_run(&result);
+        bench_sink = sum;
+    }
+    write_bench_result(results, &result);
+}
+
+int main(int argc, char ** argv) {
+    char size[128];
+    FILE * results;
+    bench_config * conf;
+    conf = init_bench_config(50);
+    parse_bench_args(conf, "bench_partitions",
+            "Integer to partition. Default: 50.", argc, argv);
+    snprintf(size, sizeof(size), "n=%d", conf->n);
+    results = open_bench_results(conf->results_path);
+    bench_number_of_int_partitions(results, conf, size);
+    bench_number_of_int_partitions_by_k(results, conf, size);
+    bench_frequency_of_int_partitions_by_k(results, conf, size);
+    bench_generate_int_partitions(results, conf, size);
+    bench_visit_int_partitions(results, conf, size);
+    bench_visit_int_partitions_parallel(results, conf, size);
+    bench_visit_set_partitions(results, conf);
+    close_bench_results(results);
+    free_bench_config(conf);
+    return 0;
+}
@@ -0,0 +1,383 @@
+/**
+ * @file        bench_utils.c
+ * @authors     Jamie Oaks
+ * @package     ABACUS (Approximate BAyesian C UtilitieS)
+ * @brief       Timing, reporting and synthetic data for the benchmarks.
+ * @copyright   Copyright (C) 2013 Jamie Oaks.
+ *   This file is part of ABACUS.  ABACUS is free software; you can
+ *   redistribute it and/or modify it under the terms of the GNU General Public
+ *   License as published by the Free Software Foundation; either version 2 of
+ *   the License, or (at your option) any later version.
+ * 
+ *   ABACUS is distributed in the hope that it will be useful, but WITHOUT ANY
+ *   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *   FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *   details.
+ * 
+ *   You should have received a copy of the GNU General Public License along
+ *   with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "bench_utils.h"
+
+#ifdef __GLIBC__
+
+extern void * __libc_malloc(size_t size);
+extern void * __libc_calloc(size_t n, size_t size);
+extern void * __libc_realloc(void * p, size_t size);
+extern void __libc_free(void * p);
+
+static long bench_heap_calls = 0;
+
+void * malloc(size_t size) {
+    bench_heap_calls++;
+    return __libc_malloc(size);
+}
+
+void * calloc(size_t n, size_t size) {
+    bench_heap_calls++;
+    return __libc_calloc(n, size);
+}
+
+void * realloc(void * p, size_t size) {
+    bench_heap_calls++;
+    return __libc_realloc(p, size);
+}
+
+void free(void * p) {
+    if (p != NULL) {
+        bench_heap_calls++;
+    }
+    __libc_free(p);
+}
+
+long get_bench_heap_calls() {
+    return bench_heap_calls;
+}
+
+#else
+
+long get_bench_heap_calls() {
+    return -1;
+}
+
+#endif
+
+bench_config * init_bench_config(int n) {
+    bench_config * c;
+    c = (typeof(*c) *) malloc(sizeof(*c));
+    c->num_rows = 100000;
+    c->num_params = 2;
+    c->num_stats = 10;
+    c->num_retain = 1000;
+    c->n = n;
+    c->num_repeats = 5;
+    c->seed = 1;
+    c->data_path = init_c_array(63);
+    assign_c_array(c->data_path, "bench_sims.txt");
+    c->results_path = init_c_array(63);
+    return c;
+}
+
+void free_bench_config(bench_config * c) {
+    free_c_array(c->data_path);
+    free_c_array(c->results_path);
+    free(c);
+    c = NULL;
+}
+
+void bench_help(const char * name, const char * n_description) {
+    fprintf(stderr, "Usage:\n");
+    fprintf(stderr, "  %s [-r INT] [-p INT] [-s INT] [-k INT]%s [-R INT] "
+            "\\\n      [-S INT] [-f DATA-FILE] [-o RESULTS-FILE]\n\n", name,
+            ((n_description != NULL) ? " [-n INT]" : ""));
+    fprintf(stderr, "Options:\n");
+    fprintf(stderr,
+        " -r  Number of rows in the synthetic simulation table.\n"
+        "     Default: 100000.\n");
+    fprintf(stderr,
+        " -p  Number of parameter columns in the table. Default: 2.\n");
+    fprintf(stderr,
+        " -s  Number of stat columns in the table. Default: 10.\n");
+    fprintf(stderr,
+        " -k  Number of samples to retain during rejection. Default: 1000.\n");
+    if (n_description != NULL) {
+        fprintf(stderr, " -n  %s\n", n_description);
+    }
+    fprintf(stderr,
+        " -R  Number of times to run each benchmark; the best and mean\n"
+        "     times are reported. Default: 5.\n");
+    fprintf(stderr,
+        " -S  Seed for the synthetic data and random draws. Default: 1.\n");
+    fprintf(stderr,
+        " -f  Path for the synthetic simulation table.\n"
+        "     Default: bench_sims.txt.\n");
+    fprintf(stderr,
+        " -o  File to append tab-delimited results to. Default: standard\n"
+        "     output.\n");
+    fprintf(stderr, " -h  Display this help message and exit\n");
+}
+
+static int parse_positive_int(const char * name, const char * n_description,
+        char option, const char * arg) {
+    int i;
+    i = atoi(arg);
+    if (i < 1) {
+        fprintf(stderr, "ERROR: `-%c' must be positive integer\n", option);
+        bench_help(name, n_description);
+        exit(1);
+    }
+    return i;
+}
+
+void parse_bench_args(bench_config * conf, const char * name,
+        const char * n_description, int argc, char ** argv) {
+    int i;
+    while((i = getopt(argc, argv, "r:p:s:k:n:R:S:f:o:h")) != -1) {
+        switch(i) {
+            case 'r':
+                conf->num_rows = parse_positive_int(name, n_description, i,
+                        optarg);
+                break;
+            case 'p':
+                conf->num_params = parse_positive_int(name, n_description, i,
+                        optarg);
+                break;
+            case 's':
+                conf->num_stats = parse_positive_int(name, n_description, i,
+                        optarg);
+                break;
+            case 'k':
+                conf->num_retain = parse_positive_int(name, n_description, i,
+                        optarg);
+                break;
+            case 'n':
+                if (n_description == NULL) {
+                    fprintf(stderr, "ERROR: `-n' is not used by %s\n", name);
+                    bench_help(name, n_description);
+                    exit(1);
+                }
+                conf->n = parse_positive_int(name, n_description, i, optarg);
+                break;
+            case 'R':
+                conf->num_repeats = parse_positive_int(name, n_description, i,
+                        optarg);
+                break;
+            case 'S':
+                conf->seed = strtoul(optarg, NULL, 10);
+                break;
+            case 'f':
+                assign_c_array(conf->data_path, optarg);
+                break;
+            case 'o':
+                assign_c_array(conf->results_path, optarg);
+                break;
+            case 'h':
+                bench_help(name, n_description);
+                exit(0);
+                break;
+            case '?':
+                if (isprint(optopt)) {
+                    fprintf(stderr, "ERROR: unknown option or missing "
+                            "argument `-%c'\n", optopt);
+                }
+                bench_help(name, n_description);
+                exit(1);
+                break;
+            default:
+                bench_help(name, n_description);
+                exit(1);
+        }
+    }
+    if (optind < argc) {
+        fprintf(stderr, "ERROR: unexpected argument `%s'\n", argv[optind]);
+        bench_help(name, n_description);
+        exit(1);
+    }
+}
+
+void init_bench_result(bench_result * r, const char * name, const char * size,
+        long num_ops) {
+    r->name = name;
+    snprintf(r->size, sizeof(r->size), "%s", size);
+    r->num_ops = num_ops;
+    r->num_repeats = 0;
+    r->best_seconds = 0.0;
+    r->total_seconds = 0.0;
+    r->heap_calls = (get_bench_heap_calls() < 0) ? -1 : 0;
+    r->run_start_time = 0.0;
+    r->run_start_heap_calls = 0;
+}
+
+void add_bench_time(bench_result * r, double seconds) {
+    if ((r->num_repeats == 0) || (seconds < r->best_seconds)) {
+        r->best_seconds = seconds;
+    }
+    r->total_seconds += seconds;
+    r->num_repeats++;
+}
+
+void start_bench_run(bench_result * r) {
+    r->run_start_heap_calls = get_bench_heap_calls();
+    r->run_start_time = get_monotonic_time();
+}
+
+void stop_bench_run(bench_result * r) {
+    double seconds;
+    seconds = get_monotonic_time() - r->run_start_time;
+    if (r->heap_calls >= 0) {
+        r->heap_calls += get_bench_heap_calls() - r->run_start_heap_calls;
+    }
+    add_bench_time(r, seconds);
+}
+
+FILE * open_bench_results(const c_array * path) {
+    FILE * stream;
+    if (path->a[0] == '\0') {
+        write_bench_header(stdout);
+        return stdout;
+    }
+    if ((stream = fopen(path->a, "a")) == NULL) {
+        perror(path->a);
+        exit(1);
+    }
+    fseek(stream, 0, SEEK_END);
+    if (ftell(stream) == 0) {
+        write_bench_header(stream);
+    }
+    return stream;
+}
+
+void close_bench_results(FILE * stream) {
+    if (stream != stdout) {
+        fclose(stream);
+    }
+    else {
+        fflush(stream);
+    }
+}
+
+void write_bench_header(FILE * stream) {
+    fprintf(stream, "benchmark\tversion\tsize\tops\trepeats\tbest_seconds\t"
+            "mean_seconds\tns_per_op\tops_per_second\theap_calls_per_op\n");
+}
+
+void write_bench_result(FILE * stream, const bench_result * r) {
+    double mean, ns_per_op, ops_per_second;
+    char heap_calls_per_op[32];
+    assert(r->num_repeats > 0);
+    mean = r->total_seconds / r->num_repeats;
+    ns_per_op = 0.0;
+    ops_per_second = 0.0;
+    if (r->num_ops > 0) {
+        ns_per_op = (r->best_seconds * 1e9) / r->num_ops;
+    }
+    if (r->best_seconds > 0.0) {
+        ops_per_second = r->num_ops / r->best_seconds;
+    }
+    snprintf(heap_calls_per_op, sizeof(heap_calls_per_op), "NA");
+    if ((r->heap_calls >= 0) && (r->num_ops > 0)) {
+        snprintf(heap_calls_per_op, sizeof(heap_calls_per_op), "%.4lf",
+                (((double) r->heap_calls) / r->num_repeats) / r->num_ops);
+    }
+    fprintf(stream,
+            "%s\t%s\t%s\t%ld\t%d\t%.6lf\t%.6lf\t%.2lf\t%.1lf\t%s\n",
+            r->name, ABACUS_VERSION, r->size, r->num_ops, r->num_repeats,
+            r->best_seconds, mean, ns_per_op, ops_per_second,
+            heap_calls_per_op);
+    fflush(stream);
+}
+
+void seed_bench_rng(bench_rng * rng, unsigned long seed) {
+    rng->state = (uint64_t) seed;
+}
+
+uint64_t get_bench_rng_int(bench_rng * rng) {
+    uint64_t z;
+    rng->state += 0x9E3779B97F4A7C15ULL;
+    z = rng->state;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+double get_bench_rng_uniform(bench_rng * rng) {
+    // the top 53 bits fill the mantissa of a double in [0, 1)
+    return (get_bench_rng_int(rng) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+static void draw_sim_row(bench_rng * rng, d_array * params, d_array * stats,
+        int num_params, int num_stats) {
+    int i;
+    double p;
+    params->length = 0;
+    stats->length = 0;
+    for (i = 0; i < num_params; i++) {
+        append_d_array(params, get_bench_rng_uniform(rng));
+    }
+    for (i = 0; i < num_stats; i++) {
+        p = get_d_array(params, (i % num_params));
+        append_d_array(stats, (((i + 1) * p) +
+                (0.1 * (get_bench_rng_uniform(rng) - 0.5))));
+    }
+}
+
+static void write_sim_header(FILE * stream, int num_params, int num_stats) {
+    int i;
+    for (i = 0; i < num_params; i++) {
+        fprintf(stream, "param.%d\t", (i + 1));
+    }
+    for (i = 0; i < num_stats; i++) {
+        fprintf(stream, "stat.%d%s", (i + 1),
+                ((i < (num_stats - 1)) ? "\t" : "\n"));
+    }
+}
+
+void write_sim_table(FILE * stream, int num_rows, int num_params,
+        int num_stats, unsigned long seed) {
+    assert((num_params > 0) && (num_stats > 0));
+    int i, j;
+    bench_rng rng;
+    d_array * params;
+    d_array * stats;
+    seed_bench_rng(&rng, seed);
+    params = init_d_array(num_params);
+    stats = init_d_array(num_stats);
+    write_sim_header(stream, num_params, num_stats);
+    for (i = 0; i < num_rows; i++) {
+        draw_sim_row(&rng, params, stats, num_params, num_stats);
+        for (j = 0; j < num_params; j++) {
+            fprintf(stream, "%.6lf\t", get_d_array(params, j));
+        }
+        for (j = 0; j < num_stats; j++) {
+            fprintf(stream, "%.6lf%s", get_d_array(stats, j),
+                    ((j < (num_stats - 1)) ? "\t" : "\n"));
+        }
+    }
+    free_d_array(params);
+    free_d_array(stats);
+}
+
+void write_observed_stats(FILE * stream, int num_params, int num_stats,
+        unsigned long seed) {
+    assert((num_params > 0) && (num_stats > 0));
+    int j;
+    bench_rng rng;
+    d_array * params;
+    d_array * stats;
+    // a different stream of draws than the table's
+    seed_bench_rng(&rng, ~seed);
+    params = init_d_array(num_params);
+    stats = init_d_array(num_stats);
+    draw_sim_row(&rng, params, stats, num_params, num_stats);
+    for (j = 0; j < num_stats; j++) {
+        fprintf(stream, "stat.%d%s", (j + 1),
+                ((j < (num_stats - 1)) ? "\t" : "\n"));
+    }
+    for (j = 0; j < num_stats; j++) {
+        fprintf(stream, "%.6lf%s", get_d_array(stats, j),
+                ((j < (num_stats - 1)) ? "\t" : "\n"));
+    }
+    free_d_array(params);
+    free_d_array(stats);
+}
@@ -0,0 +1,144 @@
+/**
+ * @file        bench_utils.h
+ * @authors     Jamie Oaks
+ * @package     ABACUS (Approximate BAyesian C UtilitieS)
+ * @brief       Timing, reporting and synthetic data for the benchmarks.
+ * @copyright   Copyright (C) 2013 Jamie Oaks.
+ *   This file is part of ABACUS.  ABACUS is free software; you can
+ *   redistribute it and/or modify it under the terms of the GNU General Public
+ *   License as published by the Free Software Foundation; either version 2 of
+ *   the License, or (at your option) any later version.
+ * 
+ *   ABACUS is distributed in the hope that it will be useful, but WITHOUT ANY
+ *   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *   FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *   details.
+ * 
+ *   You should have received a copy of the GNU General Public License along
+ *   with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BENCH_UTILS_H
+#define BENCH_UTILS_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h> // for getopt
+#include <ctype.h>
+#include <stdint.h>
+#include <assert.h>
+
+#include "array_utils.h"
+#include "run_stats.h"
+#include "abacus.h"
+
+typedef struct bench_config_ {
+    int num_rows;
+    int num_params;
+    int num_stats;
+    int num_retain;
+    int n;
+    int num_repeats;
+    unsigned long seed;
+    c_array * data_path;
+    c_array * results_path;
+} bench_config;
+
+/**
+ * The times of repeated runs of one benchmark, each of which performs
+ * `num_ops` operations (rows parsed, samples processed, draws made, ...).
+ * `size` describes the problem size, e.g. "rows=100000;stats=10".
+ * `heap_calls` counts the calls to malloc, calloc, realloc and free made
+ * during all of the runs, or is -1 if they cannot be counted on this
+ * platform.
+ */
+typedef struct bench_result_ {
+    const char * name;
+    char size[128];
+    long num_ops;
+    int num_repeats;
+    double best_seconds;
+    double total_seconds;
+    long heap_calls;
+    double run_start_time;
+    long run_start_heap_calls;
+} bench_result;
+
+/**
+ * A small, fast and portable random number generator (SplitMix64), so that
+ * synthetic data are the same on every platform and do not depend on GSL.
+ */
+typedef struct bench_rng_ {
+    uint64_t state;
+} bench_rng;
+
+bench_config * init_bench_config(int n);
+void free_bench_config(bench_config * c);
+
+/**
+ * Print the usage of benchmark `name`, which takes the common options and,
+ * if `n_description` is not NULL, a problem size `-n` described by it.
+ */
+void bench_help(const char * name, const char * n_description);
+void parse_bench_args(bench_config * conf, const char * name,
+        const char * n_description, int argc, char ** argv);
+
+void init_bench_result(bench_result * r, const char * name, const char * size,
+        long num_ops);
+void add_bench_time(bench_result * r, double seconds);
+
+/**
+ * Start and stop timing (and counting the heap calls of) one run of a
+ * benchmark.
+ */
+void start_bench_run(bench_result * r);
+void stop_bench_run(bench_result * r);
+
+/**
+ * Returns the number of heap calls the program has made, or -1 if they are
+ * not counted on this platform. Heap calls are counted by replacing the C
+ * library's allocator functions, which is only done with glibc.
+ */
+long get_bench_heap_calls();
+
+/**
+ * Open the results file for appending, writing the header if the file is
+ * new or empty; if `path` is empty, results are written to standard output.
+ */
+FILE * open_bench_results(const c_array * path);
+void close_bench_results(FILE * stream);
+void write_bench_header(FILE * stream);
+
+/**
+ * Write one tab-delimited line of results: the benchmark, ABACUS version,
+ * problem size, operations per run, number of runs, the best and mean
+ * seconds per run, the nanoseconds per operation and operations per
+ * second of the best run, and the mean heap calls per operation ("NA" if
+ * they were not counted).
+ */
+void write_bench_result(FILE * stream, const bench_result * r);
+
+void seed_bench_rng(bench_rng * rng, unsigned long seed);
+uint64_t get_bench_rng_int(bench_rng * rng);
+double get_bench_rng_uniform(bench_rng * rng);
+
+/**
+ * Write a simulation table, with a header, of `num_rows` draws of
+ * `num_params` parameters (columns "param.1", ...) and `num_stats` stats
+ * (columns "stat.1", ...). The parameters are uniform on [0, 1); each stat
+ * depends on one parameter, plus noise, so that the nearest samples to an
+ * observed dataset are not simply a random subset. The table is determined
+ * by `seed`.
+ */
+void write_sim_table(FILE * stream, int num_rows, int num_params,
+        int num_stats, unsigned long seed);
+
+/**
+ * Write an observed stats file (a header and one row) for tables written by
+ * `write_sim_table`.
+ */
+void write_observed_stats(FILE * stream, int num_params, int num_stats,
+        unsigned long seed);
+
+#endif /* BENCH_UTILS_H */
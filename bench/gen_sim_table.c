@@ -0,0 +1,106 @@
+/**
+ * @file        gen_sim_table.c
+ * @authors     Jamie Oaks
+ * @package     ABACUS (Approximate BAyesian C UtilitieS)
+ * @brief       Writes synthetic simulation tables for benchmarking.
+ * @copyright   Copyright (C) 2013 Jamie Oaks.
+ *   This file is part of ABACUS.  ABACUS is free software; you can
+ *   redistribute it and/or modify it under the terms of the GNU General Public
+ *   License as published by the Free Software Foundation; either version 2 of
+ *   the License, or (at your option) any later version.
+ * 
+ *   ABACUS is distributed in the hope that it will be useful, but WITHOUT ANY
+ *   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *   FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *   details.
+ * 
+ *   You should have received a copy of the GNU General Public License along
+ *   with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "bench_utils.h"
+
+static void help() {
+    fprintf(stderr, "Usage:\n");
+    fprintf(stderr,
+        "  gen_sim_table [-r INT] [-p INT] [-s INT] [-S INT] \\\n"
+        "      [-b OBS-OUT-FILE] [SIMS-OUT-FILE]\n\n");
+    fprintf(stderr,
+        "Writes a synthetic simulation table (to standard output if no\n"
+        "file is given) for benchmarking eureject. The same options always\n"
+        "produce the same table.\n\n");
+    fprintf(stderr, "Options:\n");
+    fprintf(stderr, " -r  Number of rows. Default: 100000.\n");
+    fprintf(stderr, " -p  Number of parameter columns. Default: 2.\n");
+    fprintf(stderr, " -s  Number of stat columns. Default: 10.\n");
+    fprintf(stderr, " -S  Seed. Default: 1.\n");
+    fprintf(stderr,
+        " -b  Also write an observed stats file for the table.\n");
+    fprintf(stderr, " -h  Display this help message and exit\n");
+}
+
+int main(int argc, char ** argv) {
+    int i;
+    FILE * f;
+    bench_config * conf;
+    c_array * obs_path;
+    conf = init_bench_config(0);
+    obs_path = init_c_array(63);
+    while((i = getopt(argc, argv, "r:p:s:S:b:h")) != -1) {
+        switch(i) {
+            case 'r':
+                conf->num_rows = atoi(optarg);
+                break;
+            case 'p':
+                conf->num_params = atoi(optarg);
+                break;
+            case 's':
+                conf->num_stats = atoi(optarg);
+                break;
+            case 'S':
+                conf->seed = strtoul(optarg, NULL, 10);
+                break;
+            case 'b':
+                assign_c_array(obs_path, optarg);
+                break;
+            case 'h':
+                help();
+                exit(0);
+                break;
+            default:
+                help();
+                exit(1);
+        }
+    }
+    if ((conf->num_rows < 0) || (conf->num_params < 1) ||
+            (conf->num_stats < 1)) {
+        fprintf(stderr, "ERROR: `-p' and `-s' must be positive integers, "
+                "and `-r' cannot be negative\n");
+        help();
+        exit(1);
+    }
+    f = stdout;
+    if (optind < argc) {
+        if ((f = fopen(argv[optind], "w")) == NULL) {
+            perror(argv[optind]);
+            exit(1);
+        }
+    }
+    write_sim_table(f, conf->num_rows, conf->num_params, conf->num_stats,
+            conf->seed);
+    if (f != stdout) {
+        fclose(f);
+    }
+    if (obs_path->a[0] != '\0') {
+        if ((f = fopen(obs_path->a, "w")) == NULL) {
+            perror(obs_path->a);
+            exit(1);
+        }
+        write_observed_stats(f, conf->num_params, conf->num_stats,
+                conf->seed);
+        fclose(f);
+    }
+    free_c_array(obs_path);
+    free_bench_config(conf);
+    return 0;
+}
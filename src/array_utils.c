@@ -20,19 +20,11 @@
 
 #include "array_utils.h"
 
-d_array * init_d_array(int capacity) {
-    assert(capacity > 0);
-    d_array * v;
-    v = (typeof(*v) *) malloc(sizeof(*v));
-    v->capacity = capacity;
-    if ((v->a = (typeof(*v->a) *) calloc(v->capacity,
-            sizeof(*v->a))) == NULL) {
-        perror("out of memory");
-        exit(1);
-    }
-    v->length = 0;
-    return v;
-}
+DEFINE_TYPED_ARRAY(d_array, double)
+DEFINE_TYPED_ARRAY(i_array, int)
+DEFINE_TYPED_ARRAY(f_array, float)
+DEFINE_TYPED_ARRAY(z_array, size_t)
+DEFINE_TYPED_ARRAY(o_array, long)
 
 c_array * init_c_array(int capacity) {
     assert(capacity > 0);
@@ -48,43 +40,26 @@ c_array * init_c_array(int capacity) {
     return v;
 }
 
-i_array * init_i_array(int capacity) {
-    assert(capacity > 0);
-    i_array * v;
-    v = (typeof(*v) *) malloc(sizeof(*v));
-    v->capacity = capacity;
-    if ((v->a = (typeof(*v->a) *) calloc(v->capacity,
-            sizeof(*v->a))) == NULL) {
-        perror("out of memory");
-        exit(1);
-    }
-    v->length = 0;
-    return v;
-}
-
 s_array * init_s_array(int capacity) {
     assert(capacity > 0);
-    int i;
     s_array * v;
     v = (typeof(*v) *) malloc(sizeof(*v));
     v->capacity = capacity;
-    if ((v->a = (typeof(*v->a) *) calloc(v->capacity,
-            sizeof(*v->a))) == NULL) {
+    if ((v->offsets = (typeof(*v->offsets) *) calloc((v->capacity + 1),
+            sizeof(*v->offsets))) == NULL) {
         perror("out of memory");
         exit(1);
     }
-    for (i = 0; i < v->capacity; i++) {
-        v->a[i] = init_c_array(64);
+    v->arena_capacity = S_ARRAY_BYTES_PER_STRING * v->capacity;
+    if ((v->arena = (typeof(*v->arena) *) malloc(v->arena_capacity *
+            sizeof(*v->arena))) == NULL) {
+        perror("out of memory");
+        exit(1);
     }
     v->length = 0;
     return v;
 }
 
-void set_d_array(d_array * v, int index, double x) {
-    assert((index >= 0) && (index < v->length));
-    v->a[index] = x;
-}
-
 void assign_c_array(c_array * v, const char * s) {
     while (strlen(s) > v->capacity) {
         expand_c_array(v);
@@ -92,23 +67,77 @@ void assign_c_array(c_array * v, const char * s) {
     strncpy(v->a, s, v->capacity);
 }
 
-void set_i_array(i_array * v, int index, int x) {
-    assert((index >= 0) && (index < v->length));
-    v->a[index] = x;
+/**
+ * Make room for at least `size` bytes in the arena of `v`.
+ */
+static void reserve_s_array_arena(s_array * v, size_t size) {
+    if (size <= v->arena_capacity) {
+        return;
+    }
+    while (v->arena_capacity < size) {
+        v->arena_capacity *= 2;
+    }
+    if ((v->arena = (typeof(*v->arena) *) realloc(v->arena,
+            (v->arena_capacity * sizeof(*v->arena)))) == NULL) {
+        perror("out of memory");
+        exit(1);
+    }
+}
+
+/**
+ * Append the `n` bytes at `x`, plus a null character, as a new string. `x`
+ * may point into the arena of `v`.
+ */
+static void append_s_array_n(s_array * v, const char * x, size_t n) {
+    size_t start, x_offset;
+    int x_in_arena;
+    x_in_arena = ((x >= v->arena) && (x < (v->arena + v->arena_capacity)));
+    x_offset = x_in_arena ? (size_t) (x - v->arena) : 0;
+    if (v->length >= v->capacity) {
+        expand_s_array(v);
+    }
+    start = v->offsets[v->length];
+    reserve_s_array_arena(v, (start + n + 1));
+    if (x_in_arena) {
+        x = v->arena + x_offset;
+    }
+    memmove((v->arena + start), x, n);
+    v->arena[start + n] = '\0';
+    v->length++;
+    v->offsets[v->length] = start + n + 1;
 }
 
 void set_s_array(s_array * v, int index, const char * s) {
     assert((index >= 0) && (index < v->length));
-    assign_c_array(v->a[index], s);
+    int i;
+    size_t old_size, new_size, end;
+    char * copy;
+    copy = NULL;
+    if ((s >= v->arena) && (s < (v->arena + v->arena_capacity))) {
+        // `s` may move as the strings after `index` are shifted
+        if ((copy = (typeof(*copy) *) malloc(strlen(s) + 1)) == NULL) {
+            perror("out of memory");
+            exit(1);
+        }
+        strcpy(copy, s);
+        s = copy;
+    }
+    old_size = v->offsets[index + 1] - v->offsets[index];
+    new_size = strlen(s) + 1;
+    end = v->offsets[v->length];
+    reserve_s_array_arena(v, (end - old_size + new_size));
+    memmove((v->arena + v->offsets[index] + new_size),
+            (v->arena + v->offsets[index + 1]),
+            (end - v->offsets[index + 1]));
+    memcpy((v->arena + v->offsets[index]), s, new_size);
+    for (i = (index + 1); i <= v->length; i++) {
+        v->offsets[i] = v->offsets[i] - old_size + new_size;
+    }
+    free(copy);
 }
 
-void expand_d_array(d_array * v) {
-    v->capacity *= 2;
-    if ((v->a = (typeof(*v->a) *) realloc(v->a ,
-            (v->capacity * sizeof(*v->a)))) == NULL) {
-        perror("out of memory");
-        exit(1);
-    }
+void reset_s_array(s_array * v) {
+    v->length = 0;
 }
 
 void expand_c_array(c_array * v) {
@@ -121,86 +150,39 @@ void expand_c_array(c_array * v) {
     v->a[v->capacity] = '\0';
 }
 
-void expand_i_array(i_array * v) {
+void expand_s_array(s_array * v) {
     v->capacity *= 2;
-    if ((v->a = (typeof(*v->a) *) realloc(v->a ,
-            (v->capacity * sizeof(*v->a)))) == NULL) {
+    if ((v->offsets = (typeof(*v->offsets) *) realloc(v->offsets,
+            ((v->capacity + 1) * sizeof(*v->offsets)))) == NULL) {
         perror("out of memory");
         exit(1);
     }
 }
 
-void expand_s_array(s_array * v) {
-    int i;
-    if ((v->a = (typeof(*v->a) *) realloc(v->a ,
-            ((v->capacity * 2) * sizeof(*v->a)))) == NULL) {
-        perror("out of memory");
-        exit(1);
-    }
-    for (i = v->capacity; i < (v->capacity * 2); i++) {
-        v->a[i] = init_c_array(64);
-    }
-    v->capacity *= 2;
-}
-
-void append_d_array(d_array * v, double x) {
-    if (v->length >= v->capacity) {
-        expand_d_array(v);
-    }
-    v->length++;
-    set_d_array(v, (v->length - 1), x);
-}
-
-void append_i_array(i_array * v, int x) {
-    if (v->length >= v->capacity) {
-        expand_i_array(v);
-    }
-    v->length++;
-    set_i_array(v, (v->length - 1), x);
-}
-
 void append_s_array(s_array * v, const char * x) {
-    if (v->length >= v->capacity) {
-        expand_s_array(v);
-    }
-    v->length++;
-    assign_c_array(v->a[(v->length - 1)], x);
-}
-
-void extend_d_array(d_array * dest, const d_array * to_add) {
-    int i;
-    for (i = 0; i < to_add->length; i++) {
-        append_d_array(dest, to_add->a[i]);
-    }
-}
-
-void extend_i_array(i_array * dest, const i_array * to_add) {
-    int i;
-    for (i = 0; i < (*to_add).length; i++) {
-        append_i_array(dest, (*to_add).a[i]);
-    }
+    append_s_array_n(v, x, strlen(x));
 }
 
 void extend_s_array(s_array * dest, const s_array * to_add) {
-    int i;
-    for (i = 0; i < to_add->length; i++) {
-        append_s_array(dest, get_s_array(to_add, i));
+    int i, n;
+    size_t start;
+    n = to_add->length;
+    while ((dest->length + n) > dest->capacity) {
+        expand_s_array(dest);
     }
-}
-
-double get_d_array(const d_array * v, int index) {
-    assert((index >= 0) && (index < v->length));
-    return (v->a[index]);
-}
-
-int get_i_array(const i_array * v, int index) {
-    assert((index >= 0) && (index < v->length));
-    return (v->a[index]);
+    start = dest->offsets[dest->length];
+    reserve_s_array_arena(dest, (start + to_add->offsets[n]));
+    // `to_add` may be `dest`, but the bytes copied precede those written
+    memcpy((dest->arena + start), to_add->arena, to_add->offsets[n]);
+    for (i = 1; i <= n; i++) {
+        dest->offsets[dest->length + i] = start + to_add->offsets[i];
+    }
+    dest->length += n;
 }
 
 char * get_s_array(const s_array * v, int index) {
     assert((index >= 0) && (index < v->length));
-    return (v->a[index]->a);
+    return (v->arena + v->offsets[index]);
 }
 
 char * get_c_array(const c_array * v) {
@@ -231,30 +213,15 @@ void write_s_array(FILE * stream, const s_array * v, const char * sep) {
     fprintf(stream, "%s\n", get_s_array(v, (v->length - 1)));
 }
 
-void free_d_array(d_array * v) {
-    free(v->a);
-    free(v);
-    v = NULL;
-}
-
 void free_c_array(c_array * v) {
     free(v->a);
     free(v);
     v = NULL;
 }
 
-void free_i_array(i_array * v) {
-    free(v->a);
-    free(v);
-    v = NULL;
-}
-
 void free_s_array(s_array * v) {
-    int i;
-    for (i = 0; i < v->capacity; i++) {
-        free_c_array(v->a[i]);
-    }
-    free(v->a);
+    free(v->arena);
+    free(v->offsets);
     free(v);
     v = NULL;
 }
@@ -290,35 +257,36 @@ int i_arrays_equal(const i_array * v1, const i_array * v2) {
 }
 
 int s_arrays_equal(const s_array * v1, const s_array * v2) {
-    int i;
-    if (v1->length != v2->length) {
+    // the strings cannot contain null characters, so the bytes in use
+    // determine where each string ends
+    if ((v1->length != v2->length) ||
+            (v1->offsets[v1->length] != v2->offsets[v2->length])) {
         return 0;
     }
-    for (i = 0; i < v1->length; i++) {
-        if (strcmp(get_s_array(v1, i), get_s_array(v2, i)) != 0) {
-            return 0;
-        }
-    }
-    return 1;
+    return (memcmp(v1->arena, v2->arena, v1->offsets[v1->length]) == 0);
 }
 
-int split_str(char * string, s_array * words, int expected_num) {
-    int word_idx, n;
-    char * ptr;
-    c_array * match;
-    match = init_c_array(63);
+int split_str(const char * string, s_array * words, int expected_num) {
+    int word_idx;
+    const char * ptr;
+    const char * start;
     word_idx = 0;
     ptr = string;
-    words->length = 0;
-    while(*ptr) {
-        if ((sscanf(ptr, "%s%n", match->a, &n)) == 1) {
-            ptr += n;
-            append_s_array(words, match->a);
-            word_idx++;
+    reset_s_array(words);
+    while (*ptr) {
+        while (isspace((unsigned char) *ptr)) {
+            ptr++;
         }
-        ++ptr;
+        if (*ptr == '\0') {
+            break;
+        }
+        start = ptr;
+        while ((*ptr) && (!isspace((unsigned char) *ptr))) {
+            ptr++;
+        }
+        append_s_array_n(words, start, (size_t) (ptr - start));
+        word_idx++;
     }
-    free_c_array(match);
     if ((expected_num > 0) && (expected_num != word_idx)) {
         if (word_idx == 0) word_idx--;
         return word_idx;
@@ -326,9 +294,9 @@ int split_str(char * string, s_array * words, int expected_num) {
     return 0;
 }
 
-int split_str_d(char * string, d_array * v, int expected_num) {
+int split_str_d(const char * string, d_array * v, int expected_num) {
     int word_idx, n;
-    char * ptr;
+    const char * ptr;
     double match;
     word_idx = 0;
     ptr = string;
@@ -348,9 +316,9 @@ int split_str_d(char * string, d_array * v, int expected_num) {
     return 0;
 }
 
-int split_str_i(char * string, i_array * v, int expected_num) {
+int split_str_i(const char * string, i_array * v, int expected_num) {
     int word_idx, n;
-    char * ptr;
+    const char * ptr;
     int match;
     word_idx = 0;
     ptr = string;
@@ -373,38 +341,40 @@ int split_str_i(char * string, i_array * v, int expected_num) {
 void get_matching_indices(const s_array * search_strings,
         const s_array * target_strings,
         i_array * indices) {
-    int i, j, found;
+    int i, j;
+    s_map * target_indices;
     indices->length = 0;
-    for (i = 0; i < (*search_strings).length; i++) {
-        found = 0;
-        for (j = 0; j < (*target_strings).length; j++) {
-            if (strcmp(get_s_array(search_strings, i),
-                    get_s_array(target_strings, j)) == 0) {
-                if (found != 0) {
-                    fprintf(stderr, "ERROR: get_matching_indices: string %s "
-                            "found more than once\n",
-                            get_s_array(search_strings, i));
-                    exit(1);
-                }
-                found = 1;
-                append_i_array(indices, j);
-            }
+    target_indices = init_s_map((target_strings->length > 0) ?
+            target_strings->length : 1);
+    for (j = 0; j < target_strings->length; j++) {
+        if (set_s_map(target_indices, get_s_array(target_strings, j),
+                j) != 0) {
+            // only an error if the string is searched for
+            set_s_map(target_indices, get_s_array(target_strings, j), -1);
         }
-        if (found == 0) {
+    }
+    for (i = 0; i < (*search_strings).length; i++) {
+        if (get_s_map(target_indices, get_s_array(search_strings, i),
+                &j) == 0) {
             fprintf(stderr, "ERROR: get_matching_indices: string %s was not "
                     "found\n", get_s_array(search_strings, i));
             exit(1);
         }
+        if (j < 0) {
+            fprintf(stderr, "ERROR: get_matching_indices: string %s "
+                    "found more than once\n",
+                    get_s_array(search_strings, i));
+            exit(1);
+        }
+        append_i_array(indices, j);
     }
+    free_s_map(target_indices);
 }
 
 int get_doubles(const s_array * strings, const i_array * indices,
         d_array * doubles_dest) {
     int i, ret;
     char * end_ptr;
-    char * end_ptr_orig;
-    end_ptr = (typeof(*end_ptr) *) malloc(sizeof(end_ptr) * 64);
-    end_ptr_orig = end_ptr;
     ret = 0;
     (*doubles_dest).length = 0;
     for (i = 0; i < (*indices).length; i++) {
@@ -417,7 +387,6 @@ int get_doubles(const s_array * strings, const i_array * indices,
             ret++;
         }
     }
-    free(end_ptr_orig);
     return ret;
 }
 
@@ -507,3 +476,268 @@ void free_i_array_2d(i_array_2d * v) {
     v = NULL;
 }
 
+/**
+ * The 64-bit FNV-1a hash of string `s`.
+ */
+static size_t hash_string(const char * s) {
+    unsigned long long h;
+    h = 14695981039346656037ULL;
+    for (; *s != '\0'; s++) {
+        h ^= (unsigned char) *s;
+        h *= 1099511628211ULL;
+    }
+    return (size_t) h;
+}
+
+static void fill_s_map_slots(s_map * m) {
+    int i;
+    size_t slot, mask;
+    mask = (size_t) (m->num_slots - 1);
+    for (i = 0; i < m->num_slots; i++) {
+        m->slots[i] = -1;
+    }
+    for (i = 0; i < m->keys->length; i++) {
+        slot = m->hashes->a[i] & mask;
+        while (m->slots[slot] >= 0) {
+            slot = (slot + 1) & mask;
+        }
+        m->slots[slot] = i;
+    }
+}
+
+s_map * init_s_map(int capacity) {
+    assert(capacity > 0);
+    s_map * m;
+    m = (typeof(*m) *) malloc(sizeof(*m));
+    m->keys = init_s_array(capacity);
+    m->values = init_i_array(capacity);
+    m->hashes = init_z_array(capacity);
+    // keep the map at most half full
+    m->num_slots = 4;
+    while (m->num_slots < (capacity * 2)) {
+        m->num_slots *= 2;
+    }
+    if ((m->slots = (typeof(*m->slots) *) malloc(m->num_slots *
+            sizeof(*m->slots))) == NULL) {
+        perror("out of memory");
+        exit(1);
+    }
+    fill_s_map_slots(m);
+    return m;
+}
+
+/**
+ * Returns the slot holding `key`, or the empty slot where it belongs.
+ */
+static size_t find_s_map_slot(const s_map * m, const char * key,
+        size_t hash) {
+    int e;
+    size_t slot, mask;
+    mask = (size_t) (m->num_slots - 1);
+    slot = hash & mask;
+    while ((e = m->slots[slot]) >= 0) {
+        if ((m->hashes->a[e] == hash) &&
+                (strcmp(get_s_array(m->keys, e), key) == 0)) {
+            break;
+        }
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+int set_s_map(s_map * m, const char * key, int value) {
+    size_t hash, slot;
+    hash = hash_string(key);
+    slot = find_s_map_slot(m, key, hash);
+    if (m->slots[slot] >= 0) {
+        m->values->a[m->slots[slot]] = value;
+        return 1;
+    }
+    m->slots[slot] = m->keys->length;
+    append_s_array(m->keys, key);
+    i_array_append(m->values, value);
+    z_array_append(m->hashes, hash);
+    if ((m->keys->length * 2) > m->num_slots) {
+        m->num_slots *= 2;
+        if ((m->slots = (typeof(*m->slots) *) realloc(m->slots,
+                (m->num_slots * sizeof(*m->slots)))) == NULL) {
+            perror("out of memory");
+            exit(1);
+        }
+        fill_s_map_slots(m);
+    }
+    return 0;
+}
+
+int get_s_map(const s_map * m, const char * key, int * value) {
+    size_t slot;
+    slot = find_s_map_slot(m, key, hash_string(key));
+    if (m->slots[slot] < 0) {
+        return 0;
+    }
+    *value = m->values->a[m->slots[slot]];
+    return 1;
+}
+
+void free_s_map(s_map * m) {
+    free_s_array(m->keys);
+    free_i_array(m->values);
+    free_z_array(m->hashes);
+    free(m->slots);
+    free(m);
+    m = NULL;
+}
+
+i_array_csr * init_i_array_csr(int capacity, int value_capacity) {
+    assert((capacity > 0) && (value_capacity > 0));
+    i_array_csr * v;
+    v = (typeof(*v) *) malloc(sizeof(*v));
+    v->values = init_i_array(value_capacity);
+    v->offsets = init_i_array(capacity + 1);
+    i_array_append(v->offsets, 0);
+    v->length = 0;
+    return v;
+}
+
+void start_row_i_array_csr(i_array_csr * v) {
+    i_array_append(v->offsets, v->values->length);
+    v->length++;
+}
+
+void append_el_i_array_csr(i_array_csr * v, int x) {
+    assert(v->length > 0);
+    i_array_append(v->values, x);
+    v->offsets->a[v->length] = v->values->length;
+}
+
+void append_row_i_array_csr(i_array_csr * v, const i_array * x) {
+    extend_i_array(v->values, x);
+    i_array_append(v->offsets, v->values->length);
+    v->length++;
+}
+
+int get_row_length_i_array_csr(const i_array_csr * v, int index) {
+    assert((index >= 0) && (index < v->length));
+    return (v->offsets->a[index + 1] - v->offsets->a[index]);
+}
+
+int get_el_i_array_csr(const i_array_csr * v, int row_index, int el_index) {
+    assert((el_index >= 0) &&
+            (el_index < get_row_length_i_array_csr(v, row_index)));
+    return (v->values->a[v->offsets->a[row_index] + el_index]);
+}
+
+i_array * view_row_i_array_csr(const i_array_csr * v, int index,
+        i_array * view) {
+    view->length = get_row_length_i_array_csr(v, index);
+    view->capacity = view->length;
+    view->a = v->values->a + v->offsets->a[index];
+    return view;
+}
+
+void write_i_array_csr(FILE * stream, const i_array_csr * v,
+        const char * sep) {
+    int i, j, start, end;
+    for (i = 0; i < v->length; i++) {
+        start = v->offsets->a[i];
+        end = v->offsets->a[i + 1];
+        for (j = start; j < end; j++) {
+            fprintf(stream, "%d%s", v->values->a[j],
+                    ((j < (end - 1)) ? sep : ""));
+        }
+        fprintf(stream, "\n");
+    }
+}
+
+void free_i_array_csr(i_array_csr * v) {
+    free_i_array(v->values);
+    free_i_array(v->offsets);
+    free(v);
+    v = NULL;
+}
+
+bump_arena * init_bump_arena(size_t capacity) {
+    assert(capacity > 0);
+    bump_arena * b;
+    b = (typeof(*b) *) malloc(sizeof(*b));
+    b->capacity = capacity;
+    if ((b->a = (typeof(*b->a) *) malloc(b->capacity *
+            sizeof(*b->a))) == NULL) {
+        perror("out of memory");
+        exit(1);
+    }
+    b->used = 0;
+    b->retired = NULL;
+    b->num_retired = 0;
+    b->retired_capacity = 0;
+    return b;
+}
+
+/**
+ * Replace the block of `b` with one of at least `size` bytes, keeping the
+ * old block until the next reset.
+ */
+static void grow_bump_arena(bump_arena * b, size_t size) {
+    if (b->num_retired >= b->retired_capacity) {
+        b->retired_capacity = (b->retired_capacity > 0) ?
+                (b->retired_capacity * 2) : 4;
+        if ((b->retired = (typeof(*b->retired) *) realloc(b->retired,
+                (b->retired_capacity * sizeof(*b->retired)))) == NULL) {
+            perror("out of memory");
+            exit(1);
+        }
+    }
+    b->retired[b->num_retired] = b->a;
+    b->num_retired++;
+    // the new block also holds everything allocated since the last reset,
+    // so that a single block suffices after it
+    b->capacity = ((b->capacity + size) > (b->capacity * 2)) ?
+            (b->capacity + size) : (b->capacity * 2);
+    if ((b->a = (typeof(*b->a) *) malloc(b->capacity *
+            sizeof(*b->a))) == NULL) {
+        perror("out of memory");
+        exit(1);
+    }
+    b->used = 0;
+}
+
+void * bump_alloc(bump_arena * b, size_t size) {
+    void * p;
+    size_t start;
+    start = (b->used + (BUMP_ARENA_ALIGNMENT - 1)) &
+            ~((size_t) (BUMP_ARENA_ALIGNMENT - 1));
+    if ((start + size) > b->capacity) {
+        grow_bump_arena(b, size);
+        start = 0;
+    }
+    p = b->a + start;
+    b->used = start + size;
+    return p;
+}
+
+void reset_bump_arena(bump_arena * b) {
+    int i;
+    for (i = 0; i < b->num_retired; i++) {
+        free(b->retired[i]);
+    }
+    b->num_retired = 0;
+    b->used = 0;
+}
+
+void free_bump_arena(bump_arena * b) {
+    reset_bump_arena(b);
+    free(b->retired);
+    free(b->a);
+    free(b);
+    b = NULL;
+}
+
+d_array * bump_alloc_d_array(bump_arena * b, int capacity) {
+    assert(capacity > 0);
+    d_array * v;
+    v = (typeof(*v) *) bump_alloc(b, sizeof(*v));
+    v->a = (typeof(*v->a) *) bump_alloc(b, (capacity * sizeof(*v->a)));
+    v->capacity = capacity;
+    v->length = 0;
+    return v;
+}
@@ -26,26 +26,39 @@
 #include <string.h>
 #include <assert.h>
 #include <math.h>
+#include <ctype.h>
 
-typedef struct d_array_ {
-    double * a;
-    int length;
-    int capacity;
-} d_array;
+#include "typed_array.h"
 
-typedef struct i_array_ {
-    int * a;
-    int length;
-    int capacity;
-} i_array;
+DECLARE_TYPED_ARRAY(d_array, double)
+DECLARE_TYPED_ARRAY(i_array, int)
+DECLARE_TYPED_ARRAY(f_array, float)
+DECLARE_TYPED_ARRAY(z_array, size_t)
+
+// an array of file offsets, as returned by `ftell`
+DECLARE_TYPED_ARRAY(o_array, long)
 
 typedef struct c_array_ {
     char * a;
     int capacity;
 } c_array;
 
+// initial bytes of string storage per element of an s_array
+#define S_ARRAY_BYTES_PER_STRING 16
+
+/**
+ * An array of strings stored back to back, each with its terminating null
+ * character, in one contiguous `arena` of bytes. String `i` starts at byte
+ * `offsets[i]` and ends before byte `offsets[i + 1]`, so `offsets[length]` is
+ * the number of bytes in use and `offsets[0]` is always 0; truncating the
+ * array (e.g., setting `length` to 0) frees the space of the strings removed
+ * for reuse. The pointers returned by `get_s_array` are only valid until the
+ * array is next modified.
+ */
 typedef struct s_array_ {
-    c_array ** a;
+    char * arena;
+    size_t arena_capacity;
+    size_t * offsets;
     int length;
     int capacity;
 } s_array;
@@ -57,14 +70,56 @@ typedef struct i_array_2d_ {
     int initial_element_capacity;
 } i_array_2d;
 
-d_array * init_d_array(int length);
-void expand_d_array(d_array * v);
-void append_d_array(d_array * v, double x);
-void extend_d_array(d_array * dest, const d_array * to_add);
-double get_d_array(const d_array * v, int index);
-void set_d_array(d_array * v, int index, double x);
+/**
+ * A hash map from strings to ints, with open addressing and linear probing.
+ * Entry `i` has key `get_s_array(keys, i)`, value `values->a[i]` and hash
+ * `hashes->a[i]`; `slots` holds the index of the entry in each of the
+ * `num_slots` slots (a power of 2), or -1 for empty slots. Entries cannot
+ * be removed.
+ */
+typedef struct s_map_ {
+    s_array * keys;
+    i_array * values;
+    z_array * hashes;
+    int * slots;
+    int num_slots;
+} s_map;
+
+/**
+ * A two-dimensional array of ints in compressed sparse row (CSR) layout:
+ * the rows are stored back to back in `values`, and row `i` spans
+ * `values->a[offsets->a[i]]` up to (but not including)
+ * `values->a[offsets->a[i + 1]]`. `length` is the number of rows. Rows can
+ * only be added at the end, and the last row can be extended.
+ */
+typedef struct i_array_csr_ {
+    i_array * values;
+    i_array * offsets;
+    int length;
+} i_array_csr;
+
+// alignment of the blocks returned by `bump_alloc`
+#define BUMP_ARENA_ALIGNMENT 16
+
+/**
+ * A resettable bump allocator for short-lived temporaries. `bump_alloc`
+ * hands out the next `size` bytes of the block `a`; nothing is freed until
+ * `reset_bump_arena` releases everything at once. When the block is full, a
+ * larger one replaces it, and the outgrown blocks (which may still be in
+ * use) are kept in `retired` until the next reset, after which the arena
+ * makes no further heap calls as long as the same amount is allocated
+ * between resets.
+ */
+typedef struct bump_arena_ {
+    char * a;
+    size_t used;
+    size_t capacity;
+    char ** retired;
+    int num_retired;
+    int retired_capacity;
+} bump_arena;
+
 void write_d_array(FILE * stream, const d_array * v, const char * sep);
-void free_d_array(d_array * v);
 
 c_array * init_c_array(int length);
 void expand_c_array(c_array * v);
@@ -72,14 +127,7 @@ void assign_c_array(c_array * v, const char * s);
 void free_c_array(c_array * v);
 char * get_c_array(const c_array * v);
 
-i_array * init_i_array(int length);
-void expand_i_array(i_array * v);
-void append_i_array(i_array * v, int x);
-void extend_i_array(i_array * dest, const i_array * to_add);
-int get_i_array(const i_array * v, int index);
-void set_i_array(i_array * v, int index, int x);
 void write_i_array(FILE * stream, const i_array * v, const char * sep);
-void free_i_array(i_array * v);
 
 s_array * init_s_array(int length);
 void expand_s_array(s_array * v);
@@ -87,6 +135,7 @@ void append_s_array(s_array * v, const char * x);
 void extend_s_array(s_array * dest, const s_array * to_add);
 char * get_s_array(const s_array * v, int index);
 void set_s_array(s_array * v, int index, const char * s);
+void reset_s_array(s_array * v);
 void write_s_array(FILE * stream, const s_array * v, const char * sep);
 void free_s_array(s_array * v);
 
@@ -95,9 +144,9 @@ int d_arrays_equal(const d_array * v1, const d_array * v2, double error);
 int i_arrays_equal(const i_array * v1, const i_array * v2);
 int s_arrays_equal(const s_array * v1, const s_array * v2);
 
-int split_str(char * string, s_array * words, int expected_num);
-int split_str_d(char * string, d_array * v, int expected_num);
-int split_str_i(char * string, i_array * v, int expected_num);
+int split_str(const char * string, s_array * words, int expected_num);
+int split_str_d(const char * string, d_array * v, int expected_num);
+int split_str_i(const char * string, i_array * v, int expected_num);
 void get_matching_indices(const s_array * search_strings,
         const s_array * target_strings,
         i_array * indices);
@@ -115,5 +164,50 @@ i_array * get_i_array_2d(const i_array_2d * v, int index);
 int get_el_i_array_2d(const i_array_2d * v, int i_array_index, int el_index);
 void free_i_array_2d(i_array_2d * v);
 
+s_map * init_s_map(int capacity);
+
+/**
+ * Map `key` to `value`, replacing the value if `key` is already in the map;
+ * returns 1 if it was, and 0 otherwise.
+ */
+int set_s_map(s_map * m, const char * key, int value);
+
+/**
+ * Store the value of `key` in `value` and return 1, or return 0 if `key` is
+ * not in the map.
+ */
+int get_s_map(const s_map * m, const char * key, int * value);
+void free_s_map(s_map * m);
+
+i_array_csr * init_i_array_csr(int capacity, int value_capacity);
+void start_row_i_array_csr(i_array_csr * v);
+void append_el_i_array_csr(i_array_csr * v, int x);
+void append_row_i_array_csr(i_array_csr * v, const i_array * x);
+int get_row_length_i_array_csr(const i_array_csr * v, int index);
+int get_el_i_array_csr(const i_array_csr * v, int row_index, int el_index);
+
+/**
+ * Point `view` at row `index` of `v`, without copying it, and return
+ * `view`. The view shares the storage of `v`: it must not be grown or freed,
+ * and is only valid until a row is next added to `v`.
+ */
+i_array * view_row_i_array_csr(const i_array_csr * v, int index,
+        i_array * view);
+void write_i_array_csr(FILE * stream, const i_array_csr * v,
+        const char * sep);
+void free_i_array_csr(i_array_csr * v);
+
+bump_arena * init_bump_arena(size_t capacity);
+void * bump_alloc(bump_arena * b, size_t size);
+void reset_bump_arena(bump_arena * b);
+void free_bump_arena(bump_arena * b);
+
+/**
+ * Allocate a `d_array` of `capacity` elements, struct included, from `b`.
+ * The array is released by resetting `b`; it must not be grown beyond
+ * `capacity` or passed to `free_d_array`.
+ */
+d_array * bump_alloc_d_array(bump_arena * b, int capacity);
+
 #endif /* ARRAY_UTILS_H */
 
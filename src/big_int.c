@@ -0,0 +1,243 @@
+/**
+ * @file        big_int.c
+ * @authors     Jamie Oaks
+ * @package     ABACUS (Approximate BAyesian C UtilitieS)
+ * @brief       Arbitrary-precision non-negative integers.
+ * @copyright   Copyright (C) 2013 Jamie Oaks.
+ *   This file is part of ABACUS.  ABACUS is free software; you can
+ *   redistribute it and/or modify it under the terms of the GNU General Public
+ *   License as published by the Free Software Foundation; either version 2 of
+ *   the License, or (at your option) any later version.
+ * 
+ *   ABACUS is distributed in the hope that it will be useful, but WITHOUT ANY
+ *   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *   FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *   details.
+ * 
+ *   You should have received a copy of the GNU General Public License along
+ *   with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "big_int.h"
+
+big_int * init_big_int(int capacity) {
+    assert(capacity > 0);
+    big_int * b;
+    b = (typeof(*b) *) malloc(sizeof(*b));
+    b->capacity = capacity;
+    b->length = 0;
+    b->a = (typeof(*b->a) *) malloc(sizeof(*b->a) * b->capacity);
+    if (b->a == NULL) {
+        perror("out of memory");
+        exit(1);
+    }
+    return b;
+}
+
+static void reserve_big_int(big_int * b, int capacity) {
+    uint32_t * a;
+    if (capacity <= b->capacity) {
+        return;
+    }
+    if (capacity < (b->capacity * 2)) {
+        capacity = b->capacity * 2;
+    }
+    a = (typeof(*a) *) realloc(b->a, sizeof(*a) * capacity);
+    if (a == NULL) {
+        perror("out of memory");
+        exit(1);
+    }
+    b->a = a;
+    b->capacity = capacity;
+}
+
+void free_big_int(big_int * b) {
+    free(b->a);
+    free(b);
+    b = NULL;
+}
+
+void assign_big_int(big_int * b, uint64_t x) {
+    b->length = 0;
+    while (x > 0) {
+        reserve_big_int(b, (b->length + 1));
+        b->a[b->length++] = (uint32_t) (x % BIG_INT_BASE);
+        x /= BIG_INT_BASE;
+    }
+}
+
+void copy_big_int(big_int * dest, const big_int * src) {
+    reserve_big_int(dest, src->length);
+    memcpy(dest->a, src->a, (sizeof(*src->a) * src->length));
+    dest->length = src->length;
+}
+
+void add_big_int(big_int * dest, const big_int * x) {
+    int i, length;
+    uint32_t carry, d;
+    length = (dest->length > x->length) ? dest->length : x->length;
+    reserve_big_int(dest, (length + 1));
+    for (i = dest->length; i < length; i++) {
+        dest->a[i] = 0;
+    }
+    carry = 0;
+    for (i = 0; i < length; i++) {
+        d = dest->a[i] + carry + ((i < x->length) ? x->a[i] : 0);
+        carry = (d >= BIG_INT_BASE);
+        dest->a[i] = carry ? (d - BIG_INT_BASE) : d;
+        if ((i >= x->length) && (carry == 0)) {
+            break;
+        }
+    }
+    dest->length = length;
+    if (carry) {
+        dest->a[dest->length++] = carry;
+    }
+}
+
+void subtract_big_int(big_int * dest, const big_int * x) {
+    int i;
+    uint32_t borrow, d;
+    assert(compare_big_int(dest, x) >= 0);
+    borrow = 0;
+    for (i = 0; i < dest->length; i++) {
+        d = borrow + ((i < x->length) ? x->a[i] : 0);
+        if ((i >= x->length) && (borrow == 0)) {
+            break;
+        }
+        borrow = (dest->a[i] < d);
+        dest->a[i] = borrow ? (dest->a[i] + BIG_INT_BASE - d) :
+                (dest->a[i] - d);
+    }
+    while ((dest->length > 0) && (dest->a[dest->length - 1] == 0)) {
+        dest->length--;
+    }
+}
+
+void multiply_big_int(big_int * dest, const big_int * x, const big_int * y) {
+    assert((dest != x) && (dest != y));
+    int i, j;
+    uint64_t carry, t;
+    if ((x->length == 0) || (y->length == 0)) {
+        dest->length = 0;
+        return;
+    }
+    reserve_big_int(dest, (x->length + y->length));
+    memset(dest->a, 0, (sizeof(*dest->a) * (x->length + y->length)));
+    for (i = 0; i < x->length; i++) {
+        carry = 0;
+        for (j = 0; j < y->length; j++) {
+            t = ((uint64_t) x->a[i] * y->a[j]) + dest->a[i+j] + carry;
+            dest->a[i+j] = (uint32_t) (t % BIG_INT_BASE);
+            carry = t / BIG_INT_BASE;
+        }
+        dest->a[i + y->length] = (uint32_t) carry;
+    }
+    dest->length = x->length + y->length;
+    while ((dest->length > 0) && (dest->a[dest->length - 1] == 0)) {
+        dest->length--;
+    }
+}
+
+void multiply_big_int_small(big_int * b, uint32_t x) {
+    int i;
+    uint64_t carry, t;
+    if (x == 0) {
+        b->length = 0;
+        return;
+    }
+    carry = 0;
+    for (i = 0; i < b->length; i++) {
+        t = ((uint64_t) b->a[i] * x) + carry;
+        b->a[i] = (uint32_t) (t % BIG_INT_BASE);
+        carry = t / BIG_INT_BASE;
+    }
+    while (carry > 0) {
+        reserve_big_int(b, (b->length + 1));
+        b->a[b->length++] = (uint32_t) (carry % BIG_INT_BASE);
+        carry /= BIG_INT_BASE;
+    }
+}
+
+uint32_t divide_big_int_small(big_int * b, uint32_t x) {
+    assert(x > 0);
+    int i;
+    uint64_t r, t;
+    r = 0;
+    for (i = b->length - 1; i >= 0; i--) {
+        t = (r * BIG_INT_BASE) + b->a[i];
+        b->a[i] = (uint32_t) (t / x);
+        r = t % x;
+    }
+    while ((b->length > 0) && (b->a[b->length - 1] == 0)) {
+        b->length--;
+    }
+    return (uint32_t) r;
+}
+
+void shift_big_int(big_int * b, int num_digits) {
+    if ((b->length == 0) || (num_digits == 0)) {
+        return;
+    }
+    if (num_digits < 0) {
+        if (-num_digits >= b->length) {
+            b->length = 0;
+            return;
+        }
+        memmove(b->a, (b->a - num_digits),
+                (sizeof(*b->a) * (b->length + num_digits)));
+        b->length += num_digits;
+        return;
+    }
+    reserve_big_int(b, (b->length + num_digits));
+    memmove((b->a + num_digits), b->a, (sizeof(*b->a) * b->length));
+    memset(b->a, 0, (sizeof(*b->a) * num_digits));
+    b->length += num_digits;
+}
+
+int compare_big_int(const big_int * x, const big_int * y) {
+    int i;
+    if (x->length != y->length) {
+        return (x->length < y->length) ? -1 : 1;
+    }
+    for (i = x->length - 1; i >= 0; i--) {
+        if (x->a[i] != y->a[i]) {
+            return (x->a[i] < y->a[i]) ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+double get_log_big_int(const big_int * b) {
+    int i, n;
+    double x;
+    assert(b->length > 0);
+    // the leading three digits carry more than double precision
+    n = (b->length < 3) ? b->length : 3;
+    x = 0.0;
+    for (i = b->length - 1; i >= (b->length - n); i--) {
+        x = (x * BIG_INT_BASE) + b->a[i];
+    }
+    return log(x) + ((b->length - n) * BIG_INT_BASE_DIGITS * log(10.0));
+}
+
+void write_big_int(FILE * stream, const big_int * b) {
+    int i;
+    if (b->length == 0) {
+        fprintf(stream, "0");
+        return;
+    }
+    fprintf(stream, "%u", b->a[b->length - 1]);
+    for (i = b->length - 2; i >= 0; i--) {
+        fprintf(stream, "%09u", b->a[i]);
+    }
+}
+
+void write_big_ints(FILE * stream, big_int ** v, int length,
+        const char * sep) {
+    int i;
+    for (i = 0; i < length; i++) {
+        write_big_int(stream, v[i]);
+        fprintf(stream, "%s", ((i < (length - 1)) ? sep : "\n"));
+    }
+}
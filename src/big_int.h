@@ -0,0 +1,100 @@
+/**
+ * @file        big_int.h
+ * @authors     Jamie Oaks
+ * @package     ABACUS (Approximate BAyesian C UtilitieS)
+ * @brief       Arbitrary-precision non-negative integers.
+ * @copyright   Copyright (C) 2013 Jamie Oaks.
+ *   This file is part of ABACUS.  ABACUS is free software; you can
+ *   redistribute it and/or modify it under the terms of the GNU General Public
+ *   License as published by the Free Software Foundation; either version 2 of
+ *   the License, or (at your option) any later version.
+ * 
+ *   ABACUS is distributed in the hope that it will be useful, but WITHOUT ANY
+ *   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *   FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *   details.
+ * 
+ *   You should have received a copy of the GNU General Public License along
+ *   with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BIG_INT_H
+#define BIG_INT_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <assert.h>
+
+// the base of the digits of a big_int, so that they print in decimal
+#define BIG_INT_BASE 1000000000U
+#define BIG_INT_BASE_DIGITS 9
+
+/**
+ * A non-negative integer of any size, stored as `length` digits in base
+ * `BIG_INT_BASE`, least significant first. Zero has no digits; the most
+ * significant digit of any other value is not zero.
+ */
+typedef struct big_int_ {
+    uint32_t * a;
+    int length;
+    int capacity;
+} big_int;
+
+big_int * init_big_int(int capacity);
+void free_big_int(big_int * b);
+void assign_big_int(big_int * b, uint64_t x);
+void copy_big_int(big_int * dest, const big_int * src);
+
+/**
+ * Add `x` to `dest`.
+ */
+void add_big_int(big_int * dest, const big_int * x);
+
+/**
+ * Subtract `x` from `dest`, which must not be less than `x`.
+ */
+void subtract_big_int(big_int * dest, const big_int * x);
+
+/**
+ * Store the product of `x` and `y` in `dest`, which must be neither.
+ */
+void multiply_big_int(big_int * dest, const big_int * x, const big_int * y);
+void multiply_big_int_small(big_int * b, uint32_t x);
+
+/**
+ * Divide `b` by `x`, which must not be zero, in place; returns the
+ * remainder.
+ */
+uint32_t divide_big_int_small(big_int * b, uint32_t x);
+
+/**
+ * Multiply `b` by `BIG_INT_BASE` to the power `num_digits` or, if
+ * `num_digits` is negative, divide it by `BIG_INT_BASE` to the power
+ * `-num_digits`, dropping the remainder.
+ */
+void shift_big_int(big_int * b, int num_digits);
+
+/**
+ * Returns a negative number, zero or a positive number if `x` is less
+ * than, equal to or greater than `y`.
+ */
+int compare_big_int(const big_int * x, const big_int * y);
+
+/**
+ * Returns the natural logarithm of `b`, which must not be zero, to double
+ * precision; unlike converting `b` to a double, this does not overflow.
+ */
+double get_log_big_int(const big_int * b);
+void write_big_int(FILE * stream, const big_int * b);
+
+/**
+ * Write `length` big_ints, separated by `sep` and followed by a newline,
+ * like `write_i_array`.
+ */
+void write_big_ints(FILE * stream, big_int ** v, int length,
+        const char * sep);
+
+#endif /* BIG_INT_H */
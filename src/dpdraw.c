@@ -25,6 +25,9 @@ config * init_config() {
     c = (typeof(*c) *) malloc(sizeof(*c));
     c->reps = 1;
     c->alpha = 1.0;
+    c->num_subsets = 0;
+    c->uniform = 0;
+    c->num_threads = 1;
     srand(time(NULL));
     c->seed = rand();
     return c;
@@ -48,12 +51,22 @@ void dpdraw_preamble() {
 void help() {
     dpdraw_preamble();
     fprintf(stderr, "Usage:\n");
-    fprintf(stderr, "  dpdraw [ -r REPS -a ALPHA -s SEED ] NUM_ELEMENTS\n\n");
+    fprintf(stderr, "  dpdraw [ -r REPS -a ALPHA | -k SUBSETS | -u ] "
+            "[ -t THREADS ] [ -s SEED ] NUM_ELEMENTS\n\n");
     fprintf(stderr, "Options:\n");
     fprintf(stderr, " -r  Number of replicates. Default 1.\n");
     fprintf(stderr,
         " -a  Alpha (concentration) parameter of the Dirichlet process.\n"
         "     Default 1.0.\n");
+    fprintf(stderr,
+        " -k  Instead of the Dirichlet process, draw partitions with this\n"
+        "     number of subsets, uniformly.\n");
+    fprintf(stderr,
+        " -u  Instead of the Dirichlet process, draw partitions uniformly.\n");
+    fprintf(stderr,
+        " -t  Number of threads. Default 1. Replicate i is drawn from its\n"
+        "     own random number stream, so the output is the same for any\n"
+        "     number of threads.\n");
     fprintf(stderr, " -s  Random number seed.\n");
     fprintf(stderr, " -h  Display this help message and exit\n");
 }
@@ -65,7 +78,7 @@ void parse_args(config * conf, int argc, char ** argv) {
     /* opterr = 0; */
     end_ptr = (typeof(*end_ptr) *) malloc(sizeof(end_ptr) * 64);
     end_ptr_orig = end_ptr;
-    while((i = getopt(argc, argv, "r:a:s:h")) != -1) {
+    while((i = getopt(argc, argv, "r:a:k:ut:s:h")) != -1) {
         switch(i) {
             case 'r':
                 conf->reps = atoi(optarg);
@@ -78,6 +91,20 @@ void parse_args(config * conf, int argc, char ** argv) {
                     exit(1);
                 }
                 break;
+            case 'k':
+                conf->num_subsets = atoi(optarg);
+                if (conf->num_subsets < 1) {
+                    fprintf(stderr, "ERROR: `-k` should be a positive "
+                            "integer\n");
+                    exit(1);
+                }
+                break;
+            case 'u':
+                conf->uniform = 1;
+                break;
+            case 't':
+                conf->num_threads = atoi(optarg);
+                break;
             case 's':
                 conf->seed = atoi(optarg);
                 break;
@@ -94,7 +121,8 @@ void parse_args(config * conf, int argc, char ** argv) {
                     fprintf(stderr, "ERROR: option `-%c' requires an "
                             "argument\n", optopt);
                 }
-                else if (optopt == 'a') {
+                else if ((optopt == 'a') || (optopt == 'k') ||
+                        (optopt == 't')) {
                     fprintf(stderr, "ERROR: option `-%c' requires an "
                             "argument\n", optopt);
                 }
@@ -139,6 +167,22 @@ void parse_args(config * conf, int argc, char ** argv) {
         help();
         exit(1);
     }
+    if (conf->num_subsets > conf->num_elements) {
+        fprintf(stderr, "ERROR: `-k` should be no more than the number of "
+                "elements\n");
+        help();
+        exit(1);
+    }
+    if ((conf->num_subsets > 0) && (conf->uniform != 0)) {
+        fprintf(stderr, "ERROR: `-k` and `-u` cannot be used together\n");
+        help();
+        exit(1);
+    }
+    if (conf->num_threads < 1) {
+        fprintf(stderr, "ERROR: `-t` should be a positive integer\n");
+        help();
+        exit(1);
+    }
     if (conf->seed < 1) {
         fprintf(stderr, "ERROR: `-s` should be a positive integer\n");
         help();
@@ -147,11 +191,72 @@ void parse_args(config * conf, int argc, char ** argv) {
     free(end_ptr_orig);
 }
 
+/**
+ * The state shared by the threads drawing the replicates, which take the
+ * pieces of `DPDRAW_REPS_PER_PIECE` replicates from `queue`.
+ */
+typedef struct dpdraw_job_ {
+    const config * conf;
+    const set_partition_table * table;
+    piece_queue * queue;
+} dpdraw_job;
+
+/**
+ * Draw replicate `rep` into `elements` from stream `rep` of the seed.
+ */
+static void draw_dpdraw_replicate(const gsl_rng * rng, const dpdraw_job * job,
+        int rep, i_array * elements) {
+    int num_cats;
+    const config * conf = job->conf;
+    set_philox_stream(rng, conf->seed, rep);
+    if (conf->num_subsets > 0) {
+        num_cats = draw_set_partition_by_k(rng, job->table,
+                conf->num_elements, conf->num_subsets, elements);
+    }
+    else if (conf->uniform != 0) {
+        num_cats = draw_set_partition(rng, job->table, conf->num_elements,
+                elements);
+    }
+    else {
+        num_cats = dirichlet_process_draw(rng, conf->num_elements,
+                conf->alpha, elements);
+    }
+    assert((num_cats > 0) && (num_cats <= conf->num_elements));
+}
+
+static void * draw_dpdraw_pieces(void * arg) {
+    int piece, i, end;
+    dpdraw_job * job = (dpdraw_job *) arg;
+    text_buffer * t;
+    i_array * elements;
+    gsl_rng * rng;
+    rng = gsl_rng_alloc(philox_rng_type);
+    elements = init_i_array(job->conf->num_elements);
+    while ((piece = take_piece_queue(job->queue)) >= 0) {
+        t = init_text_buffer(DPDRAW_REPS_PER_PIECE *
+                ((job->conf->num_elements * 2) + 1));
+        end = (piece + 1) * DPDRAW_REPS_PER_PIECE;
+        if (end > job->conf->reps) {
+            end = job->conf->reps;
+        }
+        for (i = piece * DPDRAW_REPS_PER_PIECE; i < end; i++) {
+            draw_dpdraw_replicate(rng, job, i, elements);
+            append_text_buffer_ints(t, elements->a, elements->length, "\t",
+                    1);
+        }
+        finish_piece_queue(job->queue, piece, t);
+    }
+    free_i_array(elements);
+    gsl_rng_free(rng);
+    return NULL;
+}
+
 int dpdraw_main(int argc, char ** argv) {
-    int i, num_cats;
+    int i, rc;
     config * conf;
-    const gsl_rng_type * mt = gsl_rng_mt19937;
-    i_array * elements;
+    set_partition_table * table;
+    pthread_t * threads;
+    dpdraw_job job;
 
     if (argc < 2) {
         help();
@@ -160,20 +265,37 @@ int dpdraw_main(int argc, char ** argv) {
     conf = init_config();
     parse_args(conf, argc, argv);
 
-    gsl_rng * rng = gsl_rng_alloc(mt);
-    gsl_rng_set(rng, conf->seed);
-    elements = init_i_array(conf->num_elements);
-
-    for (i = 0; i < conf->reps; i++) {
-        num_cats= dirichlet_process_draw(rng,
-                conf->num_elements,
-                conf->alpha,
-                elements);
-        assert((num_cats > 0) && (num_cats <= conf->num_elements));
-        write_i_array(stdout, elements, "\t");
+    table = NULL;
+    if ((conf->num_subsets > 0) || (conf->uniform != 0)) {
+        table = init_set_partition_table(conf->num_elements, 0);
+    }
+    job.conf = conf;
+    job.table = table;
+    job.queue = init_piece_queue(
+            (((conf->reps - 1) / DPDRAW_REPS_PER_PIECE) + 1),
+            conf->num_threads, stdout, 1);
+    threads = (typeof(*threads) *) malloc(sizeof(*threads) *
+            conf->num_threads);
+    if (threads == NULL) {
+        perror("out of memory");
+        exit(1);
+    }
+    for (i = 0; i < conf->num_threads; i++) {
+        rc = pthread_create(&threads[i], NULL, draw_dpdraw_pieces, &job);
+        if (rc != 0) {
+            fprintf(stderr, "ERROR: could not create thread %d of %d "
+                    "(error %d)\n", (i + 1), conf->num_threads, rc);
+            exit(1);
+        }
+    }
+    for (i = 0; i < conf->num_threads; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    free(threads);
+    free_piece_queue(job.queue);
+    if (table != NULL) {
+        free_set_partition_table(table);
     }
-    gsl_rng_free(rng);
-    free_i_array(elements);
     free_config(conf);
     return 0;
 }
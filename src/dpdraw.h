@@ -26,18 +26,28 @@
 #include <unistd.h> // for getopt
 #include <string.h>
 #include <ctype.h>
+#include <pthread.h>
 
 #include "array_utils.h"
 #include "partition_combinatorics.h"
 #include "partition_combinatorics_random.h"
+#include "philox.h"
+#include "piece_queue.h"
 #include "abacus.h"
 
 #define DPDRAW_VERSION "0.1.0"
 
+// the replicates in a piece of work; the threads take pieces in turn, and
+// each piece is written once all of the pieces before it are
+#define DPDRAW_REPS_PER_PIECE 256
+
 typedef struct config_ {
     int num_elements;
     int reps;
     double alpha;
+    int num_subsets;
+    int uniform;
+    int num_threads;
     int seed;
 } config;
 
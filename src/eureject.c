@@ -34,6 +34,18 @@ config * init_config() {
     c->summary_path = init_c_array(63);
     c->summary_out_path = init_s_array(1);
     c->include_distance = 0;
+    c->index_path = init_c_array(63);
+    c->index_out_path = init_s_array(1);
+    c->index_provided = 0;
+    c->memory_budget = 0;
+    c->precision = STAT_PRECISION_DOUBLE;
+    c->report_out_path = init_s_array(1);
+    c->posterior_out_path = init_s_array(1);
+    c->posterior_only = 0;
+    c->write_covariances = 0;
+    c->num_components = 0;
+    c->projection_method = PROJECTION_PCA;
+    c->projection = NULL;
     return c;
 }
 
@@ -44,6 +56,13 @@ void free_config(config * c) {
     free_c_array(c->observed_path);
     free_c_array(c->summary_path);
     free_s_array(c->summary_out_path);
+    free_c_array(c->index_path);
+    free_s_array(c->index_out_path);
+    free_s_array(c->report_out_path);
+    free_s_array(c->posterior_out_path);
+    if (c->projection != NULL) {
+        free_projection(c->projection);
+    }
     free(c);
     c = NULL;
 }
@@ -56,26 +75,67 @@ sample * init_sample(
         const d_array * std_observed_stats,
         const d_array * means,
         const d_array * std_devs) {
-    int get_stats_return;
+    int num_invalid_stats;
+    double distance;
     d_array * stats;
+    stats = init_d_array(stat_indices->length);
+    distance = get_sample_distance(line_array, stat_indices,
+            std_observed_stats, means, std_devs, NULL, stats,
+            &num_invalid_stats);
+    if (num_invalid_stats != 0) {
+        fprintf(stderr, "ERROR: file %s line %d contains %d invalid stats "
+                "columns\n",
+                file_path, line_num, num_invalid_stats);
+    }
+    free_d_array(stats);
+    return init_sample_with_distance(file_path, line_num, line_array,
+            distance, num_invalid_stats);
+}
+
+sample * init_sample_with_distance(
+        const char * file_path,
+        const int line_num,
+        const s_array * line_array,
+        const double distance,
+        const int num_invalid_stats) {
     sample * s;
     s = (typeof(*s) *) malloc(sizeof(*s));
     s->file_path = init_c_array(63);
+    s->line_array = init_s_array(line_array->length);
+    set_sample(s, file_path, line_num, line_array, distance,
+            num_invalid_stats);
+    return s;
+}
+
+void set_sample(sample * s,
+        const char * file_path,
+        const int line_num,
+        const s_array * line_array,
+        const double distance,
+        const int num_invalid_stats) {
     assign_c_array(s->file_path, file_path);
     s->line_num = line_num;
-    s->line_array = init_s_array(line_array->length);
+    reset_s_array(s->line_array);
     extend_s_array(s->line_array, line_array);
-    stats = init_d_array(stat_indices->length);
-    get_stats_return = get_doubles(line_array, stat_indices, stats);
-    if (get_stats_return != 0) {
-        fprintf(stderr, "ERROR: file %s line %d contains %d invalid stats "
-                "columns\n",
-                file_path, line_num, get_stats_return);
-    }
+    s->distance = distance;
+    s->num_invalid_stats = num_invalid_stats;
+}
+
+double get_sample_distance(const s_array * line_array,
+        const i_array * stat_indices,
+        const d_array * std_observed_stats,
+        const d_array * means,
+        const d_array * std_devs,
+        const projection * proj,
+        d_array * stats,
+        int * num_invalid_stats) {
+    assert(stats->capacity >= stat_indices->length);
+    *num_invalid_stats = get_doubles(line_array, stat_indices, stats);
     standardize_vector(stats, means, std_devs);
-    s->distance = get_euclidean_distance(std_observed_stats, stats);
-    free_d_array(stats);
-    return s;
+    if (proj != NULL) {
+        return get_projected_distance(proj, std_observed_stats, stats);
+    }
+    return get_euclidean_distance(std_observed_stats, stats);
 }
 
 void write_sample(FILE * stream, const sample * s, const int include_distance) {
@@ -108,6 +168,10 @@ sample_array * init_sample_array(int capacity) {
     }
     v->length = 0;
     v->num_processed = 0;
+    v->num_visited = 0;
+    v->num_admitted = 0;
+    v->num_parse_errors = 0;
+    v->num_bytes_read = 0;
     v->header = init_s_array(64);
     v->paths_processed = init_s_array(1);
     return v;
@@ -141,6 +205,13 @@ int process_sample(sample_array * samples, sample * s) {
     return -1;
 }
 
+int sample_is_retained(const sample_array * samples, double distance) {
+    if (samples->length < samples->capacity) {
+        return 1;
+    }
+    return (samples->a[(samples->length - 1)]->distance > distance);
+}
+
 void rshift_samples(sample_array * s, int index) {
     int i, inc;
     inc = 0;
@@ -196,7 +267,12 @@ void help() {
     fprintf(stderr, "Usage:\n");
     fprintf(stderr,
         "  eureject -f OBS-FILE [-k INT] [-n INT] [-e] [-s SUM-FILE] \\\n"
-        "      [-o SUM-OUT-FILE] SIMS-FILE1 [ SIMS-FILE2 [...] ]\n\n");
+        "      [-o SUM-OUT-FILE [-v]] [-w INDEX-OUT-FILE [-p PRECISION]] \\\n"
+        "      [-m INT] [-j REPORT-FILE] [-q POSTERIOR-FILE [-Q]] \\\n"
+        "      [-c INT [-d METHOD]] SIMS-FILE1 [ SIMS-FILE2 [...] ]\n"
+        "  eureject -f OBS-FILE -x INDEX-FILE [-k INT] [-e] \\\n"
+        "      [-o SUM-OUT-FILE] [-j REPORT-FILE] [-q POSTERIOR-FILE [-Q]]\n"
+        "  eureject serve [...]  (see `eureject serve -h`)\n\n");
     fprintf(stderr, "Options:\n");
     fprintf(stderr,
         " -f  Path to file containing observed summary statistics\n");
@@ -225,10 +301,86 @@ void help() {
         "     with `-s` (it will simply recreate the file specified by `-s`).\n"
         "     This option is nice if you plan to re-use the means/standard\n"
         "     deviations, or just want a permanent record of them.\n");
+    fprintf(stderr,
+        " -v  Also write the covariance matrix of the statistics to the\n"
+        "     file given by `-o`, one row per line after the sample sizes.\n"
+        "     Requires `-o`, and cannot be used with `-s` or `-x`, as the\n"
+        "     covariances are calculated along with the means and standard\n"
+        "     deviations. With many statistics, this is costly: the matrix\n"
+        "     has one entry for each pair of statistics.\n");
     fprintf(stderr,
         " -e  Report Euclidean distances of retained samples in the\n"
         "     first column of the output. Default is not to report\n"
         "     the distance column.\n");
+    fprintf(stderr,
+        " -w  Output file path for an index of the simulation files. The\n"
+        "     stats of every simulated sample are standardized and stored\n"
+        "     in a k-d tree, along with the location of each sample in the\n"
+        "     simulation files. The index can be used with `-x` to perform\n"
+        "     rejection for other observed datasets without re-reading the\n"
+        "     simulation files.\n");
+    fprintf(stderr,
+        " -p  Precision of the stats stored in the index written with `-w`:\n"
+        "     `double` (default) or `float`. Single-precision stats halve the\n"
+        "     size of the index and the memory it is searched in. The nearest\n"
+        "     samples are still ranked by their double-precision distances\n"
+        "     (by re-reading the few candidates from the simulation files),\n"
+        "     so the retained samples are the same in either precision.\n");
+    fprintf(stderr,
+        " -x  Path to an index built with `-w`. The simulation files, and\n"
+        "     the means and standard deviations for standardizing stats, are\n"
+        "     taken from the index, so simulation files and `-s` cannot be\n"
+        "     given. The observed stats file must have the same header as\n"
+        "     the one the index was built with. The retained samples are\n"
+        "     exactly those a full scan of the simulation files would\n"
+        "     retain, but only a fraction of the samples are visited. The\n"
+        "     simulation files must not be moved or modified after the index\n"
+        "     is built.\n");
+    fprintf(stderr,
+        " -m  Memory budget (in megabytes) for the samples retained during\n"
+        "     rejection. Rather than holding the retained samples in memory,\n"
+        "     only their distances and locations in the simulation files are\n"
+        "     kept; once these exceed the budget, they are sorted and written\n"
+        "     to temporary files, which are merged when the retained samples\n"
+        "     are written. This bounds memory use for very large `-k`. The\n"
+        "     output is identical to that without `-m`. Cannot be used with\n"
+        "     `-w` or `-x`. Default: 0 (no budget).\n");
+    fprintf(stderr,
+        " -j  Output file path for a JSON report of the run. The time spent\n"
+        "     in each phase of the run (checking headers, calculating means\n"
+        "     and standard deviations, building the index, rejection and\n"
+        "     writing the retained samples), along with the bytes read, rows\n"
+        "     processed, parse errors, samples admitted and peak memory use\n"
+        "     of each phase, are always reported to standard error in the\n"
+        "     run summary; this option also writes them to a file.\n");
+    fprintf(stderr,
+        " -q  Output file path for a summary of the posterior sample. For\n"
+        "     each column of the simulation files that is not a stat, the\n"
+        "     retained samples are summarized by their number, mean,\n"
+        "     standard deviation, minimum, 2.5%%, 25%%, 50%%, 75%% and\n"
+        "     97.5%% quantiles, maximum and 95%% HPD interval. The\n"
+        "     quantiles and HPD intervals are exact for up to %d retained\n"
+        "     samples, and otherwise approximate (to within about 1%% of\n"
+        "     the retained samples).\n", EUREJECT_POSTERIOR_SKETCH_SIZE);
+    fprintf(stderr,
+        " -c  Number of components of a projection of the standardized\n"
+        "     stats to calculate distances in. The projection is learned\n"
+        "     from the samples used for calculating the means and standard\n"
+        "     deviations (`-n`), and written to the file given by `-o`,\n"
+        "     which can then be given to `-s` to reuse the projection (the\n"
+        "     projection of a file given to `-s` is always used, so `-c`\n"
+        "     cannot be given with `-s`). Distances (including those\n"
+        "     reported by `-e`) are between the projected stats. Cannot be\n"
+        "     used with `-w` or `-x`. Default: 0 (no projection).\n");
+    fprintf(stderr,
+        " -d  Method of the projection (`-c`): `pca` (default), the\n"
+        "     leading principal components of the standardized stats, or\n"
+        "     `pls`, the partial least squares components of the stats for\n"
+        "     predicting the columns of the simulation files that are not\n"
+        "     stats (e.g., the parameters).\n");
+    fprintf(stderr,
+        " -Q  Only write the summary of the posterior sample (`-q`); the\n"
+        "     retained samples are not written to standard output.\n");
     fprintf(stderr, " -h  Display this help message and exit\n");
 }
 
@@ -260,6 +412,17 @@ void write_summary(FILE * stream,
     fprintf(stream, "Number of samples retained: %d\n", num_samples_retained);
 }
 
+void write_run_report(const char * path, const run_stats * r) {
+    FILE * f;
+    if ((f = fopen(path, "w")) == NULL) {
+        fprintf(stderr, "ERROR: Could not open %s for writing the run "
+                "report\n", path);
+        return;
+    }
+    write_run_stats_json(f, r);
+    fclose(f);
+}
+
 void write_config(FILE * stream, const config * c) {
     int i;
     fprintf(stream, "========\nSETTINGS\n========\n");
@@ -273,15 +436,43 @@ void write_config(FILE * stream, const config * c) {
     }
     fprintf(stream, "%s\n", get_s_array(c->sim_paths,
                 (c->sim_paths->length-1)));
+    if (c->index_provided != 0) {
+        fprintf(stream, "Index path: %s\n", c->index_path->a);
+    }
+    if (c->index_out_path->length > 0) {
+        fprintf(stream, "Index output path: %s\n",
+                get_s_array(c->index_out_path, 0));
+    }
+    if (c->index_out_path->length > 0) {
+        fprintf(stream, "Index precision: %s\n",
+                (c->precision == STAT_PRECISION_FLOAT) ? "float" : "double");
+    }
+    if (c->memory_budget > 0) {
+        fprintf(stream, "Memory budget for retained samples: %d MB\n",
+                c->memory_budget);
+    }
+    if (c->report_out_path->length > 0) {
+        fprintf(stream, "Run report output path: %s\n",
+                get_s_array(c->report_out_path, 0));
+    }
+    if (c->posterior_out_path->length > 0) {
+        fprintf(stream, "Posterior summary output path: %s\n",
+                get_s_array(c->posterior_out_path, 0));
+    }
+    if (c->num_components > 0) {
+        fprintf(stream, "Projection of stats: %s, %d components\n",
+                get_projection_method_name(c->projection_method),
+                c->num_components);
+    }
     fprintf(stream, "Means for standardization: ");
-    if (c->summary_provided == 0) {
+    if ((c->summary_provided == 0) && (c->index_provided == 0)) {
         fprintf(stream, "None\n");
     }
     else {
         write_d_array(stream, c->means, ", ");
     }
     fprintf(stream, "Standard deviations for standardization: ");
-    if (c->summary_provided == 0) {
+    if ((c->summary_provided == 0) && (c->index_provided == 0)) {
         fprintf(stream, "None\n");
     }
     else {
@@ -300,7 +491,7 @@ void parse_args(config * conf, int argc, char ** argv) {
     conf->means->length = 0;
     conf->std_devs->length = 0;
     conf->sim_paths->length = 0;
-    while((i = getopt(argc, argv, "f:k:n:s:o:eh")) != -1) {
+    while((i = getopt(argc, argv, "f:k:n:s:o:x:w:m:p:j:q:c:d:Qveh")) != -1) {
         switch(i) {
             case 'f':
                 assign_c_array(conf->observed_path, optarg);
@@ -326,6 +517,63 @@ void parse_args(config * conf, int argc, char ** argv) {
             case 'o':
                 append_s_array(conf->summary_out_path, optarg);
                 break;
+            case 'x':
+                conf->index_provided = 1;
+                assign_c_array(conf->index_path, optarg);
+                break;
+            case 'w':
+                append_s_array(conf->index_out_path, optarg);
+                break;
+            case 'm':
+                if (atoi(optarg) >= 0) {
+                    conf->memory_budget = atoi(optarg);
+                    break;
+                }
+                else {
+                    fprintf(stderr, "ERROR: `-m' must be positive integer\n");
+                    help();
+                    exit(1);
+                }
+                break;
+            case 'p':
+                if ((conf->precision = parse_stat_precision(optarg)) < 0) {
+                    fprintf(stderr, "ERROR: `-p' must be `double' or "
+                            "`float'\n");
+                    help();
+                    exit(1);
+                }
+                break;
+            case 'j':
+                append_s_array(conf->report_out_path, optarg);
+                break;
+            case 'q':
+                append_s_array(conf->posterior_out_path, optarg);
+                break;
+            case 'Q':
+                conf->posterior_only = 1;
+                break;
+            case 'v':
+                conf->write_covariances = 1;
+                break;
+            case 'c':
+                if (atoi(optarg) >= 0) {
+                    conf->num_components = atoi(optarg);
+                    break;
+                }
+                else {
+                    fprintf(stderr, "ERROR: `-c' must be positive integer\n");
+                    help();
+                    exit(1);
+                }
+                break;
+            case 'd':
+                if ((conf->projection_method = parse_projection_method(
+                        optarg)) < 0) {
+                    fprintf(stderr, "ERROR: `-d' must be `pca' or `pls'\n");
+                    help();
+                    exit(1);
+                }
+                break;
             case 'e':
                 conf->include_distance = 1;
                 break;
@@ -350,6 +598,13 @@ void parse_args(config * conf, int argc, char ** argv) {
                     fprintf(stderr, "ERROR: option `-%c' requires an "
                             "argument\n", optopt);
                 }
+                else if ((optopt == 'x') || (optopt == 'w') ||
+                        (optopt == 'm') || (optopt == 'p') ||
+                        (optopt == 'j') || (optopt == 'q') ||
+                        (optopt == 'c') || (optopt == 'd')) {
+                    fprintf(stderr, "ERROR: option `-%c' requires an "
+                            "argument\n", optopt);
+                }
                 else if (isprint(optopt)) {
                     fprintf(stderr, "ERROR: unknown option `-%c'\n", optopt);
                 }
@@ -366,7 +621,73 @@ void parse_args(config * conf, int argc, char ** argv) {
     for (i = optind, j = 0; i < argc; i++, j++) {
         append_s_array(conf->sim_paths, argv[i]);
     }
-    if ((conf->num_subsample < 1) && (conf->summary_provided != 1)) {
+    if (conf->index_provided == 1) {
+        if (conf->sim_paths->length > 0) {
+            fprintf(stderr, "ERROR: Simulation files cannot be given with "
+                    "`-x`; they are taken from the index\n");
+            help();
+            exit(1);
+        }
+        if (conf->summary_provided == 1) {
+            fprintf(stderr, "ERROR: `-s` cannot be used with `-x`; the "
+                    "means and standard deviations are taken from the "
+                    "index\n");
+            help();
+            exit(1);
+        }
+        if (conf->index_out_path->length > 0) {
+            fprintf(stderr, "ERROR: `-w` cannot be used with `-x`\n");
+            help();
+            exit(1);
+        }
+        conf->num_subsample = 0;
+    }
+    if ((conf->precision != STAT_PRECISION_DOUBLE) &&
+            (conf->index_out_path->length < 1)) {
+        fprintf(stderr, "ERROR: `-p` only applies to an index written with "
+                "`-w`\n");
+        help();
+        exit(1);
+    }
+    if ((conf->memory_budget > 0) && ((conf->index_provided == 1) ||
+            (conf->index_out_path->length > 0))) {
+        fprintf(stderr, "ERROR: `-m` cannot be used with `-w` or `-x`; "
+                "the index is held in memory\n");
+        help();
+        exit(1);
+    }
+    if ((conf->projection_method != PROJECTION_PCA) &&
+            (conf->num_components < 1)) {
+        fprintf(stderr, "ERROR: `-d` only applies to a projection given "
+                "by `-c`\n");
+        help();
+        exit(1);
+    }
+    if ((conf->num_components > 0) && ((conf->summary_provided == 1) ||
+            (conf->index_provided == 1) ||
+            (conf->index_out_path->length > 0))) {
+        fprintf(stderr, "ERROR: `-c` cannot be used with `-s`, `-w` or "
+                "`-x`\n");
+        help();
+        exit(1);
+    }
+    if ((conf->posterior_only != 0) &&
+            (conf->posterior_out_path->length < 1)) {
+        fprintf(stderr, "ERROR: `-Q` requires a posterior summary file "
+                "via `-q`\n");
+        help();
+        exit(1);
+    }
+    if ((conf->write_covariances != 0) &&
+            ((conf->summary_out_path->length < 1) ||
+            (conf->summary_provided == 1) || (conf->index_provided == 1))) {
+        fprintf(stderr, "ERROR: `-v` requires `-o`, and cannot be used with "
+                "`-s` or `-x`\n");
+        help();
+        exit(1);
+    }
+    if ((conf->num_subsample < 1) && (conf->summary_provided != 1) &&
+            (conf->index_provided != 1)) {
         fprintf(stderr, "ERROR: If `-n` is 0, a summary file must be provided "
                 "via `-s`\n");
         help();
@@ -381,8 +702,8 @@ void parse_args(config * conf, int argc, char ** argv) {
         help();
         exit(1);
     }
-    if ((conf->sim_paths->length < 1) ||
-            (get_s_array(conf->sim_paths, 0) == NULL)) {
+    if ((conf->index_provided != 1) && ((conf->sim_paths->length < 1) ||
+            (get_s_array(conf->sim_paths, 0) == NULL))) {
         fprintf(stderr, "ERROR: Please provide at least one simulation file\n");
         help();
         exit(1);
@@ -397,12 +718,21 @@ sample_array * reject(const s_array * paths,
         const d_array * means,
         const d_array * std_devs,
         int num_retain,
-        const s_array * header) {
+        const s_array * header,
+        const projection * proj) {
     FILE * f;
-    int i, line_num, ncols, sample_idx;
+    int i, line_num, ncols, sample_idx, num_invalid_stats;
+    double distance;
     s_array * line_array;
+    d_array * stats;
+    bump_arena * row_arena;
     sample_array * retained_samples;
     line_array = init_s_array((*header).length);
+    // the temporaries of each row come from here, so that rows that are
+    // not retained cost no heap calls
+    row_arena = init_bump_arena(sizeof(*stats) +
+            ((*stat_indices).length * sizeof(*stats->a)) +
+            (2 * BUMP_ARENA_ALIGNMENT));
     retained_samples = init_sample_array(num_retain);
     extend_s_array(retained_samples->header, header);
     for (i = 0; i < (*paths).length; i++) {
@@ -425,36 +755,253 @@ sample_array * reject(const s_array * paths,
                 exit(1);
             }
             if (line_num == 1) continue;
+            reset_bump_arena(row_arena);
+            stats = bump_alloc_d_array(row_arena, (*stat_indices).length);
+            distance = get_sample_distance(line_array, stat_indices,
+                    std_observed_stats, means, std_devs, proj, stats,
+                    &num_invalid_stats);
+            if (num_invalid_stats != 0) {
+                fprintf(stderr, "ERROR: file %s line %d contains %d invalid "
+                        "stats columns\n", get_s_array(paths, i), line_num,
+                        num_invalid_stats);
+                retained_samples->num_parse_errors++;
+            }
+            if (sample_is_retained(retained_samples, distance) == 0) {
+                retained_samples->num_processed++;
+                continue;
+            }
             sample * s;
-            s = init_sample(get_s_array(paths, i), line_num, line_array,
-                    stat_indices, std_observed_stats, means, std_devs);
+            if (retained_samples->length >= retained_samples->capacity) {
+                // reuse the farthest sample, which the new one displaces
+                retained_samples->length--;
+                s = retained_samples->a[retained_samples->length];
+                set_sample(s, get_s_array(paths, i), line_num, line_array,
+                        distance, num_invalid_stats);
+            }
+            else {
+                s = init_sample_with_distance(get_s_array(paths, i),
+                        line_num, line_array, distance, num_invalid_stats);
+            }
             sample_idx = process_sample(retained_samples, s);
             if (sample_idx < 0) {
                 free_sample(s);
             }
+            else {
+                retained_samples->num_admitted++;
+            }
+        }
+        retained_samples->num_bytes_read += ftell(f);
+        fclose(f);
+    }
+    retained_samples->num_visited = retained_samples->num_processed;
+    free_bump_arena(row_arena);
+    free_s_array(line_array);
+    return retained_samples;
+}
+
+spill_topk * reject_within_budget(const s_array * paths,
+        c_array * line_buffer,
+        const i_array * stat_indices,
+        const d_array * std_observed_stats,
+        const d_array * means,
+        const d_array * std_devs,
+        int num_retain,
+        const s_array * header,
+        size_t memory_budget,
+        sample_array * processed,
+        const projection * proj) {
+    FILE * f;
+    int i, ncols, get_stats_return;
+    long offset;
+    row_ref ref;
+    s_array * line_array;
+    d_array * stats;
+    spill_topk * retained;
+    line_array = init_s_array(header->length);
+    stats = init_d_array(stat_indices->length);
+    retained = init_spill_topk(num_retain, memory_budget);
+    for (i = 0; i < paths->length; i++) {
+        if ((f = fopen(get_s_array(paths, i), "r")) == NULL) {
+            perror(get_s_array(paths, i));
+            exit(1);
+        }
+        append_s_array(processed->paths_processed, get_s_array(paths, i));
+        ref.file_index = i;
+        ref.line_num = 0;
+        offset = ftell(f);
+        while (fgets(line_buffer->a, ((line_buffer->capacity) - 1),
+                    f) != NULL) {
+            ref.line_num++;
+            ref.offset = offset;
+            offset = ftell(f);
+            ncols = split_str(line_buffer->a, line_array, header->length);
+            if (ncols == -1) continue; //empty line
+            if (ncols != 0) {
+                fprintf(stderr, "ERROR: file %s line %d has %d columns "
+                        "(expected %d)\n", get_s_array(paths, i),
+                        ref.line_num, ncols, header->length);
+                exit(1);
+            }
+            if (ref.line_num == 1) continue;
+            get_stats_return = get_doubles(line_array, stat_indices, stats);
+            if (get_stats_return != 0) {
+                fprintf(stderr, "ERROR: file %s line %d contains %d invalid "
+                        "stats columns\n", get_s_array(paths, i),
+                        ref.line_num, get_stats_return);
+                processed->num_parse_errors++;
+            }
+            standardize_vector(stats, means, std_devs);
+            processed->num_admitted += push_spill_topk(retained,
+                    ((proj != NULL) ?
+                    get_projected_distance(proj, std_observed_stats, stats) :
+                    get_euclidean_distance(std_observed_stats, stats)),
+                    &ref);
         }
+        processed->num_bytes_read += ftell(f);
         fclose(f);
     }
+    processed->num_processed += retained->num_offered;
+    processed->num_visited += retained->num_offered;
+    finish_spill_topk(retained);
+    free_d_array(stats);
+    free_s_array(line_array);
+    return retained;
+}
+
+void write_spilled_samples(FILE * stream,
+        spill_topk * retained,
+        const s_array * paths,
+        c_array * line_buffer,
+        const s_array * header,
+        const int include_distance,
+        posterior_summary * summary) {
+    int i, ncols;
+    FILE ** streams;
+    s_array * line_array;
+    spill_candidate c;
+    line_array = init_s_array(header->length);
+    if ((streams = (typeof(*streams) *) calloc(paths->length,
+            sizeof(*streams))) == NULL) {
+        perror("out of memory");
+        exit(1);
+    }
+    for (i = 0; i < paths->length; i++) {
+        if ((streams[i] = fopen(get_s_array(paths, i), "r")) == NULL) {
+            perror(get_s_array(paths, i));
+            exit(1);
+        }
+    }
+    if ((stream != NULL) && (include_distance != 0)) {
+        fprintf(stream, "distance\t");
+    }
+    if (stream != NULL) {
+        write_s_array(stream, header, "\t");
+    }
+    while (next_spill_topk(retained, &c) != 0) {
+        if ((fseek(streams[c.ref.file_index], c.ref.offset, SEEK_SET) != 0) ||
+                (fgets(line_buffer->a, ((line_buffer->capacity) - 1),
+                        streams[c.ref.file_index]) == NULL)) {
+            fprintf(stderr, "ERROR: could not read line %d of %s\n",
+                    c.ref.line_num, get_s_array(paths, c.ref.file_index));
+            exit(1);
+        }
+        ncols = split_str(line_buffer->a, line_array, header->length);
+        if (ncols != 0) {
+            fprintf(stderr, "ERROR: file %s line %d has %d columns "
+                    "(expected %d)\n", get_s_array(paths, c.ref.file_index),
+                    c.ref.line_num, ncols, header->length);
+            exit(1);
+        }
+        if (summary != NULL) {
+            update_posterior_summary(summary, line_array);
+        }
+        if (stream == NULL) {
+            continue;
+        }
+        if (include_distance != 0) {
+            fprintf(stream, "%lf\t", c.distance);
+        }
+        write_s_array(stream, line_array, "\t");
+    }
+    for (i = 0; i < paths->length; i++) {
+        fclose(streams[i]);
+    }
+    free(streams);
+    free_s_array(line_array);
+}
+
+sample_array * reject_from_table(stat_table * table,
+        c_array * line_buffer,
+        const i_array * stat_indices,
+        const d_array * std_observed_stats,
+        int num_retain) {
+    int i, ncols;
+    const row_ref * ref;
+    s_array * line_array;
+    neighbor_heap * nearest;
+    sample_array * retained_samples;
+    sample * s;
+    line_array = init_s_array(table->header->length);
+    retained_samples = init_sample_array(num_retain);
+    extend_s_array(retained_samples->header, table->header);
+    extend_s_array(retained_samples->paths_processed, table->paths);
+    nearest = init_neighbor_heap(num_retain, table->ranks);
+    retained_samples->num_visited = query_stat_table(table,
+            std_observed_stats->a, nearest);
+    retained_samples->num_admitted = nearest->num_admitted;
+    sort_neighbor_heap(nearest);
+    for (i = 0; i < nearest->length; i++) {
+        ref = &table->refs[nearest->a[i].index];
+        read_stat_table_row(table, nearest->a[i].index, line_buffer);
+        retained_samples->num_bytes_read += strlen(line_buffer->a);
+        ncols = split_str(line_buffer->a, line_array, table->header->length);
+        if (ncols != 0) {
+            fprintf(stderr, "ERROR: file %s line %d has %d columns "
+                    "(expected %d)\n",
+                    get_s_array(table->paths, ref->file_index),
+                    ref->line_num, ncols, table->header->length);
+            exit(1);
+        }
+        s = init_sample(get_s_array(table->paths, ref->file_index),
+                ref->line_num, line_array, stat_indices, std_observed_stats,
+                table->means, table->std_devs);
+        retained_samples->a[retained_samples->length] = s;
+        retained_samples->length++;
+    }
+    retained_samples->num_processed = table->num_rows;
+    free_neighbor_heap(nearest);
     free_s_array(line_array);
     return retained_samples;
 }
 
-void summarize_stat_samples(const s_array * paths,
+long summarize_stat_samples(const s_array * paths,
         c_array * line_buffer,
         const i_array * stat_indices,
-        sample_sum_array * ss_array,
+        sample_moments * moments,
         d_array * means,
         d_array * std_devs,
         int num_to_sample,
         int expected_num_columns,
-        s_array * paths_processed) {
-    assert(ss_array->length == stat_indices->length);
+        s_array * paths_processed,
+        cov_sum * covariances,
+        const i_array * cov_indices) {
+    assert(moments->length == stat_indices->length);
     FILE * f;
-    int i, line_num, ncols, get_stats_return;
+    int i, line_num, ncols, get_stats_return, num_sampled;
+    long bytes_read;
     s_array * line_array;
     d_array * stats;
+    d_array * cov_values;
+    if (cov_indices == NULL) {
+        cov_indices = stat_indices;
+    }
+    assert((covariances == NULL) ||
+            (covariances->dim == cov_indices->length));
+    bytes_read = 0;
+    num_sampled = 0;
     line_array = init_s_array(expected_num_columns);
     stats = init_d_array((*stat_indices).length);
+    cov_values = init_d_array(cov_indices->length);
     for (i = 0; i < (*paths).length; i++) {
         line_num = 0;
         if ((f = fopen(get_s_array(paths, i), "r")) == NULL) {
@@ -482,16 +1029,63 @@ void summarize_stat_samples(const s_array * paths,
                         get_stats_return);
                 exit(1);
             }
-            update_sample_sum_array(ss_array, stats);
-            if (ss_array->a[0]->n >= num_to_sample) break;
+            update_sample_moments(moments, stats);
+            num_sampled++;
+            if ((covariances != NULL) && (cov_indices == stat_indices)) {
+                update_cov_sum(covariances, stats);
+            }
+            else if (covariances != NULL) {
+                get_stats_return = get_doubles(line_array, cov_indices,
+                        cov_values);
+                if (get_stats_return != 0) {
+                    fprintf(stderr, "ERROR: file %s line %d has %d invalid "
+                            "columns\n", get_s_array(paths, i), line_num,
+                            get_stats_return);
+                    exit(1);
+                }
+                update_cov_sum(covariances, cov_values);
+            }
+            if (num_sampled >= num_to_sample) break;
         }
+        bytes_read += ftell(f);
         fclose(f);
-        if (ss_array->a[0]->n >= num_to_sample) break;
+        if (num_sampled >= num_to_sample) break;
+    }
+    get_sample_moments_means(moments, means);
+    get_sample_moments_std_devs(moments, std_devs);
+    if (covariances != NULL) {
+        flush_cov_sum(covariances);
     }
-    get_mean_array(ss_array, means);
-    get_std_dev_array(ss_array, std_devs);
     free_d_array(stats);
+    free_d_array(cov_values);
     free_s_array(line_array);
+    return bytes_read;
+}
+
+void update_posterior_summary_from_samples(posterior_summary * summary,
+        const sample_array * samples) {
+    int i;
+    for (i = 0; i < samples->length; i++) {
+        update_posterior_summary(summary, samples->a[i]->line_array);
+    }
+}
+
+void get_parameter_indices(const s_array * header,
+        const i_array * stat_indices, i_array * param_indices) {
+    int i, j, is_stat;
+    param_indices->length = 0;
+    for (i = 0; i < header->length; i++) {
+        is_stat = 0;
+        for (j = 0; j < stat_indices->length; j++) {
+            if (get_i_array(stat_indices, j) == i) {
+                is_stat = 1;
+                break;
+            }
+        }
+        if (is_stat == 0) {
+            append_i_array(param_indices, i);
+        }
+    }
 }
 
 int eureject_main(int argc, char ** argv) {
@@ -501,25 +1095,46 @@ int eureject_main(int argc, char ** argv) {
     s_array * sim_header;
     s_array * sim_header_comp;
     d_array * obs_stats;
-    int i, heads_match, sum_sample_size;
+    int i, heads_match, sum_sample_size, num_retained;
+    long bytes_read, header_bytes_read;
     i_array * indices;
     i_array * summary_sample_sizes;
-    sample_sum_array * sample_sums;
+    sample_moments * moments;
     sample_array * retained_samples;
     s_array * sum_paths_used;
+    stat_table * table;
+    spill_topk * spilled_samples;
+    i_array * param_indices;
+    i_array * cov_indices;
+    posterior_summary * posterior;
+    cov_sum * covariances;
+    d_array * observed;
     config * conf;
+    run_stats * stats;
+    run_phase * phase;
+    const char * phase_names[EUREJECT_NUM_PHASES] = {"header_checks",
+            "summarize", "index_build", "rejection", "output"};
     FILE * summary_out_stream;
+    FILE * posterior_out_stream;
     line_buffer = init_c_array(pow(2, 20));
     obs_header = init_s_array(1);
     obs_stats = init_d_array(1);
     sum_paths_used = init_s_array(1);
     retained_samples = init_sample_array(1);
+    table = NULL;
+    spilled_samples = NULL;
+    posterior = NULL;
+    covariances = NULL;
+    cov_indices = NULL;
     if (argc < 2) {
         help();
         exit(1);
     }
     conf = init_config();
     parse_args(conf, argc, argv);
+    stats = init_run_stats(phase_names, EUREJECT_NUM_PHASES);
+    header_bytes_read = 0;
+    start_run_phase(stats, EUREJECT_PHASE_HEADERS);
 
     parse_observed_stats_file(conf->observed_path->a, line_buffer, obs_header,
             obs_stats);
@@ -540,16 +1155,58 @@ int eureject_main(int argc, char ** argv) {
             exit(1);
         }
         free_s_array(summary_header);
+        conf->projection = parse_summary_projection(conf->summary_path->a,
+                line_buffer, obs_header->length);
+        if ((conf->projection != NULL) &&
+                (conf->index_out_path->length > 0)) {
+            fprintf(stderr, "ERROR: File %s has a projection, which cannot "
+                    "be used with `-w`\n", get_c_array(conf->summary_path));
+            help();
+            exit(1);
+        }
+    }
+    if (conf->num_components > obs_header->length) {
+        fprintf(stderr, "ERROR: `-c` cannot be greater than the number of "
+                "stats (%d)\n", obs_header->length);
+        help();
+        exit(1);
+    }
+
+    // load the index, which supplies the simulation files, their header and
+    // the means and std devs
+    if (conf->index_provided != 0) {
+        table = read_stat_table(get_c_array(conf->index_path));
+        heads_match = s_arrays_equal(obs_header, table->stat_names);
+        if (heads_match == 0) {
+            fprintf(stderr, "ERROR: File %s has a different header than "
+                    "the one index %s was built with\n",
+                    get_c_array(conf->observed_path),
+                    get_c_array(conf->index_path));
+            help();
+            exit(1);
+        }
+        extend_s_array(conf->sim_paths, table->paths);
+        extend_d_array(conf->means, table->means);
+        extend_d_array(conf->std_devs, table->std_devs);
+        extend_i_array(summary_sample_sizes, table->sample_sizes);
     }
 
     sim_header = init_s_array(obs_header->length);
-    parse_header(get_s_array(conf->sim_paths, 0), line_buffer, sim_header);
+    if (table != NULL) {
+        extend_s_array(sim_header, table->header);
+    }
+    else {
+        parse_header(get_s_array(conf->sim_paths, 0), line_buffer,
+                sim_header);
+        header_bytes_read += strlen(line_buffer->a);
+    }
     // check all simulation file headers
-    if (conf->sim_paths->length > 1) {
+    if ((table == NULL) && (conf->sim_paths->length > 1)) {
         sim_header_comp = init_s_array(sim_header->length);
         for (i = 1; i < conf->sim_paths->length; i++) {
             parse_header(get_s_array(conf->sim_paths, i), line_buffer,
                     sim_header_comp);
+            header_bytes_read += strlen(line_buffer->a);
             heads_match = s_arrays_equal(sim_header, sim_header_comp);
             if (heads_match == 0) {
                 fprintf(stderr, "ERROR: Files %s and %s have different "
@@ -561,26 +1218,109 @@ int eureject_main(int argc, char ** argv) {
         }
         free_s_array(sim_header_comp);
     }
+    phase = get_run_phase(stats, EUREJECT_PHASE_HEADERS);
+    phase->bytes_read = header_bytes_read;
     indices = init_i_array(obs_header->length);
     get_matching_indices(obs_header, sim_header, indices);
+    if (conf->posterior_out_path->length > 0) {
+        param_indices = init_i_array(sim_header->length);
+        get_parameter_indices(sim_header, indices, param_indices);
+        if (param_indices->length < 1) {
+            fprintf(stderr, "ERROR: The simulation files have no columns "
+                    "other than stats to summarize with `-q`\n");
+            exit(1);
+        }
+        posterior = init_posterior_summary(sim_header, param_indices,
+                EUREJECT_POSTERIOR_SKETCH_SIZE);
+        free_i_array(param_indices);
+    }
 
     eureject_preamble();
     write_config(stderr, conf);
 
     // calc means and standard devs
     sum_sample_size = 0;
-    if (conf->summary_provided == 0) {
+    if ((conf->summary_provided == 0) && (conf->index_provided == 0)) {
         fprintf(stderr, "\nCalculating means and standard deviations... ");
-        sample_sums = init_sample_sum_array(obs_header->length);
-        summarize_stat_samples(conf->sim_paths, line_buffer,
-                indices, sample_sums, conf->means, conf->std_devs,
-                conf->num_subsample, sim_header->length, sum_paths_used);
+        start_run_phase(stats, EUREJECT_PHASE_SUMMARIZE);
+        moments = init_sample_moments(obs_header->length,
+                EUREJECT_SUMMARY_BLOCK_SIZE);
+        if ((conf->num_components > 0) &&
+                (conf->projection_method == PROJECTION_PLS)) {
+            // the covariances of the stats and the other columns
+            param_indices = init_i_array(sim_header->length);
+            get_parameter_indices(sim_header, indices, param_indices);
+            if (param_indices->length < 1) {
+                fprintf(stderr, "ERROR: The simulation files have no "
+                        "columns other than stats for `-d pls`\n");
+                exit(1);
+            }
+            cov_indices = init_i_array(sim_header->length);
+            extend_i_array(cov_indices, indices);
+            extend_i_array(cov_indices, param_indices);
+            free_i_array(param_indices);
+        }
+        if ((conf->write_covariances != 0) ||
+                (conf->num_components > 0)) {
+            covariances = init_cov_sum(((cov_indices != NULL) ?
+                    cov_indices->length : obs_header->length),
+                    EUREJECT_COV_BATCH_SIZE);
+        }
+        bytes_read = summarize_stat_samples(conf->sim_paths, line_buffer,
+                indices, moments, conf->means, conf->std_devs,
+                conf->num_subsample, sim_header->length, sum_paths_used,
+                covariances, cov_indices);
         summary_sample_sizes->length = 0;
-        for (i = 0; i < sample_sums->length; i++){
-            append_i_array(summary_sample_sizes, sample_sums->a[i]->n);
+        for (i = 0; i < moments->length; i++){
+            append_i_array(summary_sample_sizes, moments->n[i]);
         }
         sum_sample_size = get_i_array(summary_sample_sizes, 0);
-        free_sample_sum_array(sample_sums);
+        phase = get_run_phase(stats, EUREJECT_PHASE_SUMMARIZE);
+        phase->bytes_read = bytes_read;
+        phase->num_rows = sum_sample_size;
+        free_sample_moments(moments);
+        fprintf(stderr, "Done!\n");
+    }
+
+    // learn the projection of the stats
+    if (conf->num_components > 0) {
+        if (covariances->n < 2) {
+            fprintf(stderr, "ERROR: At least 2 samples are needed to learn "
+                    "a projection\n");
+            exit(1);
+        }
+        if (conf->projection_method == PROJECTION_PLS) {
+            conf->projection = get_pls_projection(covariances,
+                    obs_header->length, conf->num_components);
+            if (conf->projection == NULL) {
+                fprintf(stderr, "ERROR: The stats are uncorrelated with the "
+                        "other columns; there are no PLS components\n");
+                exit(1);
+            }
+            if (conf->projection->num_components < conf->num_components) {
+                fprintf(stderr, "WARNING: Only %d PLS components explain "
+                        "the other columns\n",
+                        conf->projection->num_components);
+            }
+        }
+        else {
+            conf->projection = get_pca_projection(covariances,
+                    conf->num_components);
+        }
+    }
+
+    // build and write index
+    if (conf->index_out_path->length == 1) {
+        fprintf(stderr, "\nBuilding index... ");
+        start_run_phase(stats, EUREJECT_PHASE_INDEX);
+        table = init_stat_table(sim_header, obs_header, conf->means,
+                conf->std_devs, summary_sample_sizes);
+        set_stat_table_precision(table, conf->precision);
+        load_stat_table(table, conf->sim_paths, line_buffer, indices);
+        build_stat_table_tree(table, KD_TREE_LEAF_SIZE);
+        write_stat_table(get_s_array(conf->index_out_path, 0), table);
+        get_run_phase(stats, EUREJECT_PHASE_INDEX)->num_rows =
+                table->num_rows;
         fprintf(stderr, "Done!\n");
     }
 
@@ -588,20 +1328,45 @@ int eureject_main(int argc, char ** argv) {
     if (conf->num_retain > 0) {
         free_sample_array(retained_samples);
         fprintf(stderr, "\nPerforming rejection... ");
+        start_run_phase(stats, EUREJECT_PHASE_REJECTION);
         standardize_vector(obs_stats, conf->means, conf->std_devs);
-        retained_samples = reject(conf->sim_paths, line_buffer, indices,
-                obs_stats, conf->means, conf->std_devs, conf->num_retain,
-                sim_header);
+        observed = obs_stats;
+        if (conf->projection != NULL) {
+            observed = init_d_array(conf->projection->num_components);
+            project_vector(conf->projection, obs_stats, observed);
+        }
+        if (table != NULL) {
+            retained_samples = reject_from_table(table, line_buffer, indices,
+                    obs_stats, conf->num_retain);
+        }
+        else if (conf->memory_budget > 0) {
+            retained_samples = init_sample_array(1);
+            spilled_samples = reject_within_budget(conf->sim_paths,
+                    line_buffer, indices, observed, conf->means,
+                    conf->std_devs, conf->num_retain, sim_header,
+                    ((size_t) conf->memory_budget * 1024 * 1024),
+                    retained_samples, conf->projection);
+        }
+        else {
+            retained_samples = reject(conf->sim_paths, line_buffer, indices,
+                    observed, conf->means, conf->std_devs, conf->num_retain,
+                    sim_header, conf->projection);
+        }
+        if (observed != obs_stats) {
+            free_d_array(observed);
+        }
+        phase = get_run_phase(stats, EUREJECT_PHASE_REJECTION);
+        phase->bytes_read = retained_samples->num_bytes_read;
+        phase->num_rows = retained_samples->num_visited;
+        phase->num_parse_errors = retained_samples->num_parse_errors;
+        phase->num_admitted = retained_samples->num_admitted;
         fprintf(stderr, "Done!\n\n");
     }
-
-    // write run stats
-    write_summary(stderr,
-        sum_paths_used,
-        sum_sample_size,
-        retained_samples->paths_processed,
-        retained_samples->num_processed,
-        retained_samples->length);
+    num_retained = ((spilled_samples != NULL) ?
+            ((spilled_samples->num_offered < conf->num_retain) ?
+                    spilled_samples->num_offered : conf->num_retain) :
+            retained_samples->length);
+    start_run_phase(stats, EUREJECT_PHASE_OUTPUT);
 
     // write means and standard devs
     if (conf->summary_out_path->length == 1) {
@@ -617,6 +1382,13 @@ int eureject_main(int argc, char ** argv) {
             write_d_array(summary_out_stream, conf->means, "\t");
             write_d_array(summary_out_stream, conf->std_devs, "\t");
             write_i_array(summary_out_stream, summary_sample_sizes, "\t");
+            if ((conf->write_covariances != 0) && (covariances->n > 1)) {
+                write_covariance_block(summary_out_stream, covariances,
+                        obs_header->length);
+            }
+            if (conf->projection != NULL) {
+                write_projection(summary_out_stream, conf->projection);
+            }
             fclose(summary_out_stream);
         }
     }
@@ -629,13 +1401,66 @@ int eureject_main(int argc, char ** argv) {
     write_d_array(stderr, conf->std_devs, "\t");
     write_i_array(stderr, summary_sample_sizes, "\t");
     fprintf(stderr, "\n");
+    if (conf->projection != NULL) {
+        fprintf(stderr, "==================================\n");
+        fprintf(stderr, "PROJECTION USED FOR DISTANCES\n");
+        fprintf(stderr, "==================================\n");
+        write_projection(stderr, conf->projection);
+        fprintf(stderr, "\n");
+    }
 
     // write retained samples
-    if (conf->num_retain > 0) {
-        write_sample_array(stdout, retained_samples, conf->include_distance);
+    if (spilled_samples != NULL) {
+        write_spilled_samples(((conf->posterior_only != 0) ? NULL : stdout),
+                spilled_samples, conf->sim_paths, line_buffer, sim_header,
+                conf->include_distance, posterior);
+        free_spill_topk(spilled_samples);
+    }
+    else if (conf->num_retain > 0) {
+        if (conf->posterior_only == 0) {
+            write_sample_array(stdout, retained_samples,
+                    conf->include_distance);
+        }
+        if (posterior != NULL) {
+            update_posterior_summary_from_samples(posterior,
+                    retained_samples);
+        }
+    }
+    fflush(stdout);
+
+    // write posterior summary
+    if (posterior != NULL) {
+        if ((posterior_out_stream = fopen(get_s_array(
+                conf->posterior_out_path, 0), "w")) == NULL) {
+            fprintf(stderr, "ERROR: Could not open %s for writing the "
+                    "posterior summary\n",
+                    get_s_array(conf->posterior_out_path, 0));
+        }
+        else {
+            write_posterior_summary(posterior_out_stream, posterior);
+            fclose(posterior_out_stream);
+        }
+        free_posterior_summary(posterior);
+    }
+    get_run_phase(stats, EUREJECT_PHASE_OUTPUT)->num_rows = num_retained;
+    stop_run_phase(stats);
+
+    // write run stats
+    write_summary(stderr,
+        sum_paths_used,
+        sum_sample_size,
+        retained_samples->paths_processed,
+        retained_samples->num_processed,
+        num_retained);
+    write_run_stats(stderr, stats);
+    if (conf->report_out_path->length == 1) {
+        write_run_report(get_s_array(conf->report_out_path, 0), stats);
     }
 
     free_sample_array(retained_samples);
+    if (table != NULL) {
+        free_stat_table(table);
+    }
     free_i_array(indices);
     free_c_array(line_buffer);
     free_s_array(obs_header);
@@ -644,6 +1469,13 @@ int eureject_main(int argc, char ** argv) {
     free_s_array(sum_paths_used);
     free_config(conf);
     free_i_array(summary_sample_sizes);
+    if (covariances != NULL) {
+        free_cov_sum(covariances);
+    }
+    if (cov_indices != NULL) {
+        free_i_array(cov_indices);
+    }
+    free_run_stats(stats);
     return 0;
 }
 
@@ -33,10 +33,29 @@
 #include "stats_utils.h"
 #include "array_utils.h"
 #include "parsing.h"
+#include "stat_table.h"
+#include "spill.h"
+#include "run_stats.h"
 #include "abacus.h"
 
 #define EUREJECT_VERSION "0.1.2"
 
+#define EUREJECT_PHASE_HEADERS 0
+#define EUREJECT_PHASE_SUMMARIZE 1
+#define EUREJECT_PHASE_INDEX 2
+#define EUREJECT_PHASE_REJECTION 3
+#define EUREJECT_PHASE_OUTPUT 4
+#define EUREJECT_NUM_PHASES 5
+
+// the rows buffered for each update of the stats' covariance matrix
+#define EUREJECT_COV_BATCH_SIZE 256
+
+// the rows buffered for each update of the stats' means and variances
+#define EUREJECT_SUMMARY_BLOCK_SIZE 256
+
+// the values held per parameter for the quantiles of the posterior summary
+#define EUREJECT_POSTERIOR_SKETCH_SIZE 4096
+
 typedef struct config_ {
     c_array * observed_path;
     c_array * summary_path;
@@ -48,15 +67,37 @@ typedef struct config_ {
     d_array * means;
     d_array * std_devs;
     int include_distance;
+    c_array * index_path;
+    s_array * index_out_path;
+    int index_provided;
+    int memory_budget;
+    int precision;
+    s_array * report_out_path;
+    s_array * posterior_out_path;
+    int posterior_only;
+    int write_covariances;
+    int num_components;
+    int projection_method;
+    projection * projection;
 } config;
 
 typedef struct sample_ {
     c_array * file_path;
     int line_num;
     double distance;
+    int num_invalid_stats;
     s_array * line_array;
 } sample;
 
+/**
+ * The retained samples, ordered by distance, and a record of the rejection
+ * that retained them. `num_processed` samples were considered; the distances
+ * of `num_visited` of them were calculated (all of them, unless an index was
+ * searched), and `num_admitted` were retained at some point (including those
+ * later displaced by nearer samples). `num_parse_errors` samples had stats
+ * that could not be parsed, and `num_bytes_read` bytes of simulation files
+ * were read.
+ */
 typedef struct sample_array_ {
     sample ** a;
     int length;
@@ -64,6 +105,10 @@ typedef struct sample_array_ {
     s_array * header;
     s_array * paths_processed;
     int num_processed;
+    int num_visited;
+    int num_admitted;
+    int num_parse_errors;
+    long num_bytes_read;
 } sample_array;
 
 config * init_config();
@@ -76,16 +121,55 @@ sample * init_sample(
         const d_array * std_observed_stats,
         const d_array * means,
         const d_array * std_devs);
+sample * init_sample_with_distance(
+        const char * file_path,
+        const int line_num,
+        const s_array * line_array,
+        const double distance,
+        const int num_invalid_stats);
+
+/**
+ * Overwrite sample `s` with a copy of a new one, reusing its storage.
+ */
+void set_sample(sample * s,
+        const char * file_path,
+        const int line_num,
+        const s_array * line_array,
+        const double distance,
+        const int num_invalid_stats);
+
+/**
+ * Parse the stats of `line_array` into `stats`, which must have room for
+ * them, standardize them and return their distance from the observed stats.
+ * If `proj` is not NULL, `std_observed_stats` are the projected observed
+ * stats, and the distance is that between the projections. The number of
+ * stats that could not be parsed is stored in `num_invalid_stats`.
+ */
+double get_sample_distance(const s_array * line_array,
+        const i_array * stat_indices,
+        const d_array * std_observed_stats,
+        const d_array * means,
+        const d_array * std_devs,
+        const projection * proj,
+        d_array * stats,
+        int * num_invalid_stats);
 void free_sample(sample * s);
 void write_sample(FILE * stream, const sample * s, const int include_distance);
 sample_array * init_sample_array(int length);
 void free_sample_array(sample_array * v);
 int process_sample(sample_array * samples, sample * s);
+
+/**
+ * Returns 1 if `process_sample` would retain a sample at `distance`, and 0
+ * otherwise.
+ */
+int sample_is_retained(const sample_array * samples, double distance);
 void rshift_samples(sample_array * s, int index);
 void write_sample_array(FILE * stream, const sample_array * s,
         const int include_distance);
 void eureject_preamble();
 void help();
+void write_run_report(const char * path, const run_stats * r);
 void write_summary(FILE * stream,
         const s_array * sum_paths_processed,
         const int sum_sample_size,
@@ -94,6 +178,11 @@ void write_summary(FILE * stream,
         const int num_samples_retained);
 void write_config(FILE * stream, const config * c);
 void parse_args(config * conf, int argc, char ** argv);
+/**
+ * Retain the `num_retain` samples nearest the observed stats. If `proj` is
+ * not NULL, distances are calculated between the projections of the stats
+ * (see `get_sample_distance`).
+ */
 sample_array * reject(const s_array * paths,
         const c_array * line_buffer,
         const i_array * stat_indices,
@@ -101,16 +190,61 @@ sample_array * reject(const s_array * paths,
         const d_array * means,
         const d_array * std_devs,
         int num_retain,
-        const s_array * header);
-void summarize_stat_samples(const s_array * paths,
+        const s_array * header,
+        const projection * proj);
+spill_topk * reject_within_budget(const s_array * paths,
+        c_array * line_buffer,
+        const i_array * stat_indices,
+        const d_array * std_observed_stats,
+        const d_array * means,
+        const d_array * std_devs,
+        int num_retain,
+        const s_array * header,
+        size_t memory_budget,
+        sample_array * processed,
+        const projection * proj);
+/**
+ * Write the samples retained by `reject_within_budget`, unless `stream` is
+ * NULL, and add them to `summary`, unless it is NULL.
+ */
+void write_spilled_samples(FILE * stream,
+        spill_topk * retained,
+        const s_array * paths,
+        c_array * line_buffer,
+        const s_array * header,
+        const int include_distance,
+        posterior_summary * summary);
+void update_posterior_summary_from_samples(posterior_summary * summary,
+        const sample_array * samples);
+
+/**
+ * Store in `param_indices` the indices of the columns of `header` that are
+ * not stats (i.e., not in `stat_indices`).
+ */
+void get_parameter_indices(const s_array * header,
+        const i_array * stat_indices, i_array * param_indices);
+sample_array * reject_from_table(stat_table * table,
+        c_array * line_buffer,
+        const i_array * stat_indices,
+        const d_array * std_observed_stats,
+        int num_retain);
+/**
+ * Calculate the means and standard deviations of the stats in (up to)
+ * `num_to_sample` samples, and, unless `covariances` is NULL, add the
+ * values of columns `cov_indices` (or of the stats, if it is NULL) of the
+ * samples to it; returns the number of bytes read.
+ */
+long summarize_stat_samples(const s_array * paths,
         c_array * line_buffer,
         const i_array * stat_indices,
-        sample_sum_array * ss_array,
+        sample_moments * moments,
         d_array * means,
         d_array * std_devs,
         int num_to_sample,
         int expected_num_columns,
-        s_array * paths_processed);
+        s_array * paths_processed,
+        cov_sum * covariances,
+        const i_array * cov_indices);
 int eureject_main(int argc, char ** argv);
 
 #endif /* EUREJECT_H */
@@ -19,9 +19,14 @@
  */
 
 #include "eureject.h"
+#include "eureject_serve.h"
 
 int main(int argc, char ** argv) {
     int rc;
+    if ((argc > 1) && (strcmp(argv[1], "serve") == 0)) {
+        rc = eureject_serve_main((argc - 1), (argv + 1));
+        return rc;
+    }
     rc = eureject_main(argc, argv);
     return rc;
 }
@@ -0,0 +1,559 @@
+/**
+ * @file        eureject_serve.c
+ * @authors     Jamie Oaks
+ * @package     ABACUS (Approximate BAyesian C UtilitieS)
+ * @brief       A resident mode of eureject that loads a simulation table once
+ *              and answers rejection requests for many observed datasets.
+ * @copyright   Copyright (C) 2013 Jamie Oaks.
+ *   This file is part of ABACUS.  ABACUS is free software; you can
+ *   redistribute it and/or modify it under the terms of the GNU General Public
+ *   License as published by the Free Software Foundation; either version 2 of
+ *   the License, or (at your option) any later version.
+ * 
+ *   ABACUS is distributed in the hope that it will be useful, but WITHOUT ANY
+ *   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *   FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *   details.
+ * 
+ *   You should have received a copy of the GNU General Public License along
+ *   with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "eureject_serve.h"
+
+static volatile sig_atomic_t serve_interrupted = 0;
+
+serve_config * init_serve_config() {
+    serve_config * c;
+    c = (typeof(*c) *) malloc(sizeof(*c));
+    c->observed_path = init_c_array(63);
+    c->summary_path = init_c_array(63);
+    c->index_path = init_c_array(63);
+    c->socket_path = init_c_array(63);
+    c->sim_paths = init_s_array(1);
+    c->num_retain = 1000;
+    c->num_subsample = 10000;
+    c->summary_provided = 0;
+    c->index_provided = 0;
+    c->socket_provided = 0;
+    c->include_distance = 0;
+    c->write_offsets = 0;
+    c->precision = STAT_PRECISION_DOUBLE;
+    return c;
+}
+
+void free_serve_config(serve_config * c) {
+    free_c_array(c->observed_path);
+    free_c_array(c->summary_path);
+    free_c_array(c->index_path);
+    free_c_array(c->socket_path);
+    free_s_array(c->sim_paths);
+    free(c);
+    c = NULL;
+}
+
+void serve_help() {
+    eureject_preamble();
+    fprintf(stderr, "Usage:\n");
+    fprintf(stderr,
+        "  eureject serve -x INDEX-FILE [-k INT] [-e] [-O] [-u SOCKET]\n"
+        "  eureject serve -f OBS-FILE [-s SUM-FILE | -n INT] \\\n"
+        "      [-p PRECISION] [-k INT] [-e] [-O] [-u SOCKET] \\\n"
+        "      SIMS-FILE1 [ SIMS-FILE2 [...] ]\n\n");
+    fprintf(stderr,
+        "Loads a table of simulated samples once and then performs rejection\n"
+        "for each request read from standard input (or from each connection\n"
+        "to `-u`). A request is a line with the observed value of each stat,\n"
+        "in the order of the stats in the index (or in `-f`). The response\n"
+        "is what `eureject` would write for that observed dataset, followed\n"
+        "by an empty line. Malformed requests get a response of a single\n"
+        "line starting with `ERROR:`. Empty lines are ignored.\n\n");
+    fprintf(stderr, "Options:\n");
+    fprintf(stderr,
+        " -x  Path to an index built with `eureject -w`. The simulation\n"
+        "     files, stats, and the means and standard deviations for\n"
+        "     standardizing stats are taken from the index.\n");
+    fprintf(stderr,
+        " -f  Path to a file whose header names the stats to use when the\n"
+        "     table is loaded from simulation files (e.g., an observed\n"
+        "     stats file). Only the header is read.\n");
+    fprintf(stderr,
+        " -s  Tab-delimited file containing the means and standard\n"
+        "     deviations to use for standardizing statistics (see\n"
+        "     `eureject -h`).\n");
+    fprintf(stderr,
+        " -n  Number of samples to use for calculating stat means and\n"
+        "     standard deviations. Ignored if `-s` is provided.\n"
+        "     Default: 10000\n");
+    fprintf(stderr,
+        " -p  Precision of the stats held in memory when the table is\n"
+        "     loaded from simulation files: `double` (default) or `float`\n"
+        "     (see `eureject -h`). With `-x`, the precision of the index\n"
+        "     is used. With `float`, the simulation files are kept open and\n"
+        "     the candidates for each request are re-read from them, to be\n"
+        "     ranked by their double-precision distances.\n");
+    fprintf(stderr,
+        " -k  Number of samples to keep for each request. Default: 1000.\n");
+    fprintf(stderr,
+        " -e  Report Euclidean distances of retained samples in the\n"
+        "     first column of each response.\n");
+    fprintf(stderr,
+        " -O  Respond with the location of each retained sample (file path,\n"
+        "     line number and byte offset) rather than the sample itself.\n"
+        "     With a `double` table, the simulation files are not read\n"
+        "     while serving requests; a `float` table still re-reads the\n"
+        "     candidates from them (see `-p`).\n");
+    fprintf(stderr,
+        " -u  Listen for requests on a Unix-domain socket at this path\n"
+        "     rather than reading them from standard input. Connections are\n"
+        "     served one at a time until the server is interrupted, at\n"
+        "     which point the socket is removed. The path must not exist.\n");
+    fprintf(stderr, " -h  Display this help message and exit\n");
+}
+
+void write_serve_config(FILE * stream, const serve_config * c) {
+    fprintf(stream, "========\nSETTINGS\n========\n");
+    fprintf(stream, "Number of samples to retain per request: %d\n",
+            c->num_retain);
+    if (c->index_provided != 0) {
+        fprintf(stream, "Index path: %s\n", c->index_path->a);
+    }
+    else {
+        fprintf(stream, "Stats header path: %s\n", c->observed_path->a);
+        fprintf(stream, "Path(s) to file(s) with simulated draws: ");
+        write_s_array(stream, c->sim_paths, ", ");
+        if (c->summary_provided != 0) {
+            fprintf(stream, "Summary path: %s\n", c->summary_path->a);
+        }
+        else {
+            fprintf(stream, "Number of samples to use for "
+                    "standardization: %d\n", c->num_subsample);
+        }
+    }
+    fprintf(stream, "Requests read from: %s\n",
+            (c->socket_provided != 0) ? c->socket_path->a : "standard input");
+    if (c->index_provided == 0) {
+        fprintf(stream, "Precision of stats: %s\n",
+                (c->precision == STAT_PRECISION_FLOAT) ? "float" : "double");
+    }
+    fprintf(stream, "Responding with: %s\n",
+            (c->write_offsets != 0) ? "sample locations" : "samples");
+}
+
+void parse_serve_args(serve_config * conf, int argc, char ** argv) {
+    int i;
+    conf->sim_paths->length = 0;
+    while((i = getopt(argc, argv, "x:f:s:n:k:u:p:eOh")) != -1) {
+        switch(i) {
+            case 'x':
+                conf->index_provided = 1;
+                assign_c_array(conf->index_path, optarg);
+                break;
+            case 'f':
+                assign_c_array(conf->observed_path, optarg);
+                break;
+            case 's':
+                conf->summary_provided = 1;
+                assign_c_array(conf->summary_path, optarg);
+                break;
+            case 'n':
+                conf->num_subsample = atoi(optarg);
+                break;
+            case 'k':
+                conf->num_retain = atoi(optarg);
+                break;
+            case 'u':
+                conf->socket_provided = 1;
+                assign_c_array(conf->socket_path, optarg);
+                break;
+            case 'e':
+                conf->include_distance = 1;
+                break;
+            case 'O':
+                conf->write_offsets = 1;
+                break;
+            case 'p':
+                if ((conf->precision = parse_stat_precision(optarg)) < 0) {
+                    fprintf(stderr, "ERROR: `-p' must be `double' or "
+                            "`float'\n");
+                    serve_help();
+                    exit(1);
+                }
+                break;
+            case 'h':
+                serve_help();
+                exit(0);
+                break;
+            case '?':
+                if (isprint(optopt) && (strchr("xfsnkup", optopt) != NULL)) {
+                    fprintf(stderr, "ERROR: option `-%c' requires an "
+                            "argument\n", optopt);
+                }
+                else if (isprint(optopt)) {
+                    fprintf(stderr, "ERROR: unknown option `-%c'\n", optopt);
+                }
+                else {
+                    fprintf(stderr, "ERROR: unknown option character `\\x%x'\n",
+                            optopt);
+                }
+                serve_help();
+                exit(1);
+            default:
+                serve_help();
+                exit(1);
+        }
+    }
+    for (i = optind; i < argc; i++) {
+        append_s_array(conf->sim_paths, argv[i]);
+    }
+    // vetting
+    if (conf->num_retain < 1) {
+        fprintf(stderr, "ERROR: `-k` must be a positive integer\n");
+        serve_help();
+        exit(1);
+    }
+    if (conf->index_provided == 1) {
+        if ((conf->sim_paths->length > 0) || (conf->summary_provided == 1) ||
+                (conf->observed_path->a[0] != '\0') ||
+                (conf->precision != STAT_PRECISION_DOUBLE)) {
+            fprintf(stderr, "ERROR: Simulation files, `-f`, `-s` and `-p` "
+                    "cannot be given with `-x`; they are taken from the "
+                    "index\n");
+            serve_help();
+            exit(1);
+        }
+        return;
+    }
+    if (conf->observed_path->a[0] == '\0') {
+        fprintf(stderr, "ERROR: Please provide an index via `-x` or a file "
+                "naming the stats via `-f`\n");
+        serve_help();
+        exit(1);
+    }
+    if (conf->sim_paths->length < 1) {
+        fprintf(stderr, "ERROR: Please provide at least one simulation file\n");
+        serve_help();
+        exit(1);
+    }
+    if ((conf->num_subsample < 1) && (conf->summary_provided != 1)) {
+        fprintf(stderr, "ERROR: If `-n` is 0, a summary file must be provided "
+                "via `-s`\n");
+        serve_help();
+        exit(1);
+    }
+}
+
+stat_table * load_serve_table(const serve_config * conf,
+        c_array * line_buffer) {
+    int i;
+    s_array * stat_names;
+    s_array * sim_header;
+    s_array * sim_header_comp;
+    s_array * summary_header;
+    s_array * sum_paths_used;
+    d_array * means;
+    d_array * std_devs;
+    i_array * indices;
+    i_array * sample_sizes;
+    sample_moments * moments;
+    stat_table * table;
+    if (conf->index_provided != 0) {
+        return read_stat_table(get_c_array(conf->index_path));
+    }
+    stat_names = init_s_array(1);
+    sim_header = init_s_array(1);
+    means = init_d_array(1);
+    std_devs = init_d_array(1);
+    sample_sizes = init_i_array(1);
+    parse_header(get_c_array(conf->observed_path), line_buffer, stat_names);
+    parse_header(get_s_array(conf->sim_paths, 0), line_buffer, sim_header);
+    sim_header_comp = init_s_array(sim_header->length);
+    for (i = 1; i < conf->sim_paths->length; i++) {
+        parse_header(get_s_array(conf->sim_paths, i), line_buffer,
+                sim_header_comp);
+        if (s_arrays_equal(sim_header, sim_header_comp) == 0) {
+            fprintf(stderr, "ERROR: Files %s and %s have different "
+                    "headers\n", get_s_array(conf->sim_paths, 0),
+                    get_s_array(conf->sim_paths, i));
+            exit(1);
+        }
+    }
+    free_s_array(sim_header_comp);
+    indices = init_i_array(stat_names->length);
+    get_matching_indices(stat_names, sim_header, indices);
+    if (conf->summary_provided != 0) {
+        summary_header = init_s_array(stat_names->length);
+        parse_summary_file(conf->summary_path->a, line_buffer, summary_header,
+                means, std_devs, sample_sizes);
+        if (s_arrays_equal(stat_names, summary_header) == 0) {
+            fprintf(stderr, "ERROR: Files %s and %s have different headers\n",
+                    get_c_array(conf->observed_path),
+                    get_c_array(conf->summary_path));
+            exit(1);
+        }
+        free_s_array(summary_header);
+        if (parse_summary_projection(conf->summary_path->a, line_buffer,
+                stat_names->length) != NULL) {
+            fprintf(stderr, "ERROR: File %s has a projection, which is not "
+                    "supported by `eureject serve`\n",
+                    get_c_array(conf->summary_path));
+            exit(1);
+        }
+    }
+    else {
+        moments = init_sample_moments(stat_names->length,
+                EUREJECT_SUMMARY_BLOCK_SIZE);
+        sum_paths_used = init_s_array(1);
+        summarize_stat_samples(conf->sim_paths, line_buffer, indices,
+                moments, means, std_devs, conf->num_subsample,
+                sim_header->length, sum_paths_used, NULL, NULL);
+        for (i = 0; i < moments->length; i++){
+            append_i_array(sample_sizes, moments->n[i]);
+        }
+        free_sample_moments(moments);
+        free_s_array(sum_paths_used);
+    }
+    table = init_stat_table(sim_header, stat_names, means, std_devs,
+            sample_sizes);
+    set_stat_table_precision(table, conf->precision);
+    load_stat_table(table, conf->sim_paths, line_buffer, indices);
+    build_stat_table_tree(table, KD_TREE_LEAF_SIZE);
+    free_s_array(stat_names);
+    free_s_array(sim_header);
+    free_d_array(means);
+    free_d_array(std_devs);
+    free_i_array(indices);
+    free_i_array(sample_sizes);
+    return table;
+}
+
+server * init_server(stat_table * table, int num_retain,
+        int include_distance, int write_offsets) {
+    assert(num_retain > 0);
+    server * s;
+    s = (typeof(*s) *) malloc(sizeof(*s));
+    s->table = table;
+    s->stat_indices = init_i_array(table->num_stats);
+    get_matching_indices(table->stat_names, table->header, s->stat_indices);
+    s->observed_stats = init_d_array(table->num_stats);
+    s->request_words = init_s_array(table->num_stats);
+    s->line_buffer = init_c_array(pow(2, 20));
+    s->request_buffer = init_c_array(pow(2, 20));
+    s->num_retain = num_retain;
+    s->include_distance = include_distance;
+    s->write_offsets = write_offsets;
+    s->num_requests = 0;
+    s->num_bad_requests = 0;
+    return s;
+}
+
+void free_server(server * s) {
+    free_i_array(s->stat_indices);
+    free_d_array(s->observed_stats);
+    free_s_array(s->request_words);
+    free_c_array(s->line_buffer);
+    free_c_array(s->request_buffer);
+    free(s);
+    s = NULL;
+}
+
+/**
+ * Parse the words of a request into `s->observed_stats`.
+ *
+ * @return
+ *   0 on success, or the (1-based) column of the first word that is not
+ *   a number.
+ */
+static int parse_request_stats(server * s) {
+    int i;
+    char * word;
+    char * end_ptr;
+    s->observed_stats->length = 0;
+    for (i = 0; i < s->request_words->length; i++) {
+        word = get_s_array(s->request_words, i);
+        append_d_array(s->observed_stats, strtod(word, &end_ptr));
+        if ((end_ptr == word) || (*end_ptr != '\0')) {
+            return (i + 1);
+        }
+    }
+    return 0;
+}
+
+static void write_sample_locations(FILE * stream, const server * s,
+        const neighbor_heap * nearest) {
+    int i;
+    const row_ref * ref;
+    if (s->include_distance != 0) {
+        fprintf(stream, "distance\t");
+    }
+    fprintf(stream, "file\tline\toffset\n");
+    for (i = 0; i < nearest->length; i++) {
+        ref = &s->table->refs[nearest->a[i].index];
+        if (s->include_distance != 0) {
+            fprintf(stream, "%lf\t", nearest->a[i].distance);
+        }
+        fprintf(stream, "%s\t%d\t%ld\n",
+                get_s_array(s->table->paths, ref->file_index),
+                ref->line_num, ref->offset);
+    }
+}
+
+int answer_request(server * s, FILE * stream, char * request) {
+    int ret;
+    neighbor_heap * nearest;
+    sample_array * samples;
+    ret = split_str(request, s->request_words, s->table->num_stats);
+    if (ret == -1) {
+        return -1;
+    }
+    s->num_requests++;
+    if (ret != 0) {
+        s->num_bad_requests++;
+        fprintf(stream, "ERROR: request %d has %d stats (expected %d)\n\n",
+                s->num_requests, ret, s->table->num_stats);
+        fflush(stream);
+        return 1;
+    }
+    if ((ret = parse_request_stats(s)) != 0) {
+        s->num_bad_requests++;
+        fprintf(stream, "ERROR: request %d column %d is not a valid "
+                "number\n\n", s->num_requests, ret);
+        fflush(stream);
+        return 1;
+    }
+    standardize_vector(s->observed_stats, s->table->means,
+            s->table->std_devs);
+    if (s->write_offsets != 0) {
+        nearest = init_neighbor_heap(s->num_retain, s->table->ranks);
+        query_stat_table(s->table, s->observed_stats->a, nearest);
+        sort_neighbor_heap(nearest);
+        write_sample_locations(stream, s, nearest);
+        free_neighbor_heap(nearest);
+    }
+    else {
+        samples = reject_from_table(s->table, s->line_buffer,
+                s->stat_indices, s->observed_stats, s->num_retain);
+        write_sample_array(stream, samples, s->include_distance);
+        free_sample_array(samples);
+    }
+    fprintf(stream, "\n");
+    fflush(stream);
+    return 0;
+}
+
+int serve_stream(server * s, FILE * in, FILE * out) {
+    int n;
+    n = 0;
+    while (fgets(s->request_buffer->a, ((s->request_buffer->capacity) - 1),
+                in) != NULL) {
+        if (answer_request(s, out, s->request_buffer->a) >= 0) {
+            n++;
+        }
+    }
+    return n;
+}
+
+static void interrupt_serve(int sig) {
+    (void) sig;
+    serve_interrupted = 1;
+}
+
+void serve_socket(server * s, const char * path) {
+    int listen_fd, conn_fd;
+    struct sockaddr_un address;
+    struct sigaction action;
+    FILE * in;
+    FILE * out;
+    if (strlen(path) >= sizeof(address.sun_path)) {
+        fprintf(stderr, "ERROR: socket path %s is too long\n", path);
+        exit(1);
+    }
+    if ((listen_fd = socket(AF_UNIX, SOCK_STREAM, 0)) < 0) {
+        perror("socket");
+        exit(1);
+    }
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, path);
+    if (bind(listen_fd, (struct sockaddr *) &address, sizeof(address)) < 0) {
+        perror(path);
+        exit(1);
+    }
+    if (listen(listen_fd, 16) < 0) {
+        perror(path);
+        unlink(path);
+        exit(1);
+    }
+    // no SA_RESTART, so that an interrupt breaks out of accept
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = interrupt_serve;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+    // a client hanging up mid-response must not kill the server
+    signal(SIGPIPE, SIG_IGN);
+    while (serve_interrupted == 0) {
+        if ((conn_fd = accept(listen_fd, NULL, NULL)) < 0) {
+            if (errno == EINTR) continue;
+            perror("accept");
+            break;
+        }
+        in = fdopen(conn_fd, "r");
+        out = fdopen(dup(conn_fd), "w");
+        if ((in == NULL) || (out == NULL)) {
+            perror("fdopen");
+            exit(1);
+        }
+        serve_stream(s, in, out);
+        fclose(in);
+        fclose(out);
+    }
+    close(listen_fd);
+    unlink(path);
+}
+
+int eureject_serve_main(int argc, char ** argv) {
+    c_array * line_buffer;
+    stat_table * table;
+    server * s;
+    serve_config * conf;
+    conf = init_serve_config();
+    parse_serve_args(conf, argc, argv);
+    line_buffer = init_c_array(pow(2, 20));
+
+    eureject_preamble();
+    write_serve_config(stderr, conf);
+
+    fprintf(stderr, "\nLoading simulation table... ");
+    table = load_serve_table(conf, line_buffer);
+    fprintf(stderr, "Done! (%d samples)\n", table->num_rows);
+    fprintf(stderr,
+                  "\n=====================================================\n");
+    fprintf(stderr, "MEANS AND STD DEVIATIONS USED FOR STANDARDIZING STATS\n");
+    fprintf(stderr, "=====================================================\n");
+    write_s_array(stderr, table->stat_names, "\t");
+    write_d_array(stderr, table->means, "\t");
+    write_d_array(stderr, table->std_devs, "\t");
+    write_i_array(stderr, table->sample_sizes, "\t");
+    fprintf(stderr, "\n");
+
+    s = init_server(table, conf->num_retain, conf->include_distance,
+            conf->write_offsets);
+    if (conf->socket_provided != 0) {
+        fprintf(stderr, "Serving requests on %s...\n",
+                get_c_array(conf->socket_path));
+        serve_socket(s, get_c_array(conf->socket_path));
+    }
+    else {
+        fprintf(stderr, "Serving requests from standard input...\n");
+        serve_stream(s, stdin, stdout);
+    }
+    fprintf(stderr, "\nRequests answered: %d (%d malformed)\n",
+            s->num_requests, s->num_bad_requests);
+
+    free_server(s);
+    free_stat_table(table);
+    free_c_array(line_buffer);
+    free_serve_config(conf);
+    return 0;
+}
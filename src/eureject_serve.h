@@ -0,0 +1,114 @@
+/**
+ * @file        eureject_serve.h
+ * @authors     Jamie Oaks
+ * @package     ABACUS (Approximate BAyesian C UtilitieS)
+ * @brief       A resident mode of eureject that loads a simulation table once
+ *              and answers rejection requests for many observed datasets.
+ * @copyright   Copyright (C) 2013 Jamie Oaks.
+ *   This file is part of ABACUS.  ABACUS is free software; you can
+ *   redistribute it and/or modify it under the terms of the GNU General Public
+ *   License as published by the Free Software Foundation; either version 2 of
+ *   the License, or (at your option) any later version.
+ * 
+ *   ABACUS is distributed in the hope that it will be useful, but WITHOUT ANY
+ *   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *   FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *   details.
+ * 
+ *   You should have received a copy of the GNU General Public License along
+ *   with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EUREJECT_SERVE_H
+#define EUREJECT_SERVE_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h> // for getopt
+#include <ctype.h>
+#include <errno.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "eureject.h"
+
+typedef struct serve_config_ {
+    c_array * observed_path;
+    c_array * summary_path;
+    c_array * index_path;
+    c_array * socket_path;
+    s_array * sim_paths;
+    int num_retain;
+    int num_subsample;
+    int summary_provided;
+    int index_provided;
+    int socket_provided;
+    int include_distance;
+    int write_offsets;
+    int precision;
+} serve_config;
+
+/**
+ * The state shared by every request: the simulation table, the columns of
+ * the simulation files that hold the stats, and buffers reused across
+ * requests.
+ */
+typedef struct server_ {
+    stat_table * table;
+    i_array * stat_indices;
+    d_array * observed_stats;
+    s_array * request_words;
+    c_array * line_buffer;
+    c_array * request_buffer;
+    int num_retain;
+    int include_distance;
+    int write_offsets;
+    int num_requests;
+    int num_bad_requests;
+} server;
+
+serve_config * init_serve_config();
+void free_serve_config(serve_config * c);
+void serve_help();
+void write_serve_config(FILE * stream, const serve_config * c);
+void parse_serve_args(serve_config * conf, int argc, char ** argv);
+
+/**
+ * Load the simulation table described by `conf`, either from an index built
+ * with `eureject -w` or from the simulation files themselves (in which case
+ * a k-d tree is built over the table).
+ */
+stat_table * load_serve_table(const serve_config * conf,
+        c_array * line_buffer);
+server * init_server(stat_table * table, int num_retain,
+        int include_distance, int write_offsets);
+void free_server(server * s);
+
+/**
+ * Answer one request: a line with the (unstandardized) observed value of
+ * each stat of the table, in the order of the table's stat names.
+ *
+ * The retained samples are written to `stream` as `eureject` would write
+ * them, or as their locations in the simulation files if the server writes
+ * offsets. The response is terminated by an empty line. A malformed request
+ * gets a one-line error response instead.
+ *
+ * @return
+ *   0 if the request was answered, 1 if it was malformed, and -1 if it was
+ *   empty (in which case nothing is written).
+ */
+int answer_request(server * s, FILE * stream, char * request);
+
+/**
+ * Answer every request read from `in` until end of file.
+ *
+ * @return
+ *   The number of requests answered.
+ */
+int serve_stream(server * s, FILE * in, FILE * out);
+void serve_socket(server * s, const char * path);
+int eureject_serve_main(int argc, char ** argv);
+
+#endif /* EUREJECT_SERVE_H */
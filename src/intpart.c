@@ -24,6 +24,9 @@ config * init_config() {
     config * c;
     c = (typeof(*c) *) malloc(sizeof(*c));
     c->summary = 1;
+    c->total = 0;
+    c->num_threads = 1;
+    c->ordered = 1;
     return c;
 }
 
@@ -45,23 +48,38 @@ void intpart_preamble() {
 void help() {
     intpart_preamble();
     printf("Usage:\n");
-    printf("  intpart [ -a ] N\n\n");
+    printf("  intpart [ -a [ -p THREADS -u ] | -t ] N\n\n");
     printf("Options:\n");
     printf(" -a  Report all partitions. The default is to show only a\n");
     printf("     summary of the number and relative frequency of partitions\n");
-    printf("     per number of categories. NOTE: only use this for\n");
-    printf("     relatively small numbers of elements (e.g., < 50).\n");
+    printf("     per number of categories. NOTE: the number of partitions\n");
+    printf("     grows quickly; there are over 10^8 for 100 elements.\n");
+    printf(" -p  Number of threads with which to enumerate the partitions\n");
+    printf("     reported by -a. Default: 1.\n");
+    printf(" -u  With -p, report the partitions as each thread finds\n");
+    printf("     them, rather than in order, which is faster.\n");
+    printf(" -t  Report only the total number of partitions, which is exact\n");
+    printf("     for up to %d elements.\n", PARTITION_HRR_MAX_N);
     printf(" -h  Display this help message and exit\n");
 }
 
 void parse_args(config * conf, int argc, char ** argv) {
     int i;
     /* opterr = 0; */
-    while((i = getopt(argc, argv, "ah")) != -1) {
+    while((i = getopt(argc, argv, "ap:uth")) != -1) {
         switch(i) {
             case 'a':
                 conf->summary = 0;
                 break;
+            case 'p':
+                conf->num_threads = atoi(optarg);
+                break;
+            case 'u':
+                conf->ordered = 0;
+                break;
+            case 't':
+                conf->total = 1;
+                break;
             case 'h':
                 help();
                 exit(0);
@@ -96,10 +114,21 @@ void parse_args(config * conf, int argc, char ** argv) {
         help();
         exit(1);
     }
+    if (conf->num_threads < 1) {
+        fprintf(stderr, "ERROR: the number of threads must be positive\n");
+        help();
+        exit(1);
+    }
+    if ((conf->total != 0) && (conf->num_elements > PARTITION_HRR_MAX_N)) {
+        fprintf(stderr, "ERROR: `-t` can count the partitions of at most %d "
+                "elements\n", PARTITION_HRR_MAX_N);
+        help();
+        exit(1);
+    }
 }
 
 int intpart_main(int argc, char ** argv) {
-    int i, ip;
+    int i;
     double total_prob;
     config * conf;
 
@@ -110,35 +139,48 @@ int intpart_main(int argc, char ** argv) {
     conf = init_config();
     parse_args(conf, argc, argv);
 
+    if (conf->total != 0) {
+        big_int * ip;
+        ip = init_big_int(1);
+        number_of_int_partitions_big(conf->num_elements, ip);
+        write_big_int(stdout, ip);
+        fprintf(stdout, "\n");
+        free_big_int(ip);
+        free_config(conf);
+        return 0;
+    }
+
     if (conf->summary!= 0) {
         i_array * header;
-        i_array * counts;
+        big_int ** counts;
         d_array * probs;
         header = init_i_array(conf->num_elements);
-        counts = init_i_array(conf->num_elements);
+        counts = (typeof(*counts) *) malloc(sizeof(*counts) *
+                conf->num_elements);
         probs = init_d_array(conf->num_elements);
         for (i = 1; i <= conf->num_elements; i++) {
             append_i_array(header, i);
+            counts[i-1] = init_big_int(1);
         }
         write_i_array(stdout, header, "\t");
-        ip = number_of_int_partitions_by_k(conf->num_elements, counts);
+        number_of_int_partitions_by_k_big(conf->num_elements, counts);
         total_prob = frequency_of_int_partitions_by_k(conf->num_elements, probs);
         assert(almost_equal(total_prob, 1.0, 0.000001));
-        write_i_array(stdout, counts, "\t");
+        write_big_ints(stdout, counts, conf->num_elements, "\t");
         write_d_array(stdout, probs, "\t");
         free_i_array(header);
-        free_i_array(counts);
+        for (i = 0; i < conf->num_elements; i++) {
+            free_big_int(counts[i]);
+        }
+        free(counts);
         free_d_array(probs);
         free_config(conf);
         return 0;
     }
 
-    i_array_2d * partitions;
-    partitions = generate_int_partitions(conf->num_elements);
-    for (i = 0; i < partitions->length; i++) {
-        write_i_array(stdout, get_i_array_2d(partitions, i), "\t");
-    }
-    free_i_array_2d(partitions);
+    // stream the partitions, rather than holding all of them in memory
+    write_int_partitions_parallel(stdout, conf->num_elements,
+            conf->num_threads, "\t", conf->ordered);
     free_config(conf);
     return(0);
 }
@@ -29,6 +29,7 @@
 
 #include "array_utils.h"
 #include "partition_combinatorics.h"
+#include "partition_combinatorics_parallel.h"
 #include "abacus.h"
 
 #define INTPART_VERSION "0.1.0"
@@ -36,6 +37,9 @@
 typedef struct config_ {
     int num_elements;
     int summary;
+    int total;
+    int num_threads;
+    int ordered;
 } config;
 
 config * init_config();
@@ -0,0 +1,381 @@
+/**
+ * @file        kdtree.c
+ * @authors     Jamie Oaks
+ * @package     ABACUS (Approximate BAyesian C UtilitieS)
+ * @brief       A k-d tree for exact nearest-neighbour queries.
+ * @copyright   Copyright (C) 2013 Jamie Oaks.
+ *   This file is part of ABACUS.  ABACUS is free software; you can
+ *   redistribute it and/or modify it under the terms of the GNU General Public
+ *   License as published by the Free Software Foundation; either version 2 of
+ *   the License, or (at your option) any later version.
+ * 
+ *   ABACUS is distributed in the hope that it will be useful, but WITHOUT ANY
+ *   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *   FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *   details.
+ * 
+ *   You should have received a copy of the GNU General Public License along
+ *   with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "kdtree.h"
+
+neighbor_heap * init_neighbor_heap(int capacity, const int * ranks) {
+    assert(capacity > 0);
+    neighbor_heap * h;
+    h = (typeof(*h) *) malloc(sizeof(*h));
+    h->capacity = capacity;
+    if ((h->a = (typeof(*h->a) *) calloc(h->capacity,
+            sizeof(*h->a))) == NULL) {
+        perror("out of memory");
+        exit(1);
+    }
+    h->length = 0;
+    h->ranks = ranks;
+    h->num_admitted = 0;
+    return h;
+}
+
+void free_neighbor_heap(neighbor_heap * h) {
+    free(h->a);
+    free(h);
+    h = NULL;
+}
+
+int neighbor_precedes(const neighbor_heap * h, const neighbor * x,
+        const neighbor * y) {
+    if (x->distance != y->distance) {
+        return (x->distance < y->distance);
+    }
+    if (h->ranks != NULL) {
+        return (h->ranks[x->index] < h->ranks[y->index]);
+    }
+    return (x->index < y->index);
+}
+
+static void swap_neighbors(neighbor * x, neighbor * y) {
+    neighbor tmp;
+    tmp = *x;
+    *x = *y;
+    *y = tmp;
+}
+
+static void sift_down_neighbor_heap(neighbor_heap * h, int i, int length) {
+    int child;
+    while ((child = (2 * i) + 1) < length) {
+        if (((child + 1) < length) &&
+                neighbor_precedes(h, &h->a[child], &h->a[child + 1])) {
+            child++;
+        }
+        if (!neighbor_precedes(h, &h->a[i], &h->a[child])) {
+            return;
+        }
+        swap_neighbors(&h->a[i], &h->a[child]);
+        i = child;
+    }
+}
+
+/**
+ * Offer a point to the heap; returns 1 if it was admitted.
+ */
+int push_neighbor_heap(neighbor_heap * h, double distance, int index) {
+    int i, parent;
+    neighbor x;
+    x.distance = distance;
+    x.index = index;
+    if (h->length >= h->capacity) {
+        if (!neighbor_precedes(h, &x, &h->a[0])) {
+            return 0;
+        }
+        h->a[0] = x;
+        sift_down_neighbor_heap(h, 0, h->length);
+        h->num_admitted++;
+        return 1;
+    }
+    i = h->length;
+    h->a[i] = x;
+    h->length++;
+    h->num_admitted++;
+    while (i > 0) {
+        parent = (i - 1) / 2;
+        if (!neighbor_precedes(h, &h->a[parent], &h->a[i])) {
+            break;
+        }
+        swap_neighbors(&h->a[parent], &h->a[i]);
+        i = parent;
+    }
+    return 1;
+}
+
+double get_worst_neighbor_distance(const neighbor_heap * h) {
+    if (h->length < h->capacity) {
+        return HUGE_VAL;
+    }
+    return h->a[0].distance;
+}
+
+/**
+ * Heap-sort the neighbours into ascending order (nearest first).
+ */
+void sort_neighbor_heap(neighbor_heap * h) {
+    int end;
+    for (end = h->length - 1; end > 0; end--) {
+        swap_neighbors(&h->a[0], &h->a[end]);
+        sift_down_neighbor_heap(h, 0, end);
+    }
+}
+
+/**
+ * Return coordinate `d` of point `i`, whichever precision the points are
+ * stored in.
+ */
+static double get_kd_coord(const kd_tree * t, int i, int d) {
+    if (t->fpoints != NULL) {
+        return (double) t->fpoints[((size_t) i * t->dim) + d];
+    }
+    return t->points[((size_t) i * t->dim) + d];
+}
+
+static size_t get_kd_row_size(const kd_tree * t) {
+    if (t->fpoints != NULL) {
+        return (t->dim * sizeof(*t->fpoints));
+    }
+    return (t->dim * sizeof(*t->points));
+}
+
+static void swap_rows(char * rows, size_t row_size, int * ranks, int i,
+        int j, char * tmp) {
+    int r;
+    if (i == j) return;
+    memcpy(tmp, rows + (i * row_size), row_size);
+    memcpy(rows + (i * row_size), rows + (j * row_size), row_size);
+    memcpy(rows + (j * row_size), tmp, row_size);
+    r = ranks[i];
+    ranks[i] = ranks[j];
+    ranks[j] = r;
+}
+
+static int get_widest_dim(const kd_tree * t, int lo, int hi) {
+    int i, j, widest;
+    double min, max, x, spread, widest_spread;
+    widest = 0;
+    widest_spread = -1.0;
+    for (j = 0; j < t->dim; j++) {
+        min = max = get_kd_coord(t, lo, j);
+        for (i = lo + 1; i < hi; i++) {
+            x = get_kd_coord(t, i, j);
+            if (x < min) min = x;
+            if (x > max) max = x;
+        }
+        spread = max - min;
+        if (spread > widest_spread) {
+            widest_spread = spread;
+            widest = j;
+        }
+    }
+    return widest;
+}
+
+/**
+ * Quickselect the rows in `[lo, hi)` so that row `k` holds the median along
+ * dimension `d`, with no greater values before it and no smaller values
+ * after it.
+ */
+static void select_rows(const kd_tree * t, char * rows, int * ranks, int d,
+        int lo, int hi, int k, char * tmp) {
+    int i, j;
+    size_t row_size;
+    double pivot;
+    row_size = get_kd_row_size(t);
+    hi--;
+    while (hi > lo) {
+        pivot = get_kd_coord(t, (lo + ((hi - lo) / 2)), d);
+        i = lo;
+        j = hi;
+        while (i <= j) {
+            while (get_kd_coord(t, i, d) < pivot) i++;
+            while (get_kd_coord(t, j, d) > pivot) j--;
+            if (i <= j) {
+                swap_rows(rows, row_size, ranks, i, j, tmp);
+                i++;
+                j--;
+            }
+        }
+        if (k <= j) {
+            hi = j;
+        }
+        else if (k >= i) {
+            lo = i;
+        }
+        else {
+            return;
+        }
+    }
+}
+
+static void build_kd_subtree(kd_tree * t, char * rows, int * ranks,
+        int lo, int hi, char * tmp) {
+    int i, d, mid;
+    if ((hi - lo) <= t->leaf_size) {
+        for (i = lo; i < hi; i++) {
+            t->split_dims[i] = -1;
+        }
+        return;
+    }
+    d = get_widest_dim(t, lo, hi);
+    mid = lo + ((hi - lo) / 2);
+    select_rows(t, rows, ranks, d, lo, hi, mid, tmp);
+    t->split_dims[mid] = d;
+    build_kd_subtree(t, rows, ranks, lo, mid, tmp);
+    build_kd_subtree(t, rows, ranks, (mid + 1), hi, tmp);
+}
+
+static void build_kd_rows(kd_tree * t, char * rows, int * ranks) {
+    char * tmp;
+    if ((tmp = (typeof(*tmp) *) calloc(get_kd_row_size(t),
+            sizeof(*tmp))) == NULL) {
+        perror("out of memory");
+        exit(1);
+    }
+    build_kd_subtree(t, rows, ranks, 0, t->num_points, tmp);
+    free(tmp);
+}
+
+kd_tree * init_kd_tree(const double * points, const int * ranks,
+        int num_points, int dim, int leaf_size) {
+    assert((num_points > 0) && (dim > 0) && (leaf_size > 0));
+    kd_tree * t;
+    t = (typeof(*t) *) malloc(sizeof(*t));
+    t->points = points;
+    t->fpoints = NULL;
+    t->ranks = ranks;
+    t->num_points = num_points;
+    t->dim = dim;
+    t->leaf_size = leaf_size;
+    if ((t->split_dims = (typeof(*t->split_dims) *) calloc(t->num_points,
+            sizeof(*t->split_dims))) == NULL) {
+        perror("out of memory");
+        exit(1);
+    }
+    return t;
+}
+
+kd_tree * init_kd_tree_f(const float * points, const int * ranks,
+        int num_points, int dim, int leaf_size) {
+    kd_tree * t;
+    t = init_kd_tree(NULL, ranks, num_points, dim, leaf_size);
+    t->fpoints = points;
+    return t;
+}
+
+kd_tree * build_kd_tree(double * points, int * ranks, int num_points,
+        int dim, int leaf_size) {
+    kd_tree * t;
+    t = init_kd_tree(points, ranks, num_points, dim, leaf_size);
+    build_kd_rows(t, (char *) points, ranks);
+    return t;
+}
+
+kd_tree * build_kd_tree_f(float * points, int * ranks, int num_points,
+        int dim, int leaf_size) {
+    kd_tree * t;
+    t = init_kd_tree_f(points, ranks, num_points, dim, leaf_size);
+    build_kd_rows(t, (char *) points, ranks);
+    return t;
+}
+
+void free_kd_tree(kd_tree * t) {
+    free(t->split_dims);
+    free(t);
+    t = NULL;
+}
+
+double get_kd_point_distance(const kd_tree * t, const double * query,
+        int i) {
+    if (t->fpoints != NULL) {
+        return sqrt(sum_of_squared_diffs_f(query,
+                t->fpoints + ((size_t) i * t->dim), t->dim));
+    }
+    return sqrt(sum_of_squared_diffs(query,
+            t->points + ((size_t) i * t->dim), t->dim));
+}
+
+static int search_kd_subtree(const kd_tree * t, const double * query,
+        int lo, int hi, neighbor_heap * h) {
+    int i, d, mid, visited;
+    double diff;
+    visited = 0;
+    if ((hi - lo) <= t->leaf_size) {
+        for (i = lo; i < hi; i++) {
+            push_neighbor_heap(h, get_kd_point_distance(t, query, i), i);
+            visited++;
+        }
+        return visited;
+    }
+    mid = lo + ((hi - lo) / 2);
+    d = t->split_dims[mid];
+    diff = query[d] - get_kd_coord(t, mid, d);
+    if (diff < 0.0) {
+        visited += search_kd_subtree(t, query, lo, mid, h);
+    }
+    else {
+        visited += search_kd_subtree(t, query, (mid + 1), hi, h);
+    }
+    push_neighbor_heap(h, get_kd_point_distance(t, query, mid), mid);
+    visited++;
+    // Every point on the far side is at least as far away as the splitting
+    // plane; it can only displace a neighbour if it is no farther than the
+    // current worst one (equal distances may still win on rank).
+    if (sqrt(diff * diff) <= get_worst_neighbor_distance(h)) {
+        if (diff < 0.0) {
+            visited += search_kd_subtree(t, query, (mid + 1), hi, h);
+        }
+        else {
+            visited += search_kd_subtree(t, query, lo, mid, h);
+        }
+    }
+    return visited;
+}
+
+static int search_kd_subtree_range(const kd_tree * t, const double * query,
+        double radius, int lo, int hi, i_array * indices) {
+    int i, d, mid, visited;
+    double diff;
+    visited = 0;
+    if ((hi - lo) <= t->leaf_size) {
+        for (i = lo; i < hi; i++) {
+            if (get_kd_point_distance(t, query, i) <= radius) {
+                i_array_append(indices, i);
+            }
+            visited++;
+        }
+        return visited;
+    }
+    mid = lo + ((hi - lo) / 2);
+    d = t->split_dims[mid];
+    diff = query[d] - get_kd_coord(t, mid, d);
+    if (get_kd_point_distance(t, query, mid) <= radius) {
+        i_array_append(indices, mid);
+    }
+    visited++;
+    if ((diff < 0.0) || (sqrt(diff * diff) <= radius)) {
+        visited += search_kd_subtree_range(t, query, radius, lo, mid,
+                indices);
+    }
+    if ((diff >= 0.0) || (sqrt(diff * diff) <= radius)) {
+        visited += search_kd_subtree_range(t, query, radius, (mid + 1), hi,
+                indices);
+    }
+    return visited;
+}
+
+int kd_tree_knn(const kd_tree * t, const double * query, neighbor_heap * h) {
+    return search_kd_subtree(t, query, 0, t->num_points, h);
+}
+
+int kd_tree_range(const kd_tree * t, const double * query, double radius,
+        i_array * indices) {
+    indices->length = 0;
+    return search_kd_subtree_range(t, query, radius, 0, t->num_points,
+            indices);
+}
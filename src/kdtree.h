@@ -0,0 +1,126 @@
+/**
+ * @file        kdtree.h
+ * @authors     Jamie Oaks
+ * @package     ABACUS (Approximate BAyesian C UtilitieS)
+ * @brief       A k-d tree for exact nearest-neighbour queries.
+ * @copyright   Copyright (C) 2013 Jamie Oaks.
+ *   This file is part of ABACUS.  ABACUS is free software; you can
+ *   redistribute it and/or modify it under the terms of the GNU General Public
+ *   License as published by the Free Software Foundation; either version 2 of
+ *   the License, or (at your option) any later version.
+ * 
+ *   ABACUS is distributed in the hope that it will be useful, but WITHOUT ANY
+ *   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *   FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *   details.
+ * 
+ *   You should have received a copy of the GNU General Public License along
+ *   with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KDTREE_H
+#define KDTREE_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <assert.h>
+
+#include "array_utils.h"
+#include "math_utils.h"
+
+#define KD_TREE_LEAF_SIZE 16
+
+typedef struct neighbor_ {
+    double distance;
+    int index;
+} neighbor;
+
+/**
+ * A bounded max-heap of the nearest neighbours found so far.
+ *
+ * Neighbours are ordered by distance, and ties are broken by `ranks` (the
+ * position of each point in the original input), so that the retained set is
+ * the same as the one kept by a sequential scan over the input.  If `ranks`
+ * is `NULL`, ties are broken by point index. `num_admitted` counts the
+ * points admitted, including those later displaced by nearer ones.
+ */
+typedef struct neighbor_heap_ {
+    neighbor * a;
+    int length;
+    int capacity;
+    const int * ranks;
+    int num_admitted;
+} neighbor_heap;
+
+/**
+ * An implicit k-d tree over the rows of a row-major matrix of points, stored
+ * in double (`points`) or single (`fpoints`) precision.
+ *
+ * The tree does not store nodes. The points are reordered so that the node
+ * covering rows `[lo, hi)` has its splitting point at row `(lo + hi) / 2`,
+ * with the left subtree below it and the right subtree above it;
+ * `split_dims` holds the splitting dimension of each such row (-1 for rows
+ * in leaf buckets of at most `leaf_size` points). The points and ranks are
+ * borrowed; only `split_dims` is owned by the tree.
+ */
+typedef struct kd_tree_ {
+    const double * points;
+    const float * fpoints;
+    const int * ranks;
+    int * split_dims;
+    int num_points;
+    int dim;
+    int leaf_size;
+} kd_tree;
+
+neighbor_heap * init_neighbor_heap(int capacity, const int * ranks);
+void free_neighbor_heap(neighbor_heap * h);
+int neighbor_precedes(const neighbor_heap * h, const neighbor * x,
+        const neighbor * y);
+int push_neighbor_heap(neighbor_heap * h, double distance, int index);
+double get_worst_neighbor_distance(const neighbor_heap * h);
+void sort_neighbor_heap(neighbor_heap * h);
+
+/**
+ * Build a k-d tree over `num_points` rows of `points`.
+ *
+ * The rows of `points` and the corresponding elements of `ranks` are
+ * reordered in place into tree order. Each node splits on the dimension with
+ * the largest spread at the median of that dimension.
+ */
+kd_tree * build_kd_tree(double * points, int * ranks, int num_points,
+        int dim, int leaf_size);
+kd_tree * build_kd_tree_f(float * points, int * ranks, int num_points,
+        int dim, int leaf_size);
+kd_tree * init_kd_tree(const double * points, const int * ranks,
+        int num_points, int dim, int leaf_size);
+kd_tree * init_kd_tree_f(const float * points, const int * ranks,
+        int num_points, int dim, int leaf_size);
+void free_kd_tree(kd_tree * t);
+double get_kd_point_distance(const kd_tree * t, const double * query, int i);
+
+/**
+ * Find the nearest neighbours of `query`.
+ *
+ * The heap is filled with (up to) its capacity of nearest points. The result
+ * is exact: it is identical to pushing every point through the heap, but
+ * subtrees that cannot contain a point closer than the current worst
+ * neighbour are skipped.
+ *
+ * @return
+ *   The number of points whose distance to `query` was computed.
+ */
+int kd_tree_knn(const kd_tree * t, const double * query, neighbor_heap * h);
+
+/**
+ * Find every point within `radius` of `query`; their indices are stored in
+ * `indices` (in tree order).
+ *
+ * @return
+ *   The number of points whose distance to `query` was computed.
+ */
+int kd_tree_range(const kd_tree * t, const double * query, double radius,
+        i_array * indices);
+
+#endif /* KDTREE_H */
@@ -22,11 +22,139 @@
 
 double get_euclidean_distance(const d_array * v1, const d_array * v2) {
     assert((*v1).length == (*v2).length);
-    double sum_of_squared_diffs = 0.0;
+    return sqrt(sum_of_squared_diffs((*v1).a, (*v2).a, (*v1).length));
+}
+
+/**
+ * The distance kernel shared by every rejection path (streaming scan, table
+ * scan and k-d tree), so that all of them produce bit-identical distances.
+ */
+double sum_of_squared_diffs(const double * x, const double * y, int n) {
+    double sum = 0.0;
+    double d;
     int i;
-    for (i = 0; i < (*v1).length; i++) {
-        sum_of_squared_diffs += pow(((*v1).a[i] - (*v2).a[i]), 2);
+    for (i = 0; i < n; i++) {
+        d = x[i] - y[i];
+        sum += d * d;
+    }
+    return sum;
+}
+
+
+/**
+ * As `sum_of_squared_diffs`, but for stats stored in single precision; the
+ * differences are taken and accumulated in double precision.
+ */
+double sum_of_squared_diffs_f(const double * x, const float * y, int n) {
+    double sum = 0.0;
+    double d;
+    int i;
+    for (i = 0; i < n; i++) {
+        d = x[i] - (double) y[i];
+        sum += d * d;
+    }
+    return sum;
+}
+
+// the most sweeps of Jacobi rotations; they converge quadratically, and
+// rarely take more than 10
+#define MAX_JACOBI_SWEEPS 100
+
+/**
+ * Rotate rows and columns `p` and `q` of the `n` by `n` matrix `a`, and
+ * columns `p` and `q` of `v`, by cosine `c` and sine `s`.
+ */
+static void jacobi_rotate(double * a, double * v, int n, int p, int q,
+        double c, double s) {
+    int k;
+    double x, y;
+    for (k = 0; k < n; k++) {
+        x = a[(k * n) + p];
+        y = a[(k * n) + q];
+        a[(k * n) + p] = (c * x) - (s * y);
+        a[(k * n) + q] = (s * x) + (c * y);
+    }
+    for (k = 0; k < n; k++) {
+        x = a[(p * n) + k];
+        y = a[(q * n) + k];
+        a[(p * n) + k] = (c * x) - (s * y);
+        a[(q * n) + k] = (s * x) + (c * y);
+    }
+    for (k = 0; k < n; k++) {
+        x = v[(k * n) + p];
+        y = v[(k * n) + q];
+        v[(k * n) + p] = (c * x) - (s * y);
+        v[(k * n) + q] = (s * x) + (c * y);
     }
-    return sqrt(sum_of_squared_diffs);
 }
 
+void get_symmetric_eigen(double * a, int n, double * values,
+        double * vectors) {
+    assert(n > 0);
+    int i, j, k, p, q, sweep, best;
+    double off, diag, theta, t, c, x;
+    double * v;
+    if ((v = (typeof(*v) *) calloc(((size_t) n * n), sizeof(*v))) == NULL) {
+        perror("out of memory");
+        exit(1);
+    }
+    for (i = 0; i < n; i++) {
+        v[(i * n) + i] = 1.0;
+    }
+    for (sweep = 0; sweep < MAX_JACOBI_SWEEPS; sweep++) {
+        off = 0.0;
+        diag = 0.0;
+        for (p = 0; p < n; p++) {
+            diag += a[(p * n) + p] * a[(p * n) + p];
+            for (q = (p + 1); q < n; q++) {
+                off += a[(p * n) + q] * a[(p * n) + q];
+            }
+        }
+        if ((off == 0.0) || (off <= (1e-28 * diag))) {
+            break;
+        }
+        for (p = 0; p < n; p++) {
+            for (q = (p + 1); q < n; q++) {
+                if (a[(p * n) + q] == 0.0) {
+                    continue;
+                }
+                // the rotation that zeroes element (p, q)
+                theta = (a[(q * n) + q] - a[(p * n) + p]) /
+                        (2.0 * a[(p * n) + q]);
+                t = 1.0 / (fabs(theta) + sqrt((theta * theta) + 1.0));
+                if (theta < 0.0) {
+                    t = -t;
+                }
+                c = 1.0 / sqrt((t * t) + 1.0);
+                jacobi_rotate(a, v, n, p, q, c, (t * c));
+            }
+        }
+    }
+    // sort the eigenvalues, and store the eigenvectors (the columns of `v`)
+    // as rows
+    for (i = 0; i < n; i++) {
+        values[i] = a[(i * n) + i];
+    }
+    for (i = 0; i < n; i++) {
+        best = i;
+        for (j = (i + 1); j < n; j++) {
+            if (values[j] > values[best]) {
+                best = j;
+            }
+        }
+        x = values[i];
+        values[i] = values[best];
+        values[best] = x;
+        for (k = 0; k < n; k++) {
+            x = v[(k * n) + i];
+            v[(k * n) + i] = v[(k * n) + best];
+            v[(k * n) + best] = x;
+        }
+    }
+    for (i = 0; i < n; i++) {
+        for (k = 0; k < n; k++) {
+            vectors[(i * n) + k] = v[(k * n) + i];
+        }
+    }
+    free(v);
+}
@@ -28,6 +28,17 @@
 #include "array_utils.h"
 
 double get_euclidean_distance(const d_array * v1, const d_array * v2);
+double sum_of_squared_diffs(const double * x, const double * y, int n);
+double sum_of_squared_diffs_f(const double * x, const float * y, int n);
+
+/**
+ * Store in `values` the eigenvalues of the symmetric `n` by `n` matrix `a`
+ * (in row-major order), in decreasing order, and in the rows of `vectors`
+ * (also `n` by `n`) the corresponding unit eigenvectors. The eigenvalues
+ * are found by cyclic Jacobi rotations, which overwrite `a`.
+ */
+void get_symmetric_eigen(double * a, int n, double * values,
+        double * vectors);
 
 #endif /* MATH_UTILS_H */
 
@@ -120,6 +120,70 @@ void parse_summary_file(const char * path,
     }
 }
 
+projection * parse_summary_projection(const char * path,
+        c_array * line_buffer,
+        int num_stats) {
+    FILE * f;
+    int i, line_num, method, num_components;
+    s_array * words;
+    d_array * weights;
+    projection * p;
+    if ((f = fopen(path, "r")) == NULL) {
+        perror(path);
+        exit(1);
+    }
+    p = NULL;
+    words = init_s_array(3);
+    // skip the header, means, std devs and sample sizes, which
+    // `parse_summary_file` reads; a stat may be named "projection..."
+    for (line_num = 0; line_num < 4; line_num++) {
+        if (fgets(line_buffer->a, (line_buffer->capacity - 1), f) == NULL) {
+            break;
+        }
+    }
+    while (fgets(line_buffer->a, (line_buffer->capacity - 1), f) != NULL) {
+        if (strncmp(line_buffer->a, "projection\t", 11) != 0) {
+            continue;
+        }
+        split_str(line_buffer->a, words, 0);
+        method = -1;
+        num_components = 0;
+        if (words->length == 3) {
+            method = parse_projection_method(get_s_array(words, 1));
+            num_components = atoi(get_s_array(words, 2));
+        }
+        if ((method < 0) || (num_components < 1) ||
+                (num_components > num_stats)) {
+            fprintf(stderr, "ERROR: invalid projection in %s\n", path);
+            exit(1);
+        }
+        p = init_projection(method, num_stats, num_components);
+        weights = init_d_array(num_stats);
+        for (i = 0; i < num_components; i++) {
+            if (fgets(line_buffer->a, (line_buffer->capacity - 1), f) ==
+                    NULL) {
+                fprintf(stderr, "ERROR: found %d of %d projection weights "
+                        "lines in %s\n", i, num_components, path);
+                exit(1);
+            }
+            split_str_d(line_buffer->a, weights, 0);
+            if (weights->length != num_stats) {
+                fprintf(stderr, "ERROR: found %d column headers, but %d "
+                        "projection weights in file %s\n", num_stats,
+                        weights->length, path);
+                exit(1);
+            }
+            memcpy((p->weights->a + ((size_t) i * num_stats)), weights->a,
+                    (num_stats * sizeof(*weights->a)));
+        }
+        free_d_array(weights);
+        break;
+    }
+    free_s_array(words);
+    fclose(f);
+    return p;
+}
+
 int strcmp_i(const char * a, const char * b) {
     for (;; a++, b++) {
         int x = tolower(*a) - tolower(*b);
@@ -23,8 +23,10 @@
 
 #include <stdio.h>
 #include <string.h>
+#include <ctype.h>
 
 #include "array_utils.h"
+#include "stats_utils.h"
 
 
 void parse_header(const char * path, c_array * line_buffer, s_array * header);
@@ -36,6 +38,15 @@ void parse_summary_file(const char * path,
         d_array * means,
         d_array * std_devs,
         i_array * sample_sizes);
+
+/**
+ * Returns the projection stored in summary file `path` (after the means,
+ * standard deviations, sample sizes and covariances of its `num_stats`
+ * stats), or NULL if it has none.
+ */
+projection * parse_summary_projection(const char * path,
+        c_array * line_buffer,
+        int num_stats);
 int strcmp_i(const char * a, const char * b);
 char * strip(const char * s);
 
@@ -23,28 +23,156 @@
 int cumulative_number_of_int_partitions_by_k(int n,
         i_array * dest) {
     assert(n > 0);
-    int i, j;
-    int table[n+1][n+1];
-    // initialize table with base cases
-    for (i = 0; i <= n; i++)
-        table[i][0] = 0;
-    for (i = 1; i <= n; i++)
-        table[0][i] = 1;
-    // populate table
-    for (i = 1 ; i <= n; i++) {
-        for (j = 1; j <= n; j++) {
-            if (i - j < 0){
-                table[i][j] = table[i][j-1];
-                continue;
+    int i;
+    uint128 ip;
+    uint128 * counts;
+    counts = (typeof(*counts) *) malloc(sizeof(*counts) * n);
+    if (counts == NULL) {
+        perror("out of memory");
+        exit(1);
+    }
+    ip = cumulative_number_of_int_partitions_by_k_u128(n, counts);
+    if ((ip == 0) || (ip > INT_MAX)) {
+        fprintf(stderr, "ERROR: the number of partitions of %d is too large "
+                "for an int\n", n);
+        exit(1);
+    }
+    (*dest).length = 0;
+    for (i = 0; i < n; i++) {
+        i_array_append(dest, (int) counts[i]);
+    }
+    free(counts);
+    return (int) ip;
+}
+
+uint128 cumulative_number_of_int_partitions_by_k_u128(int n,
+        uint128 * dest) {
+    assert(n > 0);
+    int i, k;
+    uint128 ip;
+    uint128 * row;
+    // row[i] is the number of partitions of i into parts of at most k (the
+    // conjugates of those into at most k parts)
+    row = (typeof(*row) *) calloc((n + 1), sizeof(*row));
+    if (row == NULL) {
+        perror("out of memory");
+        exit(1);
+    }
+    row[0] = 1;
+    for (k = 1; k <= n; k++) {
+        for (i = k; i <= n; i++) {
+            row[i] += row[i-k];
+            if (row[i] < row[i-k]) {
+                // the counts only grow, so p(n) overflows too
+                free(row);
+                return 0;
             }
-            table[i][j] = table[i][j-1] + table[i-j][j];
         }
+        dest[k-1] = row[n];
+    }
+    ip = row[n];
+    free(row);
+    return ip;
+}
+
+void cumulative_number_of_int_partitions_by_k_big(int n, big_int ** dest) {
+    assert(n > 0);
+    int i, k;
+    big_int ** row;
+    row = (typeof(*row) *) malloc(sizeof(*row) * (n + 1));
+    if (row == NULL) {
+        perror("out of memory");
+        exit(1);
+    }
+    for (i = 0; i <= n; i++) {
+        row[i] = init_big_int(1);
+    }
+    assign_big_int(row[0], 1);
+    for (k = 1; k <= n; k++) {
+        for (i = k; i <= n; i++) {
+            add_big_int(row[i], row[i-k]);
+        }
+        copy_big_int(dest[k-1], row[n]);
+    }
+    for (i = 0; i <= n; i++) {
+        free_big_int(row[i]);
+    }
+    free(row);
+}
+
+double * get_int_partition_count_table(int n) {
+    assert(n > 0);
+    int k, m;
+    double * table;
+    table = (typeof(*table) *) malloc(sizeof(*table) * (n + 1) * (n + 1));
+    if (table == NULL) {
+        perror("out of memory");
+        exit(1);
+    }
+    table[0] = 1.0;
+    for (m = 1; m <= n; m++) {
+        table[m] = 0.0;
+    }
+    for (k = 1; k <= n; k++) {
+        for (m = 0; m <= n; m++) {
+            table[(k * (n + 1)) + m] = table[((k - 1) * (n + 1)) + m] +
+                    ((m >= k) ? table[(k * (n + 1)) + m - k] : 0.0);
+        }
+    }
+    return table;
+}
+
+/**
+ * Returns log(exp(x) + exp(y)).
+ */
+static double log_add(double x, double y) {
+    if (x < y) {
+        return log_add(y, x);
+    }
+    if (y == -INFINITY) {
+        return x;
+    }
+    return x + log1p(exp(y - x));
+}
+
+/**
+ * Store in `dest` the log of the number of partitions of `n` into at most
+ * k parts or, if `exact` is not zero, exactly k parts, for k = 1, ..., n.
+ * The partitions of n into exactly k parts are the conjugates of those with
+ * a largest part of k, of which there are p(n - k, <=k).
+ */
+static double log_int_partitions_by_k(int n, d_array * dest, int exact) {
+    assert(n > 0);
+    int i, k;
+    double lp;
+    double * row;
+    row = (typeof(*row) *) malloc(sizeof(*row) * (n + 1));
+    if (row == NULL) {
+        perror("out of memory");
+        exit(1);
+    }
+    row[0] = 0.0;
+    for (i = 1; i <= n; i++) {
+        row[i] = -INFINITY;
     }
     (*dest).length = 0;
-    for (i = 0; i < n; i++) {
-        append_i_array(dest, table[n][i+1]);
+    for (k = 1; k <= n; k++) {
+        for (i = k; i <= n; i++) {
+            row[i] = log_add(row[i], row[i-k]);
+        }
+        d_array_append(dest, (exact ? row[n-k] : row[n]));
     }
-    return table[n][n];
+    lp = row[n];
+    free(row);
+    return lp;
+}
+
+double log_cumulative_number_of_int_partitions_by_k(int n, d_array * dest) {
+    return log_int_partitions_by_k(n, dest, 0);
+}
+
+double log_number_of_int_partitions_by_k(int n, d_array * dest) {
+    return log_int_partitions_by_k(n, dest, 1);
 }
 
 int number_of_int_partitions_by_k(int n, i_array * dest) {
@@ -54,111 +182,947 @@ int number_of_int_partitions_by_k(int n, i_array * dest) {
     v = init_i_array(n);
     int ip = cumulative_number_of_int_partitions_by_k(n, v);
     (*dest).length = 0;
-    append_i_array(dest, 1);
+    i_array_append(dest, 1);
     for (i = 1; i < n; i++) {
-        append_i_array(dest, (v->a[i] - v->a[i-1]));
+        i_array_append(dest, (v->a[i] - v->a[i-1]));
     }
     free_i_array(v);
     return ip;
 }
+
+uint128 number_of_int_partitions_by_k_u128(int n, uint128 * dest) {
+    assert(n > 0);
+    int i;
+    uint128 ip;
+    ip = cumulative_number_of_int_partitions_by_k_u128(n, dest);
+    for (i = n - 1; i > 0; i--) {
+        dest[i] -= dest[i-1];
+    }
+    return ip;
+}
+
+void number_of_int_partitions_by_k_big(int n, big_int ** dest) {
+    assert(n > 0);
+    int i;
+    cumulative_number_of_int_partitions_by_k_big(n, dest);
+    for (i = n - 1; i > 0; i--) {
+        subtract_big_int(dest[i], dest[i-1]);
+    }
+}
     
-double cumulative_frequency_of_int_partitions_by_k(int n,
-        d_array * probs) {
+/**
+ * Store in `probs` the frequencies of the partitions of `n` into at most
+ * (if `cumulative` is not zero) or exactly k parts, for k = 1, ..., n. They
+ * are calculated from the exact counts while these fit in 128 bits, and
+ * from the logs of the counts beyond.
+ */
+static void int_partition_frequencies_by_k(int n, d_array * probs,
+        int cumulative) {
     assert(n > 0);
     int i;
-    i_array * v;
-    v = init_i_array(n);
-    int ip = cumulative_number_of_int_partitions_by_k(n, v);
+    uint128 ip;
+    uint128 * counts;
+    d_array * v;
+    double lp;
     (*probs).length = 0;
+    if (n <= PARTITION_COUNT_U128_MAX_N) {
+        counts = (typeof(*counts) *) malloc(sizeof(*counts) * n);
+        if (counts == NULL) {
+            perror("out of memory");
+            exit(1);
+        }
+        ip = (cumulative ?
+                cumulative_number_of_int_partitions_by_k_u128(n, counts) :
+                number_of_int_partitions_by_k_u128(n, counts));
+        for (i = 0; i < n; i++) {
+            d_array_append(probs, (counts[i] / ((double) ip)));
+        }
+        free(counts);
+        return;
+    }
+    v = init_d_array(n);
+    lp = (cumulative ? log_cumulative_number_of_int_partitions_by_k(n, v) :
+            log_number_of_int_partitions_by_k(n, v));
     for (i = 0; i < n; i++) {
-        append_d_array(probs, (v->a[i] / ((double) ip)));
+        d_array_append(probs, exp(v->a[i] - lp));
     }
-    free_i_array(v);
+    free_d_array(v);
+}
+
+double cumulative_frequency_of_int_partitions_by_k(int n,
+        d_array * probs) {
+    assert(n > 0);
+    int_partition_frequencies_by_k(n, probs, 1);
     return (get_d_array(probs, (n-1)));
 }
 
 double frequency_of_int_partitions_by_k(int n, d_array * probs) {
     assert(n > 0);
     int i;
-    i_array * v;
-    v = init_i_array(n);
-    int ip = number_of_int_partitions_by_k(n, v);
-    (*probs).length = 0;
+    int_partition_frequencies_by_k(n, probs, 0);
     double sum = 0.0;
     for (i = 0; i < n; i++) {
-        append_d_array(probs, (v->a[i] / ((double) ip)));
-        sum += get_d_array(probs, i);
+        sum += d_array_get(probs, i);
     }
-    free_i_array(v);
     return sum;
 }
 
 int number_of_int_partitions(int n) {
     if (n < 0) return 0;
     if (n == 0) return 1;
-    i_array * v;
-    v = init_i_array(n);
-    int ip = cumulative_number_of_int_partitions_by_k(n, v);
-    free_i_array(v);
-    return ip;
+    uint64_t ip;
+    big_int * b;
+    b = init_big_int(2);
+    number_of_int_partitions_pentagonal(n, b);
+    if (b->length > 2) {
+        ip = ((uint64_t) INT_MAX) + 1;
+    }
+    else {
+        ip = (b->length > 1) ? (((uint64_t) b->a[1]) * BIG_INT_BASE) : 0;
+        ip += (b->length > 0) ? b->a[0] : 0;
+    }
+    free_big_int(b);
+    if (ip > INT_MAX) {
+        fprintf(stderr, "ERROR: the number of partitions of %d is too large "
+                "for an int\n", n);
+        exit(1);
+    }
+    return (int) ip;
+}
+
+void number_of_int_partitions_pentagonal(int n, big_int * dest) {
+    int i, k;
+    long g;
+    big_int * pos;
+    big_int * neg;
+    big_int ** p;
+    if (n < 0) {
+        assign_big_int(dest, 0);
+        return;
+    }
+    p = (typeof(*p) *) malloc(sizeof(*p) * (n + 1));
+    if (p == NULL) {
+        perror("out of memory");
+        exit(1);
+    }
+    pos = init_big_int(1);
+    neg = init_big_int(1);
+    p[0] = init_big_int(1);
+    assign_big_int(p[0], 1);
+    for (i = 1; i <= n; i++) {
+        pos->length = 0;
+        neg->length = 0;
+        // p(i) = sum over k of (-1)^(k+1) (p(i - g(k)) + p(i - g(-k))), for
+        // the generalized pentagonal numbers g(k) = k(3k - 1)/2
+        for (k = 1; ; k++) {
+            g = ((long) k * ((3 * (long) k) - 1)) / 2;
+            if (g > i) {
+                break;
+            }
+            add_big_int(((k % 2) ? pos : neg), p[i-g]);
+            g += k;
+            if (g <= i) {
+                add_big_int(((k % 2) ? pos : neg), p[i-g]);
+            }
+        }
+        subtract_big_int(pos, neg);
+        p[i] = init_big_int((pos->length > 0) ? pos->length : 1);
+        copy_big_int(p[i], pos);
+    }
+    copy_big_int(dest, p[n]);
+    for (i = 0; i <= n; i++) {
+        free_big_int(p[i]);
+    }
+    free(p);
+    free_big_int(pos);
+    free_big_int(neg);
+}
+
+/*
+ * Fixed-point arithmetic for the Hardy-Ramanujan-Rademacher series. A
+ * non-negative real number x is held as the big_int x * BIG_INT_BASE^f,
+ * with `f` fractional digits; products are truncated to `f` digits.
+ */
+
+static void set_fixed_one(big_int * x, int f) {
+    assign_big_int(x, 1);
+    shift_big_int(x, f);
+}
+
+static void multiply_fixed(big_int * dest, const big_int * x,
+        const big_int * y, int f) {
+    multiply_big_int(dest, x, y);
+    shift_big_int(dest, -f);
+}
+
+static void swap_big_ints(big_int ** x, big_int ** y) {
+    big_int * t;
+    t = *x;
+    *x = *y;
+    *y = t;
+}
+
+static double get_fixed_double(const big_int * x, int f) {
+    int i, n;
+    double v;
+    n = (x->length < 3) ? x->length : 3;
+    v = 0.0;
+    for (i = x->length - 1; i >= (x->length - n); i--) {
+        v = (v * BIG_INT_BASE) + x->a[i];
+    }
+    return v * pow(BIG_INT_BASE, (x->length - n - f));
+}
+
+/**
+ * Set `x` to `v`, which must be positive, to 16 significant figures.
+ */
+static void set_fixed_double(big_int * x, double v, int f) {
+    int e, d;
+    uint32_t p;
+    e = (int) floor(log10(v));
+    assign_big_int(x, (uint64_t) llround(v * pow(10.0, (15 - e))));
+    // x is now v * 10^(15 - e); shift it by d decimal places
+    d = (BIG_INT_BASE_DIGITS * f) + e - 15;
+    if (d >= 0) {
+        shift_big_int(x, (d / BIG_INT_BASE_DIGITS));
+    }
+    else {
+        shift_big_int(x, -(-d / BIG_INT_BASE_DIGITS));
+    }
+    for (p = 1, e = 0; e < (abs(d) % BIG_INT_BASE_DIGITS); e++) {
+        p *= 10;
+    }
+    if (d >= 0) {
+        multiply_big_int_small(x, p);
+    }
+    else {
+        divide_big_int_small(x, p);
+    }
+}
+
+/**
+ * Add `sign` * `y` to the number held as the difference `pos` - `neg`.
+ */
+static void add_signed_fixed(big_int * pos, big_int * neg,
+        const big_int * y, int sign) {
+    add_big_int(((sign > 0) ? pos : neg), y);
+}
+
+/**
+ * Store 1/x in `dest` by Newton's iteration, y <- y + y(1 - xy).
+ */
+static void get_fixed_reciprocal(big_int * dest, const big_int * x, int f) {
+    int num_correct;
+    big_int * one;
+    big_int * e;
+    big_int * t;
+    one = init_big_int(f + 1);
+    e = init_big_int(f + 1);
+    t = init_big_int(f + 1);
+    set_fixed_one(one, f);
+    set_fixed_double(dest, (1.0 / get_fixed_double(x, f)), f);
+    // the number of correct decimal places doubles with each iteration
+    for (num_correct = 12; num_correct < ((BIG_INT_BASE_DIGITS * f) + 24);
+            num_correct *= 2) {
+        multiply_fixed(e, x, dest, f);
+        if (compare_big_int(e, one) <= 0) {
+            subtract_big_int(one, e);
+            multiply_fixed(t, dest, one, f);
+            add_big_int(dest, t);
+        }
+        else {
+            subtract_big_int(e, one);
+            multiply_fixed(t, dest, e, f);
+            subtract_big_int(dest, t);
+        }
+        set_fixed_one(one, f);
+    }
+    free_big_int(one);
+    free_big_int(e);
+    free_big_int(t);
+}
+
+/**
+ * Store the square root of the integer `m` in `dest`, by Newton's iteration
+ * for its reciprocal, y <- y + y(1 - my^2)/2.
+ */
+static void get_fixed_sqrt(big_int * dest, uint32_t m, int f) {
+    int num_correct;
+    big_int * y;
+    big_int * e;
+    big_int * t;
+    y = init_big_int(f + 1);
+    e = init_big_int(f + 1);
+    t = init_big_int(f + 1);
+    set_fixed_double(y, (1.0 / sqrt(m)), f);
+    for (num_correct = 12; num_correct < ((BIG_INT_BASE_DIGITS * f) + 24);
+            num_correct *= 2) {
+        multiply_fixed(e, y, y, f);
+        multiply_big_int_small(e, m);
+        set_fixed_one(dest, f);
+        if (compare_big_int(e, dest) <= 0) {
+            subtract_big_int(dest, e);
+            multiply_fixed(t, y, dest, f);
+            divide_big_int_small(t, 2);
+            add_big_int(y, t);
+        }
+        else {
+            subtract_big_int(e, dest);
+            multiply_fixed(t, y, e, f);
+            divide_big_int_small(t, 2);
+            subtract_big_int(y, t);
+        }
+    }
+    copy_big_int(dest, y);
+    multiply_big_int_small(dest, m);
+    free_big_int(y);
+    free_big_int(e);
+    free_big_int(t);
+}
+
+/**
+ * Store exp(x) in `dest`. The argument is halved until it is below 2^-10,
+ * and the Taylor series of the result is squared as many times, with
+ * enough extra digits to cover the error that the squaring amplifies.
+ */
+static void get_fixed_exp(big_int * dest, const big_int * x, int f) {
+    int j, s, g;
+    double xd;
+    big_int * r;
+    big_int * term;
+    big_int * t;
+    xd = get_fixed_double(x, f);
+    for (s = 0; xd > (1.0 / 1024); s++) {
+        xd /= 2.0;
+    }
+    g = f + 1 + ((s * 3) / (10 * BIG_INT_BASE_DIGITS)) + 1;
+    r = init_big_int(g + 1);
+    term = init_big_int(g + 1);
+    t = init_big_int(g + 1);
+    copy_big_int(r, x);
+    shift_big_int(r, (g - f));
+    for (j = 0; j < s; j++) {
+        divide_big_int_small(r, 2);
+    }
+    set_fixed_one(dest, g);
+    set_fixed_one(term, g);
+    for (j = 1; term->length > 0; j++) {
+        multiply_fixed(t, term, r, g);
+        divide_big_int_small(t, j);
+        swap_big_ints(&term, &t);
+        add_big_int(dest, term);
+    }
+    for (j = 0; j < s; j++) {
+        multiply_fixed(t, dest, dest, g);
+        copy_big_int(dest, t);
+    }
+    shift_big_int(dest, -(g - f));
+    free_big_int(r);
+    free_big_int(term);
+    free_big_int(t);
+}
+
+/**
+ * Add atan(1/q) * `coef` to `dest`, by its alternating Taylor series.
+ */
+static void add_fixed_atan_inverse(big_int * dest, uint32_t q, uint32_t coef,
+        int f) {
+    int j;
+    big_int * power;
+    big_int * term;
+    big_int * neg;
+    power = init_big_int(f + 1);
+    term = init_big_int(f + 1);
+    neg = init_big_int(f + 1);
+    set_fixed_one(power, f);
+    multiply_big_int_small(power, coef);
+    divide_big_int_small(power, q);
+    neg->length = 0;
+    for (j = 0; power->length > 0; j++) {
+        copy_big_int(term, power);
+        divide_big_int_small(term, ((2 * j) + 1));
+        add_signed_fixed(dest, neg, term, ((j % 2) ? -1 : 1));
+        divide_big_int_small(power, (q * q));
+    }
+    subtract_big_int(dest, neg);
+    free_big_int(power);
+    free_big_int(term);
+    free_big_int(neg);
+}
+
+/**
+ * Store pi in `dest`, by Machin's formula pi = 16 atan(1/5) - 4 atan(1/239).
+ */
+static void get_fixed_pi(big_int * dest, int f) {
+    big_int * t;
+    t = init_big_int(f + 2);
+    dest->length = 0;
+    t->length = 0;
+    add_fixed_atan_inverse(dest, 5, 16, (f + 1));
+    add_fixed_atan_inverse(t, 239, 4, (f + 1));
+    subtract_big_int(dest, t);
+    shift_big_int(dest, -1);
+    free_big_int(t);
+}
+
+/**
+ * Store |cos(pi * a / b)| in `dest`, given pi; returns the sign of the
+ * cosine. The angle is reduced to at most pi/4, so that the Taylor series
+ * of the cosine (or of the sine of the complementary angle) converges
+ * quickly.
+ */
+static int get_fixed_cos_pi(big_int * dest, const big_int * pi, uint32_t a,
+        uint32_t b, int f) {
+    int j, sign, use_sine;
+    big_int * theta2;
+    big_int * term;
+    big_int * t;
+    big_int * neg;
+    theta2 = init_big_int(f + 1);
+    term = init_big_int(f + 1);
+    t = init_big_int(f + 1);
+    neg = init_big_int(f + 1);
+    a %= (2 * b);
+    if (a > b) {
+        a = (2 * b) - a;
+    }
+    sign = 1;
+    if ((2 * a) > b) {
+        sign = -1;
+        a = b - a;
+    }
+    // cos(pi a/b) = sin(pi (b - 2a)/(2b))
+    use_sine = ((4 * a) > b);
+    copy_big_int(t, pi);
+    if (use_sine) {
+        multiply_big_int_small(t, (b - (2 * a)));
+        divide_big_int_small(t, (2 * b));
+    }
+    else {
+        multiply_big_int_small(t, a);
+        divide_big_int_small(t, b);
+    }
+    multiply_fixed(theta2, t, t, f);
+    if (use_sine) {
+        copy_big_int(term, t);
+    }
+    else {
+        set_fixed_one(term, f);
+    }
+    copy_big_int(dest, term);
+    neg->length = 0;
+    for (j = 1; term->length > 0; j++) {
+        multiply_fixed(t, term, theta2, f);
+        if (use_sine) {
+            divide_big_int_small(t, ((2 * j) * ((2 * j) + 1)));
+        }
+        else {
+            divide_big_int_small(t, (((2 * j) - 1) * (2 * j)));
+        }
+        swap_big_ints(&term, &t);
+        add_signed_fixed(dest, neg, term, ((j % 2) ? -1 : 1));
+    }
+    subtract_big_int(dest, neg);
+    free_big_int(theta2);
+    free_big_int(term);
+    free_big_int(t);
+    free_big_int(neg);
+    return sign;
+}
+
+/**
+ * Returns the number of terms of the Rademacher series needed for the
+ * remainder to be less than 1/4, by the bound of Lehmer (1938).
+ */
+static int get_hrr_num_terms(int n) {
+    int num_terms;
+    double a, b, c, bound;
+    a = (44.0 * M_PI * M_PI) / (225.0 * sqrt(3.0));
+    b = (M_PI * sqrt(2.0)) / 75.0;
+    c = M_PI * sqrt((2.0 * n) / 3.0);
+    for (num_terms = 1; ; num_terms++) {
+        bound = (a / sqrt(num_terms)) +
+                (b * sqrt(num_terms / (n - 1.0)) * sinh(c / num_terms));
+        if (bound < 0.25) {
+            return num_terms;
+        }
+    }
+}
+
+/**
+ * The Hardy-Ramanujan-Rademacher series, in the form
+ *
+ *   p(n) = (4/m) sum_k S_k(n) (cosh(U_k) - sinh(U_k)/U_k),
+ *
+ * where m = 24n - 1 and U_k = pi sqrt(m) / (6k), and where, by Selberg's
+ * formula for the Kloosterman-type sums A_k(n) = sqrt(k/3) S_k(n),
+ *
+ *   S_k(n) = sum over l in [0, 2k) with (3l^2 + l)/2 = -n (mod k) of
+ *       (-1)^l cos(pi (6l + 1) / (6k)).
+ *
+ * Term k has about U_k log10(e) decimal digits, so it is calculated with
+ * only that many digits (plus guard digits); the sum is truncated once the
+ * remainder is less than 1/4, and rounded to the nearest integer.
+ */
+void number_of_int_partitions_hrr(int n, big_int * dest) {
+    assert((n > 1) && (n <= PARTITION_HRR_MAX_N));
+    int k, l, f, f_max, num_terms, sign;
+    uint32_t m;
+    double mu, u, guard;
+    big_int * pi;
+    big_int * sqrt_m;
+    big_int * pi_k;
+    big_int * sqrt_m_k;
+    big_int * c;
+    big_int * s_pos;
+    big_int * s_neg;
+    big_int * x_u;
+    big_int * inv_u;
+    big_int * exp_u;
+    big_int * t;
+    big_int * x_pos;
+    big_int * x_neg;
+    big_int * pos;
+    big_int * neg;
+    m = (24 * (uint32_t) n) - 1;
+    num_terms = get_hrr_num_terms(n);
+    mu = (M_PI * sqrt(m)) / 6.0;
+    guard = 25.0 + (2.0 * log10(num_terms));
+    f_max = (int) ceil(((mu * M_LOG10E) + guard) / BIG_INT_BASE_DIGITS) + 1;
+    pi = init_big_int(f_max + 1);
+    sqrt_m = init_big_int(f_max + 1);
+    pi_k = init_big_int(f_max + 1);
+    sqrt_m_k = init_big_int(f_max + 1);
+    c = init_big_int(f_max + 1);
+    s_pos = init_big_int(f_max + 1);
+    s_neg = init_big_int(f_max + 1);
+    x_u = init_big_int(f_max + 1);
+    inv_u = init_big_int(f_max + 1);
+    exp_u = init_big_int(2 * (f_max + 1));
+    t = init_big_int(2 * (f_max + 1));
+    x_pos = init_big_int(2 * (f_max + 1));
+    x_neg = init_big_int(2 * (f_max + 1));
+    pos = init_big_int(f_max + 1);
+    neg = init_big_int(f_max + 1);
+    get_fixed_pi(pi, f_max);
+    get_fixed_sqrt(sqrt_m, m, f_max);
+    pos->length = 0;
+    neg->length = 0;
+    for (k = 1; k <= num_terms; k++) {
+        u = mu / k;
+        f = (int) ceil(((u * M_LOG10E) + guard) / BIG_INT_BASE_DIGITS) + 1;
+        copy_big_int(pi_k, pi);
+        shift_big_int(pi_k, -(f_max - f));
+        copy_big_int(sqrt_m_k, sqrt_m);
+        shift_big_int(sqrt_m_k, -(f_max - f));
+        s_pos->length = 0;
+        s_neg->length = 0;
+        for (l = 0; l < (2 * k); l++) {
+            if (((((3 * (int64_t) l * l) + l) / 2) + n) % k != 0) {
+                continue;
+            }
+            sign = get_fixed_cos_pi(c, pi_k, ((6 * l) + 1), (6 * k), f);
+            add_signed_fixed(s_pos, s_neg, c, ((l % 2) ? -sign : sign));
+        }
+        sign = 1;
+        if (compare_big_int(s_pos, s_neg) < 0) {
+            swap_big_ints(&s_pos, &s_neg);
+            sign = -1;
+        }
+        subtract_big_int(s_pos, s_neg);
+        if (s_pos->length == 0) {
+            continue;
+        }
+        // 2 (cosh(U) - sinh(U)/U) = e^U (1 - 1/U) + e^-U (1 + 1/U)
+        multiply_fixed(x_u, pi_k, sqrt_m_k, f);
+        divide_big_int_small(x_u, (6 * k));
+        get_fixed_reciprocal(inv_u, x_u, f);
+        get_fixed_exp(exp_u, x_u, f);
+        copy_big_int(x_pos, exp_u);
+        multiply_fixed(x_neg, exp_u, inv_u, f);
+        if (u < 64.0) {
+            // beyond this, e^-U is negligible
+            get_fixed_reciprocal(c, exp_u, f);
+            add_big_int(x_pos, c);
+            multiply_fixed(t, c, inv_u, f);
+            add_big_int(x_pos, t);
+        }
+        if (compare_big_int(x_pos, x_neg) < 0) {
+            continue;
+        }
+        subtract_big_int(x_pos, x_neg);
+        multiply_fixed(t, x_pos, s_pos, f);
+        // one fractional digit is enough for the sum
+        shift_big_int(t, -(f - 1));
+        add_signed_fixed(pos, neg, t, sign);
+    }
+    subtract_big_int(pos, neg);
+    multiply_big_int_small(pos, 2);
+    divide_big_int_small(pos, m);
+    assign_big_int(t, (BIG_INT_BASE / 2));
+    add_big_int(pos, t);
+    shift_big_int(pos, -1);
+    copy_big_int(dest, pos);
+    free_big_int(pi);
+    free_big_int(sqrt_m);
+    free_big_int(pi_k);
+    free_big_int(sqrt_m_k);
+    free_big_int(c);
+    free_big_int(s_pos);
+    free_big_int(s_neg);
+    free_big_int(x_u);
+    free_big_int(inv_u);
+    free_big_int(exp_u);
+    free_big_int(t);
+    free_big_int(x_pos);
+    free_big_int(x_neg);
+    free_big_int(pos);
+    free_big_int(neg);
+}
+
+void number_of_int_partitions_big(int n, big_int * dest) {
+    if (n > PARTITION_HRR_MAX_N) {
+        fprintf(stderr, "ERROR: number_of_int_partitions_big: cannot count "
+                "the partitions of more than %d elements\n",
+                PARTITION_HRR_MAX_N);
+        exit(1);
+    }
+    if (n < PARTITION_HRR_MIN_N) {
+        number_of_int_partitions_pentagonal(n, dest);
+        return;
+    }
+    number_of_int_partitions_hrr(n, dest);
+}
+
+int_partition_iterator * init_int_partition_iterator(int n) {
+    assert(n > 0);
+    return init_int_partition_iterator_prefix(n, NULL, 0);
+}
+
+int_partition_iterator * init_int_partition_iterator_prefix(int n,
+        const int * prefix, int prefix_length) {
+    assert(n > 0);
+    assert(prefix_length >= 0);
+    int i, m, b;
+    int_partition_iterator * it;
+    it = (typeof(*it) *) malloc(sizeof(*it));
+    it->n = n;
+    it->x = (typeof(*it->x) *) malloc(sizeof(*it->x) * n);
+    if (it->x == NULL) {
+        perror("out of memory");
+        exit(1);
+    }
+    m = n;
+    b = n;
+    for (i = 0; i < prefix_length; i++) {
+        assert((prefix[i] > 0) && (prefix[i] <= b) && (prefix[i] <= m));
+        it->x[i] = prefix[i];
+        b = prefix[i];
+        m -= prefix[i];
+    }
+    for (i = prefix_length; i < n; i++) {
+        it->x[i] = 1;
+    }
+    // the first partition with the prefix fills the rest of n with as many
+    // parts of b as fit, followed by what remains
+    it->first = prefix_length;
+    it->num_parts = prefix_length;
+    it->h = prefix_length - 1;
+    while (m > 0) {
+        it->x[it->num_parts] = (m < b) ? m : b;
+        m -= it->x[it->num_parts];
+        if (it->x[it->num_parts] > 1) {
+            it->h = it->num_parts;
+        }
+        it->num_parts++;
+    }
+    return it;
+}
+
+void free_int_partition_iterator(int_partition_iterator * it) {
+    free(it->x);
+    free(it);
+    it = NULL;
+}
+
+int next_int_partition(int_partition_iterator * it) {
+    int r, t, m, h;
+    int * x;
+    x = it->x;
+    if (it->h < it->first) {
+        return 0;
+    }
+    // m is the index of the last part
+    m = it->num_parts - 1;
+    h = it->h;
+    if (x[h] == 2) {
+        m += 1;
+        x[h] = 1;
+        h -= 1;
+    }
+    else {
+        r = x[h] - 1;
+        t = m - h + 1;
+        x[h] = r;
+        while (t >= r) {
+            h += 1;
+            x[h] = r;
+            t -= r;
+        }
+        if (t == 0) {
+            m = h;
+        }
+        else {
+            m = h + 1;
+            x[m] = t;
+            if (t > 1) {
+                h += 1;
+            }
+        }
+    }
+    it->num_parts = m + 1;
+    it->h = h;
+    return 1;
+}
+
+long visit_int_partitions(int n, int_partition_visitor visit, void * data) {
+    long num_visited;
+    int_partition_iterator * it;
+    it = init_int_partition_iterator(n);
+    num_visited = 0;
+    do {
+        num_visited++;
+        if (visit(it->x, it->num_parts, data) != 0) {
+            break;
+        }
+    } while (next_int_partition(it));
+    free_int_partition_iterator(it);
+    return num_visited;
 }
 
 /** 
  * A function for generating all partitions of an integer.
  */ 
-i_array_2d * generate_int_partitions(int n) {
+i_array_csr * generate_int_partitions(int n) {
     assert(n > 0);
     int i, ip;
-    i_array_2d * partitions;
+    i_array_csr * partitions;
+    int_partition_iterator * it;
     ip = number_of_int_partitions(n);
-    partitions = init_i_array_2d(ip, n);
-    partitions->length = ip;
-    int x[n];
-    for (i = 0; i < n; i++) {
-        x[i] = 1;
-    }
-    x[0] = n;
-    int m = 0;
-    int h = 0;
-    int r, t, sum;
-    append_el_i_array_2d(partitions, 0, x[0]);
-    int part_index = 0;
-    while (x[0] != 1) {
-        part_index += 1;
-        if (x[h] == 2) {
-            m += 1;
-            x[h] = 1;
-            h -= 1;
+    // partitions have fewer than n parts on average; the values grow as
+    // needed
+    partitions = init_i_array_csr(ip, ip);
+    it = init_int_partition_iterator(n);
+    do {
+        start_row_i_array_csr(partitions);
+        for (i = 0; i < it->num_parts; i++) {
+            append_el_i_array_csr(partitions, it->x[i]);
         }
-        else {
-            r = x[h] - 1;
-            t = m - h + 1;
-            x[h] = r;
-            while (t >= r) {
-                h += 1;
-                x[h] = r;
-                t -= r;
+    } while (next_int_partition(it));
+    free_int_partition_iterator(it);
+    return partitions;
+}
+
+set_partition_table * init_set_partition_table(int n, int exact) {
+    assert(n >= 0);
+    int m, k, i, j;
+    set_partition_table * t;
+    t = (typeof(*t) *) malloc(sizeof(*t));
+    t->n = n;
+    t->exact = exact;
+    // the triangle of S(m, k) is stored by row, at (m(m + 1) / 2) + k
+    t->log_stirling = (typeof(*t->log_stirling) *) malloc(
+            sizeof(*t->log_stirling) * (((n + 1) * (n + 2)) / 2));
+    t->log_bell = (typeof(*t->log_bell) *) malloc(sizeof(*t->log_bell) *
+            (n + 1));
+    if ((t->log_stirling == NULL) || (t->log_bell == NULL)) {
+        perror("out of memory");
+        exit(1);
+    }
+    t->stirling = NULL;
+    t->bell = NULL;
+    if (exact != 0) {
+        t->stirling = (typeof(*t->stirling) *) malloc(sizeof(*t->stirling) *
+                (((n + 1) * (n + 2)) / 2));
+        t->bell = (typeof(*t->bell) *) malloc(sizeof(*t->bell) * (n + 1));
+        if ((t->stirling == NULL) || (t->bell == NULL)) {
+            perror("out of memory");
+            exit(1);
+        }
+    }
+    for (m = 0; m <= n; m++) {
+        i = (m * (m + 1)) / 2;
+        j = ((m - 1) * m) / 2;
+        for (k = 0; k <= m; k++) {
+            if (k == m) {
+                t->log_stirling[i + k] = 0.0;
             }
-            if (t == 0) {
-                m = h;
+            else if (k == 0) {
+                t->log_stirling[i + k] = -INFINITY;
             }
             else {
-                m = h + 1;
-                if (t > 1) {
-                    h += 1;
-                    x[h] = t;
-                }
+                t->log_stirling[i + k] = log_add(
+                        log(k) + t->log_stirling[j + k],
+                        t->log_stirling[j + k - 1]);
+            }
+            if (exact == 0) {
+                continue;
+            }
+            t->stirling[i + k] = init_big_int(1);
+            if (k == m) {
+                assign_big_int(t->stirling[i + k], 1);
+            }
+            else if (k > 0) {
+                copy_big_int(t->stirling[i + k], t->stirling[j + k]);
+                multiply_big_int_small(t->stirling[i + k], (uint32_t) k);
+                add_big_int(t->stirling[i + k], t->stirling[j + k - 1]);
             }
         }
-        sum = 0;
-        for (i = 0; i < n; i++) {
-            append_el_i_array_2d(partitions, part_index, x[i]);
-            sum += x[i];
-            if (sum >= n) {
-                break;
+        t->log_bell[m] = -INFINITY;
+        for (k = 0; k <= m; k++) {
+            t->log_bell[m] = log_add(t->log_bell[m], t->log_stirling[i + k]);
+        }
+        if (exact != 0) {
+            t->bell[m] = init_big_int(1);
+            for (k = 0; k <= m; k++) {
+                add_big_int(t->bell[m], t->stirling[i + k]);
             }
         }
     }
-    return partitions;
+    return t;
+}
+
+void free_set_partition_table(set_partition_table * t) {
+    int i;
+    if (t->exact != 0) {
+        for (i = 0; i < (((t->n + 1) * (t->n + 2)) / 2); i++) {
+            free_big_int(t->stirling[i]);
+        }
+        for (i = 0; i <= t->n; i++) {
+            free_big_int(t->bell[i]);
+        }
+        free(t->stirling);
+        free(t->bell);
+    }
+    free(t->log_stirling);
+    free(t->log_bell);
+    free(t);
+    t = NULL;
+}
+
+const big_int * get_stirling2(const set_partition_table * t, int m, int k) {
+    assert(t->exact != 0);
+    assert((m >= 0) && (m <= t->n) && (k >= 0) && (k <= m));
+    return t->stirling[((m * (m + 1)) / 2) + k];
+}
+
+double get_log_stirling2(const set_partition_table * t, int m, int k) {
+    assert((m >= 0) && (m <= t->n) && (k >= 0) && (k <= m));
+    return t->log_stirling[((m * (m + 1)) / 2) + k];
+}
+
+const big_int * get_bell(const set_partition_table * t, int m) {
+    assert(t->exact != 0);
+    assert((m >= 0) && (m <= t->n));
+    return t->bell[m];
+}
+
+double get_log_bell(const set_partition_table * t, int m) {
+    assert((m >= 0) && (m <= t->n));
+    return t->log_bell[m];
+}
+
+set_partition_iterator * init_set_partition_iterator(int n) {
+    assert(n > 0);
+    int i;
+    set_partition_iterator * it;
+    it = (typeof(*it) *) malloc(sizeof(*it));
+    it->n = n;
+    it->a = (typeof(*it->a) *) malloc(sizeof(*it->a) * n);
+    it->max = (typeof(*it->max) *) malloc(sizeof(*it->max) * n);
+    it->up = (typeof(*it->up) *) malloc(sizeof(*it->up) * n);
+    if ((it->a == NULL) || (it->max == NULL) || (it->up == NULL)) {
+        perror("out of memory");
+        exit(1);
+    }
+    for (i = 0; i < n; i++) {
+        it->a[i] = 0;
+        it->max[i] = 0;
+        it->up[i] = 1;
+    }
+    it->num_blocks = 1;
+    it->changed = -1;
+    it->from = -1;
+    return it;
+}
+
+void free_set_partition_iterator(set_partition_iterator * it) {
+    free(it->a);
+    free(it->max);
+    free(it->up);
+    free(it);
+    it = NULL;
 }
 
+/**
+ * Returns the block after `v` in the sweep of an element whose largest
+ * block before it is `m`, or -1 if `v` ends the sweep.
+ */
+static int get_next_set_partition_block(int v, int m, int up) {
+    if (up != 0) {
+        // 0, m+1, m, ..., 1
+        if (v == 0) {
+            return m + 1;
+        }
+        return (v == 1) ? -1 : (v - 1);
+    }
+    // 1, 2, ..., m+1, 0
+    if (v == 0) {
+        return -1;
+    }
+    return (v == (m + 1)) ? 0 : (v + 1);
+}
+
+int next_set_partition(set_partition_iterator * it) {
+    int i, j, v;
+    // the last element that can move; those after it have ended their
+    // sweeps and turn around
+    v = -1;
+    for (i = it->n - 1; i > 0; i--) {
+        v = get_next_set_partition_block(it->a[i], it->max[i], it->up[i]);
+        if (v >= 0) {
+            break;
+        }
+    }
+    if (i == 0) {
+        return 0;
+    }
+    for (j = i + 1; j < it->n; j++) {
+        it->up[j] = !it->up[j];
+    }
+    it->changed = i;
+    it->from = it->a[i];
+    it->a[i] = v;
+    for (j = i + 1; j < it->n; j++) {
+        it->max[j] = (it->a[j-1] > it->max[j-1]) ? it->a[j-1] :
+                it->max[j-1];
+    }
+    j = it->n - 1;
+    it->num_blocks = ((it->a[j] > it->max[j]) ? it->a[j] : it->max[j]) + 1;
+    return 1;
+}
+
+long visit_set_partitions(int n, set_partition_visitor visit, void * data) {
+    long num_visited;
+    set_partition_iterator * it;
+    it = init_set_partition_iterator(n);
+    num_visited = 0;
+    do {
+        num_visited++;
+        if (visit(it->a, it->n, it->num_blocks, data) != 0) {
+            break;
+        }
+    } while (next_set_partition(it));
+    free_set_partition_iterator(it);
+    return num_visited;
+}
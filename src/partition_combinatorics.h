@@ -21,13 +21,143 @@
 #ifndef PARTITION_COMBINATORICS_H
 #define PARTITION_COMBINATORICS_H
 
+#include <stdint.h>
+#include <limits.h>
+
 #include "array_utils.h"
+#include "big_int.h"
+
+/**
+ * An exact count of up to 128 bits, which holds the number of partitions
+ * of integers up to `PARTITION_COUNT_U128_MAX_N`.
+ */
+typedef unsigned __int128 uint128;
+#define PARTITION_COUNT_U128_MAX_N 1458
+
+// where the Rademacher series overtakes the pentagonal number recurrence,
+// and the largest n for which 24n - 1 fits in 32 bits
+#define PARTITION_HRR_MIN_N 1000
+#define PARTITION_HRR_MAX_N 178956970
 
+/**
+ * The number of partitions of `n` into at most k parts, for k = 1, ..., n,
+ * stored in `dest`; returns the number of partitions of `n`. The counts are
+ * built by the recurrence p(i, <=k) = p(i, <=k-1) + p(i-k, <=k), rolling
+ * over k in a single row of n + 1 counts.
+ *
+ * The int versions exit with an error if the counts do not fit in an int
+ * (n > 121); the uint128 versions store the counts in `dest` (which must
+ * hold `n` values) and return 0 if they do not fit in 128 bits (n >
+ * `PARTITION_COUNT_U128_MAX_N`); the big_int versions store the counts in
+ * the `n` big_ints of `dest` and work for any `n`.
+ */
 int cumulative_number_of_int_partitions_by_k(int n, i_array * dest);
+uint128 cumulative_number_of_int_partitions_by_k_u128(int n,
+        uint128 * dest);
+void cumulative_number_of_int_partitions_by_k_big(int n, big_int ** dest);
+
+/**
+ * Returns a table of the number of partitions of m into parts of at most k,
+ * at `table[(k * (n + 1)) + m]`, for m, k = 0, ..., n, which the caller
+ * must free. The counts are doubles, which do not overflow for n below
+ * about 75000 and are exact to double precision.
+ */
+double * get_int_partition_count_table(int n);
+
+/**
+ * The log of the number of partitions of `n` into at most (or, for the
+ * second, exactly) k parts, for k = 1, ..., n, stored in `dest`; returns
+ * the log of the number of partitions of `n`. The recurrence is summed in
+ * log space, so this does not overflow for any `n`.
+ */
+double log_cumulative_number_of_int_partitions_by_k(int n, d_array * dest);
+double log_number_of_int_partitions_by_k(int n, d_array * dest);
+
+/**
+ * The number of partitions of `n` into exactly k parts, for k = 1, ..., n,
+ * stored in `dest`; returns the number of partitions of `n`. The versions
+ * are as for `cumulative_number_of_int_partitions_by_k`.
+ */
 int number_of_int_partitions_by_k(int n, i_array * dest);
+uint128 number_of_int_partitions_by_k_u128(int n, uint128 * dest);
+void number_of_int_partitions_by_k_big(int n, big_int ** dest);
 double cumulative_frequency_of_int_partitions_by_k(int n, d_array * probs);
 double frequency_of_int_partitions_by_k(int n, d_array * probs);
+
+/**
+ * The number of partitions of `n`, by the recurrence of Euler's pentagonal
+ * number theorem, which takes O(n^1.5) additions of O(n^0.5) digits; the
+ * int version exits with an error if the number does not fit in an int.
+ */
 int number_of_int_partitions(int n);
+void number_of_int_partitions_pentagonal(int n, big_int * dest);
+
+/**
+ * The number of partitions of `n`, 1 < `n` <= `PARTITION_HRR_MAX_N`, by the
+ * Hardy-Ramanujan-Rademacher series, which takes about sqrt(n) terms, each
+ * calculated to the precision of its size with fixed-point big_ints.
+ */
+void number_of_int_partitions_hrr(int n, big_int * dest);
+
+/**
+ * The number of partitions of `n`, by the pentagonal number recurrence
+ * below `PARTITION_HRR_MIN_N` and by the Rademacher series from there;
+ * exits with an error if `n` is greater than `PARTITION_HRR_MAX_N`.
+ */
+void number_of_int_partitions_big(int n, big_int * dest);
+
+/**
+ * The state of an enumeration of the integer partitions of `n`, by
+ * Algorithm ZS1 (see `generate_int_partitions`). The current partition is
+ * the `num_parts` parts `x[0]`, ..., `x[num_parts - 1]`, largest first.
+ * The first `first` parts are a fixed prefix; `h` is the index of the last
+ * part after the prefix that is greater than 1, or `first - 1` if there is
+ * none.
+ */
+typedef struct int_partition_iterator_ {
+    int n;
+    int * x;
+    int num_parts;
+    int first;
+    int h;
+} int_partition_iterator;
+
+/**
+ * A function called with each partition by `visit_int_partitions`; a
+ * non-zero return value stops the enumeration.
+ */
+typedef int (*int_partition_visitor)(const int * parts, int num_parts,
+        void * data);
+
+/**
+ * Start an enumeration of the partitions of `n`; the current partition is
+ * the first, `n` itself.
+ */
+int_partition_iterator * init_int_partition_iterator(int n);
+
+/**
+ * Start an enumeration of only the partitions of `n` that begin with the
+ * `prefix_length` parts of `prefix`, which must not increase and must sum
+ * to no more than `n`; the remaining parts are no larger than the last
+ * part of the prefix. Splitting the partitions by prefix divides the
+ * enumeration into pieces that can be run independently.
+ */
+int_partition_iterator * init_int_partition_iterator_prefix(int n,
+        const int * prefix, int prefix_length);
+void free_int_partition_iterator(int_partition_iterator * it);
+
+/**
+ * Advance to the next partition in anti-lexicographic order; returns 0,
+ * leaving the last partition (all ones) as the current one, if there are
+ * no more.
+ */
+int next_int_partition(int_partition_iterator * it);
+
+/**
+ * Call `visit` with each partition of `n`, in anti-lexicographic order,
+ * and `data`, using O(n) memory; returns the number of partitions visited.
+ */
+long visit_int_partitions(int n, int_partition_visitor visit, void * data);
 
 /** 
  * A function for generating all partitions of an integer.
@@ -42,12 +172,95 @@ int number_of_int_partitions(int n);
  * @param n
  *   The integer to partition.
  * @return
- *   The function returns a pointer to an `i_array_2d` struct. This is an array
- *   of `i_array`s. Each `i_array` contains a distinct integer partition of
- *   `n`; there will be `number_of_int_partitions(n)` of these.
+ *   The function returns a pointer to an `i_array_csr` struct, which stores
+ *   the partitions contiguously, one row per partition. Each row contains a
+ *   distinct integer partition of `n`; there will be
+ *   `number_of_int_partitions(n)` of these.
  *   @see number_of_int_partitions()
  */ 
-i_array_2d * generate_int_partitions(int n);
+i_array_csr * generate_int_partitions(int n);
+
+/**
+ * The Stirling numbers of the second kind, S(m, k), the number of
+ * partitions of a set of m elements into k blocks, and the Bell numbers,
+ * B(m), the number of partitions of a set of m elements, for 0 <= k <= m
+ * <= `n`, built once by the recurrence S(m, k) = k S(m-1, k) + S(m-1, k-1)
+ * and looked up with the functions below.
+ *
+ * The logs of the numbers are always stored; the exact numbers, as
+ * big_ints, only if the table was built with `exact` set, as they take
+ * O(n^3) bits.
+ */
+typedef struct set_partition_table_ {
+    int n;
+    int exact;
+    big_int ** stirling;
+    big_int ** bell;
+    double * log_stirling;
+    double * log_bell;
+} set_partition_table;
+
+set_partition_table * init_set_partition_table(int n, int exact);
+void free_set_partition_table(set_partition_table * t);
+const big_int * get_stirling2(const set_partition_table * t, int m, int k);
+double get_log_stirling2(const set_partition_table * t, int m, int k);
+const big_int * get_bell(const set_partition_table * t, int m);
+double get_log_bell(const set_partition_table * t, int m);
+
+/**
+ * The state of an enumeration of the partitions of a set of `n` elements,
+ * as restricted growth strings: element i is in block `a[i]`, where `a[0]`
+ * is 0 and each `a[i]` is at most one more than the largest block before
+ * it, so each partition has exactly one string. The partition has
+ * `num_blocks` blocks.
+ *
+ * The strings are enumerated in a Gray code order, in which each
+ * partition differs from the one before by moving one element, `changed`,
+ * from block `from` to block `a[changed]`. The last element sweeps through
+ * its blocks while the others are fixed, alternately as 0, m+1, m, ..., 1
+ * and as 1, 2, ..., m+1, 0, where m is the largest block before it; since
+ * both sweeps end in a block that is open to the element whatever comes
+ * before it, the next element to the left can then move (Kaye, R. 1976. A
+ * Gray code for set partitions. Inform. Process. Lett. 5:171--173).
+ * `max[i]` is the largest block of the elements before i, and `up[i]` is
+ * the direction of element i's sweep.
+ */
+typedef struct set_partition_iterator_ {
+    int n;
+    int * a;
+    int * max;
+    int * up;
+    int num_blocks;
+    int changed;
+    int from;
+} set_partition_iterator;
+
+/**
+ * A function called with each partition by `visit_set_partitions`; a
+ * non-zero return value stops the enumeration.
+ */
+typedef int (*set_partition_visitor)(const int * blocks, int n,
+        int num_blocks, void * data);
+
+/**
+ * Start an enumeration of the partitions of a set of `n` elements; the
+ * current partition is the first, with all elements in block 0.
+ */
+set_partition_iterator * init_set_partition_iterator(int n);
+void free_set_partition_iterator(set_partition_iterator * it);
+
+/**
+ * Advance to the next partition, by moving one element; returns 0 if there
+ * are no more.
+ */
+int next_set_partition(set_partition_iterator * it);
+
+/**
+ * Call `visit` with the block of each element of each partition of a set of
+ * `n` elements, in Gray code order, and `data`, using O(n) memory; returns
+ * the number of partitions visited.
+ */
+long visit_set_partitions(int n, set_partition_visitor visit, void * data);
 
 #endif /* PARTITION_COMBINATORICS_H */
 
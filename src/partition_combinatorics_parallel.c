@@ -0,0 +1,233 @@
+/**
+ * @file        partition_combinatorics_parallel.c
+ * @authors     Jamie Oaks
+ * @package     ABACUS (Approximate BAyesian C UtilitieS)
+ * @brief       Enumerating integer partitions with several threads.
+ * @copyright   Copyright (C) 2013 Jamie Oaks.
+ *   This file is part of ABACUS.  ABACUS is free software; you can
+ *   redistribute it and/or modify it under the terms of the GNU General Public
+ *   License as published by the Free Software Foundation; either version 2 of
+ *   the License, or (at your option) any later version.
+ * 
+ *   ABACUS is distributed in the hope that it will be useful, but WITHOUT ANY
+ *   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *   FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *   details.
+ * 
+ *   You should have received a copy of the GNU General Public License along
+ *   with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "partition_combinatorics_parallel.h"
+
+/**
+ * The state shared by the threads of one enumeration, which take the pieces
+ * of `prefixes` from `queue`.
+ */
+typedef struct partition_job_ {
+    int n;
+    i_array_csr * prefixes;
+    piece_queue * queue;
+    int_partition_visitor visit;
+    void ** data;
+    const char * sep;
+} partition_job;
+
+typedef struct partition_worker_ {
+    partition_job * job;
+    int index;
+    long num_visited;
+} partition_worker;
+
+static void split_int_partition_piece(const double * table, int n,
+        i_array * prefix, int m, int b, double max_count,
+        i_array_csr * prefixes) {
+    int c;
+    if (b > m) {
+        b = m;
+    }
+    if ((m == 0) || (table[(b * (n + 1)) + m] <= max_count)) {
+        append_row_i_array_csr(prefixes, prefix);
+        return;
+    }
+    for (c = b; c > 0; c--) {
+        append_i_array(prefix, c);
+        split_int_partition_piece(table, n, prefix, (m - c), c, max_count,
+                prefixes);
+        prefix->length--;
+    }
+}
+
+i_array_csr * split_int_partitions(int n, double max_count) {
+    assert(n > 0);
+    double * table;
+    i_array * prefix;
+    i_array_csr * prefixes;
+    table = get_int_partition_count_table(n);
+    prefix = init_i_array(n);
+    prefixes = init_i_array_csr(1, 1);
+    split_int_partition_piece(table, n, prefix, n, n, max_count, prefixes);
+    free(table);
+    free_i_array(prefix);
+    return prefixes;
+}
+
+/**
+ * Split the partitions of `n` into at least
+ * `INT_PARTITION_PIECES_PER_THREAD` pieces per thread, of no more than
+ * `INT_PARTITION_MAX_PIECE_SIZE` partitions.
+ */
+static i_array_csr * split_int_partitions_for_threads(int n,
+        int num_threads) {
+    double max_count;
+    double * table;
+    table = get_int_partition_count_table(n);
+    max_count = table[(n * (n + 1)) + n] /
+            ((double) num_threads * INT_PARTITION_PIECES_PER_THREAD);
+    if (max_count > INT_PARTITION_MAX_PIECE_SIZE) {
+        max_count = INT_PARTITION_MAX_PIECE_SIZE;
+    }
+    free(table);
+    return split_int_partitions(n, max_count);
+}
+
+static int_partition_iterator * init_partition_piece_iterator(
+        const partition_job * job, int piece) {
+    int start;
+    start = job->prefixes->offsets->a[piece];
+    return init_int_partition_iterator_prefix(job->n,
+            (job->prefixes->values->a + start),
+            get_row_length_i_array_csr(job->prefixes, piece));
+}
+
+static void * visit_int_partition_pieces(void * arg) {
+    int piece, stop;
+    partition_worker * w = (partition_worker *) arg;
+    partition_job * job = w->job;
+    int_partition_iterator * it;
+    stop = 0;
+    while ((stop == 0) && ((piece = take_piece_queue(job->queue)) >= 0)) {
+        it = init_partition_piece_iterator(job, piece);
+        do {
+            w->num_visited++;
+            stop = job->visit(it->x, it->num_parts,
+                    ((job->data == NULL) ? NULL : job->data[w->index]));
+        } while ((stop == 0) && next_int_partition(it));
+        free_int_partition_iterator(it);
+    }
+    if (stop != 0) {
+        stop_piece_queue(job->queue);
+    }
+    return NULL;
+}
+
+static void * write_int_partition_pieces(void * arg) {
+    int piece;
+    size_t sep_length;
+    partition_worker * w = (partition_worker *) arg;
+    partition_job * job = w->job;
+    piece_queue * q = job->queue;
+    text_buffer * t;
+    int_partition_iterator * it;
+    sep_length = strlen(job->sep);
+    t = NULL;
+    if (q->ordered == 0) {
+        t = init_text_buffer(INT_PARTITION_WRITE_BUFFER_SIZE);
+    }
+    while ((piece = take_piece_queue(q)) >= 0) {
+        if (q->ordered != 0) {
+            t = init_text_buffer(INT_PARTITION_WRITE_BUFFER_SIZE);
+        }
+        it = init_partition_piece_iterator(job, piece);
+        do {
+            w->num_visited++;
+            append_text_buffer_ints(t, it->x, it->num_parts, job->sep,
+                    sep_length);
+            if ((q->ordered == 0) &&
+                    (t->length >= INT_PARTITION_WRITE_BUFFER_SIZE)) {
+                write_piece_queue(q, t);
+            }
+        } while (next_int_partition(it));
+        free_int_partition_iterator(it);
+        if (q->ordered != 0) {
+            finish_piece_queue(q, piece, t);
+        }
+    }
+    if (q->ordered == 0) {
+        write_piece_queue(q, t);
+        free_text_buffer(t);
+    }
+    return NULL;
+}
+
+/**
+ * Run `work` on `num_threads` threads, handing them the pieces of
+ * `job->prefixes` through a queue writing to `stream` (which may be NULL if
+ * nothing is written); returns the number of partitions they visited.
+ */
+static long run_partition_job(partition_job * job, int num_threads,
+        FILE * stream, int ordered, void * (*work)(void *)) {
+    int i, rc;
+    long num_visited;
+    pthread_t * threads;
+    partition_worker * workers;
+    threads = (typeof(*threads) *) malloc(sizeof(*threads) * num_threads);
+    workers = (typeof(*workers) *) malloc(sizeof(*workers) * num_threads);
+    if ((threads == NULL) || (workers == NULL)) {
+        perror("out of memory");
+        exit(1);
+    }
+    job->queue = init_piece_queue(job->prefixes->length, num_threads, stream,
+            ordered);
+    for (i = 0; i < num_threads; i++) {
+        workers[i].job = job;
+        workers[i].index = i;
+        workers[i].num_visited = 0;
+        rc = pthread_create(&threads[i], NULL, work, &workers[i]);
+        if (rc != 0) {
+            fprintf(stderr, "ERROR: could not create thread %d of %d "
+                    "(error %d)\n", (i + 1), num_threads, rc);
+            exit(1);
+        }
+    }
+    num_visited = 0;
+    for (i = 0; i < num_threads; i++) {
+        pthread_join(threads[i], NULL);
+        num_visited += workers[i].num_visited;
+    }
+    free_piece_queue(job->queue);
+    free(threads);
+    free(workers);
+    return num_visited;
+}
+
+long visit_int_partitions_parallel(int n, int num_threads,
+        int_partition_visitor visit, void ** data) {
+    assert(n > 0);
+    assert(num_threads > 0);
+    long num_visited;
+    partition_job job;
+    job.n = n;
+    job.prefixes = split_int_partitions_for_threads(n, num_threads);
+    job.visit = visit;
+    job.data = data;
+    num_visited = run_partition_job(&job, num_threads, NULL, 0,
+            visit_int_partition_pieces);
+    free_i_array_csr(job.prefixes);
+    return num_visited;
+}
+
+long write_int_partitions_parallel(FILE * stream, int n, int num_threads,
+        const char * sep, int ordered) {
+    assert(n > 0);
+    assert(num_threads > 0);
+    long num_visited;
+    partition_job job;
+    job.n = n;
+    job.prefixes = split_int_partitions_for_threads(n, num_threads);
+    job.sep = sep;
+    num_visited = run_partition_job(&job, num_threads, stream, ordered,
+            write_int_partition_pieces);
+    free_i_array_csr(job.prefixes);
+    return num_visited;
+}
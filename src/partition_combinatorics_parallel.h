@@ -0,0 +1,79 @@
+/**
+ * @file        partition_combinatorics_parallel.h
+ * @authors     Jamie Oaks
+ * @package     ABACUS (Approximate BAyesian C UtilitieS)
+ * @brief       Enumerating integer partitions with several threads.
+ * @copyright   Copyright (C) 2013 Jamie Oaks.
+ *   This file is part of ABACUS.  ABACUS is free software; you can
+ *   redistribute it and/or modify it under the terms of the GNU General Public
+ *   License as published by the Free Software Foundation; either version 2 of
+ *   the License, or (at your option) any later version.
+ * 
+ *   ABACUS is distributed in the hope that it will be useful, but WITHOUT ANY
+ *   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *   FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *   details.
+ * 
+ *   You should have received a copy of the GNU General Public License along
+ *   with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PARTITION_COMBINATORICS_PARALLEL_H
+#define PARTITION_COMBINATORICS_PARALLEL_H
+
+#include <pthread.h>
+
+#include "array_utils.h"
+#include "partition_combinatorics.h"
+#include "piece_queue.h"
+
+// the pieces of work per thread; more pieces balance the threads better
+// at the cost of more locking
+#define INT_PARTITION_PIECES_PER_THREAD 64
+
+// the most partitions in a piece, which bounds the output held in memory
+// while writing in order
+#define INT_PARTITION_MAX_PIECE_SIZE 65536
+
+// the bytes of output a thread collects before writing them, when the
+// output need not be in order
+#define INT_PARTITION_WRITE_BUFFER_SIZE 65536
+
+/**
+ * Split the partitions of `n` into pieces of no more than `max_count`
+ * partitions each, where possible, and return the prefix shared by the
+ * partitions of each piece, one row per piece. The pieces are in
+ * anti-lexicographic order, so enumerating them in turn (with
+ * `init_int_partition_iterator_prefix`) visits every partition of `n` once,
+ * in the same order as `visit_int_partitions`.
+ *
+ * A piece is split by its next part until it is small enough, using the
+ * table of the number of partitions of m into parts of at most k, for all
+ * m, k <= n, which costs O(n^2) time and memory.
+ */
+i_array_csr * split_int_partitions(int n, double max_count);
+
+/**
+ * Call `visit` with each partition of `n`, using `num_threads` threads;
+ * the thread with index t (from 0) passes `data[t]` to `visit` (or NULL, if
+ * `data` is NULL), which must be safe to call from several threads at once.
+ * The partitions are visited in no particular order. After `visit` returns
+ * non-zero, the other threads stop at the end of their current pieces.
+ * Returns the number of partitions visited.
+ */
+long visit_int_partitions_parallel(int n, int num_threads,
+        int_partition_visitor visit, void ** data);
+
+/**
+ * Write each partition of `n` to `stream`, one per line with the parts
+ * separated by `sep`, using `num_threads` threads. If `ordered` is not
+ * zero, the partitions are written in the order of `visit_int_partitions`,
+ * and each thread buffers the pieces it finishes ahead of the slowest
+ * thread; otherwise, each thread writes whenever its buffer fills, which is
+ * faster but mixes the order of the partitions. Returns the number of
+ * partitions written.
+ */
+long write_int_partitions_parallel(FILE * stream, int n, int num_threads,
+        const char * sep, int ordered);
+
+#endif /* PARTITION_COMBINATORICS_PARALLEL_H */
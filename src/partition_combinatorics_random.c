@@ -30,7 +30,7 @@ int draw_int_partition_category(const gsl_rng * rng, int n) {
     double r = gsl_rng_uniform(rng);
     int i;
     for (i = 0; i < n; i++) {
-        if (r < get_d_array(cumulative_probs, i)) {
+        if (r < d_array_get(cumulative_probs, i)) {
             break;
         }
     }
@@ -38,46 +38,327 @@ int draw_int_partition_category(const gsl_rng * rng, int n) {
     return (i+1);
 }
 
+int_partition_category_sampler * init_int_partition_category_sampler(
+        int n) {
+    assert(n > 0);
+    int i, j, num_small, num_large;
+    int * small;
+    int * large;
+    double total_prob;
+    d_array * probs;
+    int_partition_category_sampler * s;
+    s = (typeof(*s) *) malloc(sizeof(*s));
+    s->n = n;
+    s->prob = (typeof(*s->prob) *) malloc(sizeof(*s->prob) * n);
+    s->alias = (typeof(*s->alias) *) malloc(sizeof(*s->alias) * n);
+    small = (typeof(*small) *) malloc(sizeof(*small) * n);
+    large = (typeof(*large) *) malloc(sizeof(*large) * n);
+    if ((s->prob == NULL) || (s->alias == NULL) || (small == NULL) ||
+            (large == NULL)) {
+        perror("out of memory");
+        exit(1);
+    }
+    probs = init_d_array(n);
+    total_prob = frequency_of_int_partitions_by_k(n, probs);
+    assert(almost_equal(total_prob, 1.0, 0.000001) != 0);
+    // scale the probabilities to a mean of 1 and split them into those
+    // that do not fill a column and those that overfill one
+    num_small = 0;
+    num_large = 0;
+    for (i = 0; i < n; i++) {
+        s->prob[i] = (get_d_array(probs, i) / total_prob) * n;
+        s->alias[i] = i;
+        if (s->prob[i] < 1.0) {
+            small[num_small++] = i;
+        }
+        else {
+            large[num_large++] = i;
+        }
+    }
+    // top up each small column with the excess of a large one
+    while ((num_small > 0) && (num_large > 0)) {
+        i = small[--num_small];
+        j = large[num_large - 1];
+        s->alias[i] = j;
+        s->prob[j] -= (1.0 - s->prob[i]);
+        if (s->prob[j] < 1.0) {
+            num_large--;
+            small[num_small++] = j;
+        }
+    }
+    // whatever is left is 1, up to rounding error
+    while (num_large > 0) {
+        s->prob[large[--num_large]] = 1.0;
+    }
+    while (num_small > 0) {
+        s->prob[small[--num_small]] = 1.0;
+    }
+    free_d_array(probs);
+    free(small);
+    free(large);
+    return s;
+}
+
+void free_int_partition_category_sampler(int_partition_category_sampler * s) {
+    free(s->prob);
+    free(s->alias);
+    free(s);
+    s = NULL;
+}
+
+int draw_int_partition_category_alias(const gsl_rng * rng,
+        const int_partition_category_sampler * s) {
+    int i;
+    double x;
+    // the integer part of x picks the column and the fraction decides
+    // between the column's category and its alias
+    x = gsl_rng_uniform(rng) * s->n;
+    i = (int) x;
+    if (i >= s->n) {
+        i = s->n - 1;
+    }
+    if ((x - i) < s->prob[i]) {
+        return (i+1);
+    }
+    return (s->alias[i] + 1);
+}
+
+int_partition_sampler * init_int_partition_sampler(int n) {
+    assert(n > 0);
+    int_partition_sampler * s;
+    s = (typeof(*s) *) malloc(sizeof(*s));
+    s->n = n;
+    s->counts = get_int_partition_count_table(n);
+    return s;
+}
+
+void free_int_partition_sampler(int_partition_sampler * s) {
+    free(s->counts);
+    free(s);
+    s = NULL;
+}
+
+/**
+ * Draw a partition of `m` into parts of at most `b` uniformly, appending
+ * its parts to `parts`.
+ */
+static void draw_int_partition_parts(const gsl_rng * rng,
+        const int_partition_sampler * s, int m, int b, i_array * parts) {
+    int stride;
+    const double * counts;
+    counts = s->counts;
+    stride = s->n + 1;
+    while (m > 0) {
+        if (b > m) {
+            b = m;
+        }
+        // p(m, <=b) = p(m - b, <=b) + p(m, <=b-1)
+        if ((gsl_rng_uniform(rng) * counts[(b * stride) + m]) <
+                counts[(b * stride) + m - b]) {
+            append_i_array(parts, b);
+            m -= b;
+        }
+        else {
+            b--;
+        }
+    }
+}
+
+int draw_int_partition(const gsl_rng * rng, const int_partition_sampler * s,
+        i_array * parts) {
+    parts->length = 0;
+    draw_int_partition_parts(rng, s, s->n, s->n, parts);
+    return parts->length;
+}
+
+void draw_int_partition_by_k(const gsl_rng * rng,
+        const int_partition_sampler * s, int k, i_array * parts) {
+    assert((k > 0) && (k <= s->n));
+    int i, j, num_parts;
+    int * conjugate;
+    conjugate = (typeof(*conjugate) *) malloc(sizeof(*conjugate) * s->n);
+    if (conjugate == NULL) {
+        perror("out of memory");
+        exit(1);
+    }
+    parts->length = 0;
+    append_i_array(parts, k);
+    draw_int_partition_parts(rng, s, (s->n - k), k, parts);
+    // part j of the conjugate is the number of parts greater than j
+    num_parts = parts->length;
+    for (i = 0; i < num_parts; i++) {
+        conjugate[i] = get_i_array(parts, i);
+    }
+    parts->length = 0;
+    i = num_parts;
+    for (j = 0; j < k; j++) {
+        while (conjugate[i - 1] <= j) {
+            i--;
+        }
+        append_i_array(parts, i);
+    }
+    free(conjugate);
+}
+
+int draw_int_partition_boltzmann(const gsl_rng * rng, int n,
+        i_array * parts) {
+    assert(n > 0);
+    int i, j, z, total;
+    int * counts;
+    double x, log_x;
+    counts = (typeof(*counts) *) malloc(sizeof(*counts) * (n + 1));
+    if (counts == NULL) {
+        perror("out of memory");
+        exit(1);
+    }
+    log_x = -M_PI / sqrt(6.0 * n);
+    x = exp(log_x);
+    while (1) {
+        total = 0;
+        for (i = 2; i <= n; i++) {
+            counts[i] = 0;
+            if (total > n) {
+                continue;
+            }
+            // P(z >= j) = x^(ij)
+            z = (int) floor(log(gsl_rng_uniform_pos(rng)) / (i * log_x));
+            counts[i] = z;
+            if (z > 0) {
+                total += (z > (n / i)) ? (n + 1) : (i * z);
+            }
+        }
+        if ((total <= n) && (gsl_rng_uniform(rng) < pow(x, (n - total)))) {
+            break;
+        }
+    }
+    counts[1] = n - total;
+    parts->length = 0;
+    for (i = n; i > 0; i--) {
+        for (j = 0; j < counts[i]; j++) {
+            append_i_array(parts, i);
+        }
+    }
+    free(counts);
+    return parts->length;
+}
+
+int draw_set_partition_by_k(const gsl_rng * rng, const set_partition_table * t,
+        int n, int k, i_array * elements) {
+    assert((n > 0) && (n <= t->n));
+    assert((k > 0) && (k <= n));
+    int m, j, num_blocks;
+    double u, p_alone;
+    i_array_clear(elements);
+    for (m = 0; m < n; m++) {
+        i_array_append(elements, 0);
+    }
+    num_blocks = k;
+    for (m = n; m > 0; m--) {
+        u = gsl_rng_uniform(rng);
+        p_alone = exp(get_log_stirling2(t, (m - 1), (k - 1)) -
+                get_log_stirling2(t, m, k));
+        if (u < p_alone) {
+            k--;
+            elements->a[m-1] = k;
+            continue;
+        }
+        // rescale u to pick a block uniformly
+        j = (int) (((u - p_alone) / (1.0 - p_alone)) * k);
+        elements->a[m-1] = (j < k) ? j : (k - 1);
+    }
+    return num_blocks;
+}
+
+int draw_set_partition(const gsl_rng * rng, const set_partition_table * t,
+        int n, i_array * elements) {
+    assert((n > 0) && (n <= t->n));
+    int k;
+    double u, log_bell;
+    log_bell = get_log_bell(t, n);
+    u = gsl_rng_uniform(rng);
+    for (k = 1; k < n; k++) {
+        u -= exp(get_log_stirling2(t, n, k) - log_bell);
+        if (u < 0.0) {
+            break;
+        }
+    }
+    return draw_set_partition_by_k(rng, t, n, k, elements);
+}
+
+/**
+ * Add `x` to the count of subset `j` in the Fenwick tree `tree`, which
+ * holds the counts of `n` subsets at indices 1, ..., n, each node summing
+ * the counts of the subsets below it.
+ */
+static void add_subset_count(int * tree, int n, int j, int x) {
+    for (j++; j <= n; j += (j & -j)) {
+        tree[j] += x;
+    }
+}
+
+/**
+ * Returns the subset of the element with rank `r` (from 0), when the
+ * elements are ordered by subset, in O(log n) steps down the Fenwick tree
+ * `tree`; `step` is the largest power of 2 no greater than `n`.
+ */
+static int find_subset(const int * tree, int n, int step, int r) {
+    int j;
+    j = 0;
+    for (; step > 0; step >>= 1) {
+        if (((j + step) <= n) && (tree[j + step] <= r)) {
+            j += step;
+            r -= tree[j];
+        }
+    }
+    return j;
+}
+
 /** 
  * A function for generating a random draw from a Dirichlet process.
  */
 int dirichlet_process_draw(const gsl_rng * rng, int n, double alpha,
         i_array * elements) {
     assert(n > 0);
-    int num_subsets;
-    double subset_prob, new_subset_prob, u;
-    i_array * subset_counts;
-    (*elements).length = 0;
-    append_i_array(elements, 0);
-    subset_counts = init_i_array(n);
-    append_i_array(subset_counts, 1);
+    int num_subsets, step, r;
+    double new_subset_prob, u;
+    int * tree;
+    i_array_clear(elements);
+    i_array_append(elements, 0);
+    // the number of elements in each subset, in a Fenwick tree, so that
+    // seating an element takes O(log n) steps rather than a scan of the
+    // subsets
+    tree = (typeof(*tree) *) calloc((n + 1), sizeof(*tree));
+    if (tree == NULL) {
+        perror("out of memory");
+        exit(1);
+    }
+    step = 1;
+    while ((step * 2) <= n) {
+        step *= 2;
+    }
+    add_subset_count(tree, n, 0, 1);
     num_subsets = 1;
-    int i, j;
+    int i;
     for (i = 1; i < n; i++) {
         new_subset_prob = (alpha / (alpha + (double)i));
         u = gsl_rng_uniform(rng);
-        u -= new_subset_prob;
-        if (u < 0.0) {
-            append_i_array(elements, num_subsets);
-            append_i_array(subset_counts, 1);
+        if (u < new_subset_prob) {
+            i_array_append(elements, num_subsets);
+            add_subset_count(tree, n, num_subsets, 1);
             num_subsets += 1;
             continue;
         }
-        for (j = 0; j < num_subsets; j++) {
-            subset_prob = ((double)subset_counts->a[j] / (alpha + (double)i));
-            u -= subset_prob;
-            if (u < 0.0) {
-                append_i_array(elements, j);
-                subset_counts->a[j] += 1;
-                break;
-            }
-        }
-        if (u > 0.0) {
-            append_i_array(elements, (num_subsets-1));
-            subset_counts->a[num_subsets-1] += 1;
+        // join an existing subset with probability proportional to its
+        // size, by the rank of a uniformly chosen earlier element
+        r = (int) (((u - new_subset_prob) / (1.0 - new_subset_prob)) * i);
+        if (r >= i) {
+            r = i - 1;
         }
+        r = find_subset(tree, n, step, r);
+        i_array_append(elements, r);
+        add_subset_count(tree, n, r, 1);
     }
-    free_i_array(subset_counts);
+    free(tree);
     return num_subsets;
 }
 
@@ -21,13 +21,116 @@
 #ifndef PARTITION_COMBINATORICS_RANDOM_H
 #define PARTITION_COMBINATORICS_RANDOM_H
 
+#include <math.h>
 #include <gsl/gsl_rng.h>
 
 #include "array_utils.h"
 #include "partition_combinatorics.h"
 
+/**
+ * An alias table (Walker's method, as built by Vose) over the number of
+ * categories of the integer partitions of `n`, for drawing categories in
+ * O(1) time. Category `i + 1` is drawn with probability `prob[i]` from
+ * column `i` and otherwise it is category `alias[i] + 1`.
+ */
+typedef struct int_partition_category_sampler_ {
+    int n;
+    double * prob;
+    int * alias;
+} int_partition_category_sampler;
+
 int draw_int_partition_category(const gsl_rng * rng, int n);
 
+/**
+ * Build the alias table for the integer partitions of `n`; this costs as
+ * much as one call to `draw_int_partition_category`, so build it once and
+ * use it for every draw.
+ */
+int_partition_category_sampler * init_int_partition_category_sampler(int n);
+void free_int_partition_category_sampler(int_partition_category_sampler * s);
+
+/**
+ * Draw the number of categories of an integer partition, with the same
+ * distribution as `draw_int_partition_category`, using one uniform variate.
+ */
+int draw_int_partition_category_alias(const gsl_rng * rng,
+        const int_partition_category_sampler * s);
+
+/**
+ * A table of the number of partitions of m into parts of at most k, for m,
+ * k <= n (see `get_int_partition_count_table`), for drawing partitions of
+ * `n` uniformly. The table takes O(n^2) time and memory to build, so build
+ * it once and use it for every draw.
+ */
+typedef struct int_partition_sampler_ {
+    int n;
+    double * counts;
+} int_partition_sampler;
+
+int_partition_sampler * init_int_partition_sampler(int n);
+void free_int_partition_sampler(int_partition_sampler * s);
+
+/**
+ * Draw a partition of `s->n` uniformly, storing its parts in `parts`,
+ * largest first; returns the number of parts. The partition is built by
+ * the recursive method, from the largest part down: with m left to
+ * partition into parts of at most b, the next part is b with probability
+ * p(m - b, <=b) / p(m, <=b), and otherwise no part is b. This takes O(n)
+ * time and uniform variates.
+ */
+int draw_int_partition(const gsl_rng * rng, const int_partition_sampler * s,
+        i_array * parts);
+
+/**
+ * Draw a partition of `s->n` into exactly `k` parts uniformly, storing its
+ * parts in `parts`, largest first. The partition is the conjugate of one
+ * with a largest part of `k`, drawn as by `draw_int_partition`.
+ */
+void draw_int_partition_by_k(const gsl_rng * rng,
+        const int_partition_sampler * s, int k, i_array * parts);
+
+/**
+ * Draw a partition of `n` uniformly, without a table, for n too large for
+ * one; returns the number of parts.
+ *
+ * This is a Boltzmann sampler with a rejection step (probabilistic
+ * divide-and-conquer; Arratia, R., and S. DeSalvo. 2016. Probabilistic
+ * divide-and-conquer: a new exact simulation method, with integer
+ * partitions as an example. Combin. Probab. Comput. 25:324--351). The
+ * number of parts of each size i > 1 is drawn independently from a
+ * geometric distribution with parameter x^i, where x = exp(-pi /
+ * sqrt(6n)); the remainder r, if any, is made up of parts of 1, which is
+ * accepted with probability x^r. Each attempt takes O(n) time and about
+ * n^(1/4) attempts are needed.
+ */
+int draw_int_partition_boltzmann(const gsl_rng * rng, int n,
+        i_array * parts);
+
+/**
+ * Draw a partition of a set of `n` elements into exactly `k` blocks
+ * uniformly, storing the block of each element in `elements`, as a
+ * restricted growth string (like `dirichlet_process_draw`); returns `k`.
+ * `t` must hold the Stirling numbers of at least `n` elements; its logs
+ * are enough.
+ *
+ * The elements are placed from the last to the first, by the recurrence
+ * S(m, k) = k S(m-1, k) + S(m-1, k-1): element m is alone in block k with
+ * probability S(m-1, k-1) / S(m, k), and otherwise joins one of the k
+ * blocks of the first m - 1 elements uniformly, where the blocks are
+ * numbered in the order of their first elements. This takes O(n) time and
+ * one uniform variate per element.
+ */
+int draw_set_partition_by_k(const gsl_rng * rng, const set_partition_table * t,
+        int n, int k, i_array * elements);
+
+/**
+ * Draw a partition of a set of `n` elements uniformly, by drawing its
+ * number of blocks k with probability S(n, k) / B(n) and then drawing a
+ * partition into k blocks with `draw_set_partition_by_k`; returns k.
+ */
+int draw_set_partition(const gsl_rng * rng, const set_partition_table * t,
+        int n, i_array * elements);
+
 /** 
  * A function for generating a random draw from a Dirichlet process.
  *
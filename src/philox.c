@@ -0,0 +1,112 @@
+/**
+ * @file        philox.c
+ * @authors     Jamie Oaks
+ * @package     ABACUS (Approximate BAyesian C UtilitieS)
+ * @brief       A counter-based random number generator for GSL.
+ * @copyright   Copyright (C) 2013 Jamie Oaks.
+ *   This file is part of ABACUS.  ABACUS is free software; you can
+ *   redistribute it and/or modify it under the terms of the GNU General Public
+ *   License as published by the Free Software Foundation; either version 2 of
+ *   the License, or (at your option) any later version.
+ * 
+ *   ABACUS is distributed in the hope that it will be useful, but WITHOUT ANY
+ *   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *   FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *   details.
+ * 
+ *   You should have received a copy of the GNU General Public License along
+ *   with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "philox.h"
+
+#define PHILOX_M0 0xD2511F53U
+#define PHILOX_M1 0xCD9E8D57U
+#define PHILOX_W0 0x9E3779B9U
+#define PHILOX_W1 0xBB67AE85U
+
+/**
+ * The counter and key of a generator, and the block of numbers from the
+ * last counter, of which `index` have been used.
+ */
+typedef struct philox_state_ {
+    uint32_t key[2];
+    uint32_t counter[4];
+    uint32_t block[4];
+    int index;
+} philox_state;
+
+void philox4x32_10(const uint32_t * counter, const uint32_t * key,
+        uint32_t * out) {
+    int i;
+    uint32_t k0, k1, x0, x1, x2, x3;
+    uint64_t p0, p1;
+    k0 = key[0];
+    k1 = key[1];
+    x0 = counter[0];
+    x1 = counter[1];
+    x2 = counter[2];
+    x3 = counter[3];
+    for (i = 0; i < 10; i++) {
+        p0 = (uint64_t) PHILOX_M0 * x0;
+        p1 = (uint64_t) PHILOX_M1 * x2;
+        x0 = ((uint32_t) (p1 >> 32)) ^ x1 ^ k0;
+        x1 = (uint32_t) p1;
+        x2 = ((uint32_t) (p0 >> 32)) ^ x3 ^ k1;
+        x3 = (uint32_t) p0;
+        k0 += PHILOX_W0;
+        k1 += PHILOX_W1;
+    }
+    out[0] = x0;
+    out[1] = x1;
+    out[2] = x2;
+    out[3] = x3;
+}
+
+static void philox_set_stream(philox_state * s, uint64_t seed,
+        uint64_t stream) {
+    s->key[0] = (uint32_t) seed;
+    s->key[1] = (uint32_t) (seed >> 32);
+    s->counter[0] = 0;
+    s->counter[1] = 0;
+    s->counter[2] = (uint32_t) stream;
+    s->counter[3] = (uint32_t) (stream >> 32);
+    s->index = 4;
+}
+
+static void philox_set(void * vstate, unsigned long int seed) {
+    philox_set_stream((philox_state *) vstate, (uint64_t) seed, 0);
+}
+
+static unsigned long int philox_get(void * vstate) {
+    philox_state * s = (philox_state *) vstate;
+    if (s->index == 4) {
+        philox4x32_10(s->counter, s->key, s->block);
+        s->index = 0;
+        if (++s->counter[0] == 0) {
+            s->counter[1]++;
+        }
+    }
+    return s->block[s->index++];
+}
+
+static double philox_get_double(void * vstate) {
+    return philox_get(vstate) / 4294967296.0;
+}
+
+static const gsl_rng_type philox_type = {
+    "philox4x32-10",
+    0xffffffffUL,
+    0,
+    sizeof(philox_state),
+    &philox_set,
+    &philox_get,
+    &philox_get_double
+};
+
+const gsl_rng_type * philox_rng_type = &philox_type;
+
+void set_philox_stream(const gsl_rng * rng, uint64_t seed, uint64_t stream) {
+    assert(rng->type == philox_rng_type);
+    philox_set_stream((philox_state *) rng->state, seed, stream);
+}
@@ -0,0 +1,51 @@
+/**
+ * @file        philox.h
+ * @authors     Jamie Oaks
+ * @package     ABACUS (Approximate BAyesian C UtilitieS)
+ * @brief       A counter-based random number generator for GSL.
+ * @copyright   Copyright (C) 2013 Jamie Oaks.
+ *   This file is part of ABACUS.  ABACUS is free software; you can
+ *   redistribute it and/or modify it under the terms of the GNU General Public
+ *   License as published by the Free Software Foundation; either version 2 of
+ *   the License, or (at your option) any later version.
+ * 
+ *   ABACUS is distributed in the hope that it will be useful, but WITHOUT ANY
+ *   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *   FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *   details.
+ * 
+ *   You should have received a copy of the GNU General Public License along
+ *   with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PHILOX_H
+#define PHILOX_H
+
+#include <stdint.h>
+#include <assert.h>
+#include <gsl/gsl_rng.h>
+
+/**
+ * Philox4x32-10 (Salmon et al. 2011), as a GSL generator type. The output
+ * is the encryption of a counter under a key; the key is the seed, and the
+ * counter holds a stream number and the index of the next block of four
+ * numbers in that stream. So, unlike mt19937, any stream of any seed can be
+ * started in O(1) time, and the streams of a seed do not overlap (each has
+ * 2^64 blocks). `gsl_rng_set` selects stream 0 of a seed.
+ */
+extern const gsl_rng_type * philox_rng_type;
+
+/**
+ * Encrypt `counter` under `key` with ten rounds of Philox4x32, storing the
+ * four numbers in `out`.
+ */
+void philox4x32_10(const uint32_t * counter, const uint32_t * key,
+        uint32_t * out);
+
+/**
+ * Restart `rng`, which must be of `philox_rng_type`, at the beginning of
+ * stream `stream` of seed `seed`.
+ */
+void set_philox_stream(const gsl_rng * rng, uint64_t seed, uint64_t stream);
+
+#endif /* PHILOX_H */
@@ -0,0 +1,156 @@
+/**
+ * @file        piece_queue.c
+ * @authors     Jamie Oaks
+ * @package     ABACUS (Approximate BAyesian C UtilitieS)
+ * @brief       Handing pieces of work to threads and writing their output.
+ * @copyright   Copyright (C) 2013 Jamie Oaks.
+ *   This file is part of ABACUS.  ABACUS is free software; you can
+ *   redistribute it and/or modify it under the terms of the GNU General Public
+ *   License as published by the Free Software Foundation; either version 2 of
+ *   the License, or (at your option) any later version.
+ * 
+ *   ABACUS is distributed in the hope that it will be useful, but WITHOUT ANY
+ *   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *   FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *   details.
+ * 
+ *   You should have received a copy of the GNU General Public License along
+ *   with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "piece_queue.h"
+
+text_buffer * init_text_buffer(size_t capacity) {
+    text_buffer * t;
+    t = (typeof(*t) *) malloc(sizeof(*t));
+    t->length = 0;
+    t->capacity = capacity;
+    t->a = (typeof(*t->a) *) malloc(sizeof(*t->a) * t->capacity);
+    if (t->a == NULL) {
+        perror("out of memory");
+        exit(1);
+    }
+    return t;
+}
+
+void free_text_buffer(text_buffer * t) {
+    free(t->a);
+    free(t);
+    t = NULL;
+}
+
+void append_text_buffer_ints(text_buffer * t, const int * x, int length,
+        const char * sep, size_t sep_length) {
+    int i, num_digits;
+    unsigned int y;
+    char digits[16];
+    // at most 10 digits and a separator per integer
+    if ((t->length + (length * (10 + sep_length)) + 1) > t->capacity) {
+        t->capacity = (t->capacity * 2) + (length * (10 + sep_length)) + 1;
+        t->a = (typeof(*t->a) *) realloc(t->a, sizeof(*t->a) * t->capacity);
+        if (t->a == NULL) {
+            perror("out of memory");
+            exit(1);
+        }
+    }
+    for (i = 0; i < length; i++) {
+        y = (unsigned int) x[i];
+        num_digits = 0;
+        do {
+            digits[num_digits++] = '0' + (y % 10);
+            y /= 10;
+        } while (y > 0);
+        while (num_digits > 0) {
+            t->a[t->length++] = digits[--num_digits];
+        }
+        if (i < (length - 1)) {
+            memcpy((t->a + t->length), sep, sep_length);
+            t->length += sep_length;
+        }
+    }
+    t->a[t->length++] = '\n';
+}
+
+piece_queue * init_piece_queue(int num_pieces, int num_threads,
+        FILE * stream, int ordered) {
+    piece_queue * q;
+    assert(num_pieces >= 0);
+    assert(num_threads > 0);
+    q = (typeof(*q) *) malloc(sizeof(*q));
+    q->num_pieces = num_pieces;
+    q->num_threads = num_threads;
+    q->next_piece = 0;
+    q->stop = 0;
+    q->ordered = ordered;
+    q->num_written = 0;
+    q->stream = stream;
+    q->done = (typeof(*q->done) *) calloc(((num_pieces > 0) ? num_pieces :
+            1), sizeof(*q->done));
+    if (q->done == NULL) {
+        perror("out of memory");
+        exit(1);
+    }
+    pthread_mutex_init(&q->lock, NULL);
+    pthread_cond_init(&q->written, NULL);
+    return q;
+}
+
+void free_piece_queue(piece_queue * q) {
+    int i;
+    for (i = 0; i < q->num_pieces; i++) {
+        if (q->done[i] != NULL) {
+            free_text_buffer(q->done[i]);
+        }
+    }
+    free(q->done);
+    pthread_mutex_destroy(&q->lock);
+    pthread_cond_destroy(&q->written);
+    free(q);
+    q = NULL;
+}
+
+int take_piece_queue(piece_queue * q) {
+    int piece;
+    pthread_mutex_lock(&q->lock);
+    while ((q->ordered != 0) && (q->stop == 0) &&
+            (q->next_piece < q->num_pieces) &&
+            (q->next_piece >= (q->num_written + (2 * q->num_threads)))) {
+        pthread_cond_wait(&q->written, &q->lock);
+    }
+    piece = -1;
+    if ((q->stop == 0) && (q->next_piece < q->num_pieces)) {
+        piece = q->next_piece++;
+    }
+    pthread_mutex_unlock(&q->lock);
+    return piece;
+}
+
+void finish_piece_queue(piece_queue * q, int piece, text_buffer * t) {
+    assert(q->ordered != 0);
+    assert((piece >= 0) && (piece < q->num_pieces));
+    pthread_mutex_lock(&q->lock);
+    q->done[piece] = t;
+    while ((q->num_written < q->num_pieces) &&
+            (q->done[q->num_written] != NULL)) {
+        t = q->done[q->num_written];
+        fwrite(t->a, sizeof(*t->a), t->length, q->stream);
+        free_text_buffer(t);
+        q->done[q->num_written++] = NULL;
+    }
+    pthread_cond_broadcast(&q->written);
+    pthread_mutex_unlock(&q->lock);
+}
+
+void write_piece_queue(piece_queue * q, text_buffer * t) {
+    pthread_mutex_lock(&q->lock);
+    fwrite(t->a, sizeof(*t->a), t->length, q->stream);
+    pthread_mutex_unlock(&q->lock);
+    t->length = 0;
+}
+
+void stop_piece_queue(piece_queue * q) {
+    pthread_mutex_lock(&q->lock);
+    q->stop = 1;
+    pthread_cond_broadcast(&q->written);
+    pthread_mutex_unlock(&q->lock);
+}
@@ -0,0 +1,99 @@
+/**
+ * @file        piece_queue.h
+ * @authors     Jamie Oaks
+ * @package     ABACUS (Approximate BAyesian C UtilitieS)
+ * @brief       Handing pieces of work to threads and writing their output.
+ * @copyright   Copyright (C) 2013 Jamie Oaks.
+ *   This file is part of ABACUS.  ABACUS is free software; you can
+ *   redistribute it and/or modify it under the terms of the GNU General Public
+ *   License as published by the Free Software Foundation; either version 2 of
+ *   the License, or (at your option) any later version.
+ * 
+ *   ABACUS is distributed in the hope that it will be useful, but WITHOUT ANY
+ *   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *   FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *   details.
+ * 
+ *   You should have received a copy of the GNU General Public License along
+ *   with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PIECE_QUEUE_H
+#define PIECE_QUEUE_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <pthread.h>
+
+/**
+ * Text written by a thread, not yet passed to the stream.
+ */
+typedef struct text_buffer_ {
+    char * a;
+    size_t length;
+    size_t capacity;
+} text_buffer;
+
+/**
+ * The pieces `0`, ..., `num_pieces - 1` of a job shared by `num_threads`
+ * threads, which take them in order. If `ordered` is not zero, the text of
+ * each finished piece is written to `stream` once all of the pieces before
+ * it are, and a piece is only handed out when it is within twice the number
+ * of threads of the next piece to be written, so that the text held in
+ * memory is bounded. `lock` guards `next_piece`, `stop`, `num_written`,
+ * `done` and the stream.
+ */
+typedef struct piece_queue_ {
+    int num_pieces;
+    int num_threads;
+    int next_piece;
+    int stop;
+    int ordered;
+    int num_written;
+    FILE * stream;
+    text_buffer ** done;
+    pthread_mutex_t lock;
+    pthread_cond_t written;
+} piece_queue;
+
+text_buffer * init_text_buffer(size_t capacity);
+void free_text_buffer(text_buffer * t);
+
+/**
+ * Append a line with the `length` non-negative integers of `x`, separated
+ * by the `sep_length` characters of `sep`, to `t`.
+ */
+void append_text_buffer_ints(text_buffer * t, const int * x, int length,
+        const char * sep, size_t sep_length);
+
+piece_queue * init_piece_queue(int num_pieces, int num_threads,
+        FILE * stream, int ordered);
+void free_piece_queue(piece_queue * q);
+
+/**
+ * Take the next piece, or return -1 if there are none left or the queue
+ * was stopped.
+ */
+int take_piece_queue(piece_queue * q);
+
+/**
+ * Hand over the text `t` of the finished piece `piece` of an ordered queue;
+ * it is written, and freed, along with any pieces after it that were
+ * waiting for it, once the pieces before it are written.
+ */
+void finish_piece_queue(piece_queue * q, int piece, text_buffer * t);
+
+/**
+ * Write the text `t` to the stream of an unordered queue straight away, and
+ * empty it.
+ */
+void write_piece_queue(piece_queue * q, text_buffer * t);
+
+/**
+ * Stop handing out pieces.
+ */
+void stop_piece_queue(piece_queue * q);
+
+#endif /* PIECE_QUEUE_H */
@@ -0,0 +1,140 @@
+/**
+ * @file        run_stats.c
+ * @authors     Jamie Oaks
+ * @package     ABACUS (Approximate BAyesian C UtilitieS)
+ * @brief       Timers and counters for the phases of a run.
+ * @copyright   Copyright (C) 2013 Jamie Oaks.
+ *   This file is part of ABACUS.  ABACUS is free software; you can
+ *   redistribute it and/or modify it under the terms of the GNU General Public
+ *   License as published by the Free Software Foundation; either version 2 of
+ *   the License, or (at your option) any later version.
+ * 
+ *   ABACUS is distributed in the hope that it will be useful, but WITHOUT ANY
+ *   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *   FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *   details.
+ * 
+ *   You should have received a copy of the GNU General Public License along
+ *   with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "run_stats.h"
+
+double get_monotonic_time() {
+    struct timespec t;
+    if (clock_gettime(CLOCK_MONOTONIC, &t) != 0) {
+        perror("clock_gettime");
+        exit(1);
+    }
+    return t.tv_sec + (t.tv_nsec / 1e9);
+}
+
+long get_peak_rss() {
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return -1;
+    }
+#ifdef __APPLE__
+    // reported in bytes rather than kilobytes
+    return usage.ru_maxrss / 1024;
+#else
+    return usage.ru_maxrss;
+#endif
+}
+
+run_stats * init_run_stats(const char ** names, int num_phases) {
+    assert(num_phases > 0);
+    int i;
+    run_stats * r;
+    r = (typeof(*r) *) malloc(sizeof(*r));
+    if ((r->a = (typeof(*r->a) *) calloc(num_phases,
+            sizeof(*r->a))) == NULL) {
+        perror("out of memory");
+        exit(1);
+    }
+    r->length = num_phases;
+    for (i = 0; i < r->length; i++) {
+        r->a[i].name = names[i];
+    }
+    r->current = -1;
+    r->start_time = get_monotonic_time();
+    r->phase_start_time = r->start_time;
+    return r;
+}
+
+void free_run_stats(run_stats * r) {
+    free(r->a);
+    free(r);
+    r = NULL;
+}
+
+run_phase * get_run_phase(run_stats * r, int index) {
+    assert((index >= 0) && (index < r->length));
+    return &r->a[index];
+}
+
+void start_run_phase(run_stats * r, int index) {
+    assert((index >= 0) && (index < r->length));
+    stop_run_phase(r);
+    r->current = index;
+    r->a[index].used = 1;
+    r->phase_start_time = get_monotonic_time();
+}
+
+void stop_run_phase(run_stats * r) {
+    if (r->current < 0) {
+        return;
+    }
+    r->a[r->current].seconds += get_monotonic_time() - r->phase_start_time;
+    r->a[r->current].peak_rss = get_peak_rss();
+    r->current = -1;
+}
+
+double get_run_seconds(const run_stats * r) {
+    return get_monotonic_time() - r->start_time;
+}
+
+static double get_rows_per_second(const run_phase * p) {
+    if (p->seconds <= 0.0) {
+        return 0.0;
+    }
+    return p->num_rows / p->seconds;
+}
+
+void write_run_stats(FILE * stream, const run_stats * r) {
+    int i;
+    const run_phase * p;
+    fprintf(stream, "phase\tseconds\tbytes_read\trows\trows_per_second\t"
+            "parse_errors\tadmitted\tpeak_rss_kb\n");
+    for (i = 0; i < r->length; i++) {
+        p = &r->a[i];
+        if (p->used == 0) continue;
+        fprintf(stream, "%s\t%.6lf\t%ld\t%ld\t%.1lf\t%ld\t%ld\t%ld\n",
+                p->name, p->seconds, p->bytes_read, p->num_rows,
+                get_rows_per_second(p), p->num_parse_errors, p->num_admitted,
+                p->peak_rss);
+    }
+    fprintf(stream, "Total run time (seconds): %.6lf\n", get_run_seconds(r));
+    fprintf(stream, "Peak resident set size (KB): %ld\n", get_peak_rss());
+}
+
+void write_run_stats_json(FILE * stream, const run_stats * r) {
+    int i, n;
+    const run_phase * p;
+    fprintf(stream, "{\n  \"seconds\": %.6lf,\n  \"peak_rss_kb\": %ld,\n"
+            "  \"phases\": [", get_run_seconds(r), get_peak_rss());
+    n = 0;
+    for (i = 0; i < r->length; i++) {
+        p = &r->a[i];
+        if (p->used == 0) continue;
+        fprintf(stream, "%s\n    {\"name\": \"%s\", \"seconds\": %.6lf, "
+                "\"bytes_read\": %ld, \"rows\": %ld, "
+                "\"rows_per_second\": %.1lf, \"parse_errors\": %ld, "
+                "\"admitted\": %ld, \"peak_rss_kb\": %ld}",
+                ((n > 0) ? "," : ""), p->name, p->seconds, p->bytes_read,
+                p->num_rows, get_rows_per_second(p), p->num_parse_errors,
+                p->num_admitted, p->peak_rss);
+        n++;
+    }
+    fprintf(stream, "\n  ]\n}\n");
+}
@@ -0,0 +1,87 @@
+/**
+ * @file        run_stats.h
+ * @authors     Jamie Oaks
+ * @package     ABACUS (Approximate BAyesian C UtilitieS)
+ * @brief       Timers and counters for the phases of a run.
+ * @copyright   Copyright (C) 2013 Jamie Oaks.
+ *   This file is part of ABACUS.  ABACUS is free software; you can
+ *   redistribute it and/or modify it under the terms of the GNU General Public
+ *   License as published by the Free Software Foundation; either version 2 of
+ *   the License, or (at your option) any later version.
+ * 
+ *   ABACUS is distributed in the hope that it will be useful, but WITHOUT ANY
+ *   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *   FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *   details.
+ * 
+ *   You should have received a copy of the GNU General Public License along
+ *   with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RUN_STATS_H
+#define RUN_STATS_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <time.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+
+/**
+ * The time spent in one phase of a run, and what was done in it: the bytes
+ * read from input files, the rows whose stats were parsed (or whose distances
+ * were calculated), the rows with stats that could not be parsed, and the
+ * rows admitted to the set of retained samples (including those that were
+ * later displaced by nearer ones). `peak_rss` is the peak resident set size
+ * of the process (in kilobytes) when the phase ended.
+ */
+typedef struct run_phase_ {
+    const char * name;
+    int used;
+    double seconds;
+    long bytes_read;
+    long num_rows;
+    long num_parse_errors;
+    long num_admitted;
+    long peak_rss;
+} run_phase;
+
+typedef struct run_stats_ {
+    run_phase * a;
+    int length;
+    int current;
+    double start_time;
+    double phase_start_time;
+} run_stats;
+
+/**
+ * Seconds elapsed on a monotonic clock since an arbitrary starting point.
+ */
+double get_monotonic_time();
+
+/**
+ * The peak resident set size of the process in kilobytes, or -1 if it is not
+ * available.
+ */
+long get_peak_rss();
+
+/**
+ * Create timers for the phases named in `names`, in the order they are
+ * reported; the names are borrowed. The run is timed from this call.
+ */
+run_stats * init_run_stats(const char ** names, int num_phases);
+void free_run_stats(run_stats * r);
+run_phase * get_run_phase(run_stats * r, int index);
+
+/**
+ * Start timing phase `index`, ending the phase being timed, if any. A phase
+ * can be started more than once; its times accumulate.
+ */
+void start_run_phase(run_stats * r, int index);
+void stop_run_phase(run_stats * r);
+double get_run_seconds(const run_stats * r);
+void write_run_stats(FILE * stream, const run_stats * r);
+void write_run_stats_json(FILE * stream, const run_stats * r);
+
+#endif /* RUN_STATS_H */
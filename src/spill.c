@@ -0,0 +1,291 @@
+/**
+ * @file        spill.c
+ * @authors     Jamie Oaks
+ * @package     ABACUS (Approximate BAyesian C UtilitieS)
+ * @brief       Selection of the nearest samples within a fixed memory budget,
+ *              spilling sorted runs of candidates to a temporary file.
+ * @copyright   Copyright (C) 2013 Jamie Oaks.
+ *   This file is part of ABACUS.  ABACUS is free software; you can
+ *   redistribute it and/or modify it under the terms of the GNU General Public
+ *   License as published by the Free Software Foundation; either version 2 of
+ *   the License, or (at your option) any later version.
+ * 
+ *   ABACUS is distributed in the hope that it will be useful, but WITHOUT ANY
+ *   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *   FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *   details.
+ * 
+ *   You should have received a copy of the GNU General Public License along
+ *   with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "spill.h"
+
+spill_topk * init_spill_topk(int num_retain, size_t memory_budget) {
+    assert(num_retain > 0);
+    spill_topk * t;
+    t = (typeof(*t) *) malloc(sizeof(*t));
+    t->capacity = memory_budget / sizeof(*t->a);
+    if (t->capacity < 1) {
+        fprintf(stderr, "ERROR: init_spill_topk: memory budget of %lu bytes "
+                "is too small\n", (unsigned long) memory_budget);
+        exit(1);
+    }
+    if ((t->a = (typeof(*t->a) *) calloc(t->capacity,
+            sizeof(*t->a))) == NULL) {
+        perror("out of memory");
+        exit(1);
+    }
+    t->length = 0;
+    t->num_retain = num_retain;
+    t->num_offered = 0;
+    t->num_emitted = 0;
+    t->position = 0;
+    t->threshold = HUGE_VAL;
+    t->runs_stream = NULL;
+    t->runs = NULL;
+    t->num_runs = 0;
+    t->runs_capacity = 0;
+    t->block_capacity = 0;
+    t->heap = NULL;
+    t->heap_length = 0;
+    return t;
+}
+
+void free_spill_topk(spill_topk * t) {
+    int i;
+    for (i = 0; i < t->num_runs; i++) {
+        free(t->runs[i].block);
+    }
+    free(t->runs);
+    free(t->heap);
+    if (t->runs_stream != NULL) {
+        fclose(t->runs_stream);
+    }
+    free(t->a);
+    free(t);
+    t = NULL;
+}
+
+int spill_candidate_precedes(const spill_candidate * x,
+        const spill_candidate * y) {
+    if (x->distance != y->distance) {
+        return (x->distance < y->distance);
+    }
+    return (x->rank < y->rank);
+}
+
+static int compare_spill_candidates(const void * x, const void * y) {
+    const spill_candidate * a = (const spill_candidate *) x;
+    const spill_candidate * b = (const spill_candidate *) y;
+    if (spill_candidate_precedes(a, b)) return -1;
+    if (spill_candidate_precedes(b, a)) return 1;
+    return 0;
+}
+
+static void write_spill_run(spill_topk * t, int length) {
+    spill_run * r;
+    if (t->runs_stream == NULL) {
+        if ((t->runs_stream = tmpfile()) == NULL) {
+            perror("tmpfile");
+            exit(1);
+        }
+    }
+    if (t->num_runs >= t->runs_capacity) {
+        t->runs_capacity = (t->runs_capacity < 1) ? 8 : (t->runs_capacity * 2);
+        if ((t->runs = (typeof(*t->runs) *) realloc(t->runs,
+                (t->runs_capacity * sizeof(*t->runs)))) == NULL) {
+            perror("out of memory");
+            exit(1);
+        }
+    }
+    r = &t->runs[t->num_runs];
+    fseek(t->runs_stream, 0, SEEK_END);
+    r->start = ftell(t->runs_stream);
+    r->length = length;
+    r->next = 0;
+    r->block = NULL;
+    r->block_length = 0;
+    r->block_position = 0;
+    if (fwrite(t->a, sizeof(*t->a), length, t->runs_stream) !=
+            (size_t) length) {
+        perror("could not write to temporary file");
+        exit(1);
+    }
+    t->num_runs++;
+}
+
+/**
+ * Sort the buffer and make room in it, either by truncating it to the
+ * candidates that can still be retained or by spilling them as a run.
+ */
+static void compact_spill_topk(spill_topk * t) {
+    int keep;
+    qsort(t->a, t->length, sizeof(*t->a), compare_spill_candidates);
+    keep = t->length;
+    if (keep >= t->num_retain) {
+        keep = t->num_retain;
+        if (t->a[keep - 1].distance < t->threshold) {
+            t->threshold = t->a[keep - 1].distance;
+        }
+    }
+    if (keep <= (t->capacity / 2)) {
+        t->length = keep;
+        return;
+    }
+    write_spill_run(t, keep);
+    t->length = 0;
+}
+
+int push_spill_topk(spill_topk * t, double distance, const row_ref * ref) {
+    spill_candidate * c;
+    int rank;
+    rank = t->num_offered;
+    t->num_offered++;
+    // an earlier set of num_retain candidates are all at least this close,
+    // and they win ties on rank
+    if (distance >= t->threshold) {
+        return 0;
+    }
+    if (t->length >= t->capacity) {
+        compact_spill_topk(t);
+        if (distance >= t->threshold) {
+            return 0;
+        }
+    }
+    c = &t->a[t->length];
+    c->distance = distance;
+    c->rank = rank;
+    c->ref = *ref;
+    t->length++;
+    return 1;
+}
+
+/**
+ * Return the head of run `r`, reading its next block if needed, or NULL if
+ * the run is exhausted.
+ */
+static spill_candidate * get_spill_run_head(spill_topk * t, spill_run * r) {
+    int n;
+    if (r->block_position < r->block_length) {
+        return &r->block[r->block_position];
+    }
+    if (r->next >= r->length) {
+        return NULL;
+    }
+    n = r->length - r->next;
+    if (n > t->block_capacity) {
+        n = t->block_capacity;
+    }
+    if ((fseek(t->runs_stream, (r->start + ((long) r->next *
+            sizeof(*r->block))), SEEK_SET) != 0) ||
+            (fread(r->block, sizeof(*r->block), n, t->runs_stream) !=
+                    (size_t) n)) {
+        perror("could not read from temporary file");
+        exit(1);
+    }
+    r->next += n;
+    r->block_length = n;
+    r->block_position = 0;
+    return r->block;
+}
+
+static int spill_run_precedes(const spill_topk * t, int x, int y) {
+    const spill_run * a = &t->runs[x];
+    const spill_run * b = &t->runs[y];
+    return spill_candidate_precedes(&a->block[a->block_position],
+            &b->block[b->block_position]);
+}
+
+/**
+ * Move the run at `position` of the heap down until its head precedes the
+ * heads of its children.
+ */
+static void sift_down_spill_heap(spill_topk * t, int position) {
+    int child, r;
+    r = t->heap[position];
+    while ((child = (2 * position) + 1) < t->heap_length) {
+        if (((child + 1) < t->heap_length) &&
+                spill_run_precedes(t, t->heap[child + 1], t->heap[child])) {
+            child++;
+        }
+        if (!spill_run_precedes(t, t->heap[child], r)) {
+            break;
+        }
+        t->heap[position] = t->heap[child];
+        position = child;
+    }
+    t->heap[position] = r;
+}
+
+void finish_spill_topk(spill_topk * t) {
+    int i;
+    qsort(t->a, t->length, sizeof(*t->a), compare_spill_candidates);
+    if (t->length > t->num_retain) {
+        t->length = t->num_retain;
+    }
+    if (t->num_runs == 0) {
+        return;
+    }
+    if (t->length > 0) {
+        write_spill_run(t, t->length);
+        t->length = 0;
+    }
+    // share the buffer's budget among the blocks the runs are merged from
+    t->block_capacity = t->capacity / t->num_runs;
+    if (t->block_capacity < 1) {
+        t->block_capacity = 1;
+    }
+    free(t->a);
+    t->a = NULL;
+    for (i = 0; i < t->num_runs; i++) {
+        if ((t->runs[i].block = (typeof(*t->runs[i].block) *) calloc(
+                t->block_capacity, sizeof(*t->runs[i].block))) == NULL) {
+            perror("out of memory");
+            exit(1);
+        }
+    }
+    if ((t->heap = (typeof(*t->heap) *) malloc(t->num_runs *
+            sizeof(*t->heap))) == NULL) {
+        perror("out of memory");
+        exit(1);
+    }
+    for (i = 0; i < t->num_runs; i++) {
+        if (get_spill_run_head(t, &t->runs[i]) != NULL) {
+            t->heap[t->heap_length++] = i;
+        }
+    }
+    for (i = (t->heap_length / 2) - 1; i >= 0; i--) {
+        sift_down_spill_heap(t, i);
+    }
+}
+
+int next_spill_topk(spill_topk * t, spill_candidate * c) {
+    spill_run * r;
+    if (t->num_emitted >= t->num_retain) {
+        return 0;
+    }
+    if (t->num_runs == 0) {
+        if (t->position >= t->length) {
+            return 0;
+        }
+        *c = t->a[t->position];
+        t->position++;
+        t->num_emitted++;
+        return 1;
+    }
+    if (t->heap_length < 1) {
+        return 0;
+    }
+    r = &t->runs[t->heap[0]];
+    *c = r->block[r->block_position];
+    r->block_position++;
+    if (get_spill_run_head(t, r) == NULL) {
+        t->heap[0] = t->heap[--t->heap_length];
+    }
+    if (t->heap_length > 0) {
+        sift_down_spill_heap(t, 0);
+    }
+    t->num_emitted++;
+    return 1;
+}
@@ -0,0 +1,113 @@
+/**
+ * @file        spill.h
+ * @authors     Jamie Oaks
+ * @package     ABACUS (Approximate BAyesian C UtilitieS)
+ * @brief       Selection of the nearest samples within a fixed memory budget,
+ *              spilling sorted runs of candidates to a temporary file.
+ * @copyright   Copyright (C) 2013 Jamie Oaks.
+ *   This file is part of ABACUS.  ABACUS is free software; you can
+ *   redistribute it and/or modify it under the terms of the GNU General Public
+ *   License as published by the Free Software Foundation; either version 2 of
+ *   the License, or (at your option) any later version.
+ * 
+ *   ABACUS is distributed in the hope that it will be useful, but WITHOUT ANY
+ *   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *   FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *   details.
+ * 
+ *   You should have received a copy of the GNU General Public License along
+ *   with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SPILL_H
+#define SPILL_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <assert.h>
+
+#include "stat_table.h"
+
+/**
+ * A sample that may be retained: its distance, its position among all of the
+ * samples offered (used to break ties the way `process_sample` does), and
+ * where to find it in the simulation files.
+ */
+typedef struct spill_candidate_ {
+    double distance;
+    int rank;
+    row_ref ref;
+} spill_candidate;
+
+typedef struct spill_run_ {
+    long start;
+    int length;
+    int next;
+    spill_candidate * block;
+    int block_length;
+    int block_position;
+} spill_run;
+
+/**
+ * The `num_retain` nearest of all the candidates offered, kept in at most
+ * `capacity` candidates of memory.
+ *
+ * Candidates are buffered until the buffer is full; the buffer is then
+ * sorted and, if `num_retain` is small relative to the buffer, truncated in
+ * place. Otherwise its best `num_retain` candidates are written to
+ * `runs_stream` as a sorted run and the buffer is emptied. Once a buffer of
+ * at least `num_retain` candidates has been sorted, the distance of the last
+ * one retained is a bound beyond which later candidates are discarded
+ * without being buffered. The runs are merged as the candidates are read
+ * back with `next_spill_topk`, through `heap`, a binary min-heap of the
+ * `heap_length` runs that are not yet exhausted, keyed by their heads.
+ */
+typedef struct spill_topk_ {
+    spill_candidate * a;
+    int length;
+    int capacity;
+    int num_retain;
+    int num_offered;
+    int num_emitted;
+    int position;
+    double threshold;
+    FILE * runs_stream;
+    spill_run * runs;
+    int num_runs;
+    int runs_capacity;
+    int block_capacity;
+    int * heap;
+    int heap_length;
+} spill_topk;
+
+/**
+ * Create a selector of the `num_retain` nearest candidates that buffers at
+ * most `memory_budget` bytes of candidates.
+ */
+spill_topk * init_spill_topk(int num_retain, size_t memory_budget);
+void free_spill_topk(spill_topk * t);
+int spill_candidate_precedes(const spill_candidate * x,
+        const spill_candidate * y);
+
+/**
+ * Offer a candidate; returns 1 if it was buffered and 0 if it was discarded.
+ * Candidates must be offered in the order used to break distance ties.
+ */
+int push_spill_topk(spill_topk * t, double distance, const row_ref * ref);
+
+/**
+ * Finish offering candidates and prepare to read back the retained ones.
+ */
+void finish_spill_topk(spill_topk * t);
+
+/**
+ * Read the next nearest retained candidate into `c`.
+ *
+ * @return
+ *   1 if a candidate was read, or 0 once all the retained candidates have
+ *   been read.
+ */
+int next_spill_topk(spill_topk * t, spill_candidate * c);
+
+#endif /* SPILL_H */
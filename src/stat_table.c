@@ -0,0 +1,654 @@
+/**
+ * @file        stat_table.c
+ * @authors     Jamie Oaks
+ * @package     ABACUS (Approximate BAyesian C UtilitieS)
+ * @brief       An in-memory, indexable table of standardized summary
+ *              statistics.
+ * @copyright   Copyright (C) 2013 Jamie Oaks.
+ *   This file is part of ABACUS.  ABACUS is free software; you can
+ *   redistribute it and/or modify it under the terms of the GNU General Public
+ *   License as published by the Free Software Foundation; either version 2 of
+ *   the License, or (at your option) any later version.
+ * 
+ *   ABACUS is distributed in the hope that it will be useful, but WITHOUT ANY
+ *   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *   FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *   details.
+ * 
+ *   You should have received a copy of the GNU General Public License along
+ *   with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "stat_table.h"
+
+stat_table * init_stat_table(const s_array * header,
+        const s_array * stat_names,
+        const d_array * means,
+        const d_array * std_devs,
+        const i_array * sample_sizes) {
+    assert(stat_names->length > 0);
+    stat_table * t;
+    t = (typeof(*t) *) malloc(sizeof(*t));
+    t->num_rows = 0;
+    t->num_stats = stat_names->length;
+    t->capacity = 1024;
+    if ((t->stats = (typeof(*t->stats) *) calloc(
+            ((size_t) t->capacity * t->num_stats),
+            sizeof(*t->stats))) == NULL) {
+        perror("out of memory");
+        exit(1);
+    }
+    if ((t->refs = (typeof(*t->refs) *) calloc(t->capacity,
+            sizeof(*t->refs))) == NULL) {
+        perror("out of memory");
+        exit(1);
+    }
+    if ((t->ranks = (typeof(*t->ranks) *) calloc(t->capacity,
+            sizeof(*t->ranks))) == NULL) {
+        perror("out of memory");
+        exit(1);
+    }
+    t->paths = init_s_array(1);
+    t->header = init_s_array(header->length);
+    extend_s_array(t->header, header);
+    t->stat_names = init_s_array(stat_names->length);
+    extend_s_array(t->stat_names, stat_names);
+    t->means = init_d_array(means->length);
+    extend_d_array(t->means, means);
+    t->std_devs = init_d_array(std_devs->length);
+    extend_d_array(t->std_devs, std_devs);
+    t->sample_sizes = init_i_array(stat_names->length);
+    extend_i_array(t->sample_sizes, sample_sizes);
+    t->fstats = NULL;
+    t->precision = STAT_PRECISION_DOUBLE;
+    t->max_rounding_error = 0.0;
+    t->tree = NULL;
+    t->streams = NULL;
+    t->stat_indices = NULL;
+    t->line_buffer = NULL;
+    t->line_array = NULL;
+    t->row_stats = NULL;
+    t->candidates = NULL;
+    return t;
+}
+
+void free_stat_table(stat_table * t) {
+    int i;
+    if (t->streams != NULL) {
+        for (i = 0; i < t->paths->length; i++) {
+            if (t->streams[i] != NULL) {
+                fclose(t->streams[i]);
+            }
+        }
+        free(t->streams);
+    }
+    if (t->tree != NULL) {
+        free_kd_tree(t->tree);
+    }
+    if (t->stat_indices != NULL) {
+        free_i_array(t->stat_indices);
+        free_c_array(t->line_buffer);
+        free_s_array(t->line_array);
+        free_d_array(t->row_stats);
+        free_i_array(t->candidates);
+    }
+    free(t->stats);
+    free(t->fstats);
+    free(t->refs);
+    free(t->ranks);
+    free_s_array(t->paths);
+    free_s_array(t->header);
+    free_s_array(t->stat_names);
+    free_d_array(t->means);
+    free_d_array(t->std_devs);
+    free_i_array(t->sample_sizes);
+    free(t);
+    t = NULL;
+}
+
+/**
+ * Set the precision the stats of an empty table are stored in.
+ */
+void set_stat_table_precision(stat_table * t, int precision) {
+    assert((t->num_rows == 0) && (t->tree == NULL));
+    assert((precision == STAT_PRECISION_DOUBLE) ||
+            (precision == STAT_PRECISION_FLOAT));
+    if (precision == t->precision) {
+        return;
+    }
+    t->precision = precision;
+    free(t->stats);
+    free(t->fstats);
+    t->stats = NULL;
+    t->fstats = NULL;
+    if (precision == STAT_PRECISION_FLOAT) {
+        if ((t->fstats = (typeof(*t->fstats) *) calloc(
+                ((size_t) t->capacity * t->num_stats),
+                sizeof(*t->fstats))) == NULL) {
+            perror("out of memory");
+            exit(1);
+        }
+    }
+    else {
+        if ((t->stats = (typeof(*t->stats) *) calloc(
+                ((size_t) t->capacity * t->num_stats),
+                sizeof(*t->stats))) == NULL) {
+            perror("out of memory");
+            exit(1);
+        }
+    }
+}
+
+/**
+ * Parse the name of a precision ("double" or "float"); returns -1 if the
+ * name is not recognized.
+ */
+int parse_stat_precision(const char * s) {
+    if (strcmp(s, "double") == 0) {
+        return STAT_PRECISION_DOUBLE;
+    }
+    if ((strcmp(s, "float") == 0) || (strcmp(s, "single") == 0)) {
+        return STAT_PRECISION_FLOAT;
+    }
+    return -1;
+}
+
+void expand_stat_table(stat_table * t) {
+    t->capacity *= 2;
+    if (t->precision == STAT_PRECISION_FLOAT) {
+        if ((t->fstats = (typeof(*t->fstats) *) realloc(t->fstats,
+                ((size_t) t->capacity * t->num_stats *
+                        sizeof(*t->fstats)))) == NULL) {
+            perror("out of memory");
+            exit(1);
+        }
+    }
+    else if ((t->stats = (typeof(*t->stats) *) realloc(t->stats,
+            ((size_t) t->capacity * t->num_stats * sizeof(*t->stats)))) ==
+            NULL) {
+        perror("out of memory");
+        exit(1);
+    }
+    if ((t->refs = (typeof(*t->refs) *) realloc(t->refs,
+            (t->capacity * sizeof(*t->refs)))) == NULL) {
+        perror("out of memory");
+        exit(1);
+    }
+    if ((t->ranks = (typeof(*t->ranks) *) realloc(t->ranks,
+            (t->capacity * sizeof(*t->ranks)))) == NULL) {
+        perror("out of memory");
+        exit(1);
+    }
+}
+
+void append_stat_table_row(stat_table * t, const d_array * stats,
+        const row_ref * ref) {
+    assert(stats->length == t->num_stats);
+    assert(t->tree == NULL);
+    int i;
+    float * row;
+    double error;
+    if (t->num_rows >= t->capacity) {
+        expand_stat_table(t);
+    }
+    if (t->precision == STAT_PRECISION_FLOAT) {
+        row = t->fstats + ((size_t) t->num_rows * t->num_stats);
+        for (i = 0; i < t->num_stats; i++) {
+            row[i] = (float) stats->a[i];
+        }
+        error = sqrt(sum_of_squared_diffs_f(stats->a, row, t->num_stats));
+        if (error > t->max_rounding_error) {
+            t->max_rounding_error = error;
+        }
+    }
+    else {
+        memcpy(t->stats + ((size_t) t->num_rows * t->num_stats), stats->a,
+                t->num_stats * sizeof(*t->stats));
+    }
+    t->refs[t->num_rows] = *ref;
+    t->ranks[t->num_rows] = t->num_rows;
+    t->num_rows++;
+}
+
+double * get_stat_table_row(const stat_table * t, int index) {
+    assert((index >= 0) && (index < t->num_rows));
+    assert(t->precision == STAT_PRECISION_DOUBLE);
+    return (t->stats + ((size_t) index * t->num_stats));
+}
+
+float * get_stat_table_row_f(const stat_table * t, int index) {
+    assert((index >= 0) && (index < t->num_rows));
+    assert(t->precision == STAT_PRECISION_FLOAT);
+    return (t->fstats + ((size_t) index * t->num_stats));
+}
+
+void load_stat_table(stat_table * t, const s_array * paths,
+        c_array * line_buffer,
+        const i_array * stat_indices) {
+    assert(stat_indices->length == t->num_stats);
+    FILE * f;
+    int i, ncols, get_stats_return;
+    long offset;
+    row_ref ref;
+    s_array * line_array;
+    d_array * stats;
+    line_array = init_s_array(t->header->length);
+    stats = init_d_array(t->num_stats);
+    for (i = 0; i < paths->length; i++) {
+        if ((f = fopen(get_s_array(paths, i), "r")) == NULL) {
+            perror(get_s_array(paths, i));
+            exit(1);
+        }
+        append_s_array(t->paths, get_s_array(paths, i));
+        ref.file_index = t->paths->length - 1;
+        ref.line_num = 0;
+        offset = ftell(f);
+        while (fgets(line_buffer->a, ((line_buffer->capacity) - 1),
+                    f) != NULL) {
+            ref.line_num++;
+            ref.offset = offset;
+            offset = ftell(f);
+            ncols = split_str(line_buffer->a, line_array,
+                    t->header->length);
+            if (ncols == -1) continue; //empty line
+            if (ncols != 0) {
+                fprintf(stderr, "ERROR: file %s line %d has %d columns "
+                        "(expected %d)\n", get_s_array(paths, i),
+                        ref.line_num, ncols, t->header->length);
+                exit(1);
+            }
+            if (ref.line_num == 1) continue;
+            get_stats_return = get_doubles(line_array, stat_indices, stats);
+            if (get_stats_return != 0) {
+                fprintf(stderr, "ERROR: file %s line %d contains %d invalid "
+                        "stats columns\n", get_s_array(paths, i),
+                        ref.line_num, get_stats_return);
+            }
+            standardize_vector(stats, t->means, t->std_devs);
+            append_stat_table_row(t, stats, &ref);
+        }
+        fclose(f);
+    }
+    free_d_array(stats);
+    free_s_array(line_array);
+}
+
+void build_stat_table_tree(stat_table * t, int leaf_size) {
+    int i;
+    row_ref * refs;
+    assert(t->tree == NULL);
+    if (t->num_rows < 1) {
+        return;
+    }
+    if (t->precision == STAT_PRECISION_FLOAT) {
+        t->tree = build_kd_tree_f(t->fstats, t->ranks, t->num_rows,
+                t->num_stats, leaf_size);
+    }
+    else {
+        t->tree = build_kd_tree(t->stats, t->ranks, t->num_rows,
+                t->num_stats, leaf_size);
+    }
+    // the tree reorders stats and ranks; ranks are the original row indices,
+    // so use them to carry the row references along
+    if ((refs = (typeof(*refs) *) calloc(t->num_rows,
+            sizeof(*refs))) == NULL) {
+        perror("out of memory");
+        exit(1);
+    }
+    for (i = 0; i < t->num_rows; i++) {
+        refs[i] = t->refs[t->ranks[i]];
+    }
+    free(t->refs);
+    t->refs = refs;
+    t->capacity = t->num_rows;
+}
+
+static double get_stat_table_row_distance(const stat_table * t,
+        const double * std_observed_stats, int index) {
+    if (t->precision == STAT_PRECISION_FLOAT) {
+        return sqrt(sum_of_squared_diffs_f(std_observed_stats,
+                get_stat_table_row_f(t, index), t->num_stats));
+    }
+    return sqrt(sum_of_squared_diffs(std_observed_stats,
+            get_stat_table_row(t, index), t->num_stats));
+}
+
+static int query_stat_table_rows(const stat_table * t,
+        const double * std_observed_stats, neighbor_heap * h) {
+    int i;
+    if (t->tree != NULL) {
+        return kd_tree_knn(t->tree, std_observed_stats, h);
+    }
+    for (i = 0; i < t->num_rows; i++) {
+        push_neighbor_heap(h, get_stat_table_row_distance(t,
+                std_observed_stats, i), i);
+    }
+    return t->num_rows;
+}
+
+static void init_stat_table_scratch(stat_table * t) {
+    if (t->stat_indices != NULL) {
+        return;
+    }
+    t->stat_indices = init_i_array(t->num_stats);
+    get_matching_indices(t->stat_names, t->header, t->stat_indices);
+    t->line_buffer = init_c_array(pow(2, 20));
+    t->line_array = init_s_array(t->header->length);
+    t->row_stats = init_d_array(t->num_stats);
+    t->candidates = init_i_array(64);
+}
+
+/**
+ * Re-read row `index` from its simulation file and return its distance to
+ * `std_observed_stats` in double precision, exactly as it would be
+ * calculated from a table of double-precision stats.
+ */
+static double get_exact_row_distance(stat_table * t,
+        const double * std_observed_stats, int index) {
+    int ncols;
+    init_stat_table_scratch(t);
+    read_stat_table_row(t, index, t->line_buffer);
+    ncols = split_str(t->line_buffer->a, t->line_array, t->header->length);
+    if (ncols != 0) {
+        fprintf(stderr, "ERROR: file %s line %d has %d columns "
+                "(expected %d)\n",
+                get_s_array(t->paths, t->refs[index].file_index),
+                t->refs[index].line_num, ncols, t->header->length);
+        exit(1);
+    }
+    get_doubles(t->line_array, t->stat_indices, t->row_stats);
+    standardize_vector(t->row_stats, t->means, t->std_devs);
+    return sqrt(sum_of_squared_diffs(std_observed_stats, t->row_stats->a,
+            t->num_stats));
+}
+
+int query_stat_table(stat_table * t, const double * std_observed_stats,
+        neighbor_heap * h) {
+    int i, visited;
+    double radius;
+    neighbor_heap * nearest;
+    assert(h->ranks == t->ranks);
+    if (t->precision != STAT_PRECISION_FLOAT) {
+        return query_stat_table_rows(t, std_observed_stats, h);
+    }
+    nearest = init_neighbor_heap(h->capacity, t->ranks);
+    visited = query_stat_table_rows(t, std_observed_stats, nearest);
+    if (nearest->length < nearest->capacity) {
+        // every row is among the nearest
+        for (i = 0; i < nearest->length; i++) {
+            push_neighbor_heap(h, get_exact_row_distance(t,
+                    std_observed_stats, nearest->a[i].index),
+                    nearest->a[i].index);
+        }
+        free_neighbor_heap(nearest);
+        return visited;
+    }
+    // The rows found are within max_rounding_error of their single-precision
+    // distances, so the exact distance of the last of the nearest rows is at
+    // most the worst distance found plus the error; a row within that
+    // distance is at most one more error away in single precision. The
+    // relative slack covers rounding in the distance calculations.
+    radius = get_worst_neighbor_distance(nearest) +
+            (2.0 * t->max_rounding_error);
+    radius += radius * 1e-10;
+    free_neighbor_heap(nearest);
+    init_stat_table_scratch(t);
+    t->candidates->length = 0;
+    if (t->tree != NULL) {
+        visited += kd_tree_range(t->tree, std_observed_stats, radius,
+                t->candidates);
+    }
+    else {
+        for (i = 0; i < t->num_rows; i++) {
+            if (get_stat_table_row_distance(t, std_observed_stats, i) <=
+                    radius) {
+                i_array_append(t->candidates, i);
+            }
+        }
+        visited += t->num_rows;
+    }
+    for (i = 0; i < t->candidates->length; i++) {
+        push_neighbor_heap(h, get_exact_row_distance(t, std_observed_stats,
+                i_array_get(t->candidates, i)),
+                i_array_get(t->candidates, i));
+    }
+    return visited;
+}
+
+char * read_stat_table_row(stat_table * t, int index, c_array * line_buffer) {
+    assert((index >= 0) && (index < t->num_rows));
+    const row_ref * ref;
+    const char * path;
+    ref = &t->refs[index];
+    path = get_s_array(t->paths, ref->file_index);
+    if (t->streams == NULL) {
+        if ((t->streams = (typeof(*t->streams) *) calloc(t->paths->length,
+                sizeof(*t->streams))) == NULL) {
+            perror("out of memory");
+            exit(1);
+        }
+    }
+    if (t->streams[ref->file_index] == NULL) {
+        if ((t->streams[ref->file_index] = fopen(path, "r")) == NULL) {
+            perror(path);
+            exit(1);
+        }
+    }
+    if ((fseek(t->streams[ref->file_index], ref->offset, SEEK_SET) != 0) ||
+            (fgets(line_buffer->a, ((line_buffer->capacity) - 1),
+                    t->streams[ref->file_index]) == NULL)) {
+        fprintf(stderr, "ERROR: could not read line %d of %s; has the file "
+                "changed since the index was built?\n", ref->line_num, path);
+        exit(1);
+    }
+    return line_buffer->a;
+}
+
+static void write_block(FILE * f, const void * ptr, size_t size,
+        size_t count, const char * path) {
+    if (fwrite(ptr, size, count, f) != count) {
+        fprintf(stderr, "ERROR: could not write to index file %s\n", path);
+        exit(1);
+    }
+}
+
+static void read_block(FILE * f, void * ptr, size_t size, size_t count,
+        const char * path) {
+    if (fread(ptr, size, count, f) != count) {
+        fprintf(stderr, "ERROR: index file %s is truncated or corrupt\n",
+                path);
+        exit(1);
+    }
+}
+
+static void write_strings(FILE * f, const s_array * v, const char * path) {
+    int i, len;
+    write_block(f, &v->length, sizeof(v->length), 1, path);
+    for (i = 0; i < v->length; i++) {
+        len = strlen(get_s_array(v, i));
+        write_block(f, &len, sizeof(len), 1, path);
+        write_block(f, get_s_array(v, i), sizeof(char), len, path);
+    }
+}
+
+static void read_strings(FILE * f, s_array * v, const char * path) {
+    int i, n, len;
+    c_array * s;
+    s = init_c_array(63);
+    v->length = 0;
+    read_block(f, &n, sizeof(n), 1, path);
+    for (i = 0; i < n; i++) {
+        read_block(f, &len, sizeof(len), 1, path);
+        while (len > s->capacity) {
+            expand_c_array(s);
+        }
+        read_block(f, s->a, sizeof(char), len, path);
+        s->a[len] = '\0';
+        append_s_array(v, s->a);
+    }
+    free_c_array(s);
+}
+
+static void read_doubles(FILE * f, d_array * v, int n, const char * path) {
+    v->length = 0;
+    while (v->capacity < n) {
+        expand_d_array(v);
+    }
+    read_block(f, v->a, sizeof(*v->a), n, path);
+    v->length = n;
+}
+
+/**
+ * Write the table, including its k-d tree (if built), to a binary index
+ * file. The index is in the native byte order of the machine.
+ */
+void write_stat_table(const char * path, const stat_table * t) {
+    FILE * f;
+    int version, leaf_size;
+    if ((f = fopen(path, "wb")) == NULL) {
+        perror(path);
+        exit(1);
+    }
+    version = STAT_TABLE_FORMAT_VERSION;
+    leaf_size = (t->tree != NULL) ? t->tree->leaf_size : 0;
+    write_block(f, STAT_TABLE_MAGIC, sizeof(char), strlen(STAT_TABLE_MAGIC),
+            path);
+    write_block(f, &version, sizeof(version), 1, path);
+    write_block(f, &t->num_rows, sizeof(t->num_rows), 1, path);
+    write_block(f, &t->num_stats, sizeof(t->num_stats), 1, path);
+    write_block(f, &leaf_size, sizeof(leaf_size), 1, path);
+    write_block(f, &t->precision, sizeof(t->precision), 1, path);
+    write_block(f, &t->max_rounding_error, sizeof(t->max_rounding_error), 1,
+            path);
+    write_strings(f, t->paths, path);
+    write_strings(f, t->header, path);
+    write_strings(f, t->stat_names, path);
+    write_block(f, t->means->a, sizeof(*t->means->a), t->num_stats, path);
+    write_block(f, t->std_devs->a, sizeof(*t->std_devs->a), t->num_stats,
+            path);
+    write_block(f, t->sample_sizes->a, sizeof(*t->sample_sizes->a),
+            t->num_stats, path);
+    if (t->precision == STAT_PRECISION_FLOAT) {
+        write_block(f, t->fstats, sizeof(*t->fstats),
+                ((size_t) t->num_rows * t->num_stats), path);
+    }
+    else {
+        write_block(f, t->stats, sizeof(*t->stats),
+                ((size_t) t->num_rows * t->num_stats), path);
+    }
+    write_block(f, t->refs, sizeof(*t->refs), t->num_rows, path);
+    write_block(f, t->ranks, sizeof(*t->ranks), t->num_rows, path);
+    if (t->tree != NULL) {
+        write_block(f, t->tree->split_dims, sizeof(*t->tree->split_dims),
+                t->num_rows, path);
+    }
+    fclose(f);
+}
+
+stat_table * read_stat_table(const char * path) {
+    FILE * f;
+    int version, num_rows, num_stats, leaf_size, precision;
+    double max_rounding_error;
+    char magic[sizeof(STAT_TABLE_MAGIC)];
+    s_array * paths;
+    s_array * header;
+    s_array * stat_names;
+    d_array * means;
+    d_array * std_devs;
+    i_array * sample_sizes;
+    stat_table * t;
+    if ((f = fopen(path, "rb")) == NULL) {
+        perror(path);
+        exit(1);
+    }
+    read_block(f, magic, sizeof(char), strlen(STAT_TABLE_MAGIC), path);
+    magic[strlen(STAT_TABLE_MAGIC)] = '\0';
+    if (strcmp(magic, STAT_TABLE_MAGIC) != 0) {
+        fprintf(stderr, "ERROR: %s is not an eureject index file\n", path);
+        exit(1);
+    }
+    read_block(f, &version, sizeof(version), 1, path);
+    // version 1 indices are version 2 indices of double-precision stats,
+    // without the precision fields
+    if ((version < 1) || (version > STAT_TABLE_FORMAT_VERSION)) {
+        fprintf(stderr, "ERROR: index file %s has format version %d "
+                "(expected %d)\n", path, version, STAT_TABLE_FORMAT_VERSION);
+        exit(1);
+    }
+    read_block(f, &num_rows, sizeof(num_rows), 1, path);
+    read_block(f, &num_stats, sizeof(num_stats), 1, path);
+    read_block(f, &leaf_size, sizeof(leaf_size), 1, path);
+    precision = STAT_PRECISION_DOUBLE;
+    max_rounding_error = 0.0;
+    if (version > 1) {
+        read_block(f, &precision, sizeof(precision), 1, path);
+        read_block(f, &max_rounding_error, sizeof(max_rounding_error), 1,
+                path);
+        if ((precision != STAT_PRECISION_DOUBLE) &&
+                (precision != STAT_PRECISION_FLOAT)) {
+            fprintf(stderr, "ERROR: index file %s has unknown precision %d\n",
+                    path, precision);
+            exit(1);
+        }
+    }
+    paths = init_s_array(1);
+    header = init_s_array(1);
+    stat_names = init_s_array(1);
+    means = init_d_array(num_stats);
+    std_devs = init_d_array(num_stats);
+    sample_sizes = init_i_array(num_stats);
+    read_strings(f, paths, path);
+    read_strings(f, header, path);
+    read_strings(f, stat_names, path);
+    if (stat_names->length != num_stats) {
+        fprintf(stderr, "ERROR: index file %s has %d stat names but %d "
+                "stats\n", path, stat_names->length, num_stats);
+        exit(1);
+    }
+    read_doubles(f, means, num_stats, path);
+    read_doubles(f, std_devs, num_stats, path);
+    while (sample_sizes->capacity < num_stats) {
+        expand_i_array(sample_sizes);
+    }
+    read_block(f, sample_sizes->a, sizeof(*sample_sizes->a), num_stats,
+            path);
+    sample_sizes->length = num_stats;
+    t = init_stat_table(header, stat_names, means, std_devs, sample_sizes);
+    set_stat_table_precision(t, precision);
+    t->max_rounding_error = max_rounding_error;
+    extend_s_array(t->paths, paths);
+    while (t->capacity < num_rows) {
+        expand_stat_table(t);
+    }
+    if (precision == STAT_PRECISION_FLOAT) {
+        read_block(f, t->fstats, sizeof(*t->fstats),
+                ((size_t) num_rows * num_stats), path);
+    }
+    else {
+        read_block(f, t->stats, sizeof(*t->stats),
+                ((size_t) num_rows * num_stats), path);
+    }
+    read_block(f, t->refs, sizeof(*t->refs), num_rows, path);
+    read_block(f, t->ranks, sizeof(*t->ranks), num_rows, path);
+    t->num_rows = num_rows;
+    if ((leaf_size > 0) && (num_rows > 0)) {
+        if (precision == STAT_PRECISION_FLOAT) {
+            t->tree = init_kd_tree_f(t->fstats, t->ranks, num_rows,
+                    num_stats, leaf_size);
+        }
+        else {
+            t->tree = init_kd_tree(t->stats, t->ranks, num_rows, num_stats,
+                    leaf_size);
+        }
+        read_block(f, t->tree->split_dims, sizeof(*t->tree->split_dims),
+                num_rows, path);
+    }
+    fclose(f);
+    free_s_array(paths);
+    free_s_array(header);
+    free_s_array(stat_names);
+    free_d_array(means);
+    free_d_array(std_devs);
+    free_i_array(sample_sizes);
+    return t;
+}
@@ -0,0 +1,140 @@
+/**
+ * @file        stat_table.h
+ * @authors     Jamie Oaks
+ * @package     ABACUS (Approximate BAyesian C UtilitieS)
+ * @brief       An in-memory, indexable table of standardized summary
+ *              statistics.
+ * @copyright   Copyright (C) 2013 Jamie Oaks.
+ *   This file is part of ABACUS.  ABACUS is free software; you can
+ *   redistribute it and/or modify it under the terms of the GNU General Public
+ *   License as published by the Free Software Foundation; either version 2 of
+ *   the License, or (at your option) any later version.
+ * 
+ *   ABACUS is distributed in the hope that it will be useful, but WITHOUT ANY
+ *   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *   FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *   details.
+ * 
+ *   You should have received a copy of the GNU General Public License along
+ *   with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef STAT_TABLE_H
+#define STAT_TABLE_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "array_utils.h"
+#include "stats_utils.h"
+#include "kdtree.h"
+
+#define STAT_TABLE_MAGIC "ABACUSIX"
+#define STAT_TABLE_FORMAT_VERSION 2
+#define STAT_PRECISION_DOUBLE 0
+#define STAT_PRECISION_FLOAT 1
+
+/**
+ * The location of a row of a simulation file: the index of the file in the
+ * table's `paths`, the (1-based) line number, and the byte offset of the
+ * start of the line.
+ */
+typedef struct row_ref_ {
+    int file_index;
+    int line_num;
+    long offset;
+} row_ref;
+
+/**
+ * The standardized stats of every row of one or more simulation files.
+ *
+ * `stats` is a row-major `num_rows` x `num_stats` matrix; `refs` locates each
+ * row in the simulation files and `ranks` gives its position in file order,
+ * which is used to break distance ties the same way a sequential scan does.
+ * The means and standard deviations used to standardize the stats are kept
+ * with the table, along with the sample sizes they were calculated from.
+ * Once `build_stat_table_tree` has been called, rows are in k-d tree order.
+ *
+ * With `STAT_PRECISION_FLOAT`, the stats are stored in single precision in
+ * `fstats` (and `stats` is `NULL`), halving the memory (and bandwidth) of
+ * the table. `max_rounding_error` bounds the Euclidean distance between the
+ * single- and double-precision stats of any row, which lets queries find
+ * the nearest rows from the single-precision stats and then rank them
+ * exactly by re-reading them from the simulation files (see
+ * `query_stat_table`). The remaining fields are scratch space for those
+ * re-reads.
+ */
+typedef struct stat_table_ {
+    double * stats;
+    float * fstats;
+    int precision;
+    double max_rounding_error;
+    row_ref * refs;
+    int * ranks;
+    int num_rows;
+    int num_stats;
+    int capacity;
+    s_array * paths;
+    s_array * header;
+    s_array * stat_names;
+    d_array * means;
+    d_array * std_devs;
+    i_array * sample_sizes;
+    kd_tree * tree;
+    FILE ** streams;
+    i_array * stat_indices;
+    c_array * line_buffer;
+    s_array * line_array;
+    d_array * row_stats;
+    i_array * candidates;
+} stat_table;
+
+stat_table * init_stat_table(const s_array * header,
+        const s_array * stat_names,
+        const d_array * means,
+        const d_array * std_devs,
+        const i_array * sample_sizes);
+void free_stat_table(stat_table * t);
+void set_stat_table_precision(stat_table * t, int precision);
+int parse_stat_precision(const char * s);
+void expand_stat_table(stat_table * t);
+void append_stat_table_row(stat_table * t, const d_array * stats,
+        const row_ref * ref);
+double * get_stat_table_row(const stat_table * t, int index);
+float * get_stat_table_row_f(const stat_table * t, int index);
+
+/**
+ * Read the rows of the simulation files in `paths` into the table.
+ *
+ * The stats in the columns given by `stat_indices` are standardized with the
+ * table's means and standard deviations. The first line of each file is
+ * taken to be the header.
+ */
+void load_stat_table(stat_table * t, const s_array * paths,
+        c_array * line_buffer,
+        const i_array * stat_indices);
+void build_stat_table_tree(stat_table * t, int leaf_size);
+
+/**
+ * Find the rows nearest to the standardized stats `std_observed_stats`.
+ *
+ * Uses the k-d tree if one has been built, and a full scan otherwise. The
+ * result is the same in either precision: with single-precision stats, the
+ * nearest rows are found from those stats, every row that could be among
+ * the nearest given `max_rounding_error` is gathered with a range query, and
+ * these candidates are re-read from the simulation files and ranked by
+ * their double-precision distances.
+ *
+ * @return
+ *   The number of rows whose distance was computed.
+ */
+int query_stat_table(stat_table * t, const double * std_observed_stats,
+        neighbor_heap * h);
+char * read_stat_table_row(stat_table * t, int index, c_array * line_buffer);
+
+void write_stat_table(const char * path, const stat_table * t);
+stat_table * read_stat_table(const char * path);
+
+#endif /* STAT_TABLE_H */
@@ -64,7 +64,7 @@ void free_sample_sum_array(sample_sum_array * v) {
 void update_sample_sum(sample_sum * s, double x) {
     (*s).n += 1;
     (*s).sum += x;
-    (*s).sum_of_squares += pow(x, 2);
+    (*s).sum_of_squares += x * x;
 }
 
 double get_mean(const sample_sum * s) {
@@ -130,3 +130,882 @@ void standardize_vector(d_array * v, const d_array * means,
     }
 }
 
+sample_moments * init_sample_moments(int length, int block_capacity) {
+    assert((length > 0) && (block_capacity > 0));
+    sample_moments * m;
+    m = (typeof(*m) *) malloc(sizeof(*m));
+    m->length = length;
+    m->block_length = 0;
+    m->block_capacity = block_capacity;
+    if (((m->n = (typeof(*m->n) *) calloc(length, sizeof(*m->n))) ==
+            NULL) ||
+            ((m->mean = (typeof(*m->mean) *) calloc(length,
+            sizeof(*m->mean))) == NULL) ||
+            ((m->m2 = (typeof(*m->m2) *) calloc(length,
+            sizeof(*m->m2))) == NULL) ||
+            ((m->block_mean = (typeof(*m->block_mean) *) calloc(length,
+            sizeof(*m->block_mean))) == NULL) ||
+            ((m->block_m2 = (typeof(*m->block_m2) *) calloc(length,
+            sizeof(*m->block_m2))) == NULL) ||
+            ((m->block = (typeof(*m->block) *) malloc(
+            ((size_t) length * block_capacity) * sizeof(*m->block))) ==
+            NULL)) {
+        perror("out of memory");
+        exit(1);
+    }
+    return m;
+}
+
+void free_sample_moments(sample_moments * m) {
+    free(m->n);
+    free(m->mean);
+    free(m->m2);
+    free(m->block_mean);
+    free(m->block_m2);
+    free(m->block);
+    free(m);
+    m = NULL;
+}
+
+void update_sample_moments(sample_moments * m, const d_array * x) {
+    assert(x->length == m->length);
+    memcpy((m->block + ((size_t) m->block_length * m->length)), x->a,
+            (m->length * sizeof(*x->a)));
+    m->block_length++;
+    if (m->block_length >= m->block_capacity) {
+        flush_sample_moments(m);
+    }
+}
+
+void update_sample_moments_block(sample_moments * m, const double * rows,
+        int num_rows) {
+    int i, j, d;
+    double b, w, delta;
+    const double * row;
+    double * restrict bm;
+    double * restrict bm2;
+    if (num_rows < 1) {
+        return;
+    }
+    d = m->length;
+    bm = m->block_mean;
+    bm2 = m->block_m2;
+    // the block's means and sums of squares, a row at a time, so that the
+    // inner loops run over contiguous columns
+    for (j = 0; j < d; j++) {
+        bm[j] = 0.0;
+        bm2[j] = 0.0;
+    }
+    for (i = 0; i < num_rows; i++) {
+        row = rows + ((size_t) i * d);
+        for (j = 0; j < d; j++) {
+            bm[j] += row[j];
+        }
+    }
+    b = (double) num_rows;
+    for (j = 0; j < d; j++) {
+        bm[j] /= b;
+    }
+    for (i = 0; i < num_rows; i++) {
+        row = rows + ((size_t) i * d);
+        for (j = 0; j < d; j++) {
+            delta = row[j] - bm[j];
+            bm2[j] += delta * delta;
+        }
+    }
+    // merge them with the running means and sums of squares
+    for (j = 0; j < d; j++) {
+        w = b / (m->n[j] + b);
+        delta = bm[j] - m->mean[j];
+        m->mean[j] += delta * w;
+        m->m2[j] += bm2[j] + (delta * delta * m->n[j] * w);
+        m->n[j] += num_rows;
+    }
+}
+
+void update_sample_moments_column(sample_moments * m, int j, double x) {
+    assert((j >= 0) && (j < m->length));
+    assert(m->block_length == 0);
+    double delta;
+    m->n[j]++;
+    delta = x - m->mean[j];
+    m->mean[j] += delta / m->n[j];
+    m->m2[j] += delta * (x - m->mean[j]);
+}
+
+void flush_sample_moments(sample_moments * m) {
+    update_sample_moments_block(m, m->block, m->block_length);
+    m->block_length = 0;
+}
+
+void get_sample_moments_means(sample_moments * m, d_array * means) {
+    int i;
+    flush_sample_moments(m);
+    means->length = 0;
+    for (i = 0; i < m->length; i++) {
+        assert(m->n[i] > 0);
+        append_d_array(means, m->mean[i]);
+    }
+}
+
+void get_sample_moments_std_devs(sample_moments * m, d_array * std_devs) {
+    int i;
+    flush_sample_moments(m);
+    std_devs->length = 0;
+    for (i = 0; i < m->length; i++) {
+        assert(m->n[i] > 1);
+        append_d_array(std_devs, sqrt(m->m2[i] / (m->n[i] - 1)));
+    }
+}
+
+cov_sum * init_cov_sum(int dim, int batch_capacity) {
+    assert((dim > 0) && (batch_capacity > 0));
+    int n;
+    cov_sum * c;
+    c = (typeof(*c) *) malloc(sizeof(*c));
+    n = (dim * (dim + 1)) / 2;
+    c->dim = dim;
+    c->n = 0;
+    c->batch_length = 0;
+    c->batch_capacity = batch_capacity;
+    if (((c->means = (typeof(*c->means) *) calloc(dim,
+            sizeof(*c->means))) == NULL) ||
+            ((c->comoments = (typeof(*c->comoments) *) calloc(n,
+            sizeof(*c->comoments))) == NULL) ||
+            ((c->batch = (typeof(*c->batch) *) malloc(
+            ((size_t) dim * batch_capacity) * sizeof(*c->batch))) == NULL) ||
+            ((c->batch_means = (typeof(*c->batch_means) *) malloc(dim *
+            sizeof(*c->batch_means))) == NULL) ||
+            ((c->batch_comoments = (typeof(*c->batch_comoments) *) malloc(
+            n * sizeof(*c->batch_comoments))) == NULL)) {
+        perror("out of memory");
+        exit(1);
+    }
+    return c;
+}
+
+void free_cov_sum(cov_sum * c) {
+    free(c->means);
+    free(c->comoments);
+    free(c->batch);
+    free(c->batch_means);
+    free(c->batch_comoments);
+    free(c);
+    c = NULL;
+}
+
+void update_cov_sum(cov_sum * c, const d_array * x) {
+    assert(x->length == c->dim);
+    int i;
+    for (i = 0; i < c->dim; i++) {
+        c->batch[((size_t) i * c->batch_capacity) + c->batch_length] =
+                x->a[i];
+    }
+    c->batch_length++;
+    if (c->batch_length >= c->batch_capacity) {
+        flush_cov_sum(c);
+    }
+}
+
+int get_cov_sum_index(const cov_sum * c, int i, int j) {
+    int t;
+    assert((i >= 0) && (j >= 0) && (i < c->dim) && (j < c->dim));
+    if (i > j) {
+        t = i;
+        i = j;
+        j = t;
+    }
+    return (i * c->dim) - ((i * (i - 1)) / 2) + (j - i);
+}
+
+/**
+ * Add the sums of `n_b` rows, with `means_b` and `comoments_b`, to those
+ * of `c` (Chan, Golub and LeVeque 1979).
+ */
+static void add_cov_sums(cov_sum * c, long n_b, const double * means_b,
+        const double * comoments_b) {
+    int i, j, k;
+    long n;
+    double w, di;
+    n = c->n + n_b;
+    w = ((double) c->n * n_b) / n;
+    for (i = 0, k = 0; i < c->dim; i++) {
+        di = means_b[i] - c->means[i];
+        for (j = i; j < c->dim; j++, k++) {
+            c->comoments[k] += comoments_b[k] +
+                    (w * di * (means_b[j] - c->means[j]));
+        }
+    }
+    for (i = 0; i < c->dim; i++) {
+        c->means[i] += (means_b[i] - c->means[i]) * ((double) n_b / n);
+    }
+    c->n = n;
+}
+
+// the variables whose products are summed together in a rank-k update, so
+// that their buffered values stay in cache
+#define COV_SUM_BLOCK_SIZE 8
+
+void flush_cov_sum(cov_sum * c) {
+    int i, j, k, m, ib, jb, i_end, j_end;
+    double s;
+    double * col_i;
+    double * col_j;
+    double * means;
+    double * comoments;
+    m = c->batch_length;
+    if (m < 1) {
+        return;
+    }
+    // every element of the scratch space is set below
+    means = c->batch_means;
+    comoments = c->batch_comoments;
+    // center the batch on its own means
+    for (i = 0; i < c->dim; i++) {
+        col_i = c->batch + ((size_t) i * c->batch_capacity);
+        s = 0.0;
+        for (k = 0; k < m; k++) {
+            s += col_i[k];
+        }
+        means[i] = s / m;
+        for (k = 0; k < m; k++) {
+            col_i[k] -= means[i];
+        }
+    }
+    // the upper triangle of the batch's centered cross-products, a block of
+    // variables at a time
+    for (ib = 0; ib < c->dim; ib += COV_SUM_BLOCK_SIZE) {
+        i_end = ((ib + COV_SUM_BLOCK_SIZE) < c->dim) ?
+                (ib + COV_SUM_BLOCK_SIZE) : c->dim;
+        for (jb = ib; jb < c->dim; jb += COV_SUM_BLOCK_SIZE) {
+            j_end = ((jb + COV_SUM_BLOCK_SIZE) < c->dim) ?
+                    (jb + COV_SUM_BLOCK_SIZE) : c->dim;
+            for (i = ib; i < i_end; i++) {
+                col_i = c->batch + ((size_t) i * c->batch_capacity);
+                for (j = ((jb > i) ? jb : i); j < j_end; j++) {
+                    col_j = c->batch + ((size_t) j * c->batch_capacity);
+                    s = 0.0;
+                    for (k = 0; k < m; k++) {
+                        s += col_i[k] * col_j[k];
+                    }
+                    comoments[get_cov_sum_index(c, i, j)] = s;
+                }
+            }
+        }
+    }
+    add_cov_sums(c, m, means, comoments);
+    c->batch_length = 0;
+}
+
+void merge_cov_sum(cov_sum * dest, cov_sum * src) {
+    assert(dest->dim == src->dim);
+    flush_cov_sum(dest);
+    flush_cov_sum(src);
+    if (src->n < 1) {
+        return;
+    }
+    add_cov_sums(dest, src->n, src->means, src->comoments);
+}
+
+double get_covariance(cov_sum * c, int i, int j) {
+    flush_cov_sum(c);
+    assert(c->n > 1);
+    return c->comoments[get_cov_sum_index(c, i, j)] / (c->n - 1);
+}
+
+void write_covariance_matrix(FILE * stream, cov_sum * c) {
+    write_covariance_block(stream, c, c->dim);
+}
+
+void write_covariance_block(FILE * stream, cov_sum * c, int dim) {
+    assert((dim > 0) && (dim <= c->dim));
+    int i, j;
+    for (i = 0; i < dim; i++) {
+        for (j = 0; j < dim; j++) {
+            fprintf(stream, "%.12lf%s", get_covariance(c, i, j),
+                    ((j < (dim - 1)) ? "\t" : "\n"));
+        }
+    }
+}
+
+projection * init_projection(int method, int dim, int num_components) {
+    assert((dim > 0) && (num_components > 0));
+    projection * p;
+    p = (typeof(*p) *) malloc(sizeof(*p));
+    p->method = method;
+    p->dim = dim;
+    p->num_components = num_components;
+    p->weights = init_d_array(dim * num_components);
+    p->weights->length = dim * num_components;
+    memset(p->weights->a, 0, (p->weights->length * sizeof(*p->weights->a)));
+    return p;
+}
+
+void free_projection(projection * p) {
+    free_d_array(p->weights);
+    free(p);
+    p = NULL;
+}
+
+int parse_projection_method(const char * name) {
+    if (strcmp(name, "pca") == 0) {
+        return PROJECTION_PCA;
+    }
+    if (strcmp(name, "pls") == 0) {
+        return PROJECTION_PLS;
+    }
+    return -1;
+}
+
+const char * get_projection_method_name(int method) {
+    return (method == PROJECTION_PLS) ? "pls" : "pca";
+}
+
+void project_vector(const projection * p, const d_array * x,
+        d_array * scores) {
+    assert(x->length == p->dim);
+    int i, j;
+    double s;
+    const double * w;
+    scores->length = 0;
+    for (i = 0; i < p->num_components; i++) {
+        w = p->weights->a + ((size_t) i * p->dim);
+        s = 0.0;
+        for (j = 0; j < p->dim; j++) {
+            s += w[j] * x->a[j];
+        }
+        append_d_array(scores, s);
+    }
+}
+
+double get_projected_distance(const projection * p, const d_array * scores,
+        const d_array * x) {
+    assert((x->length == p->dim) && (scores->length == p->num_components));
+    int i, j;
+    double s, d, sum;
+    const double * w;
+    sum = 0.0;
+    for (i = 0; i < p->num_components; i++) {
+        w = p->weights->a + ((size_t) i * p->dim);
+        s = 0.0;
+        for (j = 0; j < p->dim; j++) {
+            s += w[j] * x->a[j];
+        }
+        d = s - scores->a[i];
+        sum += d * d;
+    }
+    return sqrt(sum);
+}
+
+/**
+ * Returns the correlation matrix (row-major) of the first `dim` variables
+ * summed by `c`; the correlations of a variable with no variance are 0.
+ */
+static double * get_correlation_matrix(cov_sum * c, int dim) {
+    int i, j;
+    double * r;
+    double * sd;
+    if (((r = (typeof(*r) *) malloc(((size_t) dim * dim) * sizeof(*r))) ==
+            NULL) || ((sd = (typeof(*sd) *) malloc(dim * sizeof(*sd))) ==
+            NULL)) {
+        perror("out of memory");
+        exit(1);
+    }
+    for (i = 0; i < dim; i++) {
+        sd[i] = sqrt(get_covariance(c, i, i));
+    }
+    for (i = 0; i < dim; i++) {
+        for (j = 0; j < dim; j++) {
+            r[(i * dim) + j] = ((sd[i] > 0.0) && (sd[j] > 0.0)) ?
+                    (get_covariance(c, i, j) / (sd[i] * sd[j])) : 0.0;
+        }
+    }
+    free(sd);
+    return r;
+}
+
+/**
+ * Flip the sign of `w` (of length `n`), if need be, so that its element of
+ * greatest magnitude is positive; this makes the weights reproducible.
+ */
+static void orient_weights(double * w, int n) {
+    int i, best;
+    best = 0;
+    for (i = 1; i < n; i++) {
+        if (fabs(w[i]) > fabs(w[best])) {
+            best = i;
+        }
+    }
+    if (w[best] < 0.0) {
+        for (i = 0; i < n; i++) {
+            w[i] = -w[i];
+        }
+    }
+}
+
+projection * get_pca_projection(cov_sum * c, int num_components) {
+    assert((num_components > 0) && (num_components <= c->dim));
+    int i, d;
+    double * r;
+    double * values;
+    double * vectors;
+    projection * p;
+    d = c->dim;
+    r = get_correlation_matrix(c, d);
+    if (((values = (typeof(*values) *) malloc(d * sizeof(*values))) ==
+            NULL) || ((vectors = (typeof(*vectors) *) malloc(
+            ((size_t) d * d) * sizeof(*vectors))) == NULL)) {
+        perror("out of memory");
+        exit(1);
+    }
+    get_symmetric_eigen(r, d, values, vectors);
+    p = init_projection(PROJECTION_PCA, d, num_components);
+    memcpy(p->weights->a, vectors, (((size_t) d * num_components) *
+            sizeof(*vectors)));
+    for (i = 0; i < num_components; i++) {
+        orient_weights((p->weights->a + ((size_t) i * d)), d);
+    }
+    free(r);
+    free(values);
+    free(vectors);
+    return p;
+}
+
+// the smallest variance of a PLS component, relative to that of the stats,
+// below which the stats are taken to explain no more of the responses
+#define PLS_MIN_VARIANCE 1e-10
+
+projection * get_pls_projection(cov_sum * c, int num_stats,
+        int num_components) {
+    assert((num_stats > 0) && (num_stats < c->dim));
+    assert((num_components > 0) && (num_components <= num_stats));
+    int i, j, k, a, d, np, num_found;
+    double x, norm, tt;
+    double * r;
+    double * s;
+    double * m;
+    double * w;
+    double * v;
+    double * load;
+    double * values;
+    double * vectors;
+    double * sd;
+    projection * p;
+    d = num_stats;
+    np = c->dim - num_stats;
+    r = get_correlation_matrix(c, d);
+    if (((s = (typeof(*s) *) malloc(((size_t) d * np) * sizeof(*s))) ==
+            NULL) ||
+            ((m = (typeof(*m) *) malloc(((size_t) np * np) * sizeof(*m))) ==
+            NULL) ||
+            ((v = (typeof(*v) *) malloc(((size_t) d * num_components) *
+            sizeof(*v))) == NULL) ||
+            ((load = (typeof(*load) *) malloc(d * sizeof(*load))) == NULL) ||
+            ((values = (typeof(*values) *) malloc(np * sizeof(*values))) ==
+            NULL) ||
+            ((vectors = (typeof(*vectors) *) malloc(((size_t) np * np) *
+            sizeof(*vectors))) == NULL) ||
+            ((sd = (typeof(*sd) *) malloc(c->dim * sizeof(*sd))) == NULL)) {
+        perror("out of memory");
+        exit(1);
+    }
+    for (i = 0; i < c->dim; i++) {
+        sd[i] = sqrt(get_covariance(c, i, i));
+    }
+    // the cross-covariances of the standardized stats and responses
+    for (i = 0; i < d; i++) {
+        for (j = 0; j < np; j++) {
+            s[(i * np) + j] = ((sd[i] > 0.0) && (sd[d + j] > 0.0)) ?
+                    (get_covariance(c, i, (d + j)) / (sd[i] * sd[d + j])) :
+                    0.0;
+        }
+    }
+    p = init_projection(PROJECTION_PLS, d, num_components);
+    num_found = 0;
+    for (a = 0; a < num_components; a++) {
+        w = p->weights->a + ((size_t) a * d);
+        // the weights are the direction of greatest covariance with the
+        // responses: s times the leading eigenvector of s's' s
+        for (i = 0; i < np; i++) {
+            for (j = 0; j < np; j++) {
+                x = 0.0;
+                for (k = 0; k < d; k++) {
+                    x += s[(k * np) + i] * s[(k * np) + j];
+                }
+                m[(i * np) + j] = x;
+            }
+        }
+        get_symmetric_eigen(m, np, values, vectors);
+        for (k = 0; k < d; k++) {
+            x = 0.0;
+            for (j = 0; j < np; j++) {
+                x += s[(k * np) + j] * vectors[j];
+            }
+            w[k] = x;
+        }
+        // scale the weights so that the component has unit variance
+        tt = 0.0;
+        for (i = 0; i < d; i++) {
+            x = 0.0;
+            for (k = 0; k < d; k++) {
+                x += r[(i * d) + k] * w[k];
+            }
+            load[i] = x;
+            tt += w[i] * x;
+        }
+        if (!(tt > PLS_MIN_VARIANCE)) {
+            break;
+        }
+        for (i = 0; i < d; i++) {
+            w[i] /= sqrt(tt);
+            load[i] /= sqrt(tt);
+        }
+        // deflate the cross-covariances by the loadings, orthogonalized
+        // against those of the previous components
+        for (j = 0; j < a; j++) {
+            x = 0.0;
+            for (k = 0; k < d; k++) {
+                x += v[(j * d) + k] * load[k];
+            }
+            for (k = 0; k < d; k++) {
+                load[k] -= x * v[(j * d) + k];
+            }
+        }
+        norm = 0.0;
+        for (k = 0; k < d; k++) {
+            norm += load[k] * load[k];
+        }
+        norm = sqrt(norm);
+        for (k = 0; k < d; k++) {
+            v[(a * d) + k] = load[k] / norm;
+        }
+        for (j = 0; j < np; j++) {
+            x = 0.0;
+            for (k = 0; k < d; k++) {
+                x += v[(a * d) + k] * s[(k * np) + j];
+            }
+            for (k = 0; k < d; k++) {
+                s[(k * np) + j] -= x * v[(a * d) + k];
+            }
+        }
+        orient_weights(w, d);
+        num_found++;
+    }
+    if (num_found < 1) {
+        free_projection(p);
+        p = NULL;
+    }
+    else {
+        p->num_components = num_found;
+        p->weights->length = num_found * d;
+    }
+    free(r);
+    free(s);
+    free(m);
+    free(v);
+    free(load);
+    free(values);
+    free(vectors);
+    free(sd);
+    return p;
+}
+
+void write_projection(FILE * stream, const projection * p) {
+    int i, j;
+    fprintf(stream, "projection\t%s\t%d\n",
+            get_projection_method_name(p->method), p->num_components);
+    for (i = 0; i < p->num_components; i++) {
+        for (j = 0; j < p->dim; j++) {
+            fprintf(stream, "%.12lf%s", p->weights->a[(i * p->dim) + j],
+                    ((j < (p->dim - 1)) ? "\t" : "\n"));
+        }
+    }
+}
+
+quantile_sketch * init_quantile_sketch(int buffer_size) {
+    assert(buffer_size > 1);
+    quantile_sketch * q;
+    q = (typeof(*q) *) malloc(sizeof(*q));
+    q->buffer_size = buffer_size;
+    q->num_levels = 1;
+    if ((q->levels = (typeof(*q->levels) *) calloc(q->num_levels,
+            sizeof(*q->levels))) == NULL) {
+        perror("out of memory");
+        exit(1);
+    }
+    q->levels[0] = init_d_array(buffer_size);
+    q->n = 0;
+    q->min = 0.0;
+    q->max = 0.0;
+    return q;
+}
+
+void free_quantile_sketch(quantile_sketch * q) {
+    int i;
+    for (i = 0; i < q->num_levels; i++) {
+        free_d_array(q->levels[i]);
+    }
+    free(q->levels);
+    free(q);
+    q = NULL;
+}
+
+static int compare_doubles(const void * a, const void * b) {
+    double x, y;
+    x = *((const double *) a);
+    y = *((const double *) b);
+    return (x > y) - (x < y);
+}
+
+/**
+ * Sort level `level` and move every other value up a level; with an odd
+ * number of values, the largest stays behind.
+ */
+static void compact_quantile_sketch(quantile_sketch * q, int level) {
+    int i, n, offset;
+    d_array * v;
+    if ((level + 1) >= q->num_levels) {
+        q->num_levels++;
+        if ((q->levels = (typeof(*q->levels) *) realloc(q->levels,
+                (q->num_levels * sizeof(*q->levels)))) == NULL) {
+            perror("out of memory");
+            exit(1);
+        }
+        q->levels[q->num_levels - 1] = init_d_array(q->buffer_size);
+    }
+    v = q->levels[level];
+    qsort(v->a, v->length, sizeof(*v->a), compare_doubles);
+    n = v->length - (v->length % 2);
+    // alternate between keeping the odd and the even values, so that the
+    // errors do not accumulate in one direction
+    offset = (int) ((q->n / q->buffer_size) % 2);
+    for (i = offset; i < n; i += 2) {
+        d_array_append(q->levels[level + 1], v->a[i]);
+    }
+    if (n < v->length) {
+        v->a[0] = v->a[n];
+    }
+    v->length -= n;
+    if (q->levels[level + 1]->length >= q->buffer_size) {
+        compact_quantile_sketch(q, (level + 1));
+    }
+}
+
+void update_quantile_sketch(quantile_sketch * q, double x) {
+    if ((q->n == 0) || (x < q->min)) {
+        q->min = x;
+    }
+    if ((q->n == 0) || (x > q->max)) {
+        q->max = x;
+    }
+    q->n++;
+    d_array_append(q->levels[0], x);
+    if (q->levels[0]->length >= q->buffer_size) {
+        compact_quantile_sketch(q, 0);
+    }
+}
+
+typedef struct weighted_value_ {
+    double value;
+    double weight;
+} weighted_value;
+
+static int compare_weighted_values(const void * a, const void * b) {
+    return compare_doubles(&((const weighted_value *) a)->value,
+            &((const weighted_value *) b)->value);
+}
+
+/**
+ * Returns the values of the sketch, sorted, with their weights; stores
+ * their number in `length` and their total weight in `total`.
+ */
+static weighted_value * get_weighted_values(const quantile_sketch * q,
+        int * length, double * total) {
+    int i, j, n;
+    double w;
+    weighted_value * v;
+    n = 0;
+    for (i = 0; i < q->num_levels; i++) {
+        n += q->levels[i]->length;
+    }
+    if ((v = (typeof(*v) *) malloc((n + 1) * sizeof(*v))) == NULL) {
+        perror("out of memory");
+        exit(1);
+    }
+    n = 0;
+    *total = 0.0;
+    for (i = 0, w = 1.0; i < q->num_levels; i++, w *= 2.0) {
+        for (j = 0; j < q->levels[i]->length; j++) {
+            v[n].value = q->levels[i]->a[j];
+            v[n].weight = w;
+            *total += w;
+            n++;
+        }
+    }
+    qsort(v, n, sizeof(*v), compare_weighted_values);
+    *length = n;
+    return v;
+}
+
+/**
+ * The value at 0-based rank `rank` of the sorted, weighted values, each of
+ * which occupies as many ranks as its weight.
+ */
+static double get_value_at_rank(const weighted_value * v, int n,
+        double rank) {
+    int i;
+    double cumulative;
+    cumulative = 0.0;
+    for (i = 0; i < (n - 1); i++) {
+        cumulative += v[i].weight;
+        if (rank < cumulative) {
+            break;
+        }
+    }
+    return v[i].value;
+}
+
+double get_quantile(const quantile_sketch * q, double p) {
+    assert((q->n > 0) && (p >= 0.0) && (p <= 1.0));
+    int n;
+    double total, h, lo, hi, x;
+    weighted_value * v;
+    if (p <= 0.0) {
+        return q->min;
+    }
+    if (p >= 1.0) {
+        return q->max;
+    }
+    v = get_weighted_values(q, &n, &total);
+    h = p * (total - 1.0);
+    lo = get_value_at_rank(v, n, floor(h));
+    hi = get_value_at_rank(v, n, ceil(h));
+    x = lo + ((h - floor(h)) * (hi - lo));
+    free(v);
+    return x;
+}
+
+void get_hpd_interval(const quantile_sketch * q, double mass, double * lower,
+        double * upper) {
+    assert((q->n > 0) && (mass > 0.0) && (mass <= 1.0));
+    int n, i, j;
+    double total, target, in_interval;
+    weighted_value * v;
+    v = get_weighted_values(q, &n, &total);
+    target = ceil(mass * total);
+    *lower = q->min;
+    *upper = q->max;
+    in_interval = 0.0;
+    // for each lower bound `i`, extend the upper bound `j` until the
+    // interval holds enough of the values
+    for (i = 0, j = 0; i < n; i++) {
+        while ((j < n) && (in_interval < target)) {
+            in_interval += v[j].weight;
+            j++;
+        }
+        if (in_interval < target) {
+            break;
+        }
+        if ((v[j - 1].value - v[i].value) < (*upper - *lower)) {
+            *lower = v[i].value;
+            *upper = v[j - 1].value;
+        }
+        in_interval -= v[i].weight;
+    }
+    free(v);
+}
+
+posterior_summary * init_posterior_summary(const s_array * header,
+        const i_array * columns, int sketch_size) {
+    assert(columns->length > 0);
+    int i;
+    posterior_summary * s;
+    s = (typeof(*s) *) malloc(sizeof(*s));
+    s->names = init_s_array(columns->length);
+    s->columns = init_i_array(columns->length);
+    extend_i_array(s->columns, columns);
+    for (i = 0; i < columns->length; i++) {
+        append_s_array(s->names, get_s_array(header, get_i_array(columns,
+                i)));
+    }
+    s->moments = init_sample_moments(columns->length, 1);
+    if ((s->sketches = (typeof(*s->sketches) *) calloc(columns->length,
+            sizeof(*s->sketches))) == NULL) {
+        perror("out of memory");
+        exit(1);
+    }
+    for (i = 0; i < columns->length; i++) {
+        s->sketches[i] = init_quantile_sketch(sketch_size);
+    }
+    return s;
+}
+
+void free_posterior_summary(posterior_summary * s) {
+    int i;
+    for (i = 0; i < s->columns->length; i++) {
+        free_quantile_sketch(s->sketches[i]);
+    }
+    free(s->sketches);
+    free_sample_moments(s->moments);
+    free_i_array(s->columns);
+    free_s_array(s->names);
+    free(s);
+    s = NULL;
+}
+
+void update_posterior_summary(posterior_summary * s,
+        const s_array * line_array) {
+    int i;
+    double x;
+    char * str;
+    char * end_ptr;
+    for (i = 0; i < s->columns->length; i++) {
+        str = get_s_array(line_array, i_array_get(s->columns, i));
+        x = strtod(str, &end_ptr);
+        if ((end_ptr == str) || (*end_ptr != '\0') || (isnan(x))) {
+            continue;
+        }
+        update_sample_moments_column(s->moments, i, x);
+        update_quantile_sketch(s->sketches[i], x);
+    }
+}
+
+static void write_summary_value(FILE * stream, double x, int available) {
+    if (available != 0) {
+        fprintf(stream, "\t%.12lf", x);
+    }
+    else {
+        fprintf(stream, "\tNA");
+    }
+}
+
+void write_posterior_summary(FILE * stream, const posterior_summary * s) {
+    int i, j, n;
+    double lower, upper;
+    const double probs[5] = {0.025, 0.25, 0.5, 0.75, 0.975};
+    const quantile_sketch * q;
+    fprintf(stream, "parameter\tn\tmean\tstd_dev\tmin\tq_0.025\tq_0.25\t"
+            "median\tq_0.75\tq_0.975\tmax\thpd_95_lower\thpd_95_upper\n");
+    for (i = 0; i < s->columns->length; i++) {
+        q = s->sketches[i];
+        n = s->moments->n[i];
+        fprintf(stream, "%s\t%d", get_s_array(s->names, i), n);
+        write_summary_value(stream, s->moments->mean[i], (n > 0));
+        write_summary_value(stream, ((n > 1) ?
+                sqrt(s->moments->m2[i] / (n - 1)) : 0.0), (n > 1));
+        write_summary_value(stream, q->min, (n > 0));
+        for (j = 0; j < 5; j++) {
+            write_summary_value(stream, ((n > 0) ? get_quantile(q, probs[j]) :
+                    0.0), (n > 0));
+        }
+        write_summary_value(stream, q->max, (n > 0));
+        lower = 0.0;
+        upper = 0.0;
+        if (n > 0) {
+            get_hpd_interval(q, 0.95, &lower, &upper);
+        }
+        write_summary_value(stream, lower, (n > 0));
+        write_summary_value(stream, upper, (n > 0));
+        fprintf(stream, "\n");
+    }
+}
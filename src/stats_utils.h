@@ -23,9 +23,14 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <math.h>
 #include <assert.h>
 #include "array_utils.h"
+#include "math_utils.h"
+
+#define PROJECTION_PCA 0
+#define PROJECTION_PLS 1
 
 typedef struct sample_sum_ {
     int n;
@@ -38,6 +43,100 @@ typedef struct sample_sum_array_ {
     int length;
 } sample_sum_array;
 
+/**
+ * Streaming sample sizes, means and sums of squared deviations from the
+ * means (`m2`) of `length` variables, stored as a structure of arrays.
+ * Rows are buffered in `block` (row by row) and, once `block_capacity` rows
+ * are buffered, folded in together: the block's own means and sums of
+ * squares are calculated a column at a time across each row, which
+ * vectorizes, and merged with the running ones as by Chan, Golub and
+ * LeVeque (1979). Unlike `sample_sum`, this does not lose precision when
+ * the variance is small relative to the mean. `n` counts the rows folded
+ * in.
+ */
+typedef struct sample_moments_ {
+    int length;
+    int * n;
+    double * mean;
+    double * m2;
+    double * block;
+    double * block_mean;
+    double * block_m2;
+    int block_length;
+    int block_capacity;
+} sample_moments;
+
+/**
+ * Streaming sums for the covariance matrix of `dim` variables. Rows are
+ * buffered in `batch` (column by column, so that each variable's values
+ * are contiguous) and, once `batch_capacity` rows are buffered, folded into
+ * the means and `comoments` with a rank-k update; `n` counts the rows
+ * folded in. `comoments` holds the sums of the products of deviations from
+ * the means, packed by rows of the upper triangle: element (i, j), with
+ * i <= j, is at i * dim - i * (i - 1) / 2 + (j - i). Two sums can be
+ * merged, so that parts of the data can be summed separately.
+ * `batch_means` and `batch_comoments` are scratch space for a flush.
+ */
+typedef struct cov_sum_ {
+    int dim;
+    long n;
+    double * means;
+    double * comoments;
+    double * batch;
+    int batch_length;
+    int batch_capacity;
+    double * batch_means;
+    double * batch_comoments;
+} cov_sum;
+
+/**
+ * A linear map from `dim` standardized stats to `num_components` scores:
+ * score i is the dot product of the stats with row i of `weights` (which
+ * holds `num_components` rows of `dim` weights). The weights are the
+ * leading principal components of the stats (`PROJECTION_PCA`), or the
+ * partial least squares (SIMPLS) weights of the stats for predicting a set
+ * of responses (`PROJECTION_PLS`).
+ */
+typedef struct projection_ {
+    int method;
+    int dim;
+    int num_components;
+    d_array * weights;
+} projection;
+
+/**
+ * A streaming sketch of a distribution for approximate quantiles, in the
+ * style of Munro and Paterson (1980) and Karnin, Lang and Liberty (2016).
+ * Values are added to `levels[0]`; when a level holds `buffer_size` values,
+ * it is sorted and every other value is moved up a level, so that each
+ * value in `levels[i]` stands for 2^i of the values added. Quantiles are
+ * exact while no more than `buffer_size` values have been added, and
+ * otherwise have a rank error of about log2(n / buffer_size) / buffer_size.
+ * The minimum and maximum are always exact.
+ */
+typedef struct quantile_sketch_ {
+    d_array ** levels;
+    int num_levels;
+    int buffer_size;
+    long n;
+    double min;
+    double max;
+} quantile_sketch;
+
+/**
+ * Posterior summaries of the columns `columns` (named `names`) of the
+ * retained samples: exact means and standard deviations, and quantiles and
+ * highest posterior density (HPD) intervals from a sketch per column.
+ * Values that are not numbers are skipped, so each column of `moments` is
+ * updated on its own.
+ */
+typedef struct posterior_summary_ {
+    s_array * names;
+    i_array * columns;
+    sample_moments * moments;
+    quantile_sketch ** sketches;
+} posterior_summary;
+
 sample_sum * init_sample_sum();
 sample_sum_array * init_sample_sum_array(int length);
 void free_sample_sum_array(sample_sum_array * v);
@@ -53,5 +152,138 @@ void get_std_dev_array(const sample_sum_array * s, d_array * std_devs);
 void standardize_vector(d_array * v, const d_array * means,
         const d_array * std_devs);
 
+sample_moments * init_sample_moments(int length, int block_capacity);
+void free_sample_moments(sample_moments * m);
+void update_sample_moments(sample_moments * m, const d_array * x);
+
+/**
+ * Fold the value `x` of column `j` alone into `m` (Welford 1962), for rows
+ * with missing values; no rows may be buffered.
+ */
+void update_sample_moments_column(sample_moments * m, int j, double x);
+
+/**
+ * Fold the `num_rows` rows of `rows` (each of `m->length` values) into `m`
+ * at once.
+ */
+void update_sample_moments_block(sample_moments * m, const double * rows,
+        int num_rows);
+
+/**
+ * Fold the buffered rows into the means and sums of squares.
+ */
+void flush_sample_moments(sample_moments * m);
+void get_sample_moments_means(sample_moments * m, d_array * means);
+void get_sample_moments_std_devs(sample_moments * m, d_array * std_devs);
+
+cov_sum * init_cov_sum(int dim, int batch_capacity);
+void free_cov_sum(cov_sum * c);
+void update_cov_sum(cov_sum * c, const d_array * x);
+
+/**
+ * Fold the buffered rows into the means and comoments.
+ */
+void flush_cov_sum(cov_sum * c);
+
+/**
+ * Add the rows summed by `src` to `dest`.
+ */
+void merge_cov_sum(cov_sum * dest, cov_sum * src);
+int get_cov_sum_index(const cov_sum * c, int i, int j);
+
+/**
+ * The sample covariance of variables `i` and `j`.
+ */
+double get_covariance(cov_sum * c, int i, int j);
+
+/**
+ * Write the sample covariance matrix, one tab-delimited row per line.
+ */
+void write_covariance_matrix(FILE * stream, cov_sum * c);
+
+/**
+ * Write the covariance matrix of the first `dim` variables.
+ */
+void write_covariance_block(FILE * stream, cov_sum * c, int dim);
+
+projection * init_projection(int method, int dim, int num_components);
+void free_projection(projection * p);
+
+/**
+ * Returns `PROJECTION_PCA` or `PROJECTION_PLS` for "pca" or "pls", and -1
+ * for anything else.
+ */
+int parse_projection_method(const char * name);
+const char * get_projection_method_name(int method);
+
+/**
+ * Store in `scores` the projection of the standardized stats `x`.
+ */
+void project_vector(const projection * p, const d_array * x,
+        d_array * scores);
+
+/**
+ * Returns the Euclidean distance between `scores` and the projection of
+ * the standardized stats `x`, without storing the projection.
+ */
+double get_projected_distance(const projection * p, const d_array * scores,
+        const d_array * x);
+
+/**
+ * Returns the projection of the standardized variables summed by `c` onto
+ * their first `num_components` principal components (the eigenvectors of
+ * their correlation matrix with the largest eigenvalues).
+ */
+projection * get_pca_projection(cov_sum * c, int num_components);
+
+/**
+ * Returns the partial least squares projection of the first `num_stats`
+ * standardized variables summed by `c` for predicting the remaining ones,
+ * by SIMPLS (de Jong 1993). Each component has unit variance. If the stats
+ * can explain no more of the responses, fewer than `num_components`
+ * components are returned, or NULL if the stats are uncorrelated with the
+ * responses.
+ */
+projection * get_pls_projection(cov_sum * c, int num_stats,
+        int num_components);
+
+/**
+ * Write `p` as a line with "projection", the method and the number of
+ * components, followed by a line of weights for each component.
+ */
+void write_projection(FILE * stream, const projection * p);
+
+quantile_sketch * init_quantile_sketch(int buffer_size);
+void free_quantile_sketch(quantile_sketch * q);
+void update_quantile_sketch(quantile_sketch * q, double x);
+
+/**
+ * The `p` quantile (0 <= p <= 1), interpolated between the nearest ranks as
+ * in R's default (type 7) quantile.
+ */
+double get_quantile(const quantile_sketch * q, double p);
+
+/**
+ * Store in `lower` and `upper` the bounds of the shortest interval that
+ * contains (at least) proportion `mass` of the values.
+ */
+void get_hpd_interval(const quantile_sketch * q, double mass, double * lower,
+        double * upper);
+
+posterior_summary * init_posterior_summary(const s_array * header,
+        const i_array * columns, int sketch_size);
+void free_posterior_summary(posterior_summary * s);
+void update_posterior_summary(posterior_summary * s,
+        const s_array * line_array);
+
+/**
+ * Write a table with a row per column summarized: the column name, the
+ * number of values, their mean, standard deviation, minimum, 2.5%, 25%,
+ * 50% (median), 75% and 97.5% quantiles, maximum and 95% HPD interval.
+ * Summaries that cannot be calculated (e.g., the standard deviation of one
+ * value) are written as "NA".
+ */
+void write_posterior_summary(FILE * stream, const posterior_summary * s);
+
 #endif /* STATS_UTILS_H */
 
@@ -0,0 +1,134 @@
+/**
+ * @file        typed_array.h
+ * @authors     Jamie Oaks
+ * @package     ABACUS (Approximate BAyesian C UtilitieS)
+ * @brief       Macros that generate typed, growable arrays.
+ * @copyright   Copyright (C) 2013 Jamie Oaks.
+ *   This file is part of ABACUS.  ABACUS is free software; you can
+ *   redistribute it and/or modify it under the terms of the GNU General Public
+ *   License as published by the Free Software Foundation; either version 2 of
+ *   the License, or (at your option) any later version.
+ * 
+ *   ABACUS is distributed in the hope that it will be useful, but WITHOUT ANY
+ *   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *   FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *   details.
+ * 
+ *   You should have received a copy of the GNU General Public License along
+ *   with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TYPED_ARRAY_H
+#define TYPED_ARRAY_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+
+/**
+ * Bounds checks of the inline accessors. Like the other asserts, they are
+ * compiled out of release builds (those that define `NDEBUG`).
+ */
+#define TYPED_ARRAY_CHECK(condition) assert(condition)
+
+/**
+ * Declare an array type `NAME` of elements of type `TYPE`, e.g.,
+ * `DECLARE_TYPED_ARRAY(d_array, double)`, with the out-of-line functions
+ * `init_NAME`, `expand_NAME`, `append_NAME`, `extend_NAME`, `get_NAME`,
+ * `set_NAME` and `free_NAME` (defined by `DEFINE_TYPED_ARRAY`), and the
+ * static inline accessors `NAME_get`, `NAME_set`, `NAME_append` and
+ * `NAME_clear`, which the compiler can inline (and vectorize) in hot
+ * loops.
+ */
+#define DECLARE_TYPED_ARRAY(NAME, TYPE) \
+    typedef struct NAME##_ { \
+        TYPE * a; \
+        int length; \
+        int capacity; \
+    } NAME; \
+    \
+    NAME * init_##NAME(int capacity); \
+    void expand_##NAME(NAME * v); \
+    void append_##NAME(NAME * v, TYPE x); \
+    void extend_##NAME(NAME * dest, const NAME * to_add); \
+    TYPE get_##NAME(const NAME * v, int index); \
+    void set_##NAME(NAME * v, int index, TYPE x); \
+    void free_##NAME(NAME * v); \
+    \
+    static inline TYPE NAME##_get(const NAME * v, int index) { \
+        TYPED_ARRAY_CHECK((index >= 0) && (index < v->length)); \
+        return v->a[index]; \
+    } \
+    static inline void NAME##_set(NAME * v, int index, TYPE x) { \
+        TYPED_ARRAY_CHECK((index >= 0) && (index < v->length)); \
+        v->a[index] = x; \
+    } \
+    static inline void NAME##_append(NAME * v, TYPE x) { \
+        if (v->length >= v->capacity) { \
+            expand_##NAME(v); \
+        } \
+        v->a[v->length++] = x; \
+    } \
+    static inline void NAME##_clear(NAME * v) { \
+        v->length = 0; \
+    }
+
+/**
+ * Define the out-of-line functions of an array type declared by
+ * `DECLARE_TYPED_ARRAY`; used once per type, in array_utils.c.
+ */
+#define DEFINE_TYPED_ARRAY(NAME, TYPE) \
+    NAME * init_##NAME(int capacity) { \
+        assert(capacity > 0); \
+        NAME * v; \
+        v = (typeof(*v) *) malloc(sizeof(*v)); \
+        v->capacity = capacity; \
+        if ((v->a = (typeof(*v->a) *) calloc(v->capacity, \
+                sizeof(*v->a))) == NULL) { \
+            perror("out of memory"); \
+            exit(1); \
+        } \
+        v->length = 0; \
+        return v; \
+    } \
+    \
+    void expand_##NAME(NAME * v) { \
+        v->capacity *= 2; \
+        if ((v->a = (typeof(*v->a) *) realloc(v->a, \
+                (v->capacity * sizeof(*v->a)))) == NULL) { \
+            perror("out of memory"); \
+            exit(1); \
+        } \
+    } \
+    \
+    void append_##NAME(NAME * v, TYPE x) { \
+        NAME##_append(v, x); \
+    } \
+    \
+    void extend_##NAME(NAME * dest, const NAME * to_add) { \
+        int i, n; \
+        n = to_add->length; \
+        while ((dest->length + n) > dest->capacity) { \
+            expand_##NAME(dest); \
+        } \
+        for (i = 0; i < n; i++) { \
+            dest->a[dest->length + i] = to_add->a[i]; \
+        } \
+        dest->length += n; \
+    } \
+    \
+    TYPE get_##NAME(const NAME * v, int index) { \
+        return NAME##_get(v, index); \
+    } \
+    \
+    void set_##NAME(NAME * v, int index, TYPE x) { \
+        NAME##_set(v, index, x); \
+    } \
+    \
+    void free_##NAME(NAME * v) { \
+        free(v->a); \
+        free(v); \
+        v = NULL; \
+    }
+
+#endif /* TYPED_ARRAY_H */
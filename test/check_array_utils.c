@@ -337,13 +337,13 @@ START_TEST (test_init_free_s_array) {
             "attribute is not an int");
     ck_assert_msg((sizeof(v->capacity) == sizeof(int)), "`s_array.capacity` "
             "attribute is not an int");
-    ck_assert_msg((sizeof(v->a) == sizeof(long)), "Array attribute "
-            "of `s_array` is not a pointer");
-    ck_assert_msg((sizeof(*v->a) == sizeof(c_array *)), "Pointer to array"
-            "of `s_array` is not pointing to array of `c_array`s");
-    for (i = 0; i < v->capacity; i++) {
-        ck_assert_msg((v->a[i]->capacity > 0), "`c_array` element %d of %d was "
-                "not initialized ", i, size);
+    ck_assert_msg((sizeof(*v->arena) == sizeof(char)), "Arena of `s_array` "
+            "is not an array of `char`s");
+    ck_assert_msg((v->arena_capacity > 0), "Arena of `s_array` was not "
+            "allocated");
+    for (i = 0; i <= v->capacity; i++) {
+        ck_assert_msg((v->offsets[i] == 0), "offset %d of %d was not "
+                "initialized ", i, size);
     }
     free_s_array(v);
 }
@@ -368,10 +368,13 @@ START_TEST (test_expand_s_array) {
         ck_assert_int_eq(v->capacity, size);
         ck_assert_int_eq(v->length, 0);
     }
-    for (i = 0; i < v->capacity; i++) {
-        ck_assert_msg((v->a[i]->capacity > 0), "`c_array` element %d of %d was "
-                "not initialized ", i, size);
+    for (i = 0; i < size; i++) {
+        append_s_array(v, "foo");
     }
+    ck_assert_int_eq(v->capacity, size);
+    ck_assert_int_eq(v->length, size);
+    ck_assert_str_eq(get_s_array(v, (size - 1)), "foo");
+    ck_assert_int_eq(v->offsets[size], (size * 4));
     free_s_array(v);
 }
 END_TEST
@@ -388,13 +391,92 @@ START_TEST (test_append_s_array) {
     append_s_array(v, s);
     ck_assert_int_eq(v->capacity, size);
     ck_assert_int_eq(v->length, 1);
-    ck_assert_msg((*v->a[0]->a == *s), "`s_array` element is %s, expecting %s",
-            v->a[0]->a, s);
+    ck_assert_str_eq(get_s_array(v, 0), s);
     append_s_array(v, s2);
     ck_assert_int_eq(v->capacity, size*2);
     ck_assert_int_eq(v->length, 2);
-    ck_assert_msg((*v->a[1]->a == *s2), "`s_array` element is %s, expecting %s",
-            v->a[0]->a, s2);
+    ck_assert_str_eq(get_s_array(v, 0), s);
+    ck_assert_str_eq(get_s_array(v, 1), s2);
+    free_s_array(v);
+}
+END_TEST
+
+START_TEST (test_append_s_array_long) {
+    int i;
+    s_array * v;
+    c_array * s;
+    s = init_c_array(1000);
+    for (i = 0; i < 999; i++) {
+        s->a[i] = 'a' + (i % 26);
+    }
+    s->a[999] = '\0';
+    v = init_s_array(1);
+    append_s_array(v, "foo");
+    append_s_array(v, s->a);
+    append_s_array(v, "bar");
+    ck_assert_int_eq(v->length, 3);
+    ck_assert_str_eq(get_s_array(v, 0), "foo");
+    ck_assert_str_eq(get_s_array(v, 1), s->a);
+    ck_assert_str_eq(get_s_array(v, 2), "bar");
+    free_s_array(v);
+    free_c_array(s);
+}
+END_TEST
+
+START_TEST (test_append_s_array_self) {
+    int i;
+    s_array * v;
+    v = init_s_array(1);
+    append_s_array(v, "foo");
+    // each append may move the arena out from under the appended string
+    for (i = 0; i < 10; i++) {
+        append_s_array(v, get_s_array(v, i));
+    }
+    ck_assert_int_eq(v->length, 11);
+    for (i = 0; i < v->length; i++) {
+        ck_assert_str_eq(get_s_array(v, i), "foo");
+    }
+    free_s_array(v);
+}
+END_TEST
+
+START_TEST (test_extend_s_array) {
+    int i;
+    s_array * v;
+    s_array * v2;
+    v = init_s_array(1);
+    v2 = init_s_array(1);
+    append_s_array(v, "foo");
+    append_s_array(v2, "bar");
+    append_s_array(v2, "");
+    extend_s_array(v, v2);
+    ck_assert_int_eq(v->length, 3);
+    ck_assert_str_eq(get_s_array(v, 0), "foo");
+    ck_assert_str_eq(get_s_array(v, 1), "bar");
+    ck_assert_str_eq(get_s_array(v, 2), "");
+    extend_s_array(v, v);
+    ck_assert_int_eq(v->length, 6);
+    for (i = 0; i < 3; i++) {
+        ck_assert_str_eq(get_s_array(v, i), get_s_array(v, (i + 3)));
+    }
+    free_s_array(v);
+    free_s_array(v2);
+}
+END_TEST
+
+START_TEST (test_reset_s_array) {
+    s_array * v;
+    v = init_s_array(1);
+    append_s_array(v, "foo");
+    append_s_array(v, "bar");
+    reset_s_array(v);
+    ck_assert_int_eq(v->length, 0);
+    ck_assert_int_eq(v->capacity, 2);
+    append_s_array(v, "foobar");
+    ck_assert_int_eq(v->length, 1);
+    ck_assert_str_eq(get_s_array(v, 0), "foobar");
+    ck_assert_int_eq(v->offsets[1], 7);
+    free_s_array(v);
 }
 END_TEST
 
@@ -406,11 +488,34 @@ START_TEST (test_set_s_array) {
     size = 1;
     v = init_s_array(size);
     append_s_array(v, s);
-    ck_assert_msg((*v->a[0]->a == *s), "`s_array` element is %s, expecting %s",
-            v->a[0], s);
+    ck_assert_str_eq(get_s_array(v, 0), s);
     set_s_array(v, 0, s2);
-    ck_assert_msg((*v->a[0]->a == *s2), "`s_array` element is %d, expecting %d",
-            v->a[0], s2);
+    ck_assert_str_eq(get_s_array(v, 0), s2);
+    free_s_array(v);
+}
+END_TEST
+
+START_TEST (test_set_s_array_resize) {
+    s_array * v;
+    v = init_s_array(1);
+    append_s_array(v, "one");
+    append_s_array(v, "two");
+    append_s_array(v, "three");
+    set_s_array(v, 1, "a longer string than the others");
+    ck_assert_str_eq(get_s_array(v, 0), "one");
+    ck_assert_str_eq(get_s_array(v, 1), "a longer string than the others");
+    ck_assert_str_eq(get_s_array(v, 2), "three");
+    set_s_array(v, 1, "2");
+    ck_assert_str_eq(get_s_array(v, 0), "one");
+    ck_assert_str_eq(get_s_array(v, 1), "2");
+    ck_assert_str_eq(get_s_array(v, 2), "three");
+    ck_assert_int_eq(v->offsets[3], 12);
+    // setting from a string of the same array
+    set_s_array(v, 0, get_s_array(v, 2));
+    ck_assert_str_eq(get_s_array(v, 0), "three");
+    ck_assert_str_eq(get_s_array(v, 1), "2");
+    ck_assert_str_eq(get_s_array(v, 2), "three");
+    free_s_array(v);
 }
 END_TEST
 
@@ -595,6 +700,83 @@ START_TEST (test_get_matching_indices_fail) {
 }
 END_TEST
 
+START_TEST (test_get_matching_indices_duplicates) {
+    s_array * search_strings;
+    s_array * target_strings;
+    i_array * indices;
+    search_strings = init_s_array(1);
+    target_strings = init_s_array(1);
+    indices = init_i_array(1);
+    append_s_array(search_strings, "bar");
+    append_s_array(search_strings, "foo");
+    append_s_array(target_strings, "boo");
+    append_s_array(target_strings, "foo");
+    append_s_array(target_strings, "boo");
+    append_s_array(target_strings, "bar");
+    // duplicates that are not searched for are allowed
+    get_matching_indices(search_strings, target_strings, indices);
+    ck_assert_int_eq(indices->length, 2);
+    ck_assert_int_eq(get_i_array(indices, 0), 3);
+    ck_assert_int_eq(get_i_array(indices, 1), 1);
+    free_s_array(search_strings);
+    free_s_array(target_strings);
+    free_i_array(indices);
+}
+END_TEST
+
+START_TEST (test_get_matching_indices_duplicate_fail) {
+    s_array * search_strings;
+    s_array * target_strings;
+    i_array * indices;
+    search_strings = init_s_array(1);
+    target_strings = init_s_array(1);
+    indices = init_i_array(1);
+    append_s_array(search_strings, "foo");
+    append_s_array(search_strings, "boo");
+    append_s_array(target_strings, "boo");
+    append_s_array(target_strings, "foo");
+    append_s_array(target_strings, "boo");
+    get_matching_indices(search_strings, target_strings, indices); // exit(1)
+}
+END_TEST
+
+/**
+ * `s_map` tests
+ */
+START_TEST (test_s_map) {
+    int i, value;
+    char key[32];
+    s_map * m;
+    m = init_s_map(1);
+    ck_assert_int_eq(get_s_map(m, "foo", &value), 0);
+    ck_assert_int_eq(set_s_map(m, "foo", 1), 0);
+    ck_assert_int_eq(set_s_map(m, "", 2), 0);
+    ck_assert_int_eq(get_s_map(m, "foo", &value), 1);
+    ck_assert_int_eq(value, 1);
+    ck_assert_int_eq(set_s_map(m, "foo", 3), 1);
+    ck_assert_int_eq(get_s_map(m, "foo", &value), 1);
+    ck_assert_int_eq(value, 3);
+    ck_assert_int_eq(get_s_map(m, "", &value), 1);
+    ck_assert_int_eq(value, 2);
+    // grow well past the initial number of slots
+    for (i = 0; i < 1000; i++) {
+        sprintf(key, "stat.%d", i);
+        ck_assert_int_eq(set_s_map(m, key, i), 0);
+    }
+    ck_assert_int_eq(m->keys->length, 1002);
+    ck_assert_msg((m->num_slots >= 2004), "map has %d slots", m->num_slots);
+    for (i = 0; i < 1000; i++) {
+        sprintf(key, "stat.%d", i);
+        ck_assert_int_eq(get_s_map(m, key, &value), 1);
+        ck_assert_int_eq(value, i);
+    }
+    ck_assert_int_eq(get_s_map(m, "stat.1000", &value), 0);
+    ck_assert_int_eq(get_s_map(m, "foo", &value), 1);
+    ck_assert_int_eq(value, 3);
+    free_s_map(m);
+}
+END_TEST
+
 START_TEST (test_get_doubles) {
     int ret;
     s_array * search_strings;
@@ -926,6 +1108,29 @@ START_TEST (test_split_str) {
 }
 END_TEST
 
+START_TEST (test_split_str_long_words) {
+    int i, ret;
+    s_array * words;
+    c_array * string;
+    string = init_c_array(300);
+    for (i = 0; i < 200; i++) {
+        string->a[i] = 'x';
+    }
+    strcpy((string->a + 200), "  \tshort \n");
+    words = init_s_array(1);
+    ret = split_str(string->a, words, 0);
+    ck_assert_int_eq(ret, 0);
+    ck_assert_int_eq(words->length, 2);
+    ck_assert_int_eq(strlen(get_s_array(words, 0)), 200);
+    ck_assert_str_eq(get_s_array(words, 1), "short");
+    ret = split_str(" \t\n", words, 2);
+    ck_assert_int_eq(ret, -1);
+    ck_assert_int_eq(words->length, 0);
+    free_s_array(words);
+    free_c_array(string);
+}
+END_TEST
+
 START_TEST (test_split_str_d) {
     int ret;
     d_array * v;
@@ -988,6 +1193,227 @@ START_TEST (test_split_str_i) {
 END_TEST
 
 
+/**
+ * `i_array_csr` tests
+ */
+START_TEST (test_i_array_csr) {
+    int i;
+    i_array_csr * v;
+    i_array * x;
+    i_array row;
+    v = init_i_array_csr(1, 1);
+    x = init_i_array(3);
+    append_i_array(x, 3);
+    append_i_array(x, 1);
+    ck_assert_int_eq(v->length, 0);
+    append_row_i_array_csr(v, x);
+    start_row_i_array_csr(v);
+    start_row_i_array_csr(v);
+    for (i = 0; i < 10; i++) {
+        append_el_i_array_csr(v, i);
+    }
+    ck_assert_int_eq(v->length, 3);
+    ck_assert_int_eq(get_row_length_i_array_csr(v, 0), 2);
+    ck_assert_int_eq(get_row_length_i_array_csr(v, 1), 0);
+    ck_assert_int_eq(get_row_length_i_array_csr(v, 2), 10);
+    ck_assert_msg((i_arrays_equal(view_row_i_array_csr(v, 0, &row), x) != 0),
+            "unexpected row");
+    ck_assert_int_eq(view_row_i_array_csr(v, 1, &row)->length, 0);
+    ck_assert_int_eq(get_el_i_array_csr(v, 2, 9), 9);
+    ck_assert_int_eq(get_el_i_array_csr(v, 0, 1), 1);
+    ck_assert_int_eq(v->values->length, 12);
+    free_i_array(x);
+    free_i_array_csr(v);
+}
+END_TEST
+
+START_TEST (test_write_i_array_csr) {
+    FILE * stream;
+    char s[64];
+    i_array_csr * v;
+    v = init_i_array_csr(2, 4);
+    start_row_i_array_csr(v);
+    append_el_i_array_csr(v, 2);
+    append_el_i_array_csr(v, 1);
+    start_row_i_array_csr(v);
+    append_el_i_array_csr(v, 3);
+    stream = tmpfile();
+    write_i_array_csr(stream, v, "\t");
+    rewind(stream);
+    s[fread(s, 1, (sizeof(s) - 1), stream)] = '\0';
+    ck_assert_str_eq(s, "2\t1\n3\n");
+    fclose(stream);
+    free_i_array_csr(v);
+}
+END_TEST
+
+START_TEST (test_get_el_i_array_csr_fail) {
+    i_array_csr * v;
+    v = init_i_array_csr(2, 4);
+    start_row_i_array_csr(v);
+    append_el_i_array_csr(v, 2);
+    start_row_i_array_csr(v);
+    get_el_i_array_csr(v, 1, 0); // SIGABRT
+}
+END_TEST
+
+START_TEST (test_append_el_i_array_csr_fail) {
+    i_array_csr * v;
+    v = init_i_array_csr(2, 4);
+    append_el_i_array_csr(v, 2); // SIGABRT
+}
+END_TEST
+
+/**
+ * typed array tests
+ */
+START_TEST (test_typed_array_inline) {
+    int i;
+    d_array * v;
+    v = init_d_array(1);
+    for (i = 0; i < 5; i++) {
+        d_array_append(v, (double) i);
+    }
+    ck_assert_int_eq(v->length, 5);
+    ck_assert_int_eq(v->capacity, 8);
+    d_array_set(v, 2, 10.0);
+    ck_assert_msg((d_array_get(v, 2) == 10.0), "element is %lf, expecting "
+            "10.0", d_array_get(v, 2));
+    ck_assert_msg((get_d_array(v, 4) == 4.0), "element is %lf, expecting "
+            "4.0", get_d_array(v, 4));
+    d_array_clear(v);
+    ck_assert_int_eq(v->length, 0);
+    ck_assert_int_eq(v->capacity, 8);
+    free_d_array(v);
+}
+END_TEST
+
+START_TEST (test_typed_array_inline_fail) {
+    i_array * v;
+    v = init_i_array(4);
+    i_array_append(v, 1);
+    i_array_get(v, 1); // SIGABRT
+}
+END_TEST
+
+START_TEST (test_f_array) {
+    f_array * v;
+    v = init_f_array(1);
+    append_f_array(v, 0.5f);
+    append_f_array(v, 1.5f);
+    extend_f_array(v, v);
+    ck_assert_int_eq(v->length, 4);
+    ck_assert_msg((get_f_array(v, 3) == 1.5f), "element is %f, expecting "
+            "1.5", get_f_array(v, 3));
+    set_f_array(v, 0, 2.5f);
+    ck_assert_msg((f_array_get(v, 0) == 2.5f), "element is %f, expecting "
+            "2.5", f_array_get(v, 0));
+    free_f_array(v);
+}
+END_TEST
+
+START_TEST (test_z_array) {
+    z_array * v;
+    v = init_z_array(2);
+    append_z_array(v, ((size_t) 1) << 40);
+    ck_assert_msg((get_z_array(v, 0) == (((size_t) 1) << 40)),
+            "element was truncated");
+    free_z_array(v);
+}
+END_TEST
+
+START_TEST (test_o_array) {
+    o_array * v;
+    o_array * v2;
+    v = init_o_array(1);
+    v2 = init_o_array(1);
+    append_o_array(v, 0L);
+    append_o_array(v2, 135L);
+    append_o_array(v2, 300L);
+    extend_o_array(v, v2);
+    ck_assert_int_eq(v->length, 3);
+    ck_assert_int_eq(get_o_array(v, 0), 0);
+    ck_assert_int_eq(get_o_array(v, 1), 135);
+    ck_assert_int_eq(get_o_array(v, 2), 300);
+    free_o_array(v);
+    free_o_array(v2);
+}
+END_TEST
+
+/**
+ * `bump_arena` tests
+ */
+START_TEST (test_bump_alloc) {
+    int i;
+    bump_arena * b;
+    char * p1;
+    char * p2;
+    b = init_bump_arena(64);
+    p1 = (typeof(*p1) *) bump_alloc(b, 3);
+    p2 = (typeof(*p2) *) bump_alloc(b, 8);
+    ck_assert_msg((((size_t) p1 % BUMP_ARENA_ALIGNMENT) == 0),
+            "block was not aligned");
+    ck_assert_msg((((size_t) p2 % BUMP_ARENA_ALIGNMENT) == 0),
+            "block was not aligned");
+    ck_assert_msg((p2 >= (p1 + 3)), "blocks overlap");
+    ck_assert_int_eq(b->num_retired, 0);
+    strcpy(p1, "ab");
+    // outgrowing the block keeps the earlier allocations
+    for (i = 0; i < 10; i++) {
+        memset(bump_alloc(b, 40), 'x', 40);
+    }
+    ck_assert_msg((b->num_retired > 0), "arena did not grow");
+    ck_assert_str_eq(p1, "ab");
+    // after a reset, the grown block holds everything
+    reset_bump_arena(b);
+    ck_assert_int_eq(b->num_retired, 0);
+    ck_assert_int_eq(b->used, 0);
+    bump_alloc(b, 3);
+    bump_alloc(b, 8);
+    for (i = 0; i < 10; i++) {
+        bump_alloc(b, 40);
+    }
+    ck_assert_int_eq(b->num_retired, 0);
+    free_bump_arena(b);
+}
+END_TEST
+
+START_TEST (test_bump_alloc_large) {
+    bump_arena * b;
+    char * p;
+    b = init_bump_arena(16);
+    p = (typeof(*p) *) bump_alloc(b, 1000);
+    memset(p, 'x', 1000);
+    ck_assert_msg((b->capacity >= 1000), "capacity is %d",
+            (int) b->capacity);
+    free_bump_arena(b);
+}
+END_TEST
+
+START_TEST (test_bump_alloc_d_array) {
+    bump_arena * b;
+    d_array * v;
+    b = init_bump_arena(8);
+    v = bump_alloc_d_array(b, 3);
+    ck_assert_int_eq(v->capacity, 3);
+    ck_assert_int_eq(v->length, 0);
+    append_d_array(v, 1.0);
+    append_d_array(v, 2.0);
+    append_d_array(v, 3.0);
+    ck_assert_int_eq(v->capacity, 3);
+    ck_assert_int_eq(v->length, 3);
+    ck_assert_msg((get_d_array(v, 2) == 3.0), "element is %lf, expecting 3.0",
+            get_d_array(v, 2));
+    free_bump_arena(b);
+}
+END_TEST
+
+START_TEST (test_init_bump_arena_fail) {
+    bump_arena * b;
+    b = init_bump_arena(0); // SIGABRT
+}
+END_TEST
+
 Suite * array_utils_suite(void) {
     Suite * s = suite_create("array_utils");
 
@@ -1026,7 +1452,12 @@ Suite * array_utils_suite(void) {
     tcase_add_test_raise_signal(tc_s_array, test_init_s_array_fail, SIGABRT);
     tcase_add_test(tc_s_array, test_expand_s_array);
     tcase_add_test(tc_s_array, test_append_s_array);
+    tcase_add_test(tc_s_array, test_append_s_array_long);
+    tcase_add_test(tc_s_array, test_append_s_array_self);
+    tcase_add_test(tc_s_array, test_extend_s_array);
+    tcase_add_test(tc_s_array, test_reset_s_array);
     tcase_add_test(tc_s_array, test_set_s_array);
+    tcase_add_test(tc_s_array, test_set_s_array_resize);
     tcase_add_test_raise_signal(tc_s_array, test_set_s_array_fail, SIGABRT);
     tcase_add_test(tc_s_array, test_get_s_array);
     tcase_add_test_raise_signal(tc_s_array, test_get_s_array_fail, SIGABRT);
@@ -1060,6 +1491,10 @@ Suite * array_utils_suite(void) {
     tcase_add_test(tc_get_matching_indices, test_get_matching_indices);
     tcase_add_exit_test(tc_get_matching_indices, test_get_matching_indices_fail,
             1);
+    tcase_add_test(tc_get_matching_indices,
+            test_get_matching_indices_duplicates);
+    tcase_add_exit_test(tc_get_matching_indices,
+            test_get_matching_indices_duplicate_fail, 1);
     suite_add_tcase(s, tc_get_matching_indices);
 
     TCase * tc_get_doubles = tcase_create("get_doubles_test_case");
@@ -1068,10 +1503,41 @@ Suite * array_utils_suite(void) {
 
     TCase * tc_split_str = tcase_create("split_str_test_case");
     tcase_add_test(tc_split_str, test_split_str);
+    tcase_add_test(tc_split_str, test_split_str_long_words);
     tcase_add_test(tc_split_str, test_split_str_d);
     tcase_add_test(tc_split_str, test_split_str_i);
     suite_add_tcase(s, tc_split_str);
 
+    TCase * tc_s_map = tcase_create("s_map_test_case");
+    tcase_add_test(tc_s_map, test_s_map);
+    suite_add_tcase(s, tc_s_map);
+
+    TCase * tc_i_array_csr = tcase_create("i_array_csr_test_case");
+    tcase_add_test(tc_i_array_csr, test_i_array_csr);
+    tcase_add_test(tc_i_array_csr, test_write_i_array_csr);
+    tcase_add_test_raise_signal(tc_i_array_csr, test_get_el_i_array_csr_fail,
+            SIGABRT);
+    tcase_add_test_raise_signal(tc_i_array_csr,
+            test_append_el_i_array_csr_fail, SIGABRT);
+    suite_add_tcase(s, tc_i_array_csr);
+
+    TCase * tc_typed_array = tcase_create("typed_array_test_case");
+    tcase_add_test(tc_typed_array, test_typed_array_inline);
+    tcase_add_test_raise_signal(tc_typed_array, test_typed_array_inline_fail,
+            SIGABRT);
+    tcase_add_test(tc_typed_array, test_f_array);
+    tcase_add_test(tc_typed_array, test_z_array);
+    tcase_add_test(tc_typed_array, test_o_array);
+    suite_add_tcase(s, tc_typed_array);
+
+    TCase * tc_bump_arena = tcase_create("bump_arena_test_case");
+    tcase_add_test(tc_bump_arena, test_bump_alloc);
+    tcase_add_test(tc_bump_arena, test_bump_alloc_large);
+    tcase_add_test(tc_bump_arena, test_bump_alloc_d_array);
+    tcase_add_test_raise_signal(tc_bump_arena, test_init_bump_arena_fail,
+            SIGABRT);
+    suite_add_tcase(s, tc_bump_arena);
+
     return s;
 }
 
@@ -0,0 +1,254 @@
+#include <stdlib.h>
+#include <check.h>
+#include <signal.h>
+#include <string.h>
+#include "../src/big_int.c"
+#include "test_utils.h"
+
+static void ck_assert_big_int_str(const big_int * b, const char * expected) {
+    char * s;
+    s = big_int_to_str(b);
+    ck_assert_msg((strcmp(s, expected) == 0), "big_int is %s, expecting %s",
+            s, expected);
+    free(s);
+}
+
+START_TEST (test_init_big_int_fail) {
+    big_int * b;
+    b = init_big_int(0); // SIGABRT
+}
+END_TEST
+
+START_TEST (test_assign_big_int) {
+    big_int * b;
+    b = init_big_int(1);
+    ck_assert_int_eq(b->length, 0);
+    ck_assert_big_int_str(b, "0");
+    assign_big_int(b, 7);
+    ck_assert_int_eq(b->length, 1);
+    ck_assert_big_int_str(b, "7");
+    assign_big_int(b, 1000000000);
+    ck_assert_int_eq(b->length, 2);
+    ck_assert_big_int_str(b, "1000000000");
+    assign_big_int(b, UINT64_MAX);
+    ck_assert_int_eq(b->length, 3);
+    ck_assert_big_int_str(b, "18446744073709551615");
+    assign_big_int(b, 0);
+    ck_assert_int_eq(b->length, 0);
+    free_big_int(b);
+}
+END_TEST
+
+START_TEST (test_add_big_int) {
+    int i;
+    big_int * x;
+    big_int * y;
+    x = init_big_int(1);
+    y = init_big_int(1);
+    assign_big_int(x, 999999999);
+    assign_big_int(y, 1);
+    add_big_int(x, y);
+    ck_assert_big_int_str(x, "1000000000");
+    // carries through every digit
+    assign_big_int(x, 999999999999999999ULL);
+    add_big_int(x, y);
+    ck_assert_big_int_str(x, "1000000000000000000");
+    add_big_int(y, x);
+    ck_assert_big_int_str(y, "1000000000000000001");
+    // doubling 2^64 - 1 to 2^100 - 2^36
+    assign_big_int(x, UINT64_MAX);
+    for (i = 0; i < 36; i++) {
+        copy_big_int(y, x);
+        add_big_int(x, y);
+    }
+    ck_assert_big_int_str(x, "1267650600228229401427983728640");
+    free_big_int(x);
+    free_big_int(y);
+}
+END_TEST
+
+START_TEST (test_subtract_big_int) {
+    big_int * x;
+    big_int * y;
+    x = init_big_int(1);
+    y = init_big_int(1);
+    assign_big_int(x, 1000000000000000000ULL);
+    assign_big_int(y, 1);
+    subtract_big_int(x, y);
+    ck_assert_big_int_str(x, "999999999999999999");
+    ck_assert_int_eq(x->length, 2);
+    copy_big_int(y, x);
+    subtract_big_int(x, y);
+    ck_assert_int_eq(x->length, 0);
+    free_big_int(x);
+    free_big_int(y);
+}
+END_TEST
+
+START_TEST (test_subtract_big_int_fail) {
+    big_int * x;
+    big_int * y;
+    x = init_big_int(1);
+    y = init_big_int(1);
+    assign_big_int(x, 1);
+    assign_big_int(y, 2);
+    subtract_big_int(x, y); // SIGABRT
+}
+END_TEST
+
+START_TEST (test_multiply_big_int) {
+    big_int * x;
+    big_int * y;
+    big_int * z;
+    x = init_big_int(1);
+    y = init_big_int(1);
+    z = init_big_int(1);
+    assign_big_int(x, 123456789012345ULL);
+    assign_big_int(y, 987654321098765ULL);
+    multiply_big_int(z, x, y);
+    ck_assert_big_int_str(z, "121932631137021071359549253925");
+    multiply_big_int(x, z, z);
+    ck_assert_big_int_str(x,
+            "14867566535996840485391949006843342179384573348024127905625");
+    y->length = 0;
+    multiply_big_int(z, x, y);
+    ck_assert_int_eq(z->length, 0);
+    free_big_int(x);
+    free_big_int(y);
+    free_big_int(z);
+}
+END_TEST
+
+START_TEST (test_multiply_big_int_alias) {
+    big_int * x;
+    x = init_big_int(1);
+    assign_big_int(x, 2);
+    multiply_big_int(x, x, x); // SIGABRT
+}
+END_TEST
+
+START_TEST (test_multiply_divide_big_int_small) {
+    uint32_t r;
+    big_int * x;
+    x = init_big_int(1);
+    assign_big_int(x, UINT64_MAX);
+    multiply_big_int_small(x, 4000000000U);
+    ck_assert_big_int_str(x, "73786976294838206460000000000");
+    r = divide_big_int_small(x, 7);
+    ck_assert_big_int_str(x, "10540996613548315208571428571");
+    ck_assert_int_eq(r, 3);
+    multiply_big_int_small(x, 0);
+    ck_assert_int_eq(x->length, 0);
+    free_big_int(x);
+}
+END_TEST
+
+START_TEST (test_divide_big_int_small_zero) {
+    big_int * x;
+    x = init_big_int(1);
+    assign_big_int(x, 2);
+    divide_big_int_small(x, 0); // SIGABRT
+}
+END_TEST
+
+START_TEST (test_shift_big_int) {
+    big_int * x;
+    x = init_big_int(1);
+    assign_big_int(x, 123456789012ULL);
+    shift_big_int(x, 2);
+    ck_assert_big_int_str(x, "123456789012000000000000000000");
+    ck_assert_int_eq(x->length, 4);
+    shift_big_int(x, -3);
+    ck_assert_big_int_str(x, "123");
+    shift_big_int(x, -1);
+    ck_assert_int_eq(x->length, 0);
+    shift_big_int(x, 1);
+    ck_assert_int_eq(x->length, 0);
+    free_big_int(x);
+}
+END_TEST
+
+START_TEST (test_compare_big_int) {
+    big_int * x;
+    big_int * y;
+    x = init_big_int(1);
+    y = init_big_int(1);
+    ck_assert_int_eq(compare_big_int(x, y), 0);
+    assign_big_int(x, 1000000000);
+    assign_big_int(y, 999999999);
+    ck_assert_msg((compare_big_int(x, y) > 0), "x is not greater than y");
+    ck_assert_msg((compare_big_int(y, x) < 0), "y is not less than x");
+    assign_big_int(y, 1000000001);
+    ck_assert_msg((compare_big_int(x, y) < 0), "x is not less than y");
+    free_big_int(x);
+    free_big_int(y);
+}
+END_TEST
+
+START_TEST (test_get_log_big_int) {
+    int i;
+    double e = 0.000000001;
+    big_int * x;
+    big_int * y;
+    x = init_big_int(1);
+    y = init_big_int(1);
+    assign_big_int(x, 12345);
+    ck_assert_msg((fabs(get_log_big_int(x) - log(12345.0)) < e),
+            "log is %lf, expecting %lf", get_log_big_int(x), log(12345.0));
+    // 2^2000, beyond the range of a double
+    assign_big_int(x, 1);
+    for (i = 0; i < 2000; i++) {
+        copy_big_int(y, x);
+        add_big_int(x, y);
+    }
+    ck_assert_msg((fabs(get_log_big_int(x) - (2000 * log(2.0))) < e),
+            "log is %lf, expecting %lf", get_log_big_int(x),
+            (2000 * log(2.0)));
+    free_big_int(x);
+    free_big_int(y);
+}
+END_TEST
+
+START_TEST (test_get_log_big_int_zero) {
+    big_int * x;
+    x = init_big_int(1);
+    get_log_big_int(x); // SIGABRT
+}
+END_TEST
+
+Suite * big_int_suite(void) {
+    Suite * s = suite_create("big_int");
+
+    TCase * tc_big_int = tcase_create("big_int_test_case");
+    tcase_add_test_raise_signal(tc_big_int, test_init_big_int_fail,
+            SIGABRT);
+    tcase_add_test(tc_big_int, test_assign_big_int);
+    tcase_add_test(tc_big_int, test_add_big_int);
+    tcase_add_test(tc_big_int, test_subtract_big_int);
+    tcase_add_test_raise_signal(tc_big_int, test_subtract_big_int_fail,
+            SIGABRT);
+    tcase_add_test(tc_big_int, test_multiply_big_int);
+    tcase_add_test_raise_signal(tc_big_int, test_multiply_big_int_alias,
+            SIGABRT);
+    tcase_add_test(tc_big_int, test_multiply_divide_big_int_small);
+    tcase_add_test_raise_signal(tc_big_int, test_divide_big_int_small_zero,
+            SIGABRT);
+    tcase_add_test(tc_big_int, test_shift_big_int);
+    tcase_add_test(tc_big_int, test_compare_big_int);
+    tcase_add_test(tc_big_int, test_get_log_big_int);
+    tcase_add_test_raise_signal(tc_big_int, test_get_log_big_int_zero,
+            SIGABRT);
+    suite_add_tcase(s, tc_big_int);
+
+    return s;
+}
+
+int main(void) {
+    int number_failed;
+    Suite * s = big_int_suite();
+    SRunner * sr = srunner_create(s);
+    srunner_run_all(sr, CK_VERBOSE);
+    number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
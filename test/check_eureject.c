@@ -15,11 +15,12 @@ END_TEST
 
 START_TEST (test_summarize_stat_samples_p1_n4) {
     int i;
+    long bytes_read;
     s_array * paths;
     s_array * paths_used;
     c_array * line_buffer;
     i_array * stat_indices;
-    sample_sum_array * ss_array;
+    sample_moments * moments;
     d_array * means;
     d_array * std_devs;
     d_array * exp_means;
@@ -32,7 +33,7 @@ START_TEST (test_summarize_stat_samples_p1_n4) {
     paths_used = init_s_array(1);
     line_buffer = init_c_array(1023);
     stat_indices = init_i_array(4);
-    ss_array = init_sample_sum_array(4);
+    moments = init_sample_moments(4, 3);
     means = init_d_array(1);
     std_devs = init_d_array(1);
     exp_means = init_d_array(1);
@@ -41,11 +42,13 @@ START_TEST (test_summarize_stat_samples_p1_n4) {
     for (i = 2; i < expected_num_cols; i++) {
         append_i_array(stat_indices, i);
     }
-    summarize_stat_samples(paths, line_buffer, stat_indices, ss_array, means,
-            std_devs, num_to_sample, expected_num_cols, paths_used);
+    bytes_read = summarize_stat_samples(paths, line_buffer, stat_indices,
+            moments, means, std_devs, num_to_sample, expected_num_cols,
+            paths_used, NULL, NULL);
+    ck_assert_int_eq(bytes_read, 134);
     ck_assert_int_eq(means->length, stat_indices->length);
     ck_assert_int_eq(std_devs->length, stat_indices->length);
-    ck_assert_int_eq(ss_array->a[0]->n, num_to_sample);
+    ck_assert_int_eq(moments->n[0], num_to_sample);
     ck_assert_msg((s_arrays_equal(paths, paths_used) != 0),
             "paths used do not match input paths");
     append_d_array(exp_means, 0.25);
@@ -64,7 +67,7 @@ START_TEST (test_summarize_stat_samples_p1_n4) {
     free_s_array(paths_used);
     free_c_array(line_buffer);
     free_i_array(stat_indices);
-    free_sample_sum_array(ss_array);
+    free_sample_moments(moments);
     free_d_array(means);
     free_d_array(std_devs);
     free_d_array(exp_means);
@@ -72,13 +75,61 @@ START_TEST (test_summarize_stat_samples_p1_n4) {
 }
 END_TEST
 
+START_TEST (test_summarize_stat_samples_covariances) {
+    int i;
+    double e = 0.000001;
+    s_array * paths;
+    s_array * paths_used;
+    c_array * line_buffer;
+    i_array * stat_indices;
+    sample_moments * moments;
+    d_array * means;
+    d_array * std_devs;
+    cov_sum * covariances;
+    paths = init_s_array(1);
+    paths_used = init_s_array(1);
+    line_buffer = init_c_array(1023);
+    stat_indices = init_i_array(4);
+    moments = init_sample_moments(4, 3);
+    means = init_d_array(1);
+    std_devs = init_d_array(1);
+    covariances = init_cov_sum(4, 3);
+    append_s_array(paths, "data/test_parameter_stat_samples.txt");
+    for (i = 2; i < 6; i++) {
+        append_i_array(stat_indices, i);
+    }
+    summarize_stat_samples(paths, line_buffer, stat_indices, moments, means,
+            std_devs, 4, 6, paths_used, covariances, NULL);
+    ck_assert_int_eq(covariances->n, 4);
+    for (i = 0; i < 4; i++) {
+        ck_assert_msg(almost_equal(get_covariance(covariances, i, i),
+                pow(get_d_array(std_devs, i), 2), e),
+                "variance %d is %lf", i, get_covariance(covariances, i, i));
+    }
+    // stat.3 is 10 times stat.1, and stat.4 is uncorrelated with stat.1
+    ck_assert_msg(almost_equal(get_covariance(covariances, 0, 2),
+            (10 * pow(get_d_array(std_devs, 0), 2)), e),
+            "covariance is %lf", get_covariance(covariances, 0, 2));
+    ck_assert_msg(almost_equal(get_covariance(covariances, 3, 0), 0.0, e),
+            "covariance is %lf", get_covariance(covariances, 3, 0));
+    free_s_array(paths);
+    free_s_array(paths_used);
+    free_c_array(line_buffer);
+    free_i_array(stat_indices);
+    free_sample_moments(moments);
+    free_d_array(means);
+    free_d_array(std_devs);
+    free_cov_sum(covariances);
+}
+END_TEST
+
 START_TEST (test_summarize_stat_samples_p1_n3) {
     int i;
     s_array * paths;
     s_array * paths_used;
     c_array * line_buffer;
     i_array * stat_indices;
-    sample_sum_array * ss_array;
+    sample_moments * moments;
     d_array * means;
     d_array * std_devs;
     d_array * exp_means;
@@ -91,7 +142,7 @@ START_TEST (test_summarize_stat_samples_p1_n3) {
     paths_used = init_s_array(1);
     line_buffer = init_c_array(1023);
     stat_indices = init_i_array(4);
-    ss_array = init_sample_sum_array(4);
+    moments = init_sample_moments(4, 3);
     means = init_d_array(1);
     std_devs = init_d_array(1);
     exp_means = init_d_array(1);
@@ -100,11 +151,12 @@ START_TEST (test_summarize_stat_samples_p1_n3) {
     for (i = 2; i < expected_num_cols; i++) {
         append_i_array(stat_indices, i);
     }
-    summarize_stat_samples(paths, line_buffer, stat_indices, ss_array, means,
-            std_devs, num_to_sample, expected_num_cols, paths_used);
+    summarize_stat_samples(paths, line_buffer, stat_indices, moments, means,
+            std_devs, num_to_sample, expected_num_cols, paths_used,
+            NULL, NULL);
     ck_assert_int_eq(means->length, stat_indices->length);
     ck_assert_int_eq(std_devs->length, stat_indices->length);
-    ck_assert_int_eq(ss_array->a[0]->n, num_to_sample);
+    ck_assert_int_eq(moments->n[0], num_to_sample);
     ck_assert_msg((s_arrays_equal(paths, paths_used) != 0),
             "paths used do not match input paths");
     append_d_array(exp_means, 0.2);
@@ -123,7 +175,7 @@ START_TEST (test_summarize_stat_samples_p1_n3) {
     free_s_array(paths_used);
     free_c_array(line_buffer);
     free_i_array(stat_indices);
-    free_sample_sum_array(ss_array);
+    free_sample_moments(moments);
     free_d_array(means);
     free_d_array(std_devs);
     free_d_array(exp_means);
@@ -137,7 +189,7 @@ START_TEST (test_summarize_stat_samples_p1_n3_c2) {
     s_array * paths_used;
     c_array * line_buffer;
     i_array * stat_indices;
-    sample_sum_array * ss_array;
+    sample_moments * moments;
     d_array * means;
     d_array * std_devs;
     d_array * exp_means;
@@ -150,7 +202,7 @@ START_TEST (test_summarize_stat_samples_p1_n3_c2) {
     paths_used = init_s_array(1);
     line_buffer = init_c_array(1023);
     stat_indices = init_i_array(4);
-    ss_array = init_sample_sum_array(2);
+    moments = init_sample_moments(2, 3);
     means = init_d_array(1);
     std_devs = init_d_array(1);
     exp_means = init_d_array(1);
@@ -159,11 +211,12 @@ START_TEST (test_summarize_stat_samples_p1_n3_c2) {
     for (i = 3; i < expected_num_cols; i += 2) {
         append_i_array(stat_indices, i);
     }
-    summarize_stat_samples(paths, line_buffer, stat_indices, ss_array, means,
-            std_devs, num_to_sample, expected_num_cols, paths_used);
+    summarize_stat_samples(paths, line_buffer, stat_indices, moments, means,
+            std_devs, num_to_sample, expected_num_cols, paths_used,
+            NULL, NULL);
     ck_assert_int_eq(means->length, stat_indices->length);
     ck_assert_int_eq(std_devs->length, stat_indices->length);
-    ck_assert_int_eq(ss_array->a[0]->n, num_to_sample);
+    ck_assert_int_eq(moments->n[0], num_to_sample);
     ck_assert_msg((s_arrays_equal(paths, paths_used) != 0),
             "paths used do not match input paths");
     append_d_array(exp_means, 0.22);
@@ -178,7 +231,7 @@ START_TEST (test_summarize_stat_samples_p1_n3_c2) {
     free_s_array(paths_used);
     free_c_array(line_buffer);
     free_i_array(stat_indices);
-    free_sample_sum_array(ss_array);
+    free_sample_moments(moments);
     free_d_array(means);
     free_d_array(std_devs);
     free_d_array(exp_means);
@@ -192,7 +245,7 @@ START_TEST (test_summarize_stat_samples_p2_n3) {
     s_array * paths_used;
     c_array * line_buffer;
     i_array * stat_indices;
-    sample_sum_array * ss_array;
+    sample_moments * moments;
     d_array * means;
     d_array * std_devs;
     d_array * exp_means;
@@ -205,7 +258,7 @@ START_TEST (test_summarize_stat_samples_p2_n3) {
     paths_used = init_s_array(1);
     line_buffer = init_c_array(1023);
     stat_indices = init_i_array(4);
-    ss_array = init_sample_sum_array(4);
+    moments = init_sample_moments(4, 3);
     means = init_d_array(1);
     std_devs = init_d_array(1);
     exp_means = init_d_array(1);
@@ -215,11 +268,12 @@ START_TEST (test_summarize_stat_samples_p2_n3) {
     for (i = 2; i < expected_num_cols; i++) {
         append_i_array(stat_indices, i);
     }
-    summarize_stat_samples(paths, line_buffer, stat_indices, ss_array, means,
-            std_devs, num_to_sample, expected_num_cols, paths_used);
+    summarize_stat_samples(paths, line_buffer, stat_indices, moments, means,
+            std_devs, num_to_sample, expected_num_cols, paths_used,
+            NULL, NULL);
     ck_assert_int_eq(means->length, stat_indices->length);
     ck_assert_int_eq(std_devs->length, stat_indices->length);
-    ck_assert_int_eq(ss_array->a[0]->n, num_to_sample);
+    ck_assert_int_eq(moments->n[0], num_to_sample);
     ck_assert_int_eq(paths_used->length, 1);
     ck_assert_msg((*get_s_array(paths, 0) == *get_s_array(paths_used, 0)),
             "paths used do not match input paths");
@@ -239,7 +293,7 @@ START_TEST (test_summarize_stat_samples_p2_n3) {
     free_s_array(paths_used);
     free_c_array(line_buffer);
     free_i_array(stat_indices);
-    free_sample_sum_array(ss_array);
+    free_sample_moments(moments);
     free_d_array(means);
     free_d_array(std_devs);
     free_d_array(exp_means);
@@ -253,7 +307,7 @@ START_TEST (test_summarize_stat_samples_p2_n4) {
     s_array * paths_used;
     c_array * line_buffer;
     i_array * stat_indices;
-    sample_sum_array * ss_array;
+    sample_moments * moments;
     d_array * means;
     d_array * std_devs;
     d_array * exp_means;
@@ -266,7 +320,7 @@ START_TEST (test_summarize_stat_samples_p2_n4) {
     paths_used = init_s_array(1);
     line_buffer = init_c_array(1023);
     stat_indices = init_i_array(4);
-    ss_array = init_sample_sum_array(4);
+    moments = init_sample_moments(4, 3);
     means = init_d_array(1);
     std_devs = init_d_array(1);
     exp_means = init_d_array(1);
@@ -276,11 +330,12 @@ START_TEST (test_summarize_stat_samples_p2_n4) {
     for (i = 2; i < expected_num_cols; i++) {
         append_i_array(stat_indices, i);
     }
-    summarize_stat_samples(paths, line_buffer, stat_indices, ss_array, means,
-            std_devs, num_to_sample, expected_num_cols, paths_used);
+    summarize_stat_samples(paths, line_buffer, stat_indices, moments, means,
+            std_devs, num_to_sample, expected_num_cols, paths_used,
+            NULL, NULL);
     ck_assert_int_eq(means->length, stat_indices->length);
     ck_assert_int_eq(std_devs->length, stat_indices->length);
-    ck_assert_int_eq(ss_array->a[0]->n, num_to_sample);
+    ck_assert_int_eq(moments->n[0], num_to_sample);
     ck_assert_int_eq(paths_used->length, 1);
     ck_assert_msg((*get_s_array(paths, 0) == *get_s_array(paths_used, 0)),
             "paths used do not match input paths");
@@ -300,7 +355,7 @@ START_TEST (test_summarize_stat_samples_p2_n4) {
     free_s_array(paths_used);
     free_c_array(line_buffer);
     free_i_array(stat_indices);
-    free_sample_sum_array(ss_array);
+    free_sample_moments(moments);
     free_d_array(means);
     free_d_array(std_devs);
     free_d_array(exp_means);
@@ -314,7 +369,7 @@ START_TEST (test_summarize_stat_samples_p2_n5) {
     s_array * paths_used;
     c_array * line_buffer;
     i_array * stat_indices;
-    sample_sum_array * ss_array;
+    sample_moments * moments;
     d_array * means;
     d_array * std_devs;
     d_array * exp_means;
@@ -327,7 +382,7 @@ START_TEST (test_summarize_stat_samples_p2_n5) {
     paths_used = init_s_array(1);
     line_buffer = init_c_array(1023);
     stat_indices = init_i_array(4);
-    ss_array = init_sample_sum_array(4);
+    moments = init_sample_moments(4, 3);
     means = init_d_array(1);
     std_devs = init_d_array(1);
     exp_means = init_d_array(1);
@@ -337,11 +392,12 @@ START_TEST (test_summarize_stat_samples_p2_n5) {
     for (i = 2; i < expected_num_cols; i++) {
         append_i_array(stat_indices, i);
     }
-    summarize_stat_samples(paths, line_buffer, stat_indices, ss_array, means,
-            std_devs, num_to_sample, expected_num_cols, paths_used);
+    summarize_stat_samples(paths, line_buffer, stat_indices, moments, means,
+            std_devs, num_to_sample, expected_num_cols, paths_used,
+            NULL, NULL);
     ck_assert_int_eq(means->length, stat_indices->length);
     ck_assert_int_eq(std_devs->length, stat_indices->length);
-    ck_assert_int_eq(ss_array->a[0]->n, num_to_sample);
+    ck_assert_int_eq(moments->n[0], num_to_sample);
     ck_assert_msg((s_arrays_equal(paths, paths_used) != 0),
             "paths used do not match input paths");
     append_d_array(exp_means, 0.222);
@@ -360,7 +416,7 @@ START_TEST (test_summarize_stat_samples_p2_n5) {
     free_s_array(paths_used);
     free_c_array(line_buffer);
     free_i_array(stat_indices);
-    free_sample_sum_array(ss_array);
+    free_sample_moments(moments);
     free_d_array(means);
     free_d_array(std_devs);
     free_d_array(exp_means);
@@ -374,7 +430,7 @@ START_TEST (test_summarize_stat_samples_p1_n4_missing_cell) {
     s_array * paths_used;
     c_array * line_buffer;
     i_array * stat_indices;
-    sample_sum_array * ss_array;
+    sample_moments * moments;
     d_array * means;
     d_array * std_devs;
     d_array * exp_means;
@@ -387,7 +443,7 @@ START_TEST (test_summarize_stat_samples_p1_n4_missing_cell) {
     paths_used = init_s_array(1);
     line_buffer = init_c_array(1023);
     stat_indices = init_i_array(4);
-    ss_array = init_sample_sum_array(4);
+    moments = init_sample_moments(4, 3);
     means = init_d_array(1);
     std_devs = init_d_array(1);
     exp_means = init_d_array(1);
@@ -396,13 +452,14 @@ START_TEST (test_summarize_stat_samples_p1_n4_missing_cell) {
     for (i = 2; i < expected_num_cols; i++) {
         append_i_array(stat_indices, i);
     }
-    summarize_stat_samples(paths, line_buffer, stat_indices, ss_array, means,
-            std_devs, num_to_sample, expected_num_cols, paths_used); // exit(1)
+    summarize_stat_samples(paths, line_buffer, stat_indices, moments, means,
+            std_devs, num_to_sample, expected_num_cols, paths_used,
+            NULL, NULL); // exit(1)
     free_s_array(paths);
     free_s_array(paths_used);
     free_c_array(line_buffer);
     free_i_array(stat_indices);
-    free_sample_sum_array(ss_array);
+    free_sample_moments(moments);
     free_d_array(means);
     free_d_array(std_devs);
     free_d_array(exp_means);
@@ -410,6 +467,38 @@ START_TEST (test_summarize_stat_samples_p1_n4_missing_cell) {
 }
 END_TEST
 
+START_TEST (test_sample_is_retained) {
+    s_array * line_array;
+    sample_array * samples;
+    sample * s;
+    line_array = init_s_array(2);
+    append_s_array(line_array, "0.1");
+    append_s_array(line_array, "0.2");
+    samples = init_sample_array(2);
+    ck_assert_int_eq(sample_is_retained(samples, 5.0), 1);
+    process_sample(samples, init_sample_with_distance("a", 2, line_array, 2.0,
+            0));
+    ck_assert_int_eq(sample_is_retained(samples, 5.0), 1);
+    process_sample(samples, init_sample_with_distance("a", 3, line_array, 1.0,
+            0));
+    ck_assert_int_eq(sample_is_retained(samples, 5.0), 0);
+    ck_assert_int_eq(sample_is_retained(samples, 2.0), 0);
+    ck_assert_int_eq(sample_is_retained(samples, 1.5), 1);
+    s = init_sample_with_distance("a", 4, line_array, 5.0, 0);
+    ck_assert_int_eq(process_sample(samples, s), -1);
+    free_sample(s);
+    // reusing a sample
+    s = samples->a[1];
+    set_sample(s, "a longer path", 5, samples->header, 0.5, 1);
+    ck_assert_str_eq(s->file_path->a, "a longer path");
+    ck_assert_int_eq(s->line_num, 5);
+    ck_assert_int_eq(s->line_array->length, 0);
+    ck_assert_int_eq(s->num_invalid_stats, 1);
+    free_s_array(line_array);
+    free_sample_array(samples);
+}
+END_TEST
+
 START_TEST (test_reject_p1_n1_c4) {
     int i;
     s_array * paths;
@@ -448,7 +537,7 @@ START_TEST (test_reject_p1_n1_c4) {
     append_d_array(std_devs, 1.154701);
     standardize_vector(obs_stats, means, std_devs);
     samples = reject(paths, line_buffer, stat_indices, obs_stats, means,
-            std_devs, num_to_retain, header);
+            std_devs, num_to_retain, header, NULL);
     ck_assert_int_eq(samples->length, num_to_retain);
     ck_assert_int_eq(samples->capacity, num_to_retain);
     ck_assert_msg((almost_equal(samples->a[0]->distance, 0.0, 0.000001)),
@@ -497,7 +586,7 @@ START_TEST (test_reject_p1_n1_c2) {
     append_d_array(std_devs, 1.154701);
     standardize_vector(obs_stats, means, std_devs);
     samples = reject(paths, line_buffer, stat_indices, obs_stats, means,
-            std_devs, num_to_retain, header);
+            std_devs, num_to_retain, header, NULL);
     ck_assert_int_eq(samples->length, num_to_retain);
     ck_assert_int_eq(samples->capacity, num_to_retain);
     ck_assert_msg((almost_equal(samples->a[0]->distance, 0.0, 0.000001)),
@@ -553,7 +642,7 @@ START_TEST (test_reject_p2_n1_c4) {
     append_d_array(std_devs, 1.154701);
     standardize_vector(obs_stats, means, std_devs);
     samples = reject(paths, line_buffer, stat_indices, obs_stats, means,
-            std_devs, num_to_retain, header);
+            std_devs, num_to_retain, header, NULL);
     ck_assert_int_eq(samples->length, num_to_retain);
     ck_assert_int_eq(samples->capacity, num_to_retain);
     ck_assert_msg((almost_equal(samples->a[0]->distance, 0.0, 0.000001)),
@@ -608,7 +697,7 @@ START_TEST (test_reject_p1_n2_c4) {
     append_d_array(std_devs, 1.154701);
     standardize_vector(obs_stats, means, std_devs);
     samples = reject(paths, line_buffer, stat_indices, obs_stats, means,
-            std_devs, num_to_retain, header);
+            std_devs, num_to_retain, header, NULL);
     ck_assert_int_eq(samples->length, num_to_retain);
     ck_assert_int_eq(samples->capacity, num_to_retain);
     ck_assert_msg((almost_equal(samples->a[0]->distance, 0.0, 0.000001)),
@@ -667,7 +756,7 @@ START_TEST (test_reject_p2_n2_c4) {
     append_d_array(std_devs, 1.154701);
     standardize_vector(obs_stats, means, std_devs);
     samples = reject(paths, line_buffer, stat_indices, obs_stats, means,
-            std_devs, num_to_retain, header);
+            std_devs, num_to_retain, header, NULL);
     ck_assert_int_eq(samples->length, num_to_retain);
     ck_assert_int_eq(samples->capacity, num_to_retain);
     ck_assert_msg((almost_equal(samples->a[0]->distance, 0.0, 0.000001)),
@@ -726,7 +815,7 @@ START_TEST (test_reject_p2_n3_c4) {
     append_d_array(std_devs, 1.154701);
     standardize_vector(obs_stats, means, std_devs);
     samples = reject(paths, line_buffer, stat_indices, obs_stats, means,
-            std_devs, num_to_retain, header);
+            std_devs, num_to_retain, header, NULL);
     ck_assert_int_eq(samples->length, num_to_retain);
     ck_assert_int_eq(samples->capacity, num_to_retain);
     ck_assert_msg((almost_equal(samples->a[0]->distance, 0.0, 0.000001)),
@@ -738,6 +827,11 @@ START_TEST (test_reject_p2_n3_c4) {
     ck_assert_msg((almost_equal(samples->a[2]->distance, 0.1433004, 0.000001)),
             "euclidean distance was %lf, expected %lf",
             samples->a[2]->distance, 0.1433004);
+    ck_assert_int_eq(samples->num_processed, 9);
+    ck_assert_int_eq(samples->num_visited, 9);
+    ck_assert_int_eq(samples->num_admitted, 5);
+    ck_assert_int_eq(samples->num_parse_errors, 0);
+    ck_assert_int_eq(samples->num_bytes_read, (165 + 135));
     free_s_array(paths);
     free_c_array(line_buffer);
     free_i_array(stat_indices);
@@ -749,6 +843,352 @@ START_TEST (test_reject_p2_n3_c4) {
 }
 END_TEST
 
+START_TEST (test_reject_projected_p2_n3_c4) {
+    int i, m;
+    s_array * paths;
+    s_array * paths_used;
+    c_array * line_buffer;
+    i_array * stat_indices;
+    sample_moments * moments;
+    d_array * obs_stats;
+    d_array * scores;
+    d_array * means;
+    d_array * std_devs;
+    s_array * header;
+    sample_array * exp_samples;
+    sample_array * samples;
+    cov_sum * covariances;
+    projection * p;
+    paths = init_s_array(1);
+    paths_used = init_s_array(1);
+    line_buffer = init_c_array(1023);
+    stat_indices = init_i_array(4);
+    moments = init_sample_moments(4, 3);
+    means = init_d_array(1);
+    std_devs = init_d_array(1);
+    obs_stats = init_d_array(1);
+    scores = init_d_array(4);
+    header = init_s_array(1);
+    covariances = init_cov_sum(4, 4);
+    append_s_array(paths, "data/test_parameter_stat_samples4.txt");
+    append_s_array(paths, "data/test_parameter_stat_samples.txt");
+    parse_header(get_s_array(paths, 0), line_buffer, header);
+    for (i = 2; i < header->length; i++) {
+        append_i_array(stat_indices, i);
+    }
+    summarize_stat_samples(paths, line_buffer, stat_indices, moments, means,
+            std_devs, 100, header->length, paths_used, covariances, NULL);
+    append_d_array(obs_stats, 0.1);
+    append_d_array(obs_stats, 0.21);
+    append_d_array(obs_stats, 1.0);
+    append_d_array(obs_stats, 2.0);
+    standardize_vector(obs_stats, means, std_devs);
+    exp_samples = reject(paths, line_buffer, stat_indices, obs_stats, means,
+            std_devs, 9, header, NULL);
+    for (m = 1; m <= 4; m++) {
+        p = get_pca_projection(covariances, m);
+        project_vector(p, obs_stats, scores);
+        samples = reject(paths, line_buffer, stat_indices, scores, means,
+                std_devs, 9, header, p);
+        ck_assert_int_eq(samples->length, exp_samples->length);
+        for (i = 0; i < samples->length; i++) {
+            // the principal components are orthonormal, so a projection
+            // onto all of them preserves distances, and a projection onto
+            // fewer of them can only shorten distances
+            if (m == 4) {
+                ck_assert_msg(almost_equal(samples->a[i]->distance,
+                        exp_samples->a[i]->distance, 0.000001),
+                        "distance %d was %lf, expected %lf", i,
+                        samples->a[i]->distance,
+                        exp_samples->a[i]->distance);
+                ck_assert_int_eq(samples->a[i]->line_num,
+                        exp_samples->a[i]->line_num);
+            }
+            ck_assert_msg((samples->a[i]->distance <=
+                    (exp_samples->a[i]->distance + 0.000001)),
+                    "%d components: distance %d was %lf, expected at most "
+                    "%lf", m, i, samples->a[i]->distance,
+                    exp_samples->a[i]->distance);
+        }
+        free_sample_array(samples);
+        free_projection(p);
+    }
+    free_s_array(paths);
+    free_s_array(paths_used);
+    free_c_array(line_buffer);
+    free_i_array(stat_indices);
+    free_sample_moments(moments);
+    free_d_array(obs_stats);
+    free_d_array(scores);
+    free_sample_array(exp_samples);
+    free_d_array(means);
+    free_d_array(std_devs);
+    free_s_array(header);
+    free_cov_sum(covariances);
+}
+END_TEST
+
+START_TEST (test_reject_from_table_p2_n3_c4) {
+    int i, j;
+    s_array * paths;
+    c_array * line_buffer;
+    i_array * stat_indices;
+    i_array * sample_sizes;
+    d_array * obs_stats;
+    d_array * means;
+    d_array * std_devs;
+    s_array * header;
+    s_array * stat_names;
+    stat_table * table;
+    sample_array * samples;
+    sample_array * exp_samples;
+    int num_to_retain;
+    paths = init_s_array(1);
+    line_buffer = init_c_array(1023);
+    stat_indices = init_i_array(4);
+    sample_sizes = init_i_array(4);
+    means = init_d_array(1);
+    std_devs = init_d_array(1);
+    obs_stats = init_d_array(1);
+    header = init_s_array(1);
+    stat_names = init_s_array(1);
+    append_s_array(paths, "data/test_parameter_stat_samples4.txt");
+    append_s_array(paths, "data/test_parameter_stat_samples.txt");
+    parse_header(get_s_array(paths, 0), line_buffer, header);
+    for (i = 2; i < header->length; i++) {
+        append_i_array(stat_indices, i);
+        append_i_array(sample_sizes, 4);
+        append_s_array(stat_names, get_s_array(header, i));
+    }
+    append_d_array(obs_stats, 0.1);
+    append_d_array(obs_stats, 0.21);
+    append_d_array(obs_stats, 1.0);
+    append_d_array(obs_stats, 2.0);
+    append_d_array(means, 0.25);
+    append_d_array(means, 0.2225);
+    append_d_array(means, 2.5);
+    append_d_array(means, 3.0);
+    append_d_array(std_devs, 0.1290994);
+    append_d_array(std_devs, 0.009574271);
+    append_d_array(std_devs, 1.290994);
+    append_d_array(std_devs, 1.154701);
+    standardize_vector(obs_stats, means, std_devs);
+    table = init_stat_table(header, stat_names, means, std_devs,
+            sample_sizes);
+    load_stat_table(table, paths, line_buffer, stat_indices);
+    build_stat_table_tree(table, 1);
+    for (num_to_retain = 1; num_to_retain < 12; num_to_retain++) {
+        exp_samples = reject(paths, line_buffer, stat_indices, obs_stats,
+                means, std_devs, num_to_retain, header, NULL);
+        samples = reject_from_table(table, line_buffer, stat_indices,
+                obs_stats, num_to_retain);
+        ck_assert_int_eq(samples->length, exp_samples->length);
+        ck_assert_int_eq(samples->num_processed, exp_samples->num_processed);
+        ck_assert_msg(((samples->num_visited > 0) &&
+                (samples->num_visited <= samples->num_processed)),
+                "%d samples visited", samples->num_visited);
+        ck_assert_msg((samples->num_admitted >= samples->length),
+                "%d samples admitted", samples->num_admitted);
+        ck_assert_msg((samples->num_bytes_read > 0), "no bytes read");
+        ck_assert_msg((s_arrays_equal(samples->paths_processed,
+                exp_samples->paths_processed) != 0),
+                "unexpected paths processed");
+        for (j = 0; j < samples->length; j++) {
+            ck_assert_int_eq(samples->a[j]->line_num,
+                    exp_samples->a[j]->line_num);
+            ck_assert_msg((strcmp(get_c_array(samples->a[j]->file_path),
+                    get_c_array(exp_samples->a[j]->file_path)) == 0),
+                    "unexpected file path");
+            ck_assert_msg((samples->a[j]->distance ==
+                    exp_samples->a[j]->distance),
+                    "euclidean distance was %lf, expected %lf",
+                    samples->a[j]->distance, exp_samples->a[j]->distance);
+            ck_assert_msg((s_arrays_equal(samples->a[j]->line_array,
+                    exp_samples->a[j]->line_array) != 0),
+                    "unexpected sample");
+        }
+        free_sample_array(samples);
+        free_sample_array(exp_samples);
+    }
+    free_stat_table(table);
+    free_s_array(paths);
+    free_c_array(line_buffer);
+    free_i_array(stat_indices);
+    free_i_array(sample_sizes);
+    free_d_array(obs_stats);
+    free_d_array(means);
+    free_d_array(std_devs);
+    free_s_array(header);
+    free_s_array(stat_names);
+}
+END_TEST
+
+START_TEST (test_reject_within_budget_p2_n3_c4) {
+    int i, budget;
+    long size, exp_size;
+    FILE * stream;
+    FILE * exp_stream;
+    char * output;
+    char * exp_output;
+    s_array * paths;
+    sample_array * processed;
+    c_array * line_buffer;
+    i_array * stat_indices;
+    d_array * obs_stats;
+    d_array * means;
+    d_array * std_devs;
+    s_array * header;
+    spill_topk * spilled;
+    sample_array * exp_samples;
+    i_array * param_indices;
+    posterior_summary * exp_summary;
+    posterior_summary * summary;
+    int num_to_retain;
+    paths = init_s_array(1);
+    line_buffer = init_c_array(1023);
+    stat_indices = init_i_array(4);
+    means = init_d_array(1);
+    std_devs = init_d_array(1);
+    obs_stats = init_d_array(1);
+    header = init_s_array(1);
+    append_s_array(paths, "data/test_parameter_stat_samples4.txt");
+    append_s_array(paths, "data/test_parameter_stat_samples.txt");
+    append_s_array(paths, "data/test_parameter_stat_samples4.txt");
+    parse_header(get_s_array(paths, 0), line_buffer, header);
+    for (i = 2; i < header->length; i++) {
+        append_i_array(stat_indices, i);
+    }
+    param_indices = init_i_array(2);
+    get_parameter_indices(header, stat_indices, param_indices);
+    append_d_array(obs_stats, 0.1);
+    append_d_array(obs_stats, 0.21);
+    append_d_array(obs_stats, 1.0);
+    append_d_array(obs_stats, 2.0);
+    append_d_array(means, 0.25);
+    append_d_array(means, 0.2225);
+    append_d_array(means, 2.5);
+    append_d_array(means, 3.0);
+    append_d_array(std_devs, 0.1290994);
+    append_d_array(std_devs, 0.009574271);
+    append_d_array(std_devs, 1.290994);
+    append_d_array(std_devs, 1.154701);
+    standardize_vector(obs_stats, means, std_devs);
+    for (budget = 1; budget < 40; budget += 3) {
+        for (num_to_retain = 1; num_to_retain < 16; num_to_retain++) {
+            exp_samples = reject(paths, line_buffer, stat_indices, obs_stats,
+                    means, std_devs, num_to_retain, header, NULL);
+            processed = init_sample_array(1);
+            spilled = reject_within_budget(paths, line_buffer, stat_indices,
+                    obs_stats, means, std_devs, num_to_retain, header,
+                    (budget * sizeof(spill_candidate)), processed, NULL);
+            ck_assert_int_eq(spilled->num_offered,
+                    exp_samples->num_processed);
+            ck_assert_int_eq(processed->num_processed,
+                    exp_samples->num_processed);
+            ck_assert_int_eq(processed->num_visited,
+                    exp_samples->num_visited);
+            ck_assert_int_eq(processed->num_bytes_read,
+                    exp_samples->num_bytes_read);
+            ck_assert_int_eq(processed->num_parse_errors, 0);
+            ck_assert_msg((processed->num_admitted >= ((num_to_retain <
+                    exp_samples->num_processed) ? num_to_retain :
+                    exp_samples->num_processed)),
+                    "%d samples admitted", processed->num_admitted);
+            ck_assert_msg((s_arrays_equal(processed->paths_processed,
+                    exp_samples->paths_processed) != 0),
+                    "unexpected paths processed");
+            exp_stream = tmpfile();
+            stream = tmpfile();
+            write_sample_array(exp_stream, exp_samples, 1);
+            exp_summary = init_posterior_summary(header, param_indices, 8);
+            summary = init_posterior_summary(header, param_indices, 8);
+            update_posterior_summary_from_samples(exp_summary, exp_samples);
+            write_spilled_samples(stream, spilled, paths, line_buffer,
+                    header, 1, summary);
+            exp_size = ftell(exp_stream);
+            size = ftell(stream);
+            ck_assert_int_eq(size, exp_size);
+            rewind(exp_stream);
+            rewind(stream);
+            exp_output = (typeof(*exp_output) *) calloc((exp_size + 1),
+                    sizeof(*exp_output));
+            output = (typeof(*output) *) calloc((size + 1),
+                    sizeof(*output));
+            ck_assert_int_eq(fread(exp_output, 1, exp_size, exp_stream),
+                    exp_size);
+            ck_assert_int_eq(fread(output, 1, size, stream), size);
+            ck_assert_msg((strcmp(output, exp_output) == 0),
+                    "k = %d, budget = %d; unexpected output:\n%s\n"
+                    "expected:\n%s", num_to_retain, budget, output,
+                    exp_output);
+            free(output);
+            free(exp_output);
+            fclose(stream);
+            fclose(exp_stream);
+            // the retained samples are summarized the same way
+            exp_stream = tmpfile();
+            stream = tmpfile();
+            write_posterior_summary(exp_stream, exp_summary);
+            write_posterior_summary(stream, summary);
+            exp_size = ftell(exp_stream);
+            size = ftell(stream);
+            ck_assert_int_eq(size, exp_size);
+            rewind(exp_stream);
+            rewind(stream);
+            exp_output = (typeof(*exp_output) *) calloc((exp_size + 1),
+                    sizeof(*exp_output));
+            output = (typeof(*output) *) calloc((size + 1),
+                    sizeof(*output));
+            ck_assert_int_eq(fread(exp_output, 1, exp_size, exp_stream),
+                    exp_size);
+            ck_assert_int_eq(fread(output, 1, size, stream), size);
+            ck_assert_msg((strcmp(output, exp_output) == 0),
+                    "k = %d, budget = %d; unexpected summary:\n%s\n"
+                    "expected:\n%s", num_to_retain, budget, output,
+                    exp_output);
+            free(output);
+            free(exp_output);
+            fclose(stream);
+            fclose(exp_stream);
+            free_posterior_summary(exp_summary);
+            free_posterior_summary(summary);
+            free_spill_topk(spilled);
+            free_sample_array(processed);
+            free_sample_array(exp_samples);
+        }
+    }
+    free_s_array(paths);
+    free_c_array(line_buffer);
+    free_i_array(stat_indices);
+    free_d_array(obs_stats);
+    free_d_array(means);
+    free_d_array(std_devs);
+    free_s_array(header);
+    free_i_array(param_indices);
+}
+END_TEST
+
+START_TEST (test_get_parameter_indices) {
+    s_array * header;
+    i_array * stat_indices;
+    i_array * param_indices;
+    header = init_s_array(5);
+    stat_indices = init_i_array(2);
+    param_indices = init_i_array(1);
+    split_str("a s1 b s2 c", header, 5);
+    append_i_array(stat_indices, 3);
+    append_i_array(stat_indices, 1);
+    get_parameter_indices(header, stat_indices, param_indices);
+    ck_assert_int_eq(param_indices->length, 3);
+    ck_assert_int_eq(get_i_array(param_indices, 0), 0);
+    ck_assert_int_eq(get_i_array(param_indices, 1), 2);
+    ck_assert_int_eq(get_i_array(param_indices, 2), 4);
+    free_s_array(header);
+    free_i_array(stat_indices);
+    free_i_array(param_indices);
+}
+END_TEST
+
 Suite * eureject_suite(void) {
     Suite * s = suite_create("eureject");
 
@@ -760,6 +1200,8 @@ Suite * eureject_suite(void) {
             "summarize_stat_samples_test_case");
     tcase_add_test(tc_summarize_stat_samples,
             test_summarize_stat_samples_p1_n4);
+    tcase_add_test(tc_summarize_stat_samples,
+            test_summarize_stat_samples_covariances);
     tcase_add_test(tc_summarize_stat_samples,
             test_summarize_stat_samples_p1_n3);
     tcase_add_test(tc_summarize_stat_samples,
@@ -775,12 +1217,17 @@ Suite * eureject_suite(void) {
     suite_add_tcase(s, tc_summarize_stat_samples);
 
     TCase * tc_reject = tcase_create("reject_test_case");
+    tcase_add_test(tc_reject, test_sample_is_retained);
     tcase_add_test(tc_reject, test_reject_p1_n1_c4);
     tcase_add_test(tc_reject, test_reject_p1_n1_c2);
     tcase_add_test(tc_reject, test_reject_p2_n1_c4);
     tcase_add_test(tc_reject, test_reject_p1_n2_c4);
     tcase_add_test(tc_reject, test_reject_p2_n2_c4);
     tcase_add_test(tc_reject, test_reject_p2_n3_c4);
+    tcase_add_test(tc_reject, test_reject_projected_p2_n3_c4);
+    tcase_add_test(tc_reject, test_reject_from_table_p2_n3_c4);
+    tcase_add_test(tc_reject, test_reject_within_budget_p2_n3_c4);
+    tcase_add_test(tc_reject, test_get_parameter_indices);
     suite_add_tcase(s, tc_reject);
 
     return s;
@@ -0,0 +1,283 @@
+#include <stdlib.h>
+#include <check.h>
+#include <signal.h>
+#include "../src/eureject_serve.c"
+#include "test_utils.h"
+
+static stat_table * get_test_table(int build_tree) {
+    int i;
+    s_array * paths;
+    s_array * header;
+    s_array * stat_names;
+    c_array * line_buffer;
+    i_array * stat_indices;
+    i_array * sample_sizes;
+    d_array * means;
+    d_array * std_devs;
+    stat_table * table;
+    paths = init_s_array(1);
+    header = init_s_array(1);
+    stat_names = init_s_array(1);
+    line_buffer = init_c_array(1023);
+    stat_indices = init_i_array(4);
+    sample_sizes = init_i_array(4);
+    means = init_d_array(1);
+    std_devs = init_d_array(1);
+    append_s_array(paths, "data/test_parameter_stat_samples4.txt");
+    append_s_array(paths, "data/test_parameter_stat_samples.txt");
+    parse_header(get_s_array(paths, 0), line_buffer, header);
+    for (i = 2; i < header->length; i++) {
+        append_i_array(stat_indices, i);
+        append_i_array(sample_sizes, 4);
+        append_s_array(stat_names, get_s_array(header, i));
+    }
+    append_d_array(means, 0.25);
+    append_d_array(means, 0.2225);
+    append_d_array(means, 2.5);
+    append_d_array(means, 3.0);
+    append_d_array(std_devs, 0.1290994);
+    append_d_array(std_devs, 0.009574271);
+    append_d_array(std_devs, 1.290994);
+    append_d_array(std_devs, 1.154701);
+    table = init_stat_table(header, stat_names, means, std_devs,
+            sample_sizes);
+    load_stat_table(table, paths, line_buffer, stat_indices);
+    if (build_tree != 0) {
+        build_stat_table_tree(table, 1);
+    }
+    free_s_array(paths);
+    free_s_array(header);
+    free_s_array(stat_names);
+    free_c_array(line_buffer);
+    free_i_array(stat_indices);
+    free_i_array(sample_sizes);
+    free_d_array(means);
+    free_d_array(std_devs);
+    return table;
+}
+
+/**
+ * Write what `eureject` would write for `obs_stats`, plus the empty line
+ * that ends a response.
+ */
+static char * get_expected_response(stat_table * table, double * obs_stats,
+        int num_retain, int include_distance) {
+    int i;
+    FILE * stream;
+    c_array * line_buffer;
+    i_array * stat_indices;
+    d_array * std_obs_stats;
+    sample_array * samples;
+    char * response;
+    line_buffer = init_c_array(1023);
+    stat_indices = init_i_array(4);
+    std_obs_stats = init_d_array(4);
+    get_matching_indices(table->stat_names, table->header, stat_indices);
+    for (i = 0; i < table->num_stats; i++) {
+        append_d_array(std_obs_stats, obs_stats[i]);
+    }
+    standardize_vector(std_obs_stats, table->means, table->std_devs);
+    samples = reject_from_table(table, line_buffer, stat_indices,
+            std_obs_stats, num_retain);
+    stream = tmpfile();
+    write_sample_array(stream, samples, include_distance);
+    fprintf(stream, "\n");
+    response = read_stream(stream);
+    fclose(stream);
+    free_sample_array(samples);
+    free_c_array(line_buffer);
+    free_i_array(stat_indices);
+    free_d_array(std_obs_stats);
+    return response;
+}
+
+START_TEST (test_answer_request) {
+    int k;
+    FILE * stream;
+    stat_table * table;
+    server * s;
+    char * exp;
+    char * response;
+    char request[] = "0.1\t0.21\t1.0\t2.0\n";
+    double obs_stats[4] = {0.1, 0.21, 1.0, 2.0};
+    table = get_test_table(1);
+    for (k = 1; k < 10; k++) {
+        s = init_server(table, k, 1, 0);
+        stream = tmpfile();
+        ck_assert_int_eq(answer_request(s, stream, request), 0);
+        // a second request must get the same answer from the same server
+        ck_assert_int_eq(answer_request(s, stream, request), 0);
+        ck_assert_int_eq(s->num_requests, 2);
+        ck_assert_int_eq(s->num_bad_requests, 0);
+        response = read_stream(stream);
+        exp = get_expected_response(table, obs_stats, k, 1);
+        ck_assert_int_eq(strlen(response), (2 * strlen(exp)));
+        ck_assert_msg((strncmp(response, exp, strlen(exp)) == 0),
+                "unexpected response:\n%s\nexpected:\n%s", response, exp);
+        ck_assert_msg((strcmp((response + strlen(exp)), exp) == 0),
+                "unexpected second response:\n%s", (response + strlen(exp)));
+        free(exp);
+        free(response);
+        fclose(stream);
+        free_server(s);
+    }
+    free_stat_table(table);
+}
+END_TEST
+
+START_TEST (test_answer_request_offsets) {
+    FILE * stream;
+    stat_table * table;
+    server * s;
+    char * response;
+    // line 4 of both files is the same sample; the tie goes to the first file
+    char request[] = "0.35 0.225 3.5 3.0\n";
+    char * exp =
+        "file\tline\toffset\n"
+        "data/test_parameter_stat_samples4.txt\t4\t90\n"
+        "data/test_parameter_stat_samples.txt\t4\t88\n"
+        "\n";
+    table = get_test_table(0);
+    s = init_server(table, 2, 0, 1);
+    stream = tmpfile();
+    ck_assert_int_eq(answer_request(s, stream, request), 0);
+    response = read_stream(stream);
+    ck_assert_msg((strcmp(response, exp) == 0),
+            "unexpected response:\n%s", response);
+    free(response);
+    fclose(stream);
+    free_server(s);
+    free_stat_table(table);
+}
+END_TEST
+
+START_TEST (test_answer_request_malformed) {
+    FILE * stream;
+    stat_table * table;
+    server * s;
+    char * response;
+    char blank[] = " \t\n";
+    char short_request[] = "0.1\t0.21\t1.0\n";
+    char bad_request[] = "stat.1\tstat.2\tstat.3\tstat.4\n";
+    table = get_test_table(1);
+    s = init_server(table, 3, 0, 0);
+    stream = tmpfile();
+    ck_assert_int_eq(answer_request(s, stream, blank), -1);
+    ck_assert_int_eq(answer_request(s, stream, short_request), 1);
+    ck_assert_int_eq(answer_request(s, stream, bad_request), 1);
+    ck_assert_int_eq(s->num_requests, 2);
+    ck_assert_int_eq(s->num_bad_requests, 2);
+    response = read_stream(stream);
+    ck_assert_msg((strcmp(response,
+            "ERROR: request 1 has 3 stats (expected 4)\n\n"
+            "ERROR: request 2 column 1 is not a valid number\n\n") == 0),
+            "unexpected response:\n%s", response);
+    free(response);
+    fclose(stream);
+    free_server(s);
+    free_stat_table(table);
+}
+END_TEST
+
+START_TEST (test_serve_stream) {
+    int n;
+    FILE * in;
+    FILE * out;
+    stat_table * table;
+    server * s;
+    char * response;
+    char * exp1;
+    char * exp2;
+    double obs_stats1[4] = {0.1, 0.21, 1.0, 2.0};
+    double obs_stats2[4] = {0.4, 0.23, 4.0, 2.0};
+    table = get_test_table(1);
+    s = init_server(table, 3, 0, 0);
+    in = tmpfile();
+    out = tmpfile();
+    fprintf(in, "0.1\t0.21\t1.0\t2.0\n\n0.4\t0.23\t4.0\t2.0\n1.0\n");
+    rewind(in);
+    n = serve_stream(s, in, out);
+    ck_assert_int_eq(n, 3);
+    ck_assert_int_eq(s->num_bad_requests, 1);
+    response = read_stream(out);
+    exp1 = get_expected_response(table, obs_stats1, 3, 0);
+    exp2 = get_expected_response(table, obs_stats2, 3, 0);
+    ck_assert_msg((strncmp(response, exp1, strlen(exp1)) == 0),
+            "unexpected first response:\n%s", response);
+    ck_assert_msg((strncmp((response + strlen(exp1)), exp2,
+            strlen(exp2)) == 0),
+            "unexpected second response:\n%s", response);
+    ck_assert_msg((strcmp((response + strlen(exp1) + strlen(exp2)),
+            "ERROR: request 3 has 1 stats (expected 4)\n\n") == 0),
+            "unexpected third response:\n%s", response);
+    free(exp1);
+    free(exp2);
+    free(response);
+    fclose(in);
+    fclose(out);
+    free_server(s);
+    free_stat_table(table);
+}
+END_TEST
+
+START_TEST (test_load_serve_table) {
+    serve_config * conf;
+    c_array * line_buffer;
+    stat_table * table;
+    double e = 0.000001;
+    conf = init_serve_config();
+    line_buffer = init_c_array(1023);
+    assign_c_array(conf->observed_path, "data/observed_stats.txt");
+    append_s_array(conf->sim_paths, "data/test_parameter_stat_samples.txt");
+    table = load_serve_table(conf, line_buffer);
+    ck_assert_int_eq(table->num_rows, 4);
+    ck_assert_int_eq(table->num_stats, 4);
+    ck_assert_int_eq(table->header->length, 6);
+    ck_assert_msg((table->tree != NULL), "tree was not built");
+    ck_assert_int_eq(get_i_array(table->sample_sizes, 0), 4);
+    ck_assert_msg(almost_equal(get_d_array(table->means, 1), 0.2225, e),
+            "unexpected mean %lf", get_d_array(table->means, 1));
+    ck_assert_msg(almost_equal(get_d_array(table->std_devs, 3), 1.154701, e),
+            "unexpected std dev %lf", get_d_array(table->std_devs, 3));
+    free_stat_table(table);
+    free_c_array(line_buffer);
+    free_serve_config(conf);
+}
+END_TEST
+
+START_TEST (test_init_server_fail) {
+    stat_table * table;
+    server * s;
+    table = get_test_table(0);
+    s = init_server(table, 0, 0, 0); // SIGABRT
+}
+END_TEST
+
+Suite * eureject_serve_suite(void) {
+    Suite * s = suite_create("eureject_serve");
+
+    TCase * tc_answer_request = tcase_create("answer_request_test_case");
+    tcase_add_test(tc_answer_request, test_answer_request);
+    tcase_add_test(tc_answer_request, test_answer_request_offsets);
+    tcase_add_test(tc_answer_request, test_answer_request_malformed);
+    tcase_add_test(tc_answer_request, test_serve_stream);
+    tcase_add_test_raise_signal(tc_answer_request, test_init_server_fail,
+            SIGABRT);
+    suite_add_tcase(s, tc_answer_request);
+
+    TCase * tc_load = tcase_create("load_serve_table_test_case");
+    tcase_add_test(tc_load, test_load_serve_table);
+    suite_add_tcase(s, tc_load);
+
+    return s;
+}
+
+int main(void) {
+    int number_failed;
+    Suite * s = eureject_serve_suite();
+    SRunner * sr = srunner_create(s);
+    srunner_run_all(sr, CK_VERBOSE);
+    number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,364 @@
+#include <stdlib.h>
+#include <check.h>
+#include <signal.h>
+#include "../src/kdtree.c"
+#include "test_utils.h"
+
+static double * get_random_points(int n, int dim, int num_levels) {
+    int i;
+    double * points;
+    points = (typeof(*points) *) calloc(n * dim, sizeof(*points));
+    for (i = 0; i < (n * dim); i++) {
+        if (num_levels > 0) {
+            // coarse values so that there are many ties
+            points[i] = (double) (rand() % num_levels);
+        }
+        else {
+            points[i] = (rand() / (double) RAND_MAX) * 2.0 - 1.0;
+        }
+    }
+    return points;
+}
+
+static neighbor_heap * brute_force_knn(const double * points,
+        const int * ranks, int n, int dim, const double * query, int k) {
+    int i;
+    neighbor_heap * h;
+    h = init_neighbor_heap(k, ranks);
+    for (i = 0; i < n; i++) {
+        push_neighbor_heap(h, sqrt(sum_of_squared_diffs(query,
+                points + (i * dim), dim)), i);
+    }
+    sort_neighbor_heap(h);
+    return h;
+}
+
+static void check_knn_matches_brute_force(int n, int dim, int k,
+        int num_levels, int leaf_size) {
+    int i, q, nq;
+    int * ranks;
+    double * points;
+    double * tree_points;
+    double * query;
+    kd_tree * t;
+    neighbor_heap * exp;
+    neighbor_heap * h;
+    points = get_random_points(n, dim, num_levels);
+    tree_points = (typeof(*tree_points) *) calloc(n * dim,
+            sizeof(*tree_points));
+    memcpy(tree_points, points, n * dim * sizeof(*points));
+    ranks = (typeof(*ranks) *) calloc(n, sizeof(*ranks));
+    for (i = 0; i < n; i++) {
+        ranks[i] = i;
+    }
+    t = build_kd_tree(tree_points, ranks, n, dim, leaf_size);
+    // the tree must be a permutation of the input
+    for (i = 0; i < n; i++) {
+        ck_assert_msg((memcmp(tree_points + (i * dim),
+                points + (ranks[i] * dim), dim * sizeof(*points)) == 0),
+                "row %d of the tree does not match input row %d", i,
+                ranks[i]);
+    }
+    nq = 20;
+    for (q = 0; q < nq; q++) {
+        query = get_random_points(1, dim, num_levels);
+        exp = brute_force_knn(points, NULL, n, dim, query, k);
+        h = init_neighbor_heap(k, ranks);
+        kd_tree_knn(t, query, h);
+        sort_neighbor_heap(h);
+        ck_assert_int_eq(h->length, exp->length);
+        for (i = 0; i < h->length; i++) {
+            ck_assert_msg((ranks[h->a[i].index] == exp->a[i].index),
+                    "neighbor %d is input row %d, expected %d", i,
+                    ranks[h->a[i].index], exp->a[i].index);
+            ck_assert_msg((h->a[i].distance == exp->a[i].distance),
+                    "neighbor %d has distance %lf, expected %lf", i,
+                    h->a[i].distance, exp->a[i].distance);
+        }
+        free_neighbor_heap(exp);
+        free_neighbor_heap(h);
+        free(query);
+    }
+    free_kd_tree(t);
+    free(points);
+    free(tree_points);
+    free(ranks);
+}
+
+static void check_knn_f_matches_brute_force(int n, int dim, int k,
+        int num_levels, int leaf_size) {
+    int i, q, nq;
+    int * ranks;
+    double * points;
+    float * tree_points;
+    float * fpoints;
+    double * query;
+    kd_tree * t;
+    neighbor_heap * exp;
+    neighbor_heap * h;
+    points = get_random_points(n, dim, num_levels);
+    fpoints = (typeof(*fpoints) *) calloc(n * dim, sizeof(*fpoints));
+    tree_points = (typeof(*tree_points) *) calloc(n * dim,
+            sizeof(*tree_points));
+    for (i = 0; i < (n * dim); i++) {
+        fpoints[i] = tree_points[i] = (float) points[i];
+    }
+    ranks = (typeof(*ranks) *) calloc(n, sizeof(*ranks));
+    for (i = 0; i < n; i++) {
+        ranks[i] = i;
+    }
+    t = build_kd_tree_f(tree_points, ranks, n, dim, leaf_size);
+    ck_assert_msg((t->points == NULL), "double points should not be set");
+    for (i = 0; i < n; i++) {
+        ck_assert_msg((memcmp(tree_points + (i * dim),
+                fpoints + (ranks[i] * dim), dim * sizeof(*fpoints)) == 0),
+                "row %d of the tree does not match input row %d", i,
+                ranks[i]);
+    }
+    nq = 20;
+    for (q = 0; q < nq; q++) {
+        query = get_random_points(1, dim, num_levels);
+        exp = init_neighbor_heap(k, NULL);
+        for (i = 0; i < n; i++) {
+            push_neighbor_heap(exp, sqrt(sum_of_squared_diffs_f(query,
+                    fpoints + (i * dim), dim)), i);
+        }
+        sort_neighbor_heap(exp);
+        h = init_neighbor_heap(k, ranks);
+        kd_tree_knn(t, query, h);
+        sort_neighbor_heap(h);
+        ck_assert_int_eq(h->length, exp->length);
+        for (i = 0; i < h->length; i++) {
+            ck_assert_int_eq(ranks[h->a[i].index], exp->a[i].index);
+            ck_assert_msg((h->a[i].distance == exp->a[i].distance),
+                    "neighbor %d has distance %lf, expected %lf", i,
+                    h->a[i].distance, exp->a[i].distance);
+        }
+        free_neighbor_heap(exp);
+        free_neighbor_heap(h);
+        free(query);
+    }
+    free_kd_tree(t);
+    free(points);
+    free(fpoints);
+    free(tree_points);
+    free(ranks);
+}
+
+static int compare_ints(const void * x, const void * y) {
+    return (*((const int *) x) - *((const int *) y));
+}
+
+static void check_range_matches_brute_force(int n, int dim, double radius,
+        int use_float) {
+    int i, q, nq, num_exp;
+    int * ranks;
+    int * exp;
+    double * points;
+    double * tree_points;
+    float * ftree_points;
+    double * query;
+    kd_tree * t;
+    i_array * indices;
+    points = get_random_points(n, dim, 0);
+    tree_points = (typeof(*tree_points) *) calloc(n * dim,
+            sizeof(*tree_points));
+    ftree_points = (typeof(*ftree_points) *) calloc(n * dim,
+            sizeof(*ftree_points));
+    ranks = (typeof(*ranks) *) calloc(n, sizeof(*ranks));
+    exp = (typeof(*exp) *) calloc(n, sizeof(*exp));
+    for (i = 0; i < (n * dim); i++) {
+        tree_points[i] = points[i];
+        ftree_points[i] = (float) points[i];
+    }
+    for (i = 0; i < n; i++) {
+        ranks[i] = i;
+    }
+    if (use_float != 0) {
+        t = build_kd_tree_f(ftree_points, ranks, n, dim, 4);
+    }
+    else {
+        t = build_kd_tree(tree_points, ranks, n, dim, 4);
+    }
+    indices = init_i_array(16);
+    nq = 20;
+    for (q = 0; q < nq; q++) {
+        query = get_random_points(1, dim, 0);
+        num_exp = 0;
+        for (i = 0; i < n; i++) {
+            if (get_kd_point_distance(t, query, i) <= radius) {
+                exp[num_exp] = ranks[i];
+                num_exp++;
+            }
+        }
+        kd_tree_range(t, query, radius, indices);
+        ck_assert_int_eq(indices->length, num_exp);
+        for (i = 0; i < indices->length; i++) {
+            indices->a[i] = ranks[indices->a[i]];
+        }
+        qsort(indices->a, indices->length, sizeof(*indices->a),
+                compare_ints);
+        qsort(exp, num_exp, sizeof(*exp), compare_ints);
+        for (i = 0; i < num_exp; i++) {
+            ck_assert_int_eq(indices->a[i], exp[i]);
+        }
+        free(query);
+    }
+    free_i_array(indices);
+    free_kd_tree(t);
+    free(points);
+    free(tree_points);
+    free(ftree_points);
+    free(ranks);
+    free(exp);
+}
+
+START_TEST (test_neighbor_heap) {
+    int i;
+    neighbor_heap * h;
+    double distances[8] = {5.0, 1.0, 4.0, 2.0, 2.0, 0.5, 9.0, 2.0};
+    h = init_neighbor_heap(4, NULL);
+    ck_assert_int_eq(h->capacity, 4);
+    ck_assert_int_eq(h->length, 0);
+    ck_assert_msg((get_worst_neighbor_distance(h) == HUGE_VAL),
+            "worst distance of a heap that is not full should be HUGE_VAL");
+    for (i = 0; i < 8; i++) {
+        push_neighbor_heap(h, distances[i], i);
+    }
+    ck_assert_int_eq(h->length, 4);
+    ck_assert_msg((get_worst_neighbor_distance(h) == 2.0),
+            "worst distance is %lf, expected 2.0",
+            get_worst_neighbor_distance(h));
+    sort_neighbor_heap(h);
+    // ties are broken in favor of the earlier index
+    ck_assert_int_eq(h->a[0].index, 5);
+    ck_assert_int_eq(h->a[1].index, 1);
+    ck_assert_int_eq(h->a[2].index, 3);
+    ck_assert_int_eq(h->a[3].index, 4);
+    free_neighbor_heap(h);
+}
+END_TEST
+
+START_TEST (test_neighbor_heap_ranks) {
+    int ranks[4] = {3, 2, 1, 0};
+    neighbor_heap * h;
+    h = init_neighbor_heap(2, ranks);
+    ck_assert_int_eq(push_neighbor_heap(h, 1.0, 0), 1);
+    ck_assert_int_eq(push_neighbor_heap(h, 1.0, 1), 1);
+    ck_assert_int_eq(push_neighbor_heap(h, 1.0, 2), 1);
+    ck_assert_int_eq(push_neighbor_heap(h, 2.0, 3), 0);
+    sort_neighbor_heap(h);
+    ck_assert_int_eq(h->a[0].index, 2);
+    ck_assert_int_eq(h->a[1].index, 1);
+    free_neighbor_heap(h);
+}
+END_TEST
+
+START_TEST (test_init_neighbor_heap_fail) {
+    neighbor_heap * h;
+    h = init_neighbor_heap(0, NULL); // SIGABRT
+}
+END_TEST
+
+START_TEST (test_kd_tree_knn_d2) {
+    srand(1);
+    check_knn_matches_brute_force(1000, 2, 10, 0, KD_TREE_LEAF_SIZE);
+    check_knn_matches_brute_force(1000, 2, 1, 0, 1);
+}
+END_TEST
+
+START_TEST (test_kd_tree_knn_d8) {
+    srand(2);
+    check_knn_matches_brute_force(500, 8, 25, 0, KD_TREE_LEAF_SIZE);
+}
+END_TEST
+
+START_TEST (test_kd_tree_knn_ties) {
+    srand(3);
+    check_knn_matches_brute_force(800, 3, 30, 3, KD_TREE_LEAF_SIZE);
+    check_knn_matches_brute_force(800, 3, 30, 2, 1);
+}
+END_TEST
+
+START_TEST (test_kd_tree_knn_k_exceeds_n) {
+    srand(4);
+    check_knn_matches_brute_force(20, 3, 50, 0, 4);
+}
+END_TEST
+
+START_TEST (test_kd_tree_knn_f) {
+    srand(6);
+    check_knn_f_matches_brute_force(1000, 3, 10, 0, KD_TREE_LEAF_SIZE);
+    check_knn_f_matches_brute_force(800, 3, 30, 3, 1);
+}
+END_TEST
+
+START_TEST (test_kd_tree_range) {
+    srand(7);
+    check_range_matches_brute_force(1000, 2, 0.1, 0);
+    check_range_matches_brute_force(1000, 4, 0.5, 0);
+    check_range_matches_brute_force(1000, 3, 0.3, 1);
+    check_range_matches_brute_force(50, 3, 10.0, 1);
+}
+END_TEST
+
+START_TEST (test_kd_tree_knn_visits_fraction) {
+    int i, n, dim, visited;
+    int * ranks;
+    double * points;
+    double query[2] = {0.1, -0.2};
+    kd_tree * t;
+    neighbor_heap * h;
+    srand(5);
+    n = 20000;
+    dim = 2;
+    points = get_random_points(n, dim, 0);
+    ranks = (typeof(*ranks) *) calloc(n, sizeof(*ranks));
+    for (i = 0; i < n; i++) {
+        ranks[i] = i;
+    }
+    t = build_kd_tree(points, ranks, n, dim, KD_TREE_LEAF_SIZE);
+    h = init_neighbor_heap(10, ranks);
+    visited = kd_tree_knn(t, query, h);
+    ck_assert_int_eq(h->length, 10);
+    ck_assert_msg((visited < (n / 10)), "visited %d of %d points", visited,
+            n);
+    free_neighbor_heap(h);
+    free_kd_tree(t);
+    free(points);
+    free(ranks);
+}
+END_TEST
+
+Suite * kdtree_suite(void) {
+    Suite * s = suite_create("kdtree");
+
+    TCase * tc_neighbor_heap = tcase_create("neighbor_heap_test_case");
+    tcase_add_test(tc_neighbor_heap, test_neighbor_heap);
+    tcase_add_test(tc_neighbor_heap, test_neighbor_heap_ranks);
+    tcase_add_test_raise_signal(tc_neighbor_heap,
+            test_init_neighbor_heap_fail, SIGABRT);
+    suite_add_tcase(s, tc_neighbor_heap);
+
+    TCase * tc_kd_tree_knn = tcase_create("kd_tree_knn_test_case");
+    tcase_add_test(tc_kd_tree_knn, test_kd_tree_knn_d2);
+    tcase_add_test(tc_kd_tree_knn, test_kd_tree_knn_d8);
+    tcase_add_test(tc_kd_tree_knn, test_kd_tree_knn_ties);
+    tcase_add_test(tc_kd_tree_knn, test_kd_tree_knn_k_exceeds_n);
+    tcase_add_test(tc_kd_tree_knn, test_kd_tree_knn_f);
+    tcase_add_test(tc_kd_tree_knn, test_kd_tree_range);
+    tcase_add_test(tc_kd_tree_knn, test_kd_tree_knn_visits_fraction);
+    suite_add_tcase(s, tc_kd_tree_knn);
+
+    return s;
+}
+
+int main(void) {
+    int number_failed;
+    Suite * s = kdtree_suite();
+    SRunner * sr = srunner_create(s);
+    srunner_run_all(sr, CK_VERBOSE);
+    number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
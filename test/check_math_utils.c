@@ -1,6 +1,7 @@
 #include <stdlib.h>
 #include <check.h>
 #include <signal.h>
+#include <string.h>
 #include "../src/math_utils.c"
 #include "test_utils.h"
 
@@ -37,14 +38,100 @@ START_TEST(test_get_euclidean_distance) {
 }
 END_TEST
 
+START_TEST(test_sum_of_squared_diffs_f) {
+    int i;
+    double x[4] = {0.1, -2.5, 3.0, 1e-9};
+    double y[4] = {1.0 / 3.0, 0.7, -1.25, 2.0};
+    float fy[4];
+    double yr[4];
+    for (i = 0; i < 4; i++) {
+        fy[i] = (float) y[i];
+        yr[i] = (double) fy[i];
+    }
+    // the same as the double kernel applied to the rounded values
+    ck_assert_msg((sum_of_squared_diffs_f(x, fy, 4) ==
+            sum_of_squared_diffs(x, yr, 4)),
+            "sum of squared diffs is %lf, expecting %lf",
+            sum_of_squared_diffs_f(x, fy, 4),
+            sum_of_squared_diffs(x, yr, 4));
+    ck_assert_msg(almost_equal(sum_of_squared_diffs_f(x, fy, 4),
+            sum_of_squared_diffs(x, y, 4), 0.000001),
+            "sum of squared diffs is %lf, expecting %lf",
+            sum_of_squared_diffs_f(x, fy, 4), sum_of_squared_diffs(x, y, 4));
+}
+END_TEST
+
+START_TEST (test_get_symmetric_eigen) {
+    int i, j, k, n;
+    double e = 0.0000001;
+    double x, norm;
+    double a[9] = {4.0, 1.0, 2.0,
+                   1.0, 3.0, 0.0,
+                   2.0, 0.0, 5.0};
+    double b[9];
+    double values[3];
+    double vectors[9];
+    n = 3;
+    memcpy(b, a, sizeof(a));
+    get_symmetric_eigen(b, n, values, vectors);
+    for (i = 0; i < n; i++) {
+        if (i > 0) {
+            ck_assert_msg((values[i] <= values[i - 1]),
+                    "eigenvalues are not sorted");
+        }
+        norm = 0.0;
+        for (j = 0; j < n; j++) {
+            // row j of a times eigenvector i
+            x = 0.0;
+            for (k = 0; k < n; k++) {
+                x += a[(j * n) + k] * vectors[(i * n) + k];
+            }
+            ck_assert_msg(almost_equal(x, (values[i] * vectors[(i * n) + j]),
+                    e), "eigenvector %d is incorrect", i);
+            norm += vectors[(i * n) + j] * vectors[(i * n) + j];
+        }
+        ck_assert_msg(almost_equal(norm, 1.0, e), "eigenvector %d has "
+                "norm %lf", i, norm);
+    }
+    // the eigenvalues sum to the trace
+    ck_assert_msg(almost_equal((values[0] + values[1] + values[2]), 12.0, e),
+            "eigenvalues sum to %lf",
+            (values[0] + values[1] + values[2]));
+}
+END_TEST
+
+START_TEST (test_get_symmetric_eigen_diagonal) {
+    double e = 0.0000001;
+    double a[4] = {1.0, 0.0,
+                   0.0, 2.0};
+    double values[2];
+    double vectors[4];
+    get_symmetric_eigen(a, 2, values, vectors);
+    ck_assert_msg((almost_equal(values[0], 2.0, e) &&
+            almost_equal(values[1], 1.0, e)), "eigenvalues are %lf and %lf",
+            values[0], values[1]);
+    ck_assert_msg((almost_equal(fabs(vectors[1]), 1.0, e) &&
+            almost_equal(fabs(vectors[2]), 1.0, e)),
+            "unexpected eigenvectors");
+}
+END_TEST
+
 Suite * math_utils_suite(void) {
     Suite * s = suite_create("math_utils");
 
     TCase * tc_get_euclidean_distance = tcase_create(
             "euclidean_distance_test_case");
     tcase_add_test(tc_get_euclidean_distance, test_get_euclidean_distance);
+    tcase_add_test(tc_get_euclidean_distance, test_sum_of_squared_diffs_f);
     suite_add_tcase(s, tc_get_euclidean_distance);
 
+    TCase * tc_get_symmetric_eigen = tcase_create(
+            "symmetric_eigen_test_case");
+    tcase_add_test(tc_get_symmetric_eigen, test_get_symmetric_eigen);
+    tcase_add_test(tc_get_symmetric_eigen,
+            test_get_symmetric_eigen_diagonal);
+    suite_add_tcase(s, tc_get_symmetric_eigen);
+
     return s;
 }
 
@@ -324,6 +324,58 @@ START_TEST (test_strip) {
 }
 END_TEST
 
+START_TEST (test_parse_summary_projection) {
+    double e = 0.000001;
+    c_array * line_buffer;
+    projection * p;
+    line_buffer = init_c_array(1023);
+    p = parse_summary_projection("data/summary_projection.txt", line_buffer,
+            3);
+    ck_assert_msg((p != NULL), "found no projection");
+    ck_assert_int_eq(p->method, PROJECTION_PLS);
+    ck_assert_int_eq(p->dim, 3);
+    ck_assert_int_eq(p->num_components, 2);
+    ck_assert_msg((almost_equal(p->weights->a[1], -0.25, e) &&
+            almost_equal(p->weights->a[5], -1.5, e)),
+            "parsed weights are incorrect");
+    free_projection(p);
+    p = parse_summary_projection("data/observed_stats_extra_line.txt",
+            line_buffer, 4);
+    ck_assert_msg((p == NULL), "found a projection");
+    free_c_array(line_buffer);
+}
+END_TEST
+
+START_TEST (test_parse_summary_projection_stat_name) {
+    double e = 0.000001;
+    c_array * line_buffer;
+    projection * p;
+    line_buffer = init_c_array(1023);
+    // the first stat is named like a projection line
+    p = parse_summary_projection("data/summary_projection_stat_name.txt",
+            line_buffer, 2);
+    ck_assert_msg((p == NULL), "found a projection");
+    p = parse_summary_projection(
+            "data/summary_projection_stat_name_pca.txt", line_buffer, 2);
+    ck_assert_msg((p != NULL), "found no projection");
+    ck_assert_int_eq(p->method, PROJECTION_PCA);
+    ck_assert_int_eq(p->num_components, 1);
+    ck_assert_msg(almost_equal(p->weights->a[1], -0.25, e),
+            "parsed weights are incorrect");
+    free_projection(p);
+    free_c_array(line_buffer);
+}
+END_TEST
+
+START_TEST (test_parse_summary_projection_invalid) {
+    c_array * line_buffer;
+    line_buffer = init_c_array(1023);
+    // more components than stats
+    parse_summary_projection("data/summary_projection_invalid.txt",
+            line_buffer, 3); // exit(1)
+}
+END_TEST
+
 Suite * parsing_suite(void) {
     Suite * s = suite_create("parsing");
 
@@ -343,6 +395,16 @@ Suite * parsing_suite(void) {
     tcase_add_test(tc_parse_summary_file, test_parse_summary_file);
     suite_add_tcase(s, tc_parse_summary_file);
 
+    TCase * tc_parse_summary_projection = tcase_create(
+            "parse_summary_projection_test_case");
+    tcase_add_test(tc_parse_summary_projection,
+            test_parse_summary_projection);
+    tcase_add_test(tc_parse_summary_projection,
+            test_parse_summary_projection_stat_name);
+    tcase_add_exit_test(tc_parse_summary_projection,
+            test_parse_summary_projection_invalid, 1);
+    suite_add_tcase(s, tc_parse_summary_projection);
+
     TCase * tc_strcmp_i = tcase_create("strcmp_i_test_case");
     tcase_add_test(tc_strcmp_i, test_strcmp_i);
     suite_add_tcase(s, tc_strcmp_i);
@@ -499,6 +499,138 @@ START_TEST (test_frequency_of_int_partitions_by_k_n7) {
 END_TEST
 
 
+START_TEST (test_cumulative_number_of_int_partitions_by_k_n122) {
+    i_array * counts;
+    counts = init_i_array(1);
+    // p(122) does not fit in an int
+    cumulative_number_of_int_partitions_by_k(122, counts); // exit(1)
+}
+END_TEST
+
+START_TEST (test_cumulative_number_of_int_partitions_by_k_u128) {
+    int i, n;
+    uint128 ip, expected;
+    uint128 * counts;
+    i_array * int_counts;
+    n = 1000;
+    counts = (typeof(*counts) *) malloc(sizeof(*counts) * n);
+    int_counts = init_i_array(1);
+    ip = cumulative_number_of_int_partitions_by_k_u128(n, counts);
+    expected = ((uint128) 24061467864032ULL * 1000000000000000000ULL) +
+            622473692149727991ULL;
+    ck_assert_msg((ip == expected), "unexpected p(1000)");
+    ck_assert_msg((counts[n-1] == expected), "unexpected p(1000)");
+    ck_assert_msg((counts[0] == 1), "unexpected p(1000, <=1)");
+    ck_assert_msg((counts[1] == 501), "unexpected p(1000, <=2)");
+    // agrees with the int version
+    n = 50;
+    ip = cumulative_number_of_int_partitions_by_k_u128(n, counts);
+    ck_assert_int_eq((int) ip,
+            cumulative_number_of_int_partitions_by_k(n, int_counts));
+    for (i = 0; i < n; i++) {
+        ck_assert_int_eq((int) counts[i], get_i_array(int_counts, i));
+    }
+    free(counts);
+    free_i_array(int_counts);
+}
+END_TEST
+
+START_TEST (test_cumulative_number_of_int_partitions_by_k_u128_overflow) {
+    uint128 * counts;
+    counts = (typeof(*counts) *) malloc(sizeof(*counts) * 1459);
+    ck_assert_msg((cumulative_number_of_int_partitions_by_k_u128(1458,
+            counts) != 0), "p(1458) overflowed");
+    ck_assert_msg((cumulative_number_of_int_partitions_by_k_u128(1459,
+            counts) == 0), "p(1459) did not overflow");
+    free(counts);
+}
+END_TEST
+
+START_TEST (test_number_of_int_partitions_by_k_big) {
+    int i, n;
+    char * s;
+    big_int ** counts;
+    i_array * int_counts;
+    n = 2000;
+    counts = (typeof(*counts) *) malloc(sizeof(*counts) * n);
+    for (i = 0; i < n; i++) {
+        counts[i] = init_big_int(1);
+    }
+    int_counts = init_i_array(1);
+    cumulative_number_of_int_partitions_by_k_big(n, counts);
+    s = big_int_to_str(counts[n-1]);
+    ck_assert_str_eq(s,
+            "4720819175619413888601432406799959512200344166");
+    free(s);
+    // agrees with the int version
+    n = 7;
+    number_of_int_partitions_by_k_big(n, counts);
+    number_of_int_partitions_by_k(n, int_counts);
+    for (i = 0; i < n; i++) {
+        s = big_int_to_str(counts[i]);
+        ck_assert_int_eq(atoi(s), get_i_array(int_counts, i));
+        free(s);
+    }
+    for (i = 0; i < 2000; i++) {
+        free_big_int(counts[i]);
+    }
+    free(counts);
+    free_i_array(int_counts);
+}
+END_TEST
+
+START_TEST (test_log_number_of_int_partitions_by_k) {
+    int i, n;
+    double e = 0.000000001;
+    double lp;
+    d_array * logs;
+    i_array * counts;
+    logs = init_d_array(1);
+    counts = init_i_array(1);
+    n = 2000;
+    lp = log_cumulative_number_of_int_partitions_by_k(n, logs);
+    ck_assert_msg((almost_equal(lp, 105.16831152342739, e) != 0),
+            "log p(2000) is %lf", lp);
+    ck_assert_int_eq(logs->length, n);
+    ck_assert_msg((get_d_array(logs, 0) == 0.0), "log p(2000, <=1) is %lf",
+            get_d_array(logs, 0));
+    n = 7;
+    cumulative_number_of_int_partitions_by_k(n, counts);
+    log_cumulative_number_of_int_partitions_by_k(n, logs);
+    for (i = 0; i < n; i++) {
+        ck_assert_msg((almost_equal(get_d_array(logs, i),
+                log(get_i_array(counts, i)), e) != 0),
+                "cumulative count %d is %lf", i + 1,
+                exp(get_d_array(logs, i)));
+    }
+    number_of_int_partitions_by_k(n, counts);
+    log_number_of_int_partitions_by_k(n, logs);
+    for (i = 0; i < n; i++) {
+        ck_assert_msg((almost_equal(get_d_array(logs, i),
+                log(get_i_array(counts, i)), e) != 0),
+                "count %d is %lf", i + 1, exp(get_d_array(logs, i)));
+    }
+    free_d_array(logs);
+    free_i_array(counts);
+}
+END_TEST
+
+START_TEST (test_frequency_of_int_partitions_by_k_n3000) {
+    double e = 0.000001;
+    double total;
+    d_array * probs;
+    probs = init_d_array(1);
+    total = frequency_of_int_partitions_by_k(3000, probs);
+    ck_assert_int_eq(probs->length, 3000);
+    ck_assert_msg((almost_equal(total, 1.0, e) != 0),
+            "total probability is %lf", total);
+    total = cumulative_frequency_of_int_partitions_by_k(3000, probs);
+    ck_assert_msg((almost_equal(total, 1.0, e) != 0),
+            "total probability is %lf", total);
+    free_d_array(probs);
+}
+END_TEST
+
 START_TEST (test_number_of_int_partitions_neg) {
     int n, ret;
     n = -1;
@@ -540,12 +672,93 @@ START_TEST (test_number_of_int_partitions_n22) {
 END_TEST
 
 
+START_TEST (test_number_of_int_partitions_pentagonal) {
+    int n;
+    big_int * ip;
+    big_int ** counts;
+    counts = (typeof(*counts) *) malloc(sizeof(*counts) * 300);
+    for (n = 0; n < 300; n++) {
+        counts[n] = init_big_int(1);
+    }
+    ip = init_big_int(1);
+    number_of_int_partitions_pentagonal(-1, ip);
+    ck_assert_int_eq(ip->length, 0);
+    number_of_int_partitions_pentagonal(0, ip);
+    ck_assert_int_eq(ip->length, 1);
+    ck_assert_int_eq(ip->a[0], 1);
+    // agrees with the table of counts by k
+    for (n = 1; n <= 300; n += 23) {
+        cumulative_number_of_int_partitions_by_k_big(n, counts);
+        number_of_int_partitions_pentagonal(n, ip);
+        ck_assert_msg((compare_big_int(ip, counts[n-1]) == 0),
+                "unexpected p(%d)", n);
+    }
+    for (n = 0; n < 300; n++) {
+        free_big_int(counts[n]);
+    }
+    free(counts);
+    free_big_int(ip);
+}
+END_TEST
+
+START_TEST (test_number_of_int_partitions_hrr) {
+    int n;
+    big_int * ip;
+    big_int * expected;
+    ip = init_big_int(1);
+    expected = init_big_int(1);
+    for (n = 2; n <= 3000; n += ((n < 200) ? 1 : 97)) {
+        number_of_int_partitions_pentagonal(n, expected);
+        number_of_int_partitions_hrr(n, ip);
+        ck_assert_msg((compare_big_int(ip, expected) == 0),
+                "unexpected p(%d)", n);
+    }
+    free_big_int(ip);
+    free_big_int(expected);
+}
+END_TEST
+
+START_TEST (test_number_of_int_partitions_hrr_n1000000) {
+    char * s;
+    big_int * ip;
+    ip = init_big_int(1);
+    number_of_int_partitions_big(1000000, ip);
+    s = big_int_to_str(ip);
+    ck_assert_int_eq(strlen(s), 1108);
+    ck_assert_msg((strncmp(s, "147168498635822339863100476060989594348403",
+            42) == 0), "unexpected p(1000000): %s", s);
+    free(s);
+    // the residue found by the pentagonal number recurrence mod 10^9 + 7
+    ck_assert_int_eq(divide_big_int_small(ip, 1000000007), 419139981);
+    free_big_int(ip);
+}
+END_TEST
+
+START_TEST (test_number_of_int_partitions_hrr_n1) {
+    big_int * ip;
+    ip = init_big_int(1);
+    number_of_int_partitions_hrr(1, ip); // SIGABRT
+}
+END_TEST
+
+START_TEST (test_number_of_int_partitions_big_too_large) {
+    big_int * ip;
+    ip = init_big_int(1);
+    number_of_int_partitions_big((PARTITION_HRR_MAX_N + 1), ip); // exit(1)
+}
+END_TEST
+
+START_TEST (test_number_of_int_partitions_n122) {
+    number_of_int_partitions(122); // exit(1)
+}
+END_TEST
+
 START_TEST (test_generate_int_partitions_n0) {
     int n;
     n = 0;
-    i_array_2d * partitions = init_i_array_2d(1,1);
+    i_array_csr * partitions;
     partitions = generate_int_partitions(n);
-    free_i_array_2d(partitions);
+    free_i_array_csr(partitions);
 }
 END_TEST
 
@@ -553,15 +766,16 @@ START_TEST (test_generate_int_partitions_n1) {
     int n;
     n = 1;
     i_array * expected = init_i_array(1);
-    i_array_2d * partitions = init_i_array_2d(1,1);
+    i_array row;
+    i_array_csr * partitions;
     partitions = generate_int_partitions(n);
     ck_assert_int_eq(partitions->length, 1);
     append_i_array(expected, 1);
-    ck_assert_msg((i_arrays_equal(get_i_array_2d(partitions, 0),
+    ck_assert_msg((i_arrays_equal(view_row_i_array_csr(partitions, 0, &row),
             expected) != 0),
             "unexpected partition");
     free_i_array(expected);
-    free_i_array_2d(partitions);
+    free_i_array_csr(partitions);
 }
 END_TEST
 
@@ -569,27 +783,28 @@ START_TEST (test_generate_int_partitions_n4) {
     int n, i;
     n = 4;
     i_array * expected = init_i_array(1);
-    i_array_2d * partitions = init_i_array_2d(1,1);
+    i_array row;
+    i_array_csr * partitions;
     partitions = generate_int_partitions(n);
     ck_assert_int_eq(partitions->length, 5);
     i = 0;
     expected->length = 0;
     append_i_array(expected, 4);
-    ck_assert_msg((i_arrays_equal(get_i_array_2d(partitions, i),
+    ck_assert_msg((i_arrays_equal(view_row_i_array_csr(partitions, i, &row),
             expected) != 0),
             "unexpected partition");
     i = 1;
     expected->length = 0;
     append_i_array(expected, 3);
     append_i_array(expected, 1);
-    ck_assert_msg((i_arrays_equal(get_i_array_2d(partitions, i),
+    ck_assert_msg((i_arrays_equal(view_row_i_array_csr(partitions, i, &row),
             expected) != 0),
             "unexpected partition");
     i = 2;
     expected->length = 0;
     append_i_array(expected, 2);
     append_i_array(expected, 2);
-    ck_assert_msg((i_arrays_equal(get_i_array_2d(partitions, i),
+    ck_assert_msg((i_arrays_equal(view_row_i_array_csr(partitions, i, &row),
             expected) != 0),
             "unexpected partition");
     i = 3;
@@ -597,7 +812,7 @@ START_TEST (test_generate_int_partitions_n4) {
     append_i_array(expected, 2);
     append_i_array(expected, 1);
     append_i_array(expected, 1);
-    ck_assert_msg((i_arrays_equal(get_i_array_2d(partitions, i),
+    ck_assert_msg((i_arrays_equal(view_row_i_array_csr(partitions, i, &row),
             expected) != 0),
             "unexpected partition");
     i = 4;
@@ -606,11 +821,11 @@ START_TEST (test_generate_int_partitions_n4) {
     append_i_array(expected, 1);
     append_i_array(expected, 1);
     append_i_array(expected, 1);
-    ck_assert_msg((i_arrays_equal(get_i_array_2d(partitions, i),
+    ck_assert_msg((i_arrays_equal(view_row_i_array_csr(partitions, i, &row),
             expected) != 0),
             "unexpected partition");
     free_i_array(expected);
-    free_i_array_2d(partitions);
+    free_i_array_csr(partitions);
 }
 END_TEST
 
@@ -618,27 +833,28 @@ START_TEST (test_generate_int_partitions_n6) {
     int n, i;
     n = 6;
     i_array * expected = init_i_array(1);
-    i_array_2d * partitions = init_i_array_2d(1,1);
+    i_array row;
+    i_array_csr * partitions;
     partitions = generate_int_partitions(n);
     ck_assert_int_eq(partitions->length, 11);
     i = 0;
     expected->length = 0;
     append_i_array(expected, 6);
-    ck_assert_msg((i_arrays_equal(get_i_array_2d(partitions, i),
+    ck_assert_msg((i_arrays_equal(view_row_i_array_csr(partitions, i, &row),
             expected) != 0),
             "unexpected partition");
     i = 1;
     expected->length = 0;
     append_i_array(expected, 5);
     append_i_array(expected, 1);
-    ck_assert_msg((i_arrays_equal(get_i_array_2d(partitions, i),
+    ck_assert_msg((i_arrays_equal(view_row_i_array_csr(partitions, i, &row),
             expected) != 0),
             "unexpected partition");
     i = 2;
     expected->length = 0;
     append_i_array(expected, 4);
     append_i_array(expected, 2);
-    ck_assert_msg((i_arrays_equal(get_i_array_2d(partitions, i),
+    ck_assert_msg((i_arrays_equal(view_row_i_array_csr(partitions, i, &row),
             expected) != 0),
             "unexpected partition");
     i = 3;
@@ -646,14 +862,14 @@ START_TEST (test_generate_int_partitions_n6) {
     append_i_array(expected, 4);
     append_i_array(expected, 1);
     append_i_array(expected, 1);
-    ck_assert_msg((i_arrays_equal(get_i_array_2d(partitions, i),
+    ck_assert_msg((i_arrays_equal(view_row_i_array_csr(partitions, i, &row),
             expected) != 0),
             "unexpected partition");
     i = 4;
     expected->length = 0;
     append_i_array(expected, 3);
     append_i_array(expected, 3);
-    ck_assert_msg((i_arrays_equal(get_i_array_2d(partitions, i),
+    ck_assert_msg((i_arrays_equal(view_row_i_array_csr(partitions, i, &row),
             expected) != 0),
             "unexpected partition");
     i = 5;
@@ -661,7 +877,7 @@ START_TEST (test_generate_int_partitions_n6) {
     append_i_array(expected, 3);
     append_i_array(expected, 2);
     append_i_array(expected, 1);
-    ck_assert_msg((i_arrays_equal(get_i_array_2d(partitions, i),
+    ck_assert_msg((i_arrays_equal(view_row_i_array_csr(partitions, i, &row),
             expected) != 0),
             "unexpected partition");
     i = 6;
@@ -670,7 +886,7 @@ START_TEST (test_generate_int_partitions_n6) {
     append_i_array(expected, 1);
     append_i_array(expected, 1);
     append_i_array(expected, 1);
-    ck_assert_msg((i_arrays_equal(get_i_array_2d(partitions, i),
+    ck_assert_msg((i_arrays_equal(view_row_i_array_csr(partitions, i, &row),
             expected) != 0),
             "unexpected partition");
     i = 7;
@@ -678,7 +894,7 @@ START_TEST (test_generate_int_partitions_n6) {
     append_i_array(expected, 2);
     append_i_array(expected, 2);
     append_i_array(expected, 2);
-    ck_assert_msg((i_arrays_equal(get_i_array_2d(partitions, i),
+    ck_assert_msg((i_arrays_equal(view_row_i_array_csr(partitions, i, &row),
             expected) != 0),
             "unexpected partition");
     i = 8;
@@ -687,7 +903,7 @@ START_TEST (test_generate_int_partitions_n6) {
     append_i_array(expected, 2);
     append_i_array(expected, 1);
     append_i_array(expected, 1);
-    ck_assert_msg((i_arrays_equal(get_i_array_2d(partitions, i),
+    ck_assert_msg((i_arrays_equal(view_row_i_array_csr(partitions, i, &row),
             expected) != 0),
             "unexpected partition");
     i = 9;
@@ -697,7 +913,7 @@ START_TEST (test_generate_int_partitions_n6) {
     append_i_array(expected, 1);
     append_i_array(expected, 1);
     append_i_array(expected, 1);
-    ck_assert_msg((i_arrays_equal(get_i_array_2d(partitions, i),
+    ck_assert_msg((i_arrays_equal(view_row_i_array_csr(partitions, i, &row),
             expected) != 0),
             "unexpected partition");
     i = 10;
@@ -708,14 +924,229 @@ START_TEST (test_generate_int_partitions_n6) {
     append_i_array(expected, 1);
     append_i_array(expected, 1);
     append_i_array(expected, 1);
-    ck_assert_msg((i_arrays_equal(get_i_array_2d(partitions, i),
+    ck_assert_msg((i_arrays_equal(view_row_i_array_csr(partitions, i, &row),
             expected) != 0),
             "unexpected partition");
     free_i_array(expected);
-    free_i_array_2d(partitions);
+    free_i_array_csr(partitions);
+}
+END_TEST
+
+START_TEST (test_init_int_partition_iterator_n0) {
+    int_partition_iterator * it;
+    it = init_int_partition_iterator(0); // SIGABRT
+}
+END_TEST
+
+START_TEST (test_next_int_partition_n1) {
+    int_partition_iterator * it;
+    it = init_int_partition_iterator(1);
+    ck_assert_int_eq(it->num_parts, 1);
+    ck_assert_int_eq(it->x[0], 1);
+    ck_assert_int_eq(next_int_partition(it), 0);
+    ck_assert_int_eq(next_int_partition(it), 0);
+    free_int_partition_iterator(it);
+}
+END_TEST
+
+START_TEST (test_next_int_partition) {
+    int n, i, j, sum;
+    i_array row;
+    i_array_csr * partitions;
+    int_partition_iterator * it;
+    for (n = 1; n < 25; n++) {
+        partitions = generate_int_partitions(n);
+        it = init_int_partition_iterator(n);
+        for (i = 0; i < partitions->length; i++) {
+            view_row_i_array_csr(partitions, i, &row);
+            ck_assert_int_eq(it->num_parts, row.length);
+            sum = 0;
+            for (j = 0; j < it->num_parts; j++) {
+                ck_assert_int_eq(it->x[j], row.a[j]);
+                sum += it->x[j];
+            }
+            ck_assert_int_eq(sum, n);
+            ck_assert_int_eq(next_int_partition(it),
+                    (i < (partitions->length - 1)));
+        }
+        free_int_partition_iterator(it);
+        free_i_array_csr(partitions);
+    }
+}
+END_TEST
+
+static int count_int_partition_parts(const int * parts, int num_parts,
+        void * data) {
+    int * counts = (int *) data;
+    counts[0]++;
+    counts[1] += num_parts;
+    return ((counts[2] > 0) && (counts[0] >= counts[2]));
+}
+
+START_TEST (test_visit_int_partitions) {
+    int counts[3];
+    long num_visited;
+    // 1002 partitions of 22, with 7899 parts in all
+    counts[0] = 0;
+    counts[1] = 0;
+    counts[2] = 0;
+    num_visited = visit_int_partitions(22, count_int_partition_parts,
+            counts);
+    ck_assert_int_eq(num_visited, 1002);
+    ck_assert_int_eq(counts[0], 1002);
+    ck_assert_int_eq(counts[1], 7899);
+    // stopping early
+    counts[0] = 0;
+    counts[1] = 0;
+    counts[2] = 10;
+    num_visited = visit_int_partitions(22, count_int_partition_parts,
+            counts);
+    ck_assert_int_eq(num_visited, 10);
+    ck_assert_int_eq(counts[0], 10);
+}
+END_TEST
+
+
+START_TEST (test_set_partition_table) {
+    int m, k;
+    char * s;
+    double e = 0.000000001;
+    set_partition_table * t;
+    int stirling_10[11] = {0, 1, 511, 9330, 34105, 42525, 22827, 5880, 750,
+            45, 1};
+    int bell[11] = {1, 1, 2, 5, 15, 52, 203, 877, 4140, 21147, 115975};
+    t = init_set_partition_table(100, 1);
+    for (k = 0; k <= 10; k++) {
+        s = big_int_to_str(get_stirling2(t, 10, k));
+        ck_assert_int_eq(atoi(s), stirling_10[k]);
+        free(s);
+        if (k > 0) {
+            ck_assert_msg((fabs(get_log_stirling2(t, 10, k) -
+                    log(stirling_10[k])) < e), "log S(10, %d) is %lf", k,
+                    get_log_stirling2(t, 10, k));
+        }
+    }
+    ck_assert_msg((get_log_stirling2(t, 10, 0) == -INFINITY),
+            "log S(10, 0) is %lf", get_log_stirling2(t, 10, 0));
+    for (m = 0; m <= 10; m++) {
+        s = big_int_to_str(get_bell(t, m));
+        ck_assert_int_eq(atoi(s), bell[m]);
+        free(s);
+        ck_assert_msg((fabs(get_log_bell(t, m) - log(bell[m])) < e),
+                "log B(%d) is %lf", m, get_log_bell(t, m));
+    }
+    s = big_int_to_str(get_bell(t, 100));
+    ck_assert_str_eq(s, "4758539127676483365879076884138720782636366968682561"
+            "1466616334637559114497892442622672724044217756306953557882560751");
+    free(s);
+    s = big_int_to_str(get_stirling2(t, 100, 50));
+    ck_assert_str_eq(s, "4309832370093663404215143015472586959435202896143406"
+            "13912441741131280319058853783145598261659992013900");
+    free(s);
+    // the logs agree with the exact numbers
+    for (m = 1; m <= 100; m++) {
+        ck_assert_msg((fabs(get_log_bell(t, m) -
+                get_log_big_int(get_bell(t, m))) < (e * m)),
+                "log B(%d) is %lf", m, get_log_bell(t, m));
+    }
+    free_set_partition_table(t);
 }
 END_TEST
 
+START_TEST (test_set_partition_table_log) {
+    set_partition_table * t;
+    t = init_set_partition_table(500, 0);
+    ck_assert_msg((fabs(get_log_bell(t, 500) - 1941.5530252146102) <
+            0.000001), "log B(500) is %lf", get_log_bell(t, 500));
+    ck_assert(t->stirling == NULL);
+    free_set_partition_table(t);
+}
+END_TEST
+
+START_TEST (test_set_partition_table_inexact) {
+    set_partition_table * t;
+    t = init_set_partition_table(5, 0);
+    get_bell(t, 5); // SIGABRT
+}
+END_TEST
+
+START_TEST (test_init_set_partition_iterator_n0) {
+    set_partition_iterator * it;
+    it = init_set_partition_iterator(0); // SIGABRT
+}
+END_TEST
+
+START_TEST (test_next_set_partition) {
+    int n, i, j, num_blocks, num_diffs, count, code;
+    int previous[10];
+    char * seen;
+    int bell[11] = {1, 1, 2, 5, 15, 52, 203, 877, 4140, 21147, 115975};
+    set_partition_iterator * it;
+    for (n = 1; n <= 10; n++) {
+        // each partition is coded as a number in base n
+        code = 1;
+        for (i = 0; i < n; i++) {
+            code *= n;
+        }
+        seen = (typeof(*seen) *) calloc(code, sizeof(*seen));
+        it = init_set_partition_iterator(n);
+        count = 0;
+        do {
+            count++;
+            code = 0;
+            num_blocks = 0;
+            num_diffs = 0;
+            for (i = 0; i < n; i++) {
+                // a restricted growth string
+                ck_assert_msg((it->a[i] <= num_blocks),
+                        "element %d of a partition of %d is in block %d", i,
+                        n, it->a[i]);
+                if (it->a[i] == num_blocks) {
+                    num_blocks++;
+                }
+                if ((count > 1) && (it->a[i] != previous[i])) {
+                    num_diffs++;
+                    ck_assert_int_eq(it->changed, i);
+                    ck_assert_int_eq(it->from, previous[i]);
+                }
+                previous[i] = it->a[i];
+                code = (code * n) + it->a[i];
+            }
+            ck_assert_int_eq(it->num_blocks, num_blocks);
+            ck_assert_int_eq(num_diffs, ((count > 1) ? 1 : 0));
+            ck_assert_msg((seen[code] == 0), "partition %d of %d repeated",
+                    count, n);
+            seen[code] = 1;
+        } while (next_set_partition(it));
+        ck_assert_int_eq(count, bell[n]);
+        free_set_partition_iterator(it);
+        free(seen);
+    }
+}
+END_TEST
+
+static int count_set_partition_blocks(const int * blocks, int n,
+        int num_blocks, void * data) {
+    int * counts = (int *) data;
+    counts[num_blocks]++;
+    return 0;
+}
+
+START_TEST (test_visit_set_partitions) {
+    int k;
+    int counts[11];
+    int stirling_10[11] = {0, 1, 511, 9330, 34105, 42525, 22827, 5880, 750,
+            45, 1};
+    for (k = 0; k <= 10; k++) {
+        counts[k] = 0;
+    }
+    ck_assert_int_eq(visit_set_partitions(10, count_set_partition_blocks,
+            counts), 115975);
+    for (k = 0; k <= 10; k++) {
+        ck_assert_int_eq(counts[k], stirling_10[k]);
+    }
+}
+END_TEST
 
 Suite * partition_combinatorics_suite(void) {
     Suite * s = suite_create("partition_combinatorics");
@@ -778,6 +1209,22 @@ Suite * partition_combinatorics_suite(void) {
             test_frequency_of_int_partitions_by_k_n7);
     suite_add_tcase(s, tc_partition_freqs);
 
+    TCase * tc_large_partition_counts = tcase_create(
+            "large_partition_count");
+    tcase_add_exit_test(tc_large_partition_counts,
+            test_cumulative_number_of_int_partitions_by_k_n122, 1);
+    tcase_add_test(tc_large_partition_counts,
+            test_cumulative_number_of_int_partitions_by_k_u128);
+    tcase_add_test(tc_large_partition_counts,
+            test_cumulative_number_of_int_partitions_by_k_u128_overflow);
+    tcase_add_test(tc_large_partition_counts,
+            test_number_of_int_partitions_by_k_big);
+    tcase_add_test(tc_large_partition_counts,
+            test_log_number_of_int_partitions_by_k);
+    tcase_add_test(tc_large_partition_counts,
+            test_frequency_of_int_partitions_by_k_n3000);
+    suite_add_tcase(s, tc_large_partition_counts);
+
     TCase * tc_num_partitions = tcase_create("number_of_partitions");
     tcase_add_test(tc_num_partitions,
             test_number_of_int_partitions_neg);
@@ -789,6 +1236,18 @@ Suite * partition_combinatorics_suite(void) {
             test_number_of_int_partitions_n7);
     tcase_add_test(tc_num_partitions,
             test_number_of_int_partitions_n22);
+    tcase_add_exit_test(tc_num_partitions,
+            test_number_of_int_partitions_n122, 1);
+    tcase_add_test(tc_num_partitions,
+            test_number_of_int_partitions_pentagonal);
+    tcase_add_test(tc_num_partitions,
+            test_number_of_int_partitions_hrr);
+    tcase_add_test(tc_num_partitions,
+            test_number_of_int_partitions_hrr_n1000000);
+    tcase_add_test_raise_signal(tc_num_partitions,
+            test_number_of_int_partitions_hrr_n1, SIGABRT);
+    tcase_add_exit_test(tc_num_partitions,
+            test_number_of_int_partitions_big_too_large, 1);
     suite_add_tcase(s, tc_num_partitions);
 
     TCase * tc_generate_int_partitions = tcase_create(
@@ -804,6 +1263,26 @@ Suite * partition_combinatorics_suite(void) {
             test_generate_int_partitions_n6);
     suite_add_tcase(s, tc_generate_int_partitions);
 
+    TCase * tc_int_partition_iterator = tcase_create(
+            "int_partition_iterator");
+    tcase_add_test_raise_signal(tc_int_partition_iterator,
+            test_init_int_partition_iterator_n0, SIGABRT);
+    tcase_add_test(tc_int_partition_iterator, test_next_int_partition_n1);
+    tcase_add_test(tc_int_partition_iterator, test_next_int_partition);
+    tcase_add_test(tc_int_partition_iterator, test_visit_int_partitions);
+    suite_add_tcase(s, tc_int_partition_iterator);
+
+    TCase * tc_set_partitions = tcase_create("set_partitions");
+    tcase_add_test(tc_set_partitions, test_set_partition_table);
+    tcase_add_test(tc_set_partitions, test_set_partition_table_log);
+    tcase_add_test_raise_signal(tc_set_partitions,
+            test_set_partition_table_inexact, SIGABRT);
+    tcase_add_test_raise_signal(tc_set_partitions,
+            test_init_set_partition_iterator_n0, SIGABRT);
+    tcase_add_test(tc_set_partitions, test_next_set_partition);
+    tcase_add_test(tc_set_partitions, test_visit_set_partitions);
+    suite_add_tcase(s, tc_set_partitions);
+
     return s;
 }
 
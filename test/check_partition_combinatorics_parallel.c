@@ -0,0 +1,198 @@
+#include <stdlib.h>
+#include <check.h>
+#include <signal.h>
+#include "../src/partition_combinatorics_parallel.c"
+#include "test_utils.h"
+
+static int count_parts(const int * parts, int num_parts, void * data) {
+    long * counts = (long *) data;
+    counts[0]++;
+    counts[1] += num_parts;
+    return ((counts[2] > 0) && (counts[0] >= counts[2]));
+}
+
+static int write_parts(const int * parts, int num_parts, void * data) {
+    int i;
+    for (i = 0; i < num_parts; i++) {
+        fprintf((FILE *) data, "%d%s", parts[i],
+                ((i < (num_parts - 1)) ? "\t" : "\n"));
+    }
+    return 0;
+}
+
+START_TEST (test_split_int_partitions_n0) {
+    i_array_csr * prefixes;
+    prefixes = split_int_partitions(0, 10.0); // SIGABRT
+}
+END_TEST
+
+START_TEST (test_split_int_partitions_all) {
+    i_array_csr * prefixes;
+    prefixes = split_int_partitions(22, 1002.0);
+    ck_assert_int_eq(prefixes->length, 1);
+    ck_assert_int_eq(get_row_length_i_array_csr(prefixes, 0), 0);
+    free_i_array_csr(prefixes);
+}
+END_TEST
+
+START_TEST (test_split_int_partitions) {
+    int n, i, j, k, num_pieces, piece_count, ip;
+    double max_count;
+    i_array row;
+    i_array_csr * partitions;
+    i_array_csr * prefixes;
+    int_partition_iterator * it;
+    for (n = 1; n < 30; n += 4) {
+        partitions = generate_int_partitions(n);
+        ip = partitions->length;
+        for (max_count = 1.0; max_count < ip; max_count *= 3.0) {
+            prefixes = split_int_partitions(n, max_count);
+            i = 0;
+            num_pieces = 0;
+            for (k = 0; k < prefixes->length; k++) {
+                view_row_i_array_csr(prefixes, k, &row);
+                it = init_int_partition_iterator_prefix(n, row.a,
+                        row.length);
+                piece_count = 0;
+                // the pieces cover the partitions, in order
+                do {
+                    ck_assert_msg((i < ip), "too many partitions of %d", n);
+                    ck_assert_int_eq(it->num_parts,
+                            get_row_length_i_array_csr(partitions, i));
+                    for (j = 0; j < it->num_parts; j++) {
+                        ck_assert_int_eq(it->x[j],
+                                get_el_i_array_csr(partitions, i, j));
+                    }
+                    i++;
+                    piece_count++;
+                } while (next_int_partition(it));
+                free_int_partition_iterator(it);
+                ck_assert_msg((piece_count <= max_count), "piece %d of "
+                        "partitions of %d has %d partitions, more than %lf",
+                        k, n, piece_count, max_count);
+                num_pieces++;
+            }
+            ck_assert_int_eq(i, ip);
+            ck_assert_int_eq(num_pieces, prefixes->length);
+            free_i_array_csr(prefixes);
+        }
+        free_i_array_csr(partitions);
+    }
+}
+END_TEST
+
+START_TEST (test_visit_int_partitions_parallel) {
+    int t, num_threads;
+    long num_visited, total, total_parts;
+    long counts[4][3];
+    void * data[4];
+    num_threads = 4;
+    for (t = 0; t < num_threads; t++) {
+        counts[t][0] = 0;
+        counts[t][1] = 0;
+        counts[t][2] = 0;
+        data[t] = counts[t];
+    }
+    num_visited = visit_int_partitions_parallel(22, num_threads, count_parts,
+            data);
+    total = 0;
+    total_parts = 0;
+    for (t = 0; t < num_threads; t++) {
+        total += counts[t][0];
+        total_parts += counts[t][1];
+    }
+    ck_assert_int_eq(num_visited, 1002);
+    ck_assert_int_eq(total, 1002);
+    ck_assert_int_eq(total_parts, 7899);
+}
+END_TEST
+
+START_TEST (test_visit_int_partitions_parallel_stop) {
+    int t, num_threads;
+    long num_visited, total;
+    long counts[4][3];
+    void * data[4];
+    num_threads = 4;
+    for (t = 0; t < num_threads; t++) {
+        counts[t][0] = 0;
+        counts[t][1] = 0;
+        counts[t][2] = 1;
+        data[t] = counts[t];
+    }
+    num_visited = visit_int_partitions_parallel(40, num_threads, count_parts,
+            data);
+    total = 0;
+    for (t = 0; t < num_threads; t++) {
+        ck_assert_msg((counts[t][0] <= 1), "thread %d visited %ld", t,
+                counts[t][0]);
+        total += counts[t][0];
+    }
+    ck_assert_msg(((total > 0) && (total <= num_threads)),
+            "visited %ld partitions", total);
+    ck_assert_int_eq(num_visited, total);
+}
+END_TEST
+
+START_TEST (test_write_int_partitions_parallel) {
+    int n, num_threads, ordered;
+    long num_written, expected_size, size;
+    FILE * stream;
+    char * expected;
+    char * s;
+    for (n = 1; n < 40; n += 6) {
+        stream = tmpfile();
+        visit_int_partitions(n, write_parts, stream);
+        expected = read_stream(stream);
+        expected_size = strlen(expected);
+        fclose(stream);
+        for (num_threads = 1; num_threads < 5; num_threads++) {
+            for (ordered = 0; ordered < 2; ordered++) {
+                stream = tmpfile();
+                num_written = write_int_partitions_parallel(stream, n,
+                        num_threads, "\t", ordered);
+                s = read_stream(stream);
+                size = strlen(s);
+                fclose(stream);
+                ck_assert_int_eq(num_written, number_of_int_partitions(n));
+                ck_assert_int_eq(size, expected_size);
+                if (ordered != 0) {
+                    ck_assert_msg((strcmp(s, expected) == 0),
+                            "partitions of %d are not in order with %d "
+                            "threads", n, num_threads);
+                }
+                free(s);
+            }
+        }
+        free(expected);
+    }
+}
+END_TEST
+
+Suite * partition_combinatorics_parallel_suite(void) {
+    Suite * s = suite_create("partition_combinatorics_parallel");
+
+    TCase * tc_split = tcase_create("split_int_partitions");
+    tcase_add_test_raise_signal(tc_split, test_split_int_partitions_n0,
+            SIGABRT);
+    tcase_add_test(tc_split, test_split_int_partitions_all);
+    tcase_add_test(tc_split, test_split_int_partitions);
+    suite_add_tcase(s, tc_split);
+
+    TCase * tc_parallel = tcase_create("int_partitions_parallel");
+    tcase_add_test(tc_parallel, test_visit_int_partitions_parallel);
+    tcase_add_test(tc_parallel, test_visit_int_partitions_parallel_stop);
+    tcase_add_test(tc_parallel, test_write_int_partitions_parallel);
+    suite_add_tcase(s, tc_parallel);
+
+    return s;
+}
+
+int main(void) {
+    int number_failed;
+    Suite * s = partition_combinatorics_parallel_suite();
+    SRunner * sr = srunner_create(s);
+    srunner_run_all(sr, CK_VERBOSE);
+    number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -115,6 +115,433 @@ START_TEST (test_draw_int_partition_category_n22) {
 }
 END_TEST
 
+START_TEST (test_init_int_partition_category_sampler_n0) {
+    int_partition_category_sampler * s;
+    s = init_int_partition_category_sampler(0); // SIGABRT
+}
+END_TEST
+
+START_TEST (test_init_int_partition_category_sampler) {
+    int_partition_category_sampler * s;
+    d_array * probs;
+    double e, p;
+    int i, j, n;
+    e = 0.000000001;
+    for (n = 1; n < 60; n += 7) {
+        s = init_int_partition_category_sampler(n);
+        probs = init_d_array(n);
+        frequency_of_int_partitions_by_k(n, probs);
+        // the probability of each category summed over the columns of the
+        // table
+        for (i = 0; i < n; i++) {
+            ck_assert_msg(((s->prob[i] >= 0.0) && (s->prob[i] <= 1.0)),
+                    "column %d of n %d has prob %lf", i, n, s->prob[i]);
+            p = s->prob[i];
+            for (j = 0; j < n; j++) {
+                if (s->alias[j] == i) {
+                    p += 1.0 - s->prob[j];
+                }
+            }
+            p /= n;
+            ck_assert_msg((almost_equal(p, get_d_array(probs, i), e) != 0),
+                    "category %d of n %d has prob %lf, expecting %lf",
+                    (i+1), n, p, get_d_array(probs, i));
+        }
+        free_d_array(probs);
+        free_int_partition_category_sampler(s);
+    }
+}
+END_TEST
+
+START_TEST (test_draw_int_partition_category_alias_n1) {
+    gsl_rng * rng;
+    int_partition_category_sampler * s;
+    int i;
+    rng = get_rng(0);
+    s = init_int_partition_category_sampler(1);
+    for (i = 0; i < 100; i++) {
+        ck_assert_int_eq(draw_int_partition_category_alias(rng, s), 1);
+    }
+    free_int_partition_category_sampler(s);
+    free_rng(rng);
+}
+END_TEST
+
+START_TEST (test_draw_int_partition_category_alias_n7) {
+    gsl_rng * rng;
+    int_partition_category_sampler * s;
+    int i, ret, sum, reps;
+    double e, p, ep;
+    rng = get_rng(0);
+    e = 0.01;
+    reps = 100000;
+    sum = 0;
+    s = init_int_partition_category_sampler(7);
+    for (i = 0; i < reps; i++) {
+        ret = draw_int_partition_category_alias(rng, s);
+        ck_assert_msg(((ret > 0) && (ret <= 7)), "drew category %d", ret);
+        if (ret == 3) sum++;
+    }
+    ep = 4 / (double)15;
+    p = sum / (double)reps;
+    ck_assert_msg((almost_equal(p, ep, e) != 0),
+            "target freq was %lf, expecting %lf", p, ep);
+    free_int_partition_category_sampler(s);
+    free_rng(rng);
+}
+END_TEST
+
+START_TEST (test_draw_int_partition_category_alias_n22) {
+    gsl_rng * rng;
+    int_partition_category_sampler * s;
+    int i, ret, sum, reps;
+    double e, p, ep;
+    rng = get_rng(0);
+    e = 0.01;
+    reps = 100000;
+    sum = 0;
+    s = init_int_partition_category_sampler(22);
+    for (i = 0; i < reps; i++) {
+        ret = draw_int_partition_category_alias(rng, s);
+        if (ret == 6) sum++;
+    }
+    ep = 136 / (double)1002;
+    p = sum / (double)reps;
+    ck_assert_msg((almost_equal(p, ep, e) != 0),
+            "target freq was %lf, expecting %lf", p, ep);
+    free_int_partition_category_sampler(s);
+    free_rng(rng);
+}
+END_TEST
+
+/**
+ * Returns the index of the partition `parts` among `partitions`, or -1.
+ */
+static int find_int_partition(const i_array_csr * partitions,
+        const i_array * parts) {
+    int i;
+    i_array row;
+    for (i = 0; i < partitions->length; i++) {
+        if (i_arrays_equal(view_row_i_array_csr(partitions, i, &row),
+                parts) != 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static void ck_assert_int_partition(const i_array * parts, int n) {
+    int i, sum;
+    sum = 0;
+    for (i = 0; i < parts->length; i++) {
+        ck_assert_msg((get_i_array(parts, i) > 0), "part %d is %d", i,
+                get_i_array(parts, i));
+        if (i > 0) {
+            ck_assert_msg(
+                    (get_i_array(parts, i) <= get_i_array(parts, (i - 1))),
+                    "part %d is larger than the one before it", i);
+        }
+        sum += get_i_array(parts, i);
+    }
+    ck_assert_int_eq(sum, n);
+}
+
+START_TEST (test_init_int_partition_sampler_n0) {
+    int_partition_sampler * s;
+    s = init_int_partition_sampler(0); // SIGABRT
+}
+END_TEST
+
+START_TEST (test_draw_int_partition) {
+    gsl_rng * rng;
+    int_partition_sampler * s;
+    i_array * parts;
+    int i, n, num_parts;
+    rng = get_rng(0);
+    parts = init_i_array(1);
+    for (n = 1; n < 200; n += 11) {
+        s = init_int_partition_sampler(n);
+        for (i = 0; i < 100; i++) {
+            num_parts = draw_int_partition(rng, s, parts);
+            ck_assert_int_eq(num_parts, parts->length);
+            ck_assert_int_partition(parts, n);
+        }
+        free_int_partition_sampler(s);
+    }
+    free_i_array(parts);
+    free_rng(rng);
+}
+END_TEST
+
+START_TEST (test_draw_int_partition_uniform) {
+    gsl_rng * rng;
+    int_partition_sampler * s;
+    i_array * parts;
+    i_array_csr * partitions;
+    int i, index, reps;
+    int counts[11];
+    double e, p, ep;
+    rng = get_rng(0);
+    e = 0.01;
+    reps = 110000;
+    parts = init_i_array(1);
+    partitions = generate_int_partitions(6);
+    s = init_int_partition_sampler(6);
+    for (i = 0; i < 11; i++) {
+        counts[i] = 0;
+    }
+    for (i = 0; i < reps; i++) {
+        draw_int_partition(rng, s, parts);
+        index = find_int_partition(partitions, parts);
+        ck_assert_msg((index >= 0), "drew a partition that is not of 6");
+        counts[index]++;
+    }
+    ep = 1 / 11.0;
+    for (i = 0; i < 11; i++) {
+        p = counts[i] / (double)reps;
+        ck_assert_msg((almost_equal(p, ep, e) != 0),
+                "freq of partition %d was %lf, expecting %lf", i, p, ep);
+    }
+    free_int_partition_sampler(s);
+    free_i_array_csr(partitions);
+    free_i_array(parts);
+    free_rng(rng);
+}
+END_TEST
+
+START_TEST (test_draw_int_partition_by_k) {
+    gsl_rng * rng;
+    int_partition_sampler * s;
+    i_array * parts;
+    i_array_csr * partitions;
+    int i, index, reps, n, k;
+    int counts[4];
+    double e, p, ep;
+    rng = get_rng(0);
+    e = 0.01;
+    reps = 100000;
+    parts = init_i_array(1);
+    // every number of parts, for a range of n
+    for (n = 1; n < 60; n += 7) {
+        s = init_int_partition_sampler(n);
+        for (k = 1; k <= n; k++) {
+            draw_int_partition_by_k(rng, s, k, parts);
+            ck_assert_int_eq(parts->length, k);
+            ck_assert_int_partition(parts, n);
+        }
+        free_int_partition_sampler(s);
+    }
+    // 7 has 4 partitions into 3 parts: 5+1+1, 4+2+1, 3+3+1 and 3+2+2
+    partitions = generate_int_partitions(7);
+    s = init_int_partition_sampler(7);
+    for (i = 0; i < 4; i++) {
+        counts[i] = 0;
+    }
+    for (i = 0; i < reps; i++) {
+        draw_int_partition_by_k(rng, s, 3, parts);
+        index = find_int_partition(partitions, parts);
+        ck_assert_int_eq(parts->length, 3);
+        ck_assert_msg((index >= 0), "drew a partition that is not of 7");
+        // the partitions into 3 parts are rows 3, 5, 7 and 8
+        counts[(index == 3) ? 0 : ((index == 5) ? 1 : (index - 5))]++;
+    }
+    ep = 0.25;
+    for (i = 0; i < 4; i++) {
+        p = counts[i] / (double)reps;
+        ck_assert_msg((almost_equal(p, ep, e) != 0),
+                "freq of partition %d was %lf, expecting %lf", i, p, ep);
+    }
+    free_int_partition_sampler(s);
+    free_i_array_csr(partitions);
+    free_i_array(parts);
+    free_rng(rng);
+}
+END_TEST
+
+START_TEST (test_draw_int_partition_by_k_k0) {
+    gsl_rng * rng;
+    int_partition_sampler * s;
+    i_array * parts;
+    rng = get_rng(0);
+    parts = init_i_array(1);
+    s = init_int_partition_sampler(7);
+    draw_int_partition_by_k(rng, s, 0, parts); // SIGABRT
+}
+END_TEST
+
+START_TEST (test_draw_int_partition_boltzmann) {
+    gsl_rng * rng;
+    i_array * parts;
+    i_array_csr * partitions;
+    int i, index, reps, num_parts;
+    int counts[11];
+    double e, p, ep;
+    rng = get_rng(0);
+    e = 0.01;
+    reps = 110000;
+    parts = init_i_array(1);
+    num_parts = draw_int_partition_boltzmann(rng, 1, parts);
+    ck_assert_int_eq(num_parts, 1);
+    ck_assert_int_partition(parts, 1);
+    for (i = 0; i < 10; i++) {
+        num_parts = draw_int_partition_boltzmann(rng, 100000, parts);
+        ck_assert_int_eq(num_parts, parts->length);
+        ck_assert_int_partition(parts, 100000);
+    }
+    partitions = generate_int_partitions(6);
+    for (i = 0; i < 11; i++) {
+        counts[i] = 0;
+    }
+    for (i = 0; i < reps; i++) {
+        draw_int_partition_boltzmann(rng, 6, parts);
+        index = find_int_partition(partitions, parts);
+        ck_assert_msg((index >= 0), "drew a partition that is not of 6");
+        counts[index]++;
+    }
+    ep = 1 / 11.0;
+    for (i = 0; i < 11; i++) {
+        p = counts[i] / (double)reps;
+        ck_assert_msg((almost_equal(p, ep, e) != 0),
+                "freq of partition %d was %lf, expecting %lf", i, p, ep);
+    }
+    free_i_array_csr(partitions);
+    free_i_array(parts);
+    free_rng(rng);
+}
+END_TEST
+
+/**
+ * Check that `elements` is a restricted growth string with `k` blocks and
+ * return it coded as a number in base n.
+ */
+static int ck_assert_set_partition(const i_array * elements, int n, int k) {
+    int i, num_blocks, code;
+    ck_assert_int_eq(elements->length, n);
+    num_blocks = 0;
+    code = 0;
+    for (i = 0; i < n; i++) {
+        ck_assert_msg((get_i_array(elements, i) <= num_blocks),
+                "element %d is in block %d", i, get_i_array(elements, i));
+        if (get_i_array(elements, i) == num_blocks) {
+            num_blocks++;
+        }
+        code = (code * n) + get_i_array(elements, i);
+    }
+    ck_assert_int_eq(num_blocks, k);
+    return code;
+}
+
+START_TEST (test_draw_set_partition_by_k) {
+    gsl_rng * rng;
+    set_partition_table * t;
+    i_array * elements;
+    int i, n, k, ret;
+    rng = get_rng(0);
+    elements = init_i_array(1);
+    t = init_set_partition_table(200, 0);
+    for (n = 1; n <= 200; n += 19) {
+        for (k = 1; k <= n; k += ((n / 7) + 1)) {
+            for (i = 0; i < 10; i++) {
+                ret = draw_set_partition_by_k(rng, t, n, k, elements);
+                ck_assert_int_eq(ret, k);
+                ck_assert_set_partition(elements, n, k);
+            }
+        }
+        // the extremes
+        draw_set_partition_by_k(rng, t, n, n, elements);
+        ck_assert_set_partition(elements, n, n);
+        draw_set_partition_by_k(rng, t, n, 1, elements);
+        ck_assert_set_partition(elements, n, 1);
+    }
+    free_set_partition_table(t);
+    free_i_array(elements);
+    free_rng(rng);
+}
+END_TEST
+
+START_TEST (test_draw_set_partition_by_k_uniform) {
+    gsl_rng * rng;
+    set_partition_table * t;
+    i_array * elements;
+    int i, reps, num_seen;
+    int counts[256];
+    double e, p, ep;
+    rng = get_rng(0);
+    e = 0.005;
+    reps = 140000;
+    elements = init_i_array(1);
+    t = init_set_partition_table(4, 0);
+    for (i = 0; i < 256; i++) {
+        counts[i] = 0;
+    }
+    // S(4, 2) = 7
+    for (i = 0; i < reps; i++) {
+        draw_set_partition_by_k(rng, t, 4, 2, elements);
+        counts[ck_assert_set_partition(elements, 4, 2)]++;
+    }
+    ep = 1 / 7.0;
+    num_seen = 0;
+    for (i = 0; i < 256; i++) {
+        if (counts[i] == 0) continue;
+        num_seen++;
+        p = counts[i] / (double)reps;
+        ck_assert_msg((almost_equal(p, ep, e) != 0),
+                "freq of partition %d was %lf, expecting %lf", i, p, ep);
+    }
+    ck_assert_int_eq(num_seen, 7);
+    free_set_partition_table(t);
+    free_i_array(elements);
+    free_rng(rng);
+}
+END_TEST
+
+START_TEST (test_draw_set_partition_by_k_k0) {
+    gsl_rng * rng;
+    set_partition_table * t;
+    i_array * elements;
+    rng = get_rng(0);
+    elements = init_i_array(1);
+    t = init_set_partition_table(4, 0);
+    draw_set_partition_by_k(rng, t, 4, 0, elements); // SIGABRT
+}
+END_TEST
+
+START_TEST (test_draw_set_partition_uniform) {
+    gsl_rng * rng;
+    set_partition_table * t;
+    i_array * elements;
+    int i, k, reps, num_seen, code;
+    int counts[256];
+    double e, p, ep;
+    rng = get_rng(0);
+    e = 0.005;
+    reps = 150000;
+    elements = init_i_array(1);
+    t = init_set_partition_table(4, 0);
+    for (i = 0; i < 256; i++) {
+        counts[i] = 0;
+    }
+    // B(4) = 15
+    for (i = 0; i < reps; i++) {
+        k = draw_set_partition(rng, t, 4, elements);
+        code = ck_assert_set_partition(elements, 4, k);
+        counts[code]++;
+    }
+    ep = 1 / 15.0;
+    num_seen = 0;
+    for (i = 0; i < 256; i++) {
+        if (counts[i] == 0) continue;
+        num_seen++;
+        p = counts[i] / (double)reps;
+        ck_assert_msg((almost_equal(p, ep, e) != 0),
+                "freq of partition %d was %lf, expecting %lf", i, p, ep);
+    }
+    ck_assert_int_eq(num_seen, 15);
+    free_set_partition_table(t);
+    free_i_array(elements);
+    free_rng(rng);
+}
+END_TEST
 
 START_TEST (test_dirichlet_process_draw_n10_a1) {
     gsl_rng * rng;
@@ -252,6 +679,40 @@ START_TEST (test_dirichlet_process_draw_n10_a9) {
 }
 END_TEST
 
+START_TEST (test_dirichlet_process_draw_n1000_a50) {
+    gsl_rng * rng;
+    rng = get_rng(0);
+    i_array * elements;
+    int i, j, n, reps, ret;
+    double e, mean, expected, alpha;
+    e = 1.0;
+    n = 1000;
+    alpha = 50.0;
+    reps = 2000;
+    mean = 0.0;
+    elements = init_i_array(n);
+    for (i = 0; i < reps; i++) {
+        ret = dirichlet_process_draw(rng, n, alpha, elements);
+        for (j = 0; j < n; j++) {
+            ck_assert_msg(((get_i_array(elements, j) >= 0) &&
+                    (get_i_array(elements, j) < ret)),
+                    "invalid category: %d", get_i_array(elements, j));
+        }
+        mean += ret / (double)reps;
+    }
+    // element i starts a new category with probability alpha / (alpha + i)
+    expected = 0.0;
+    for (i = 0; i < n; i++) {
+        expected += alpha / (alpha + i);
+    }
+    ck_assert_msg((fabs(mean - expected) < e),
+            "mean number of categories was %lf, expecting %lf", mean,
+            expected);
+    free_i_array(elements);
+    free_rng(rng);
+}
+END_TEST
+
 Suite * partition_combinatorics_random_suite(void) {
     Suite * s = suite_create("partition_combinatorics_random");
 
@@ -268,6 +729,40 @@ Suite * partition_combinatorics_random_suite(void) {
             test_draw_int_partition_category_n22);
     suite_add_tcase(s, tc_draw_cat);
 
+    TCase * tc_draw_cat_alias = tcase_create(
+            "draw_int_partition_category_alias");
+    tcase_add_test_raise_signal(tc_draw_cat_alias,
+            test_init_int_partition_category_sampler_n0, SIGABRT);
+    tcase_add_test(tc_draw_cat_alias,
+            test_init_int_partition_category_sampler);
+    tcase_add_test(tc_draw_cat_alias,
+            test_draw_int_partition_category_alias_n1);
+    tcase_add_test(tc_draw_cat_alias,
+            test_draw_int_partition_category_alias_n7);
+    tcase_add_test(tc_draw_cat_alias,
+            test_draw_int_partition_category_alias_n22);
+    suite_add_tcase(s, tc_draw_cat_alias);
+
+    TCase * tc_draw_partition = tcase_create("draw_int_partition");
+    tcase_add_test_raise_signal(tc_draw_partition,
+            test_init_int_partition_sampler_n0, SIGABRT);
+    tcase_add_test(tc_draw_partition, test_draw_int_partition);
+    tcase_add_test(tc_draw_partition, test_draw_int_partition_uniform);
+    tcase_add_test(tc_draw_partition, test_draw_int_partition_by_k);
+    tcase_add_test_raise_signal(tc_draw_partition,
+            test_draw_int_partition_by_k_k0, SIGABRT);
+    tcase_add_test(tc_draw_partition, test_draw_int_partition_boltzmann);
+    suite_add_tcase(s, tc_draw_partition);
+
+    TCase * tc_draw_set_partition = tcase_create("draw_set_partition");
+    tcase_add_test(tc_draw_set_partition, test_draw_set_partition_by_k);
+    tcase_add_test(tc_draw_set_partition,
+            test_draw_set_partition_by_k_uniform);
+    tcase_add_test_raise_signal(tc_draw_set_partition,
+            test_draw_set_partition_by_k_k0, SIGABRT);
+    tcase_add_test(tc_draw_set_partition, test_draw_set_partition_uniform);
+    suite_add_tcase(s, tc_draw_set_partition);
+
     TCase * tc_dirichlet_process_draw = tcase_create("dirichlet_process_draw");
     tcase_add_test(tc_dirichlet_process_draw,
             test_dirichlet_process_draw_n10_a1);
@@ -277,6 +772,8 @@ Suite * partition_combinatorics_random_suite(void) {
             test_dirichlet_process_draw_n5_a3);
     tcase_add_test(tc_dirichlet_process_draw,
             test_dirichlet_process_draw_n10_a9);
+    tcase_add_test(tc_dirichlet_process_draw,
+            test_dirichlet_process_draw_n1000_a50);
     suite_add_tcase(s, tc_dirichlet_process_draw);
 
     return s;
@@ -0,0 +1,133 @@
+#include <stdlib.h>
+#include <check.h>
+#include <signal.h>
+#include <math.h>
+#include "../src/philox.c"
+#include "test_rng.h"
+
+static void ck_assert_philox4x32_10(uint32_t c0, uint32_t c1, uint32_t c2,
+        uint32_t c3, uint32_t k0, uint32_t k1, uint32_t e0, uint32_t e1,
+        uint32_t e2, uint32_t e3) {
+    int i;
+    uint32_t counter[4] = {c0, c1, c2, c3};
+    uint32_t key[2] = {k0, k1};
+    uint32_t expected[4] = {e0, e1, e2, e3};
+    uint32_t out[4];
+    philox4x32_10(counter, key, out);
+    for (i = 0; i < 4; i++) {
+        ck_assert_msg((out[i] == expected[i]), "word %d is %08x, expecting "
+                "%08x", i, out[i], expected[i]);
+    }
+}
+
+START_TEST (test_philox4x32_10) {
+    // the known-answer vectors of Random123
+    ck_assert_philox4x32_10(0, 0, 0, 0, 0, 0,
+            0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8);
+    ck_assert_philox4x32_10(0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff,
+            0xffffffff, 0xffffffff,
+            0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd);
+    ck_assert_philox4x32_10(0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344,
+            0xa4093822, 0x299f31d0,
+            0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1);
+}
+END_TEST
+
+START_TEST (test_philox_rng_type) {
+    int i;
+    uint32_t key[2] = {12345, 0};
+    uint32_t counter[4] = {0, 0, 0, 0};
+    uint32_t block[4];
+    gsl_rng * rng;
+    rng = gsl_rng_alloc(philox_rng_type);
+    gsl_rng_set(rng, 12345);
+    // stream 0 of the seed is the blocks of counters 0, 1, ...
+    for (counter[0] = 0; counter[0] < 3; counter[0]++) {
+        philox4x32_10(counter, key, block);
+        for (i = 0; i < 4; i++) {
+            ck_assert_int_eq(gsl_rng_get(rng), block[i]);
+        }
+    }
+    gsl_rng_free(rng);
+}
+END_TEST
+
+START_TEST (test_set_philox_stream) {
+    int i;
+    unsigned long x[8];
+    gsl_rng * rng;
+    rng = gsl_rng_alloc(philox_rng_type);
+    set_philox_stream(rng, 7, 1000);
+    for (i = 0; i < 8; i++) {
+        x[i] = gsl_rng_get(rng);
+    }
+    // another stream of the same seed, or the same stream of another seed,
+    // differs
+    set_philox_stream(rng, 7, 1001);
+    ck_assert_msg((gsl_rng_get(rng) != x[0]), "streams 1000 and 1001 match");
+    set_philox_stream(rng, 8, 1000);
+    ck_assert_msg((gsl_rng_get(rng) != x[0]), "seeds 7 and 8 match");
+    // returning to a stream restarts it
+    set_philox_stream(rng, 7, 1000);
+    for (i = 0; i < 8; i++) {
+        ck_assert_int_eq(gsl_rng_get(rng), x[i]);
+    }
+    gsl_rng_free(rng);
+}
+END_TEST
+
+START_TEST (test_set_philox_stream_wrong_type) {
+    gsl_rng * rng;
+    rng = get_rng(0);
+    set_philox_stream(rng, 7, 1); // SIGABRT
+}
+END_TEST
+
+START_TEST (test_philox_uniform) {
+    int i, reps;
+    double e, u, sum, sum_sq;
+    gsl_rng * rng;
+    rng = gsl_rng_alloc(philox_rng_type);
+    reps = 100000;
+    e = 0.005;
+    sum = 0.0;
+    sum_sq = 0.0;
+    for (i = 0; i < reps; i++) {
+        set_philox_stream(rng, 1, i);
+        u = gsl_rng_uniform(rng);
+        ck_assert_msg(((u >= 0.0) && (u < 1.0)), "uniform is %lf", u);
+        sum += u;
+        sum_sq += u * u;
+    }
+    ck_assert_msg((fabs((sum / reps) - 0.5) < e), "mean is %lf, expecting "
+            "0.5", (sum / reps));
+    ck_assert_msg((fabs((sum_sq / reps) - (1.0 / 3.0)) < e), "mean square "
+            "is %lf, expecting %lf", (sum_sq / reps), (1.0 / 3.0));
+    gsl_rng_free(rng);
+}
+END_TEST
+
+Suite * philox_suite(void) {
+    Suite * s = suite_create("philox");
+
+    TCase * tc_philox = tcase_create("philox_test_case");
+    tcase_add_test(tc_philox, test_philox4x32_10);
+    tcase_add_test(tc_philox, test_philox_rng_type);
+    tcase_add_test(tc_philox, test_set_philox_stream);
+    tcase_add_test_raise_signal(tc_philox, test_set_philox_stream_wrong_type,
+            SIGABRT);
+    tcase_add_test(tc_philox, test_philox_uniform);
+    suite_add_tcase(s, tc_philox);
+
+    return s;
+}
+
+int main(void) {
+    int number_failed;
+    Suite * s = philox_suite();
+    SRunner * sr = srunner_create(s);
+    srunner_run_all(sr, CK_VERBOSE);
+    number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,153 @@
+#include <stdlib.h>
+#include <check.h>
+#include <signal.h>
+#include "../src/piece_queue.c"
+#include "test_utils.h"
+
+static text_buffer * init_text_buffer_line(int x) {
+    text_buffer * t;
+    t = init_text_buffer(1);
+    append_text_buffer_ints(t, &x, 1, "", 0);
+    return t;
+}
+
+START_TEST (test_append_text_buffer_ints) {
+    int x[3] = {12, 0, 345};
+    int y[1] = {2147483647};
+    text_buffer * t;
+    t = init_text_buffer(1);
+    append_text_buffer_ints(t, x, 3, "\t", 1);
+    append_text_buffer_ints(t, y, 1, "\t", 1);
+    append_text_buffer_ints(t, x, 3, ", ", 2);
+    ck_assert_int_eq(t->length, 31);
+    ck_assert_msg((t->length <= t->capacity), "capacity %zu is less than "
+            "length %zu", t->capacity, t->length);
+    ck_assert_msg((strncmp(t->a, "12\t0\t345\n2147483647\n12, 0, 345\n",
+            t->length) == 0), "unexpected text");
+    free_text_buffer(t);
+}
+END_TEST
+
+START_TEST (test_take_piece_queue) {
+    int i;
+    piece_queue * q;
+    q = init_piece_queue(5, 2, NULL, 0);
+    for (i = 0; i < 5; i++) {
+        ck_assert_int_eq(take_piece_queue(q), i);
+    }
+    ck_assert_int_eq(take_piece_queue(q), -1);
+    ck_assert_int_eq(take_piece_queue(q), -1);
+    free_piece_queue(q);
+}
+END_TEST
+
+START_TEST (test_stop_piece_queue) {
+    piece_queue * q;
+    q = init_piece_queue(5, 2, NULL, 0);
+    ck_assert_int_eq(take_piece_queue(q), 0);
+    stop_piece_queue(q);
+    ck_assert_int_eq(take_piece_queue(q), -1);
+    free_piece_queue(q);
+}
+END_TEST
+
+START_TEST (test_finish_piece_queue) {
+    char * s;
+    FILE * stream;
+    piece_queue * q;
+    stream = tmpfile();
+    q = init_piece_queue(4, 2, stream, 1);
+    ck_assert_int_eq(take_piece_queue(q), 0);
+    ck_assert_int_eq(take_piece_queue(q), 1);
+    ck_assert_int_eq(take_piece_queue(q), 2);
+    ck_assert_int_eq(take_piece_queue(q), 3);
+    // pieces finished out of order wait for the ones before them
+    finish_piece_queue(q, 2, init_text_buffer_line(2));
+    finish_piece_queue(q, 1, init_text_buffer_line(1));
+    ck_assert_int_eq(q->num_written, 0);
+    ck_assert_int_eq(ftell(stream), 0);
+    finish_piece_queue(q, 0, init_text_buffer_line(0));
+    ck_assert_int_eq(q->num_written, 3);
+    finish_piece_queue(q, 3, init_text_buffer_line(3));
+    ck_assert_int_eq(q->num_written, 4);
+    ck_assert_int_eq(take_piece_queue(q), -1);
+    free_piece_queue(q);
+    s = read_stream(stream);
+    ck_assert_str_eq(s, "0\n1\n2\n3\n");
+    free(s);
+    fclose(stream);
+}
+END_TEST
+
+START_TEST (test_free_piece_queue_unwritten) {
+    piece_queue * q;
+    q = init_piece_queue(3, 1, NULL, 1);
+    ck_assert_int_eq(take_piece_queue(q), 0);
+    ck_assert_int_eq(take_piece_queue(q), 1);
+    // a stopped job can leave finished pieces behind
+    finish_piece_queue(q, 1, init_text_buffer_line(1));
+    stop_piece_queue(q);
+    ck_assert_int_eq(take_piece_queue(q), -1);
+    free_piece_queue(q);
+}
+END_TEST
+
+START_TEST (test_write_piece_queue) {
+    int x[2] = {3, 1};
+    char * s;
+    FILE * stream;
+    text_buffer * t;
+    piece_queue * q;
+    stream = tmpfile();
+    q = init_piece_queue(2, 2, stream, 0);
+    t = init_text_buffer(1);
+    append_text_buffer_ints(t, x, 2, " ", 1);
+    write_piece_queue(q, t);
+    ck_assert_int_eq(t->length, 0);
+    append_text_buffer_ints(t, x, 1, " ", 1);
+    write_piece_queue(q, t);
+    free_text_buffer(t);
+    free_piece_queue(q);
+    s = read_stream(stream);
+    ck_assert_str_eq(s, "3 1\n3\n");
+    free(s);
+    fclose(stream);
+}
+END_TEST
+
+START_TEST (test_finish_piece_queue_unordered) {
+    piece_queue * q;
+    q = init_piece_queue(2, 1, NULL, 0);
+    finish_piece_queue(q, 0, init_text_buffer(1)); // SIGABRT
+}
+END_TEST
+
+Suite * piece_queue_suite(void) {
+    Suite * s = suite_create("piece_queue");
+
+    TCase * tc_text_buffer = tcase_create("text_buffer_test_case");
+    tcase_add_test(tc_text_buffer, test_append_text_buffer_ints);
+    suite_add_tcase(s, tc_text_buffer);
+
+    TCase * tc_piece_queue = tcase_create("piece_queue_test_case");
+    tcase_add_test(tc_piece_queue, test_take_piece_queue);
+    tcase_add_test(tc_piece_queue, test_stop_piece_queue);
+    tcase_add_test(tc_piece_queue, test_finish_piece_queue);
+    tcase_add_test(tc_piece_queue, test_free_piece_queue_unwritten);
+    tcase_add_test(tc_piece_queue, test_write_piece_queue);
+    tcase_add_test_raise_signal(tc_piece_queue,
+            test_finish_piece_queue_unordered, SIGABRT);
+    suite_add_tcase(s, tc_piece_queue);
+
+    return s;
+}
+
+int main(void) {
+    int number_failed;
+    Suite * s = piece_queue_suite();
+    SRunner * sr = srunner_create(s);
+    srunner_run_all(sr, CK_VERBOSE);
+    number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,180 @@
+#include <stdlib.h>
+#include <check.h>
+#include <signal.h>
+#include <string.h>
+#include "../src/run_stats.c"
+#include "test_utils.h"
+
+static const char * test_phase_names[3] = {"first", "second", "third"};
+
+static void spin(double seconds) {
+    double start;
+    start = get_monotonic_time();
+    while ((get_monotonic_time() - start) < seconds);
+}
+
+static int count_lines(const char * s) {
+    int n;
+    n = 0;
+    for (; *s != '\0'; s++) {
+        if (*s == '\n') n++;
+    }
+    return n;
+}
+
+START_TEST (test_get_monotonic_time) {
+    double t1, t2;
+    t1 = get_monotonic_time();
+    spin(0.001);
+    t2 = get_monotonic_time();
+    ck_assert_msg((t2 >= (t1 + 0.001)), "times were %lf and %lf", t1, t2);
+}
+END_TEST
+
+START_TEST (test_get_peak_rss) {
+    ck_assert_msg((get_peak_rss() > 0), "peak rss was %ld", get_peak_rss());
+}
+END_TEST
+
+START_TEST (test_run_phases) {
+    double first;
+    run_stats * r;
+    r = init_run_stats(test_phase_names, 3);
+    ck_assert_int_eq(r->length, 3);
+    ck_assert_int_eq(r->current, -1);
+    start_run_phase(r, 0);
+    spin(0.002);
+    start_run_phase(r, 2);
+    ck_assert_int_eq(r->current, 2);
+    spin(0.001);
+    stop_run_phase(r);
+    ck_assert_int_eq(r->current, -1);
+    // stopping again does nothing
+    stop_run_phase(r);
+    ck_assert_int_eq(get_run_phase(r, 0)->used, 1);
+    ck_assert_int_eq(get_run_phase(r, 1)->used, 0);
+    ck_assert_int_eq(get_run_phase(r, 2)->used, 1);
+    first = get_run_phase(r, 0)->seconds;
+    ck_assert_msg((first >= 0.002), "first phase took %lf", first);
+    ck_assert_msg((get_run_phase(r, 1)->seconds == 0.0),
+            "unused phase took %lf", get_run_phase(r, 1)->seconds);
+    ck_assert_msg((get_run_phase(r, 2)->seconds >= 0.001),
+            "third phase took %lf", get_run_phase(r, 2)->seconds);
+    ck_assert_msg((get_run_phase(r, 2)->peak_rss > 0),
+            "peak rss was %ld", get_run_phase(r, 2)->peak_rss);
+    // times accumulate when a phase is restarted
+    start_run_phase(r, 0);
+    spin(0.001);
+    stop_run_phase(r);
+    ck_assert_msg((get_run_phase(r, 0)->seconds >= (first + 0.001)),
+            "first phase took %lf", get_run_phase(r, 0)->seconds);
+    ck_assert_msg((get_run_seconds(r) >= (get_run_phase(r, 0)->seconds +
+            get_run_phase(r, 2)->seconds)), "run took %lf",
+            get_run_seconds(r));
+    free_run_stats(r);
+}
+END_TEST
+
+START_TEST (test_write_run_stats) {
+    FILE * stream;
+    char * s;
+    run_stats * r;
+    r = init_run_stats(test_phase_names, 3);
+    start_run_phase(r, 1);
+    get_run_phase(r, 1)->bytes_read = 135;
+    get_run_phase(r, 1)->num_rows = 4;
+    get_run_phase(r, 1)->num_parse_errors = 1;
+    get_run_phase(r, 1)->num_admitted = 3;
+    stop_run_phase(r);
+    stream = tmpfile();
+    write_run_stats(stream, r);
+    s = read_stream(stream);
+    // header, one used phase, run time and peak rss
+    ck_assert_int_eq(count_lines(s), 4);
+    ck_assert_msg((strncmp(s, "phase\tseconds\tbytes_read\trows\t", 30) == 0),
+            "unexpected header:\n%s", s);
+    ck_assert_msg((strstr(s, "\nsecond\t") != NULL),
+            "missing phase:\n%s", s);
+    ck_assert_msg((strstr(s, "\t135\t4\t") != NULL),
+            "missing counters:\n%s", s);
+    ck_assert_msg((strstr(s, "\t1\t3\t") != NULL),
+            "missing counters:\n%s", s);
+    ck_assert_msg((strstr(s, "first") == NULL), "unused phase:\n%s", s);
+    free(s);
+    fclose(stream);
+    free_run_stats(r);
+}
+END_TEST
+
+START_TEST (test_write_run_stats_json) {
+    FILE * stream;
+    char * s;
+    char * second;
+    char * third;
+    run_stats * r;
+    r = init_run_stats(test_phase_names, 3);
+    start_run_phase(r, 1);
+    get_run_phase(r, 1)->bytes_read = 135;
+    start_run_phase(r, 2);
+    get_run_phase(r, 2)->num_admitted = 7;
+    stop_run_phase(r);
+    stream = tmpfile();
+    write_run_stats_json(stream, r);
+    s = read_stream(stream);
+    ck_assert_msg((strncmp(s, "{\n  \"seconds\": ", 15) == 0),
+            "unexpected report:\n%s", s);
+    ck_assert_msg((strstr(s, "\"first\"") == NULL), "unused phase:\n%s", s);
+    second = strstr(s, "{\"name\": \"second\"");
+    third = strstr(s, "{\"name\": \"third\"");
+    ck_assert_msg(((second != NULL) && (third != NULL) && (second < third)),
+            "missing phases:\n%s", s);
+    ck_assert_msg((strstr(second, "\"bytes_read\": 135,") != NULL),
+            "missing counters:\n%s", s);
+    ck_assert_msg((strstr(third, "\"admitted\": 7,") != NULL),
+            "missing counters:\n%s", s);
+    // phases are separated, but not followed, by commas
+    ck_assert_msg((strstr(s, "},\n    {\"name\": \"third\"") != NULL),
+            "phases not separated:\n%s", s);
+    ck_assert_msg((strstr(s, "}\n  ]\n}\n") != NULL),
+            "unexpected end of report:\n%s", s);
+    free(s);
+    fclose(stream);
+    free_run_stats(r);
+}
+END_TEST
+
+START_TEST (test_get_run_phase_fail) {
+    run_stats * r;
+    r = init_run_stats(test_phase_names, 3);
+    get_run_phase(r, 3); // SIGABRT
+}
+END_TEST
+
+Suite * run_stats_suite(void) {
+    Suite * s = suite_create("run_stats");
+
+    TCase * tc_clock = tcase_create("clock_test_case");
+    tcase_add_test(tc_clock, test_get_monotonic_time);
+    tcase_add_test(tc_clock, test_get_peak_rss);
+    suite_add_tcase(s, tc_clock);
+
+    TCase * tc_run_stats = tcase_create("run_stats_test_case");
+    tcase_add_test(tc_run_stats, test_run_phases);
+    tcase_add_test(tc_run_stats, test_write_run_stats);
+    tcase_add_test(tc_run_stats, test_write_run_stats_json);
+    tcase_add_test_raise_signal(tc_run_stats, test_get_run_phase_fail,
+            SIGABRT);
+    suite_add_tcase(s, tc_run_stats);
+
+    return s;
+}
+
+int main(void) {
+    int number_failed;
+    Suite * s = run_stats_suite();
+    SRunner * sr = srunner_create(s);
+    srunner_run_all(sr, CK_VERBOSE);
+    number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,145 @@
+#include <stdlib.h>
+#include <check.h>
+#include <signal.h>
+#include "../src/spill.c"
+#include "test_utils.h"
+
+static void check_spill_topk_matches_sort(int n, int k, int num_levels,
+        size_t memory_budget, int expect_runs) {
+    int i, num_kept;
+    row_ref ref;
+    spill_candidate c;
+    spill_candidate * exp;
+    spill_topk * t;
+    exp = (typeof(*exp) *) calloc(n, sizeof(*exp));
+    t = init_spill_topk(k, memory_budget);
+    for (i = 0; i < n; i++) {
+        if (num_levels > 0) {
+            // coarse distances so that there are many ties
+            exp[i].distance = (double) (rand() % num_levels);
+        }
+        else {
+            exp[i].distance = rand() / (double) RAND_MAX;
+        }
+        exp[i].rank = i;
+        ref.file_index = i % 3;
+        ref.line_num = i;
+        ref.offset = 10L * i;
+        push_spill_topk(t, exp[i].distance, &ref);
+    }
+    ck_assert_int_eq(t->num_offered, n);
+    finish_spill_topk(t);
+    ck_assert_msg(((t->num_runs > 0) == (expect_runs != 0)),
+            "%d runs were spilled", t->num_runs);
+    qsort(exp, n, sizeof(*exp), compare_spill_candidates);
+    num_kept = 0;
+    while (next_spill_topk(t, &c) != 0) {
+        ck_assert_msg((num_kept < k), "more than %d candidates returned", k);
+        ck_assert_msg((c.distance == exp[num_kept].distance),
+                "candidate %d has distance %lf, expected %lf", num_kept,
+                c.distance, exp[num_kept].distance);
+        ck_assert_int_eq(c.rank, exp[num_kept].rank);
+        ck_assert_int_eq(c.ref.line_num, exp[num_kept].rank);
+        ck_assert_int_eq(c.ref.file_index, (exp[num_kept].rank % 3));
+        ck_assert_int_eq(c.ref.offset, (10L * exp[num_kept].rank));
+        num_kept++;
+    }
+    ck_assert_int_eq(num_kept, ((k < n) ? k : n));
+    ck_assert_int_eq(next_spill_topk(t, &c), 0);
+    free_spill_topk(t);
+    free(exp);
+}
+
+START_TEST (test_spill_topk_in_memory) {
+    srand(1);
+    check_spill_topk_matches_sort(1000, 10, 0,
+            (1000 * sizeof(spill_candidate)), 0);
+    // a small k is kept by truncating the buffer rather than spilling
+    check_spill_topk_matches_sort(1000, 10, 0,
+            (64 * sizeof(spill_candidate)), 0);
+}
+END_TEST
+
+START_TEST (test_spill_topk_spilled) {
+    srand(2);
+    check_spill_topk_matches_sort(1000, 50, 0,
+            (64 * sizeof(spill_candidate)), 1);
+    check_spill_topk_matches_sort(1000, 1000, 0,
+            (64 * sizeof(spill_candidate)), 1);
+    check_spill_topk_matches_sort(500, 400, 0, sizeof(spill_candidate), 1);
+    // hundreds of runs, merged from blocks of one or two candidates
+    check_spill_topk_matches_sort(20000, 2000, 0,
+            (16 * sizeof(spill_candidate)), 1);
+}
+END_TEST
+
+START_TEST (test_spill_topk_ties) {
+    srand(3);
+    check_spill_topk_matches_sort(2000, 300, 4,
+            (64 * sizeof(spill_candidate)), 1);
+    check_spill_topk_matches_sort(2000, 7, 2,
+            (64 * sizeof(spill_candidate)), 0);
+}
+END_TEST
+
+START_TEST (test_spill_topk_k_exceeds_n) {
+    srand(4);
+    check_spill_topk_matches_sort(100, 500, 0,
+            (1000 * sizeof(spill_candidate)), 0);
+    check_spill_topk_matches_sort(100, 500, 0,
+            (16 * sizeof(spill_candidate)), 1);
+}
+END_TEST
+
+START_TEST (test_spill_topk_threshold) {
+    int i;
+    row_ref ref;
+    spill_topk * t;
+    ref.file_index = 0;
+    ref.offset = 0;
+    t = init_spill_topk(2, (4 * sizeof(spill_candidate)));
+    for (i = 0; i < 4; i++) {
+        ref.line_num = i;
+        ck_assert_int_eq(push_spill_topk(t, (double) (4 - i), &ref), 1);
+    }
+    ck_assert_msg((t->threshold == HUGE_VAL), "threshold should not be set");
+    // the buffer is full, so it is truncated to {1.0, 2.0}
+    ck_assert_int_eq(push_spill_topk(t, 2.0, &ref), 0);
+    ck_assert_msg((t->threshold == 2.0), "threshold is %lf", t->threshold);
+    ck_assert_int_eq(t->length, 2);
+    ck_assert_int_eq(push_spill_topk(t, 1.5, &ref), 1);
+    ck_assert_int_eq(t->num_runs, 0);
+    free_spill_topk(t);
+}
+END_TEST
+
+START_TEST (test_init_spill_topk_fail) {
+    spill_topk * t;
+    t = init_spill_topk(10, (sizeof(spill_candidate) - 1)); // exit(1)
+}
+END_TEST
+
+Suite * spill_suite(void) {
+    Suite * s = suite_create("spill");
+
+    TCase * tc_spill_topk = tcase_create("spill_topk_test_case");
+    tcase_add_test(tc_spill_topk, test_spill_topk_in_memory);
+    tcase_add_test(tc_spill_topk, test_spill_topk_spilled);
+    tcase_add_test(tc_spill_topk, test_spill_topk_ties);
+    tcase_add_test(tc_spill_topk, test_spill_topk_k_exceeds_n);
+    tcase_add_test(tc_spill_topk, test_spill_topk_threshold);
+    tcase_add_exit_test(tc_spill_topk, test_init_spill_topk_fail, 1);
+    suite_add_tcase(s, tc_spill_topk);
+
+    return s;
+}
+
+int main(void) {
+    int number_failed;
+    Suite * s = spill_suite();
+    SRunner * sr = srunner_create(s);
+    srunner_run_all(sr, CK_VERBOSE);
+    number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,382 @@
+#include <stdlib.h>
+#include <check.h>
+#include <signal.h>
+#include "../src/stat_table.c"
+#include "test_utils.h"
+
+static stat_table * get_test_stat_table(const char * path,
+        c_array * line_buffer) {
+    int i;
+    s_array * paths;
+    s_array * header;
+    s_array * stat_names;
+    i_array * stat_indices;
+    i_array * sample_sizes;
+    d_array * means;
+    d_array * std_devs;
+    stat_table * t;
+    paths = init_s_array(1);
+    header = init_s_array(1);
+    stat_names = init_s_array(1);
+    stat_indices = init_i_array(1);
+    sample_sizes = init_i_array(1);
+    means = init_d_array(1);
+    std_devs = init_d_array(1);
+    append_s_array(paths, path);
+    append_s_array(header, "param1");
+    append_s_array(header, "param2");
+    for (i = 1; i <= 4; i++) {
+        sprintf(line_buffer->a, "stat.%d", i);
+        append_s_array(header, line_buffer->a);
+        append_s_array(stat_names, line_buffer->a);
+        append_i_array(stat_indices, (i + 1));
+        append_i_array(sample_sizes, 4);
+    }
+    append_d_array(means, 0.25);
+    append_d_array(means, 0.2225);
+    append_d_array(means, 2.5);
+    append_d_array(means, 3.0);
+    append_d_array(std_devs, 0.1290994);
+    append_d_array(std_devs, 0.009574271);
+    append_d_array(std_devs, 1.290994);
+    append_d_array(std_devs, 1.154701);
+    t = init_stat_table(header, stat_names, means, std_devs, sample_sizes);
+    load_stat_table(t, paths, line_buffer, stat_indices);
+    free_s_array(paths);
+    free_s_array(header);
+    free_s_array(stat_names);
+    free_i_array(stat_indices);
+    free_i_array(sample_sizes);
+    free_d_array(means);
+    free_d_array(std_devs);
+    return t;
+}
+
+/**
+ * Write a simulation file whose standardized stats are not exactly
+ * representable in single precision. The last two stats take only a few
+ * values, so rows are mostly ordered by the first, many values of which
+ * collapse to the same single-precision value.
+ */
+static void write_rounding_test_file(const char * path, int n) {
+    int i;
+    FILE * f;
+    f = fopen(path, "w");
+    fprintf(f, "param1\tstat.1\tstat.2\tstat.3\n");
+    for (i = 0; i < n; i++) {
+        fprintf(f, "%d\t%.17g\t%.17g\t%d\n", i,
+                (1000.0 + ((rand() % 1000) * 1e-7)),
+                ((rand() % 4) * 0.25), (rand() % 3));
+    }
+    fclose(f);
+}
+
+static stat_table * get_rounding_test_table(const char * path,
+        int precision, int leaf_size) {
+    int i;
+    s_array * paths;
+    s_array * header;
+    s_array * stat_names;
+    c_array * line_buffer;
+    i_array * stat_indices;
+    i_array * sample_sizes;
+    d_array * means;
+    d_array * std_devs;
+    stat_table * t;
+    paths = init_s_array(1);
+    header = init_s_array(4);
+    stat_names = init_s_array(3);
+    line_buffer = init_c_array(1023);
+    stat_indices = init_i_array(3);
+    sample_sizes = init_i_array(3);
+    means = init_d_array(3);
+    std_devs = init_d_array(3);
+    append_s_array(paths, path);
+    append_s_array(header, "param1");
+    for (i = 1; i <= 3; i++) {
+        sprintf(line_buffer->a, "stat.%d", i);
+        append_s_array(header, line_buffer->a);
+        append_s_array(stat_names, line_buffer->a);
+        append_i_array(stat_indices, i);
+        append_i_array(sample_sizes, 100);
+    }
+    append_d_array(means, 0.0);
+    append_d_array(means, 0.5);
+    append_d_array(means, 1.0);
+    append_d_array(std_devs, 1.0);
+    append_d_array(std_devs, 0.25);
+    append_d_array(std_devs, 7.0);
+    t = init_stat_table(header, stat_names, means, std_devs, sample_sizes);
+    set_stat_table_precision(t, precision);
+    load_stat_table(t, paths, line_buffer, stat_indices);
+    if (leaf_size > 0) {
+        build_stat_table_tree(t, leaf_size);
+    }
+    free_s_array(paths);
+    free_s_array(header);
+    free_s_array(stat_names);
+    free_c_array(line_buffer);
+    free_i_array(stat_indices);
+    free_i_array(sample_sizes);
+    free_d_array(means);
+    free_d_array(std_devs);
+    return t;
+}
+
+static void check_float_query_matches_double(stat_table * exp_table,
+        stat_table * t) {
+    int i, q, k;
+    double query[3];
+    neighbor_heap * exp;
+    neighbor_heap * h;
+    int ks[5] = {1, 7, 50, 400, 3000};
+    for (q = 0; q < 10; q++) {
+        query[0] = 1000.0 + ((rand() % 1000) * 1e-7);
+        query[1] = (((rand() % 4) * 0.25) - 0.5) / 0.25;
+        query[2] = ((rand() % 3) - 1.0) / 7.0;
+        for (k = 0; k < 5; k++) {
+            exp = init_neighbor_heap(ks[k], exp_table->ranks);
+            h = init_neighbor_heap(ks[k], t->ranks);
+            query_stat_table(exp_table, query, exp);
+            query_stat_table(t, query, h);
+            sort_neighbor_heap(exp);
+            sort_neighbor_heap(h);
+            ck_assert_int_eq(h->length, exp->length);
+            for (i = 0; i < h->length; i++) {
+                ck_assert_int_eq(t->refs[h->a[i].index].line_num,
+                        exp_table->refs[exp->a[i].index].line_num);
+                ck_assert_msg((h->a[i].distance == exp->a[i].distance),
+                        "neighbor %d of %d has distance %.17g, expected "
+                        "%.17g", i, ks[k], h->a[i].distance,
+                        exp->a[i].distance);
+            }
+            free_neighbor_heap(exp);
+            free_neighbor_heap(h);
+        }
+    }
+}
+
+START_TEST (test_load_stat_table) {
+    int i;
+    c_array * line_buffer;
+    stat_table * t;
+    double e = 0.000001;
+    line_buffer = init_c_array(1023);
+    t = get_test_stat_table("data/test_parameter_stat_samples.txt",
+            line_buffer);
+    ck_assert_int_eq(t->num_rows, 4);
+    ck_assert_int_eq(t->num_stats, 4);
+    ck_assert_int_eq(t->paths->length, 1);
+    ck_assert_msg((t->tree == NULL), "tree should not be built");
+    for (i = 0; i < t->num_rows; i++) {
+        ck_assert_int_eq(t->refs[i].file_index, 0);
+        ck_assert_int_eq(t->refs[i].line_num, (i + 2));
+        ck_assert_int_eq(t->ranks[i], i);
+    }
+    ck_assert_int_eq(t->refs[0].offset, 42);
+    ck_assert_msg(almost_equal(get_stat_table_row(t, 0)[0],
+            ((0.1 - 0.25) / 0.1290994), e), "unexpected standardized stat");
+    ck_assert_msg(almost_equal(get_stat_table_row(t, 3)[3],
+            ((2.0 - 3.0) / 1.154701), e), "unexpected standardized stat");
+    read_stat_table_row(t, 2, line_buffer);
+    ck_assert_msg((strcmp(line_buffer->a, "0\t3.5\t0.3\t0.22\t3.0\t4.0\n") ==
+            0), "unexpected row: %s", line_buffer->a);
+    free_stat_table(t);
+    free_c_array(line_buffer);
+}
+END_TEST
+
+START_TEST (test_stat_table_tree) {
+    int i;
+    c_array * line_buffer;
+    stat_table * t;
+    char * rows[4] = {
+        "0\t3.5\t0.1\t0.21\t1.0\t2.0\n",
+        "0\t3.5\t0.2\t0.23\t2.0\t4.0\n",
+        "0\t3.5\t0.3\t0.22\t3.0\t4.0\n",
+        "0\t3.5\t0.4\t0.23\t4.0\t2.0\n"};
+    line_buffer = init_c_array(1023);
+    t = get_test_stat_table("data/test_parameter_stat_samples.txt",
+            line_buffer);
+    build_stat_table_tree(t, 1);
+    ck_assert_msg((t->tree != NULL), "tree was not built");
+    // rows moved into tree order must keep their references
+    for (i = 0; i < t->num_rows; i++) {
+        ck_assert_int_eq(t->refs[i].line_num, (t->ranks[i] + 2));
+        read_stat_table_row(t, i, line_buffer);
+        ck_assert_msg((strcmp(line_buffer->a, rows[t->ranks[i]]) == 0),
+                "unexpected row: %s", line_buffer->a);
+    }
+    free_stat_table(t);
+    free_c_array(line_buffer);
+}
+END_TEST
+
+START_TEST (test_query_stat_table) {
+    int i, k;
+    c_array * line_buffer;
+    stat_table * linear;
+    stat_table * tree;
+    neighbor_heap * exp;
+    neighbor_heap * h;
+    double query[4] = {-0.3, 1.2, -0.4, 0.8};
+    line_buffer = init_c_array(1023);
+    linear = get_test_stat_table("data/test_parameter_stat_samples.txt",
+            line_buffer);
+    tree = get_test_stat_table("data/test_parameter_stat_samples.txt",
+            line_buffer);
+    build_stat_table_tree(tree, 1);
+    for (k = 1; k <= 5; k++) {
+        exp = init_neighbor_heap(k, linear->ranks);
+        h = init_neighbor_heap(k, tree->ranks);
+        ck_assert_int_eq(query_stat_table(linear, query, exp), 4);
+        query_stat_table(tree, query, h);
+        sort_neighbor_heap(exp);
+        sort_neighbor_heap(h);
+        ck_assert_int_eq(h->length, exp->length);
+        for (i = 0; i < h->length; i++) {
+            ck_assert_int_eq(tree->refs[h->a[i].index].line_num,
+                    linear->refs[exp->a[i].index].line_num);
+            ck_assert_msg((h->a[i].distance == exp->a[i].distance),
+                    "unexpected distance %lf", h->a[i].distance);
+        }
+        free_neighbor_heap(exp);
+        free_neighbor_heap(h);
+    }
+    free_stat_table(linear);
+    free_stat_table(tree);
+    free_c_array(line_buffer);
+}
+END_TEST
+
+START_TEST (test_write_read_stat_table) {
+    int i;
+    char * path = "data/check_stat_table_index.bin";
+    c_array * line_buffer;
+    stat_table * t;
+    stat_table * t2;
+    line_buffer = init_c_array(1023);
+    t = get_test_stat_table("data/test_parameter_stat_samples.txt",
+            line_buffer);
+    build_stat_table_tree(t, 1);
+    write_stat_table(path, t);
+    t2 = read_stat_table(path);
+    remove(path);
+    ck_assert_int_eq(t2->num_rows, t->num_rows);
+    ck_assert_int_eq(t2->num_stats, t->num_stats);
+    ck_assert_msg((s_arrays_equal(t->paths, t2->paths) != 0),
+            "paths do not match");
+    ck_assert_msg((s_arrays_equal(t->header, t2->header) != 0),
+            "headers do not match");
+    ck_assert_msg((s_arrays_equal(t->stat_names, t2->stat_names) != 0),
+            "stat names do not match");
+    ck_assert_msg((memcmp(t->means->a, t2->means->a,
+            t->num_stats * sizeof(double)) == 0), "means do not match");
+    ck_assert_msg((memcmp(t->std_devs->a, t2->std_devs->a,
+            t->num_stats * sizeof(double)) == 0), "std devs do not match");
+    ck_assert_msg((i_arrays_equal(t->sample_sizes, t2->sample_sizes) != 0),
+            "sample sizes do not match");
+    ck_assert_msg((memcmp(t->stats, t2->stats,
+            t->num_rows * t->num_stats * sizeof(double)) == 0),
+            "stats do not match");
+    ck_assert_msg((t2->tree != NULL), "tree was not read");
+    ck_assert_int_eq(t2->tree->leaf_size, 1);
+    for (i = 0; i < t->num_rows; i++) {
+        ck_assert_int_eq(t2->refs[i].line_num, t->refs[i].line_num);
+        ck_assert_int_eq(t2->refs[i].offset, t->refs[i].offset);
+        ck_assert_int_eq(t2->ranks[i], t->ranks[i]);
+        ck_assert_int_eq(t2->tree->split_dims[i], t->tree->split_dims[i]);
+    }
+    free_stat_table(t);
+    free_stat_table(t2);
+    free_c_array(line_buffer);
+}
+END_TEST
+
+START_TEST (test_query_stat_table_f) {
+    char * path = "data/check_stat_table_rounding.txt";
+    stat_table * exp_table;
+    stat_table * linear;
+    stat_table * tree;
+    srand(1);
+    write_rounding_test_file(path, 2000);
+    exp_table = get_rounding_test_table(path, STAT_PRECISION_DOUBLE, 0);
+    linear = get_rounding_test_table(path, STAT_PRECISION_FLOAT, 0);
+    tree = get_rounding_test_table(path, STAT_PRECISION_FLOAT, 4);
+    ck_assert_msg((linear->stats == NULL), "double stats were stored");
+    ck_assert_msg((linear->max_rounding_error > 0.0),
+            "rounding error was not recorded");
+    ck_assert_msg((linear->max_rounding_error < 0.0001),
+            "rounding error is %lf", linear->max_rounding_error);
+    check_float_query_matches_double(exp_table, linear);
+    check_float_query_matches_double(exp_table, tree);
+    remove(path);
+    free_stat_table(exp_table);
+    free_stat_table(linear);
+    free_stat_table(tree);
+}
+END_TEST
+
+START_TEST (test_write_read_stat_table_f) {
+    char * path = "data/check_stat_table_rounding2.txt";
+    char * index_path = "data/check_stat_table_index_f.bin";
+    stat_table * exp_table;
+    stat_table * t;
+    stat_table * t2;
+    srand(2);
+    write_rounding_test_file(path, 500);
+    exp_table = get_rounding_test_table(path, STAT_PRECISION_DOUBLE, 0);
+    t = get_rounding_test_table(path, STAT_PRECISION_FLOAT, 4);
+    write_stat_table(index_path, t);
+    t2 = read_stat_table(index_path);
+    remove(index_path);
+    ck_assert_int_eq(t2->precision, STAT_PRECISION_FLOAT);
+    ck_assert_msg((t2->max_rounding_error == t->max_rounding_error),
+            "rounding error does not match");
+    ck_assert_msg((memcmp(t->fstats, t2->fstats,
+            t->num_rows * t->num_stats * sizeof(float)) == 0),
+            "stats do not match");
+    ck_assert_msg((t2->tree != NULL) && (t2->tree->fpoints == t2->fstats),
+            "tree was not read");
+    check_float_query_matches_double(exp_table, t2);
+    remove(path);
+    free_stat_table(exp_table);
+    free_stat_table(t);
+    free_stat_table(t2);
+}
+END_TEST
+
+START_TEST (test_read_stat_table_fail) {
+    stat_table * t;
+    t = read_stat_table("data/test_parameter_stat_samples.txt"); // exit(1)
+}
+END_TEST
+
+Suite * stat_table_suite(void) {
+    Suite * s = suite_create("stat_table");
+
+    TCase * tc_stat_table = tcase_create("stat_table_test_case");
+    tcase_add_test(tc_stat_table, test_load_stat_table);
+    tcase_add_test(tc_stat_table, test_stat_table_tree);
+    tcase_add_test(tc_stat_table, test_query_stat_table);
+    tcase_add_test(tc_stat_table, test_query_stat_table_f);
+    suite_add_tcase(s, tc_stat_table);
+
+    TCase * tc_stat_table_io = tcase_create("stat_table_io_test_case");
+    tcase_add_test(tc_stat_table_io, test_write_read_stat_table);
+    tcase_add_test(tc_stat_table_io, test_write_read_stat_table_f);
+    tcase_add_exit_test(tc_stat_table_io, test_read_stat_table_fail, 1);
+    suite_add_tcase(s, tc_stat_table_io);
+
+    return s;
+}
+
+int main(void) {
+    int number_failed;
+    Suite * s = stat_table_suite();
+    SRunner * sr = srunner_create(s);
+    srunner_run_all(sr, CK_VERBOSE);
+    number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
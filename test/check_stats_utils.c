@@ -1,6 +1,7 @@
 #include <stdlib.h>
 #include <check.h>
 #include <signal.h>
+#include <string.h>
 #include "../src/stats_utils.c"
 #include "test_utils.h"
 
@@ -327,6 +328,121 @@ START_TEST (test_get_std_dev_array) {
 }
 END_TEST
 
+START_TEST (test_init_sample_moments_fail) {
+    sample_moments * m;
+    m = init_sample_moments(2, 0); // SIGABRT
+}
+END_TEST
+
+START_TEST (test_get_sample_moments_std_devs_n1) {
+    sample_moments * m;
+    d_array * x;
+    d_array * std_devs;
+    m = init_sample_moments(2, 4);
+    x = init_d_array(2);
+    std_devs = init_d_array(2);
+    append_d_array(x, 1.0);
+    append_d_array(x, 2.0);
+    update_sample_moments(m, x);
+    get_sample_moments_std_devs(m, std_devs); // SIGABRT
+}
+END_TEST
+
+START_TEST (test_update_sample_moments) {
+    int i, j, b, ret;
+    int block_sizes[4] = {1, 3, 7, 64};
+    sample_moments * m;
+    sample_sum_array * v;
+    d_array * x;
+    d_array * means;
+    d_array * std_devs;
+    d_array * expected_means;
+    d_array * expected_std_devs;
+    int size = 3;
+    int n = 50;
+    double e = 0.0000001;
+
+    x = init_d_array(size);
+    means = init_d_array(size);
+    std_devs = init_d_array(size);
+    expected_means = init_d_array(size);
+    expected_std_devs = init_d_array(size);
+    v = init_sample_sum_array(size);
+    for (i = 0; i < n; i++) {
+        x->length = 0;
+        for (j = 0; j < size; j++) {
+            append_d_array(x, (((i * 7 + j * 3) % 11) - (j * 2.5)));
+        }
+        update_sample_sum_array(v, x);
+    }
+    get_mean_array(v, expected_means);
+    get_std_dev_array(v, expected_std_devs);
+
+    // the results do not depend on the number of rows buffered
+    for (b = 0; b < 4; b++) {
+        m = init_sample_moments(size, block_sizes[b]);
+        for (i = 0; i < n; i++) {
+            x->length = 0;
+            for (j = 0; j < size; j++) {
+                append_d_array(x, (((i * 7 + j * 3) % 11) - (j * 2.5)));
+            }
+            update_sample_moments(m, x);
+        }
+        get_sample_moments_means(m, means);
+        get_sample_moments_std_devs(m, std_devs);
+        for (j = 0; j < size; j++) {
+            ck_assert_int_eq(m->n[j], n);
+            ret = almost_equal(get_d_array(means, j),
+                    get_d_array(expected_means, j), e);
+            ck_assert_msg((ret != 0), "mean %d is %lf, expecting %lf",
+                    j, get_d_array(means, j),
+                    get_d_array(expected_means, j));
+            ret = almost_equal(get_d_array(std_devs, j),
+                    get_d_array(expected_std_devs, j), e);
+            ck_assert_msg((ret != 0), "std deviation %d is %lf, expecting "
+                    "%lf", j, get_d_array(std_devs, j),
+                    get_d_array(expected_std_devs, j));
+        }
+        free_sample_moments(m);
+    }
+
+    free_sample_sum_array(v);
+    free_d_array(x);
+    free_d_array(means);
+    free_d_array(std_devs);
+    free_d_array(expected_means);
+    free_d_array(expected_std_devs);
+}
+END_TEST
+
+START_TEST (test_update_sample_moments_offset) {
+    int i, ret;
+    sample_moments * m;
+    d_array * x;
+    d_array * std_devs;
+    double e = 0.0000001;
+
+    // a variance that is tiny relative to the mean, which the sums of
+    // squares of `sample_sum` cannot resolve
+    m = init_sample_moments(1, 4);
+    x = init_d_array(1);
+    std_devs = init_d_array(1);
+    for (i = 0; i < 10; i++) {
+        x->length = 0;
+        append_d_array(x, (1e9 + ((i % 2) * 2.0)));
+        update_sample_moments(m, x);
+    }
+    get_sample_moments_std_devs(m, std_devs);
+    ret = almost_equal(get_d_array(std_devs, 0), sqrt(10.0 / 9.0), e);
+    ck_assert_msg((ret != 0), "std deviation is %lf, expecting %lf",
+            get_d_array(std_devs, 0), sqrt(10.0 / 9.0));
+
+    free_sample_moments(m);
+    free_d_array(x);
+    free_d_array(std_devs);
+}
+END_TEST
+
 START_TEST (test_standardize_vector) {
     int i, size, ret;
     double e = 0.0000001;
@@ -382,6 +498,503 @@ START_TEST (test_standardize_vector) {
 }
 END_TEST;
 
+START_TEST (test_init_quantile_sketch_fail) {
+    quantile_sketch * q;
+    q = init_quantile_sketch(1); // SIGABRT
+}
+END_TEST
+
+START_TEST (test_get_quantile_n0) {
+    quantile_sketch * q;
+    q = init_quantile_sketch(8);
+    get_quantile(q, 0.5); // SIGABRT
+}
+END_TEST
+
+START_TEST (test_get_quantile_exact) {
+    int i;
+    double e = 0.000001;
+    const double values[10] = {7.0, 2.0, 9.0, 1.0, 10.0, 4.0, 3.0, 8.0,
+            6.0, 5.0};
+    quantile_sketch * q;
+    q = init_quantile_sketch(16);
+    for (i = 0; i < 10; i++) {
+        update_quantile_sketch(q, values[i]);
+    }
+    ck_assert_int_eq(q->n, 10);
+    ck_assert_msg(almost_equal(get_quantile(q, 0.0), 1.0, e),
+            "min is %lf", get_quantile(q, 0.0));
+    ck_assert_msg(almost_equal(get_quantile(q, 1.0), 10.0, e),
+            "max is %lf", get_quantile(q, 1.0));
+    ck_assert_msg(almost_equal(get_quantile(q, 0.5), 5.5, e),
+            "median is %lf", get_quantile(q, 0.5));
+    ck_assert_msg(almost_equal(get_quantile(q, 0.25), 3.25, e),
+            "first quartile is %lf", get_quantile(q, 0.25));
+    ck_assert_msg(almost_equal(get_quantile(q, 0.9), 9.1, e),
+            "0.9 quantile is %lf", get_quantile(q, 0.9));
+    free_quantile_sketch(q);
+}
+END_TEST
+
+START_TEST (test_get_hpd_interval_exact) {
+    int i;
+    double lower, upper;
+    double e = 0.000001;
+    const double values[5] = {100.0, 2.0, 0.0, 3.0, 1.0};
+    quantile_sketch * q;
+    q = init_quantile_sketch(16);
+    for (i = 0; i < 5; i++) {
+        update_quantile_sketch(q, values[i]);
+    }
+    get_hpd_interval(q, 0.6, &lower, &upper);
+    ck_assert_msg((almost_equal(lower, 0.0, e) &&
+            almost_equal(upper, 2.0, e)), "hpd is [%lf, %lf]", lower, upper);
+    get_hpd_interval(q, 1.0, &lower, &upper);
+    ck_assert_msg((almost_equal(lower, 0.0, e) &&
+            almost_equal(upper, 100.0, e)), "hpd is [%lf, %lf]", lower,
+            upper);
+    free_quantile_sketch(q);
+}
+END_TEST
+
+START_TEST (test_quantile_sketch_compaction) {
+    int i, n;
+    double x, lower, upper;
+    double e = 0.01;
+    quantile_sketch * q;
+    n = 100000;
+    q = init_quantile_sketch(256);
+    // a permutation of the uniform grid on [0, 1)
+    for (i = 0; i < n; i++) {
+        x = ((i * 7919L) % n) / ((double) n);
+        update_quantile_sketch(q, x);
+    }
+    ck_assert_int_eq(q->n, n);
+    ck_assert_msg((q->num_levels > 1), "sketch was not compacted");
+    ck_assert_msg(almost_equal(q->min, 0.0, e), "min is %lf", q->min);
+    ck_assert_msg(almost_equal(q->max, (n - 1) / ((double) n), e),
+            "max is %lf", q->max);
+    ck_assert_msg(almost_equal(get_quantile(q, 0.5), 0.5, e),
+            "median is %lf", get_quantile(q, 0.5));
+    ck_assert_msg(almost_equal(get_quantile(q, 0.025), 0.025, e),
+            "0.025 quantile is %lf", get_quantile(q, 0.025));
+    ck_assert_msg(almost_equal(get_quantile(q, 0.975), 0.975, e),
+            "0.975 quantile is %lf", get_quantile(q, 0.975));
+    get_hpd_interval(q, 0.5, &lower, &upper);
+    ck_assert_msg(almost_equal((upper - lower), 0.5, e),
+            "hpd is [%lf, %lf]", lower, upper);
+    free_quantile_sketch(q);
+}
+END_TEST
+
+START_TEST (test_posterior_summary) {
+    int i;
+    long size;
+    double e = 0.000001;
+    char * str;
+    FILE * stream;
+    s_array * header;
+    s_array * line_array;
+    i_array * columns;
+    posterior_summary * s;
+    const char * lines[4] = {"1.0 5.0 0.5", "2.0 6.0 NA", "3.0 7.0 1.5",
+            "4.0 8.0 2.5"};
+    header = init_s_array(3);
+    line_array = init_s_array(3);
+    columns = init_i_array(2);
+    split_str("alpha beta theta", header, 3);
+    append_i_array(columns, 0);
+    append_i_array(columns, 2);
+    s = init_posterior_summary(header, columns, 16);
+    for (i = 0; i < 4; i++) {
+        split_str(lines[i], line_array, 3);
+        update_posterior_summary(s, line_array);
+    }
+    ck_assert_int_eq(s->moments->n[0], 4);
+    ck_assert_int_eq(s->moments->n[1], 3);
+    ck_assert_msg(almost_equal(s->moments->mean[0], 2.5, e),
+            "mean is %lf", s->moments->mean[0]);
+    ck_assert_msg(almost_equal(get_quantile(s->sketches[1], 0.5), 1.5, e),
+            "median is %lf", get_quantile(s->sketches[1], 0.5));
+
+    stream = tmpfile();
+    write_posterior_summary(stream, s);
+    fflush(stream);
+    size = ftell(stream);
+    rewind(stream);
+    str = (typeof(*str) *) calloc((size + 1), sizeof(*str));
+    ck_assert_int_eq(fread(str, 1, size, stream), size);
+    ck_assert_msg((strncmp(str, "parameter\tn\tmean\tstd_dev\tmin\t", 29) ==
+            0), "unexpected header:\n%s", str);
+    ck_assert_msg((strstr(str, "\nalpha\t4\t2.500000000000\t") != NULL),
+            "missing alpha summary:\n%s", str);
+    ck_assert_msg((strstr(str, "\ntheta\t3\t1.500000000000\t1.000000000000\t"
+            "0.500000000000\t") != NULL), "missing theta summary:\n%s", str);
+    ck_assert_msg((strstr(str, "beta") == NULL),
+            "unexpected beta summary:\n%s", str);
+    free(str);
+    fclose(stream);
+
+    free_posterior_summary(s);
+    free_s_array(header);
+    free_s_array(line_array);
+    free_i_array(columns);
+}
+END_TEST
+
+START_TEST (test_posterior_summary_constant) {
+    int i;
+    long size;
+    char * str;
+    FILE * stream;
+    s_array * header;
+    s_array * line_array;
+    i_array * columns;
+    posterior_summary * s;
+    header = init_s_array(1);
+    line_array = init_s_array(1);
+    columns = init_i_array(1);
+    append_s_array(header, "theta");
+    append_i_array(columns, 0);
+    s = init_posterior_summary(header, columns, 16);
+    // a constant column far from zero, whose sum of squares cancels badly
+    for (i = 0; i < 1000; i++) {
+        split_str("100000.1", line_array, 1);
+        update_posterior_summary(s, line_array);
+    }
+    ck_assert_msg((s->moments->m2[0] == 0.0), "sum of squares is %lf",
+            s->moments->m2[0]);
+    stream = tmpfile();
+    write_posterior_summary(stream, s);
+    fflush(stream);
+    size = ftell(stream);
+    rewind(stream);
+    str = (typeof(*str) *) calloc((size + 1), sizeof(*str));
+    ck_assert_int_eq(fread(str, 1, size, stream), size);
+    ck_assert_msg((strstr(str, "\ntheta\t1000\t100000.100000000006\t"
+            "0.000000000000\t") != NULL), "unexpected summary:\n%s", str);
+    free(str);
+    fclose(stream);
+    free_posterior_summary(s);
+    free_s_array(header);
+    free_s_array(line_array);
+    free_i_array(columns);
+}
+END_TEST
+
+START_TEST (test_write_posterior_summary_na) {
+    long size;
+    char * str;
+    FILE * stream;
+    s_array * header;
+    i_array * columns;
+    posterior_summary * s;
+    header = init_s_array(1);
+    columns = init_i_array(1);
+    append_s_array(header, "alpha");
+    append_i_array(columns, 0);
+    s = init_posterior_summary(header, columns, 16);
+    stream = tmpfile();
+    write_posterior_summary(stream, s);
+    fflush(stream);
+    size = ftell(stream);
+    rewind(stream);
+    str = (typeof(*str) *) calloc((size + 1), sizeof(*str));
+    ck_assert_int_eq(fread(str, 1, size, stream), size);
+    ck_assert_msg((strstr(str, "\nalpha\t0\tNA\tNA\tNA\tNA\tNA\tNA\tNA\tNA\t"
+            "NA\tNA\tNA\n") != NULL), "unexpected summary:\n%s", str);
+    free(str);
+    fclose(stream);
+    free_posterior_summary(s);
+    free_s_array(header);
+    free_i_array(columns);
+}
+END_TEST
+
+
+/**
+ * The sample covariance of columns `i` and `j` of the `n` by `dim` matrix
+ * `x`, calculated directly.
+ */
+static double get_test_covariance(const double * x, int n, int dim, int i,
+        int j) {
+    int k;
+    double mi, mj, s;
+    mi = 0.0;
+    mj = 0.0;
+    for (k = 0; k < n; k++) {
+        mi += x[(k * dim) + i];
+        mj += x[(k * dim) + j];
+    }
+    mi /= n;
+    mj /= n;
+    s = 0.0;
+    for (k = 0; k < n; k++) {
+        s += (x[(k * dim) + i] - mi) * (x[(k * dim) + j] - mj);
+    }
+    return s / (n - 1);
+}
+
+static void fill_test_matrix(double * x, int n, int dim) {
+    int k, i;
+    for (k = 0; k < n; k++) {
+        for (i = 0; i < dim; i++) {
+            x[(k * dim) + i] = 1000.0 + sin((k + 1) * (i + 1.5)) +
+                    (0.01 * k * i);
+        }
+    }
+}
+
+START_TEST (test_init_cov_sum_fail) {
+    cov_sum * c;
+    c = init_cov_sum(0, 4); // SIGABRT
+}
+END_TEST
+
+START_TEST (test_get_cov_sum_index) {
+    int i, j, k;
+    cov_sum * c;
+    c = init_cov_sum(5, 4);
+    for (i = 0, k = 0; i < 5; i++) {
+        for (j = i; j < 5; j++, k++) {
+            ck_assert_int_eq(get_cov_sum_index(c, i, j), k);
+            ck_assert_int_eq(get_cov_sum_index(c, j, i), k);
+        }
+    }
+    free_cov_sum(c);
+}
+END_TEST
+
+START_TEST (test_get_covariance_n1) {
+    d_array * x;
+    cov_sum * c;
+    c = init_cov_sum(1, 4);
+    x = init_d_array(1);
+    append_d_array(x, 1.0);
+    update_cov_sum(c, x);
+    get_covariance(c, 0, 0); // SIGABRT
+}
+END_TEST
+
+START_TEST (test_update_cov_sum) {
+    int n, dim, k, i, j, batch;
+    double e = 0.0000001;
+    double exp, got;
+    double * x;
+    d_array * row;
+    cov_sum * c;
+    n = 50;
+    dim = 11;
+    x = (typeof(*x) *) malloc(n * dim * sizeof(*x));
+    fill_test_matrix(x, n, dim);
+    row = init_d_array(dim);
+    for (batch = 1; batch < 20; batch += 3) {
+        c = init_cov_sum(dim, batch);
+        for (k = 0; k < n; k++) {
+            row->length = 0;
+            for (i = 0; i < dim; i++) {
+                append_d_array(row, x[(k * dim) + i]);
+            }
+            update_cov_sum(c, row);
+        }
+        for (i = 0; i < dim; i++) {
+            for (j = 0; j < dim; j++) {
+                exp = get_test_covariance(x, n, dim, i, j);
+                got = get_covariance(c, i, j);
+                ck_assert_msg(almost_equal(got, exp, e), "batch %d: "
+                        "covariance (%d, %d) is %lf, expecting %lf", batch,
+                        i, j, got, exp);
+            }
+        }
+        ck_assert_int_eq(c->n, n);
+        free_cov_sum(c);
+    }
+    free_d_array(row);
+    free(x);
+}
+END_TEST
+
+START_TEST (test_merge_cov_sum) {
+    int n, dim, k, i, j;
+    double e = 0.0000001;
+    double exp, got;
+    double * x;
+    d_array * row;
+    cov_sum * a;
+    cov_sum * b;
+    cov_sum * empty;
+    n = 37;
+    dim = 3;
+    x = (typeof(*x) *) malloc(n * dim * sizeof(*x));
+    fill_test_matrix(x, n, dim);
+    row = init_d_array(dim);
+    a = init_cov_sum(dim, 5);
+    b = init_cov_sum(dim, 8);
+    empty = init_cov_sum(dim, 8);
+    for (k = 0; k < n; k++) {
+        row->length = 0;
+        for (i = 0; i < dim; i++) {
+            append_d_array(row, x[(k * dim) + i]);
+        }
+        update_cov_sum(((k < 12) ? a : b), row);
+    }
+    merge_cov_sum(a, b);
+    merge_cov_sum(a, empty);
+    ck_assert_int_eq(a->n, n);
+    for (i = 0; i < dim; i++) {
+        for (j = 0; j < dim; j++) {
+            exp = get_test_covariance(x, n, dim, i, j);
+            got = get_covariance(a, i, j);
+            ck_assert_msg(almost_equal(got, exp, e), "covariance (%d, %d) "
+                    "is %lf, expecting %lf", i, j, got, exp);
+        }
+    }
+    merge_cov_sum(empty, a);
+    ck_assert_int_eq(empty->n, n);
+    ck_assert_msg(almost_equal(get_covariance(empty, 0, 2),
+            get_covariance(a, 0, 2), e), "merge into empty sum failed");
+    free_cov_sum(a);
+    free_cov_sum(b);
+    free_cov_sum(empty);
+    free_d_array(row);
+    free(x);
+}
+END_TEST
+
+/**
+ * Returns a sum of the covariances of rows k = 0, ..., n - 1 of
+ * (k mod moduli[0], k mod moduli[1], ...). With coprime moduli and n their
+ * product, the columns are exactly uncorrelated.
+ */
+static cov_sum * get_test_lattice_cov_sum(const int * moduli, int dim,
+        int n) {
+    int k, i;
+    d_array * row;
+    cov_sum * c;
+    c = init_cov_sum(dim, 64);
+    row = init_d_array(dim);
+    for (k = 0; k < n; k++) {
+        row->length = 0;
+        for (i = 0; i < dim; i++) {
+            append_d_array(row, (k % moduli[i]));
+        }
+        update_cov_sum(c, row);
+    }
+    free_d_array(row);
+    return c;
+}
+
+START_TEST (test_parse_projection_method) {
+    ck_assert_int_eq(parse_projection_method("pca"), PROJECTION_PCA);
+    ck_assert_int_eq(parse_projection_method("pls"), PROJECTION_PLS);
+    ck_assert_int_eq(parse_projection_method("PCA"), -1);
+    ck_assert_str_eq(get_projection_method_name(PROJECTION_PLS), "pls");
+}
+END_TEST
+
+START_TEST (test_project_vector) {
+    double e = 0.000001;
+    d_array * x;
+    d_array * scores;
+    d_array * obs;
+    projection * p;
+    p = init_projection(PROJECTION_PCA, 3, 2);
+    p->weights->a[0] = 1.0;
+    p->weights->a[1] = 2.0;
+    p->weights->a[2] = 0.0;
+    p->weights->a[3] = 0.0;
+    p->weights->a[4] = -1.0;
+    p->weights->a[5] = 0.5;
+    x = init_d_array(3);
+    scores = init_d_array(1);
+    obs = init_d_array(2);
+    append_d_array(x, 1.0);
+    append_d_array(x, 2.0);
+    append_d_array(x, 4.0);
+    project_vector(p, x, scores);
+    ck_assert_int_eq(scores->length, 2);
+    ck_assert_msg(almost_equal(scores->a[0], 5.0, e), "score is %lf",
+            scores->a[0]);
+    ck_assert_msg(almost_equal(scores->a[1], 0.0, e), "score is %lf",
+            scores->a[1]);
+    append_d_array(obs, 2.0);
+    append_d_array(obs, 4.0);
+    ck_assert_msg(almost_equal(get_projected_distance(p, obs, x), 5.0, e),
+            "distance is %lf", get_projected_distance(p, obs, x));
+    free_projection(p);
+    free_d_array(x);
+    free_d_array(scores);
+    free_d_array(obs);
+}
+END_TEST
+
+START_TEST (test_get_pca_projection) {
+    int k;
+    double e = 0.000001;
+    d_array * row;
+    cov_sum * c;
+    projection * p;
+    c = init_cov_sum(2, 16);
+    row = init_d_array(2);
+    // any two positively correlated variables have principal components
+    // (1, 1) / sqrt(2) and (1, -1) / sqrt(2)
+    for (k = 0; k < 100; k++) {
+        row->length = 0;
+        append_d_array(row, (k % 10));
+        append_d_array(row, ((k % 10) + (5.0 * (k % 3))));
+        update_cov_sum(c, row);
+    }
+    p = get_pca_projection(c, 2);
+    ck_assert_int_eq(p->method, PROJECTION_PCA);
+    ck_assert_int_eq(p->num_components, 2);
+    ck_assert_msg((almost_equal(p->weights->a[0], sqrt(0.5), e) &&
+            almost_equal(p->weights->a[1], sqrt(0.5), e)),
+            "first component is (%lf, %lf)", p->weights->a[0],
+            p->weights->a[1]);
+    ck_assert_msg((almost_equal(p->weights->a[2], sqrt(0.5), e) &&
+            almost_equal(p->weights->a[3], -sqrt(0.5), e)),
+            "second component is (%lf, %lf)", p->weights->a[2],
+            p->weights->a[3]);
+    free_projection(p);
+    p = get_pca_projection(c, 1);
+    ck_assert_int_eq(p->num_components, 1);
+    ck_assert_int_eq(p->weights->length, 2);
+    free_projection(p);
+    free_cov_sum(c);
+    free_d_array(row);
+}
+END_TEST
+
+START_TEST (test_get_pls_projection) {
+    double e = 0.000001;
+    const int moduli[4] = {7, 11, 13, 7};
+    cov_sum * c;
+    projection * p;
+    // the response is the first stat, and the stats are uncorrelated
+    c = get_test_lattice_cov_sum(moduli, 4, (7 * 11 * 13));
+    p = get_pls_projection(c, 3, 2);
+    ck_assert_int_eq(p->method, PROJECTION_PLS);
+    // one component explains the response
+    ck_assert_int_eq(p->num_components, 1);
+    ck_assert_msg((almost_equal(p->weights->a[0], 1.0, e) &&
+            almost_equal(p->weights->a[1], 0.0, e) &&
+            almost_equal(p->weights->a[2], 0.0, e)),
+            "component is (%lf, %lf, %lf)", p->weights->a[0],
+            p->weights->a[1], p->weights->a[2]);
+    free_projection(p);
+    free_cov_sum(c);
+}
+END_TEST
+
+START_TEST (test_get_pls_projection_uncorrelated) {
+    const int moduli[4] = {3, 5, 7, 11};
+    cov_sum * c;
+    c = get_test_lattice_cov_sum(moduli, 4, (3 * 5 * 7 * 11));
+    ck_assert_msg((get_pls_projection(c, 3, 1) == NULL),
+            "found components of uncorrelated stats");
+    free_cov_sum(c);
+}
+END_TEST
 
 Suite * stats_utils_suite(void) {
     Suite * s = suite_create("stats_utils");
@@ -414,11 +1027,53 @@ Suite * stats_utils_suite(void) {
     tcase_add_test(tc_sample_sum_array, test_get_std_dev_array);
     suite_add_tcase(s, tc_sample_sum_array);
 
+    TCase * tc_sample_moments = tcase_create("sample_moments_test_case");
+    tcase_add_test_raise_signal(tc_sample_moments,
+            test_init_sample_moments_fail, SIGABRT);
+    tcase_add_test_raise_signal(tc_sample_moments,
+            test_get_sample_moments_std_devs_n1, SIGABRT);
+    tcase_add_test(tc_sample_moments, test_update_sample_moments);
+    tcase_add_test(tc_sample_moments, test_update_sample_moments_offset);
+    suite_add_tcase(s, tc_sample_moments);
+
     TCase * tc_standardize_vector = tcase_create(
             "standardize_vector_test_case");
     tcase_add_test(tc_standardize_vector, test_standardize_vector);
     suite_add_tcase(s, tc_standardize_vector);
 
+    TCase * tc_cov_sum = tcase_create("cov_sum_test_case");
+    tcase_add_test_raise_signal(tc_cov_sum, test_init_cov_sum_fail, SIGABRT);
+    tcase_add_test(tc_cov_sum, test_get_cov_sum_index);
+    tcase_add_test_raise_signal(tc_cov_sum, test_get_covariance_n1, SIGABRT);
+    tcase_add_test(tc_cov_sum, test_update_cov_sum);
+    tcase_add_test(tc_cov_sum, test_merge_cov_sum);
+    suite_add_tcase(s, tc_cov_sum);
+
+    TCase * tc_projection = tcase_create("projection_test_case");
+    tcase_add_test(tc_projection, test_parse_projection_method);
+    tcase_add_test(tc_projection, test_project_vector);
+    tcase_add_test(tc_projection, test_get_pca_projection);
+    tcase_add_test(tc_projection, test_get_pls_projection);
+    tcase_add_test(tc_projection, test_get_pls_projection_uncorrelated);
+    suite_add_tcase(s, tc_projection);
+
+    TCase * tc_quantile_sketch = tcase_create("quantile_sketch_test_case");
+    tcase_add_test_raise_signal(tc_quantile_sketch,
+            test_init_quantile_sketch_fail, SIGABRT);
+    tcase_add_test_raise_signal(tc_quantile_sketch, test_get_quantile_n0,
+            SIGABRT);
+    tcase_add_test(tc_quantile_sketch, test_get_quantile_exact);
+    tcase_add_test(tc_quantile_sketch, test_get_hpd_interval_exact);
+    tcase_add_test(tc_quantile_sketch, test_quantile_sketch_compaction);
+    suite_add_tcase(s, tc_quantile_sketch);
+
+    TCase * tc_posterior_summary = tcase_create(
+            "posterior_summary_test_case");
+    tcase_add_test(tc_posterior_summary, test_posterior_summary);
+    tcase_add_test(tc_posterior_summary, test_posterior_summary_constant);
+    tcase_add_test(tc_posterior_summary, test_write_posterior_summary_na);
+    suite_add_tcase(s, tc_posterior_summary);
+
     return s;
 }
 
@@ -20,4 +20,16 @@
 
 #include "test_utils.h"
 
+char * read_stream(FILE * stream) {
+    long size;
+    char * s;
+    fflush(stream);
+    size = ftell(stream);
+    rewind(stream);
+    s = (typeof(*s) *) calloc((size + 1), sizeof(*s));
+    ck_assert_int_eq(fread(s, 1, size, stream), size);
+    s[size] = '\0';
+    return s;
+}
+
 
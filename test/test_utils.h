@@ -21,6 +21,32 @@
 #ifndef TEST_UTILS_H
 #define TEST_UTILS_H
 
+#include <stdio.h>
+#include <stdlib.h>
+#include <check.h>
+
+/**
+ * Return the text written to `stream` so far, as a string that the caller
+ * frees; the stream is left at its start.
+ */
+char * read_stream(FILE * stream);
+
+#ifdef BIG_INT_H
+/**
+ * Return `b` as `write_big_int` writes it. It is defined here, rather than
+ * in test_utils.c, so that only the tests that include big_int.h need
+ * big_int.c.
+ */
+static inline char * big_int_to_str(const big_int * b) {
+    FILE * stream;
+    char * s;
+    stream = tmpfile();
+    write_big_int(stream, b);
+    s = read_stream(stream);
+    fclose(stream);
+    return s;
+}
+#endif
 
 #endif /* TEST_UTILS_H */
 